@@ -72,6 +72,11 @@ export class Api {
         const {top} = await this.invokeEndpointFuture('getTopGpuProcess', {blacklist});
         return top;
     }
+    // overlay thread cpu time in ms per second of running, null when no overlay has measured it yet
+    static async getOverlayCpuCost(): Promise<number|null> {
+        const {msPerSecond} = await this.invokeEndpointFuture('getOverlayCpuCost', {});
+        return msPerSecond;
+    }
     static async enumerateAdapters(): Promise<Adapter[]> {
         const {adapters} = await this.invokeEndpointFuture('enumerateAdapters', {});
         if (!Array.isArray(adapters)) {
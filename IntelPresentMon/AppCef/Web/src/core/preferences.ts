@@ -25,6 +25,8 @@ export interface Preferences {
     independentWindow: boolean;
     samplingPeriodMs: number;
     samplesPerFrame: number;
+    minOverlayRefreshRate: number;
+    maxOverlayRefreshRate: number;
     telemetrySamplingPeriodMs: number;
     metricsOffset: number;
     metricsWindow: number;
@@ -64,6 +66,8 @@ export function makeDefaultPreferences(): Preferences {
         independentWindow: false,
         samplingPeriodMs: 100, 
         samplesPerFrame: 1, 
+        minOverlayRefreshRate: 4, // refresh rate with no new frames from the target
+        maxOverlayRefreshRate: 0, // 0 for every overlay frame
         telemetrySamplingPeriodMs: 100, 
         metricsOffset: 1020, 
         metricsWindow: 1000, 
@@ -38,6 +38,8 @@ namespace p2c::client::util
             .upscaleFactor = traversedPref["upscaleFactor"],
             .samplingPeriodMs = traversedPref["samplingPeriodMs"],
             .samplesPerFrame = traversedPref["samplesPerFrame"],
+            .minRefreshRate = traversedPref["minOverlayRefreshRate"],
+            .maxRefreshRate = traversedPref["maxOverlayRefreshRate"],
             .telemetrySamplingPeriodMs = traversedPref["telemetrySamplingPeriodMs"],
             .hideDuringCapture = traversedPref["hideDuringCapture"],
             .hideAlways = traversedPref["hideAlways"],
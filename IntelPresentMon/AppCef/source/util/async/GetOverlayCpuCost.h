@@ -0,0 +1,21 @@
+// Copyright (C) 2022 Intel Corporation
+// SPDX-License-Identifier: MIT
+#pragma once
+#include "../AsyncEndpoint.h"
+#include <Core/source/kernel/Kernel.h>
+#include "../CefValues.h"
+
+namespace p2c::client::util::async
+{
+    class GetOverlayCpuCost : public AsyncEndpoint
+    {
+    public:
+        static constexpr std::string GetKey() { return "getOverlayCpuCost"; }
+        GetOverlayCpuCost() : AsyncEndpoint{ AsyncEndpoint::Environment::KernelTask } {}
+        // {} => {msPerSecond: number|null}
+        Result ExecuteOnKernelTask(uint64_t uid, CefRefPtr<CefValue> pArgObj, kern::Kernel& kernel) const override
+        {
+            return Result{ true, MakeCefObject(CefProp{ "msPerSecond", kernel.GetOverlayCpuCost() }) };
+        }
+    };
+}
@@ -29,7 +29,7 @@ class CpuTelemetry {
       return cpuTelemetryCapBits_;
   }
 
-  std::string GetCpuName();
+  virtual std::string GetCpuName();
   double GetCpuPowerLimit() { return 0.; }
   
   // constants
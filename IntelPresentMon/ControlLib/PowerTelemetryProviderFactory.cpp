@@ -4,6 +4,7 @@
 #include "IntelPowerTelemetryProvider.h"
 #include "NvidiaPowerTelemetryProvider.h"
 #include "AmdPowerTelemetryProvider.h"
+#include "SimulatedPowerTelemetryProvider.h"
 
 namespace pwr
 {
@@ -16,4 +17,8 @@ namespace pwr
 		}
 		return {};
 	}
+	std::unique_ptr<PowerTelemetryProvider> PowerTelemetryProviderFactory::MakeSimulated(const sim::SimulatedTelemetryConfig& config)
+	{
+		return std::make_unique<sim::SimulatedPowerTelemetryProvider>(config);
+	}
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: MIT
 #pragma once
 #include "PowerTelemetryProvider.h"
+#include "SimulatedTelemetryScript.h"
 #include "../PresentMonAPI2/PresentMonAPI.h"
 #include <memory>
 
@@ -11,5 +12,6 @@ namespace pwr
 	{
 	public:
 		static std::unique_ptr<PowerTelemetryProvider> Make(PM_DEVICE_VENDOR vendor);
+		static std::unique_ptr<PowerTelemetryProvider> MakeSimulated(const sim::SimulatedTelemetryConfig& config);
 	};
 }
\ No newline at end of file
@@ -0,0 +1,64 @@
+// Copyright (C) 2022 Intel Corporation
+// SPDX-License-Identifier: MIT
+#include "SimulatedCpu.h"
+#include <thread>
+#include <chrono>
+
+namespace pwr::cpu::sim {
+
+SimulatedCpu::SimulatedCpu(const pwr::sim::SimulatedTelemetryConfig& config)
+    : script_{config.pScript},
+      sampling_latency_ms_{config.samplingLatencyMs} {
+  if (!script_) {
+    throw std::runtime_error{"Simulated cpu created without a script"};
+  }
+  // vendor is inferred from the cpu name by the service, so encode it there
+  switch (config.vendor) {
+    case PM_DEVICE_VENDOR_INTEL: cpu_name_ = "Simulated Intel CPU"; break;
+    case PM_DEVICE_VENDOR_AMD: cpu_name_ = "Simulated AMD CPU"; break;
+    default: cpu_name_ = "Simulated CPU"; break;
+  }
+  QueryPerformanceFrequency(&frequency_);
+  QueryPerformanceCounter(&start_qpc_);
+}
+
+bool SimulatedCpu::Sample() noexcept {
+  if (sampling_latency_ms_ > 0.) {
+    std::this_thread::sleep_for(
+        std::chrono::duration<double, std::milli>{sampling_latency_ms_});
+  }
+
+  LARGE_INTEGER qpc;
+  QueryPerformanceCounter(&qpc);
+
+  const auto elapsed_ms = double(qpc.QuadPart - start_qpc_.QuadPart) * 1000. /
+                          double(frequency_.QuadPart);
+  const auto step = script_->FindCpuStep(elapsed_ms);
+  if (!step) {
+    return true;
+  }
+
+  auto info = step->info;
+  info.qpc = (uint64_t)qpc.QuadPart;
+  for (size_t i = 0; i < step->caps.size(); i++) {
+    if (step->caps[i]) {
+      SetTelemetryCapBit(CpuTelemetryCapBits(i));
+    }
+  }
+
+  // insert telemetry into history
+  std::lock_guard lock{history_mutex_};
+  history_.Push(info);
+
+  return true;
+}
+
+std::optional<CpuTelemetryInfo> SimulatedCpu::GetClosest(uint64_t qpc)
+      const noexcept {
+  std::lock_guard lock{history_mutex_};
+  return history_.GetNearest(qpc);
+}
+
+std::string SimulatedCpu::GetCpuName() { return cpu_name_; }
+
+}  // namespace pwr::cpu::sim
@@ -0,0 +1,36 @@
+// Copyright (C) 2022 Intel Corporation
+// SPDX-License-Identifier: MIT
+#pragma once
+#define NOMINMAX
+#include <Windows.h>
+#include "CpuTelemetry.h"
+#include "TelemetryHistory.h"
+#include "SimulatedTelemetryScript.h"
+#include <mutex>
+#include <optional>
+#include <memory>
+
+namespace pwr::cpu::sim {
+
+// cpu telemetry source that plays back the cpu steps of a telemetry script
+class SimulatedCpu : public CpuTelemetry {
+ public:
+  SimulatedCpu(const pwr::sim::SimulatedTelemetryConfig& config);
+  bool Sample() noexcept override;
+  std::optional<CpuTelemetryInfo> GetClosest(
+      uint64_t qpc) const noexcept override;
+  std::string GetCpuName() override;
+
+ private:
+  // data
+  std::shared_ptr<const pwr::sim::TelemetryScript> script_;
+  double sampling_latency_ms_;
+  LARGE_INTEGER start_qpc_ = {};
+  LARGE_INTEGER frequency_ = {};
+  std::string cpu_name_;
+
+  mutable std::mutex history_mutex_;
+  TelemetryHistory<CpuTelemetryInfo> history_{CpuTelemetry::defaultHistorySize};
+};
+
+}  // namespace pwr::cpu::sim
@@ -0,0 +1,94 @@
+// Copyright (C) 2022 Intel Corporation
+// SPDX-License-Identifier: MIT
+#define NOMINMAX
+#include <Windows.h>
+#include "SimulatedPowerTelemetryAdapter.h"
+#include <format>
+#include <thread>
+#include <chrono>
+
+namespace pwr::sim
+{
+	SimulatedPowerTelemetryAdapter::SimulatedPowerTelemetryAdapter(const SimulatedTelemetryConfig& config, uint32_t index, uint64_t startQpc)
+		:
+		pScript{ config.pScript },
+		vendor{ config.vendor },
+		samplingLatencyMs{ config.samplingLatencyMs },
+		startQpc{ startQpc },
+		name{ std::format("Simulated Adapter {}", index) }
+	{
+		LARGE_INTEGER freq;
+		QueryPerformanceFrequency(&freq);
+		qpcPeriodMs = 1000. / double(freq.QuadPart);
+	}
+
+	bool SimulatedPowerTelemetryAdapter::Sample() noexcept
+	{
+		if (samplingLatencyMs > 0.) {
+			std::this_thread::sleep_for(std::chrono::duration<double, std::milli>{ samplingLatencyMs });
+		}
+
+		LARGE_INTEGER qpc;
+		QueryPerformanceCounter(&qpc);
+
+		const auto pStep = pScript->FindGpuStep(double(qpc.QuadPart - startQpc) * qpcPeriodMs);
+		if (!pStep) {
+			return true;
+		}
+
+		auto info = pStep->info;
+		info.qpc = (uint64_t)qpc.QuadPart;
+		for (size_t i = 0; i < pStep->caps.size(); i++) {
+			if (pStep->caps[i]) {
+				SetTelemetryCapBit(GpuTelemetryCapBits(i));
+			}
+		}
+
+		// insert telemetry into history
+		std::lock_guard lock{ historyMutex };
+		history.Push(info);
+
+		return true;
+	}
+
+	std::optional<PresentMonPowerTelemetryInfo> SimulatedPowerTelemetryAdapter::GetClosest(uint64_t qpc) const noexcept
+	{
+		std::lock_guard lock{ historyMutex };
+		return history.GetNearest(qpc);
+	}
+
+	PM_DEVICE_VENDOR SimulatedPowerTelemetryAdapter::GetVendor() const noexcept
+	{
+		return vendor;
+	}
+
+	std::string SimulatedPowerTelemetryAdapter::GetName() const noexcept
+	{
+		return name;
+	}
+
+	// static properties are taken from the start of the script
+	uint64_t SimulatedPowerTelemetryAdapter::GetDedicatedVideoMemory() const noexcept
+	{
+		if (const auto pStep = pScript->FindGpuStep(0.)) {
+			return pStep->info.gpu_mem_total_size_b;
+		}
+		return 0;
+	}
+
+	uint64_t SimulatedPowerTelemetryAdapter::GetVideoMemoryMaxBandwidth() const noexcept
+	{
+		if (const auto pStep = pScript->FindGpuStep(0.)) {
+			return pStep->info.gpu_mem_max_bandwidth_bps;
+		}
+		return 0;
+	}
+
+	double SimulatedPowerTelemetryAdapter::GetSustainedPowerLimit() const noexcept
+	{
+		if (const auto pStep = pScript->FindGpuStep(0.)) {
+			return pStep->info.gpu_sustained_power_limit_w;
+		}
+		return 0.;
+	}
+}
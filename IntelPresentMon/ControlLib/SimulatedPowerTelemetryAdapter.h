@@ -0,0 +1,37 @@
+// Copyright (C) 2022 Intel Corporation
+// SPDX-License-Identifier: MIT
+#pragma once
+#include "PowerTelemetryAdapter.h"
+#include "TelemetryHistory.h"
+#include "SimulatedTelemetryScript.h"
+#include <mutex>
+#include <optional>
+#include <memory>
+
+namespace pwr::sim
+{
+	// adapter that plays back a telemetry script instead of querying vendor driver libraries
+	class SimulatedPowerTelemetryAdapter : public PowerTelemetryAdapter
+	{
+	public:
+		SimulatedPowerTelemetryAdapter(const SimulatedTelemetryConfig& config, uint32_t index, uint64_t startQpc);
+		bool Sample() noexcept override;
+		std::optional<PresentMonPowerTelemetryInfo> GetClosest(uint64_t qpc) const noexcept override;
+		PM_DEVICE_VENDOR GetVendor() const noexcept override;
+		std::string GetName() const noexcept override;
+		uint64_t GetDedicatedVideoMemory() const noexcept override;
+		uint64_t GetVideoMemoryMaxBandwidth() const noexcept override;
+		double GetSustainedPowerLimit() const noexcept override;
+
+	private:
+		// data
+		std::shared_ptr<const TelemetryScript> pScript;
+		PM_DEVICE_VENDOR vendor;
+		double samplingLatencyMs;
+		uint64_t startQpc;
+		double qpcPeriodMs;
+		std::string name;
+		mutable std::mutex historyMutex;
+		TelemetryHistory<PresentMonPowerTelemetryInfo> history{ PowerTelemetryAdapter::defaultHistorySize };
+	};
+}
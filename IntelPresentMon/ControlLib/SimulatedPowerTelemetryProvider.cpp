@@ -0,0 +1,34 @@
+// Copyright (C) 2022 Intel Corporation
+// SPDX-License-Identifier: MIT
+#define NOMINMAX
+#include <Windows.h>
+#include "SimulatedPowerTelemetryProvider.h"
+#include "SimulatedPowerTelemetryAdapter.h"
+#include <stdexcept>
+
+namespace pwr::sim
+{
+    SimulatedPowerTelemetryProvider::SimulatedPowerTelemetryProvider(const SimulatedTelemetryConfig& config)
+    {
+        if (!config.pScript) {
+            throw std::runtime_error{ "Simulated telemetry provider created without a script" };
+        }
+        // all adapters share a common time origin so that playback is in lockstep
+        LARGE_INTEGER startQpc;
+        QueryPerformanceCounter(&startQpc);
+        for (uint32_t i = 0; i < config.adapterCount; i++) {
+            adapterPtrs.push_back(std::make_shared<SimulatedPowerTelemetryAdapter>(
+                config, i, (uint64_t)startQpc.QuadPart));
+        }
+    }
+
+    const std::vector<std::shared_ptr<PowerTelemetryAdapter>>& SimulatedPowerTelemetryProvider::GetAdapters() noexcept
+    {
+        return adapterPtrs;
+    }
+
+    uint32_t SimulatedPowerTelemetryProvider::GetAdapterCount() const noexcept
+    {
+        return (uint32_t)adapterPtrs.size();
+    }
+}
@@ -0,0 +1,21 @@
+// Copyright (C) 2022 Intel Corporation
+// SPDX-License-Identifier: MIT
+#pragma once
+#include <vector>
+#include <memory>
+#include "PowerTelemetryProvider.h"
+#include "SimulatedTelemetryScript.h"
+
+namespace pwr::sim
+{
+    class SimulatedPowerTelemetryProvider : public PowerTelemetryProvider
+    {
+    public:
+        SimulatedPowerTelemetryProvider(const SimulatedTelemetryConfig& config);
+        const std::vector<std::shared_ptr<PowerTelemetryAdapter>>& GetAdapters() noexcept override;
+        uint32_t GetAdapterCount() const noexcept override;
+
+    private:
+        std::vector<std::shared_ptr<PowerTelemetryAdapter>> adapterPtrs;
+    };
+}
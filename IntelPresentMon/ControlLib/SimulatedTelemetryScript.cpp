@@ -0,0 +1,283 @@
+// Copyright (C) 2022 Intel Corporation
+// SPDX-License-Identifier: MIT
+#include "SimulatedTelemetryScript.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <numbers>
+#include <cmath>
+#include <format>
+#include <stdexcept>
+
+namespace pwr::sim
+{
+    namespace
+    {
+        template<class I, class B>
+        struct FieldSetter
+        {
+            const char* name;
+            B bit;
+            void(*Set)(I&, double);
+        };
+
+        using G = PresentMonPowerTelemetryInfo;
+        using GB = GpuTelemetryCapBits;
+        const FieldSetter<G, GB> gpuFields[] = {
+            { "gpu_power", GB::gpu_power, [](G& i, double v) { i.gpu_power_w = v; } },
+            { "gpu_sustained_power_limit", GB::gpu_sustained_power_limit, [](G& i, double v) { i.gpu_sustained_power_limit_w = v; } },
+            { "gpu_voltage", GB::gpu_voltage, [](G& i, double v) { i.gpu_voltage_v = v; } },
+            { "gpu_frequency", GB::gpu_frequency, [](G& i, double v) { i.gpu_frequency_mhz = v; } },
+            { "gpu_temperature", GB::gpu_temperature, [](G& i, double v) { i.gpu_temperature_c = v; } },
+            { "gpu_utilization", GB::gpu_utilization, [](G& i, double v) { i.gpu_utilization = v; } },
+            { "gpu_render_compute_utilization", GB::gpu_render_compute_utilization, [](G& i, double v) { i.gpu_render_compute_utilization = v; } },
+            { "gpu_media_utilization", GB::gpu_media_utilization, [](G& i, double v) { i.gpu_media_utilization = v; } },
+            { "vram_power", GB::vram_power, [](G& i, double v) { i.vram_power_w = v; } },
+            { "vram_voltage", GB::vram_voltage, [](G& i, double v) { i.vram_voltage_v = v; } },
+            { "vram_frequency", GB::vram_frequency, [](G& i, double v) { i.vram_frequency_mhz = v; } },
+            { "vram_effective_frequency", GB::vram_effective_frequency, [](G& i, double v) { i.vram_effective_frequency_gbps = v; } },
+            { "vram_temperature", GB::vram_temperature, [](G& i, double v) { i.vram_temperature_c = v; } },
+            { "fan_speed_0", GB::fan_speed_0, [](G& i, double v) { i.fan_speed_rpm[0] = v; } },
+            { "fan_speed_1", GB::fan_speed_1, [](G& i, double v) { i.fan_speed_rpm[1] = v; } },
+            { "fan_speed_2", GB::fan_speed_2, [](G& i, double v) { i.fan_speed_rpm[2] = v; } },
+            { "fan_speed_3", GB::fan_speed_3, [](G& i, double v) { i.fan_speed_rpm[3] = v; } },
+            { "fan_speed_4", GB::fan_speed_4, [](G& i, double v) { i.fan_speed_rpm[4] = v; } },
+            // psu entries are simulated as pcie supplies, value is the power draw
+            { "psu_info_0", GB::psu_info_0, [](G& i, double v) { i.psu[0] = { PresentMonPsuType::Pcie, v, 12. }; } },
+            { "psu_info_1", GB::psu_info_1, [](G& i, double v) { i.psu[1] = { PresentMonPsuType::Pcie, v, 12. }; } },
+            { "psu_info_2", GB::psu_info_2, [](G& i, double v) { i.psu[2] = { PresentMonPsuType::Pcie, v, 12. }; } },
+            { "psu_info_3", GB::psu_info_3, [](G& i, double v) { i.psu[3] = { PresentMonPsuType::Pcie, v, 12. }; } },
+            { "psu_info_4", GB::psu_info_4, [](G& i, double v) { i.psu[4] = { PresentMonPsuType::Pcie, v, 12. }; } },
+            { "gpu_mem_size", GB::gpu_mem_size, [](G& i, double v) { i.gpu_mem_total_size_b = uint64_t(v); } },
+            { "gpu_mem_used", GB::gpu_mem_used, [](G& i, double v) { i.gpu_mem_used_b = uint64_t(v); } },
+            { "gpu_mem_max_bandwidth", GB::gpu_mem_max_bandwidth, [](G& i, double v) { i.gpu_mem_max_bandwidth_bps = uint64_t(v); } },
+            { "gpu_mem_write_bandwidth", GB::gpu_mem_write_bandwidth, [](G& i, double v) { i.gpu_mem_write_bandwidth_bps = v; } },
+            { "gpu_mem_read_bandwidth", GB::gpu_mem_read_bandwidth, [](G& i, double v) { i.gpu_mem_read_bandwidth_bps = v; } },
+            { "gpu_power_limited", GB::gpu_power_limited, [](G& i, double v) { i.gpu_power_limited = v != 0.; } },
+            { "gpu_temperature_limited", GB::gpu_temperature_limited, [](G& i, double v) { i.gpu_temperature_limited = v != 0.; } },
+            { "gpu_current_limited", GB::gpu_current_limited, [](G& i, double v) { i.gpu_current_limited = v != 0.; } },
+            { "gpu_voltage_limited", GB::gpu_voltage_limited, [](G& i, double v) { i.gpu_voltage_limited = v != 0.; } },
+            { "gpu_utilization_limited", GB::gpu_utilization_limited, [](G& i, double v) { i.gpu_utilization_limited = v != 0.; } },
+            { "vram_power_limited", GB::vram_power_limited, [](G& i, double v) { i.vram_power_limited = v != 0.; } },
+            { "vram_temperature_limited", GB::vram_temperature_limited, [](G& i, double v) { i.vram_temperature_limited = v != 0.; } },
+            { "vram_current_limited", GB::vram_current_limited, [](G& i, double v) { i.vram_current_limited = v != 0.; } },
+            { "vram_voltage_limited", GB::vram_voltage_limited, [](G& i, double v) { i.vram_voltage_limited = v != 0.; } },
+            { "vram_utilization_limited", GB::vram_utilization_limited, [](G& i, double v) { i.vram_utilization_limited = v != 0.; } },
+        };
+
+        using C = CpuTelemetryInfo;
+        using CB = CpuTelemetryCapBits;
+        const FieldSetter<C, CB> cpuFields[] = {
+            { "cpu_utilization", CB::cpu_utilization, [](C& i, double v) { i.cpu_utilization = v; } },
+            { "cpu_power", CB::cpu_power, [](C& i, double v) { i.cpu_power_w = v; } },
+            { "cpu_power_limit", CB::cpu_power_limit, [](C& i, double v) { i.cpu_power_limit_w = v; } },
+            { "cpu_temperature", CB::cpu_temperature, [](C& i, double v) { i.cpu_temperature = v; } },
+            { "cpu_frequency", CB::cpu_frequency, [](C& i, double v) { i.cpu_frequency = v; } },
+        };
+
+        // parse "offset key=value key=value ..." on top of the previous step of the same kind
+        template<class S, class F, size_t N>
+        void ParseStep_(std::istringstream& line, int lineNumber, std::vector<S>& steps, const F(&fields)[N])
+        {
+            S step = steps.empty() ? S{} : steps.back();
+            if (!(line >> step.offsetMs)) {
+                throw std::runtime_error{ std::format("Telemetry script line {}: missing time offset", lineNumber) };
+            }
+            if (!steps.empty() && step.offsetMs < steps.back().offsetMs) {
+                throw std::runtime_error{ std::format("Telemetry script line {}: time offsets must not decrease", lineNumber) };
+            }
+            std::string token;
+            while (line >> token) {
+                const auto eq = token.find('=');
+                if (eq == std::string::npos) {
+                    throw std::runtime_error{ std::format("Telemetry script line {}: expected key=value, got [{}]", lineNumber, token) };
+                }
+                const auto key = token.substr(0, eq);
+                const auto pField = std::ranges::find_if(fields, [&](const auto& f) { return key == f.name; });
+                if (pField == std::end(fields)) {
+                    throw std::runtime_error{ std::format("Telemetry script line {}: unknown field [{}]", lineNumber, key) };
+                }
+                double value = 0.;
+                try {
+                    value = std::stod(token.substr(eq + 1));
+                }
+                catch (const std::exception&) {
+                    throw std::runtime_error{ std::format("Telemetry script line {}: bad value for field [{}]", lineNumber, key) };
+                }
+                pField->Set(step.info, value);
+                step.caps.set(size_t(pField->bit));
+            }
+            steps.push_back(step);
+        }
+    }
+
+    std::shared_ptr<const TelemetryScript> TelemetryScript::Parse(std::istream& in)
+    {
+        auto pScript = std::make_shared<TelemetryScript>();
+        std::string lineText;
+        int lineNumber = 0;
+        while (std::getline(in, lineText)) {
+            lineNumber++;
+            if (const auto hash = lineText.find('#'); hash != std::string::npos) {
+                lineText.resize(hash);
+            }
+            std::istringstream line{ lineText };
+            std::string kind;
+            if (!(line >> kind)) {
+                continue;
+            }
+            if (kind == "gpu") {
+                ParseStep_(line, lineNumber, pScript->gpuSteps_, gpuFields);
+            }
+            else if (kind == "cpu") {
+                ParseStep_(line, lineNumber, pScript->cpuSteps_, cpuFields);
+            }
+            else if (kind == "duration") {
+                if (!(line >> pScript->durationMs_) || pScript->durationMs_ < 0.) {
+                    throw std::runtime_error{ std::format("Telemetry script line {}: bad duration", lineNumber) };
+                }
+            }
+            else if (kind == "vendor") {
+                std::string name;
+                line >> name;
+                if (name == "intel") {
+                    pScript->vendor_ = PM_DEVICE_VENDOR_INTEL;
+                }
+                else if (name == "nvidia") {
+                    pScript->vendor_ = PM_DEVICE_VENDOR_NVIDIA;
+                }
+                else if (name == "amd") {
+                    pScript->vendor_ = PM_DEVICE_VENDOR_AMD;
+                }
+                else if (name == "unknown") {
+                    pScript->vendor_ = PM_DEVICE_VENDOR_UNKNOWN;
+                }
+                else {
+                    throw std::runtime_error{ std::format("Telemetry script line {}: unknown vendor [{}]", lineNumber, name) };
+                }
+            }
+            else {
+                throw std::runtime_error{ std::format("Telemetry script line {}: unknown directive [{}]", lineNumber, kind) };
+            }
+        }
+        return pScript;
+    }
+
+    std::shared_ptr<const TelemetryScript> TelemetryScript::Load(const std::filesystem::path& path)
+    {
+        std::ifstream file{ path };
+        if (!file) {
+            throw std::runtime_error{ std::format("Failed to open telemetry script [{}]", path.string()) };
+        }
+        return Parse(file);
+    }
+
+    std::shared_ptr<const TelemetryScript> TelemetryScript::MakeDefault(double durationMs, double periodMs)
+    {
+        auto pScript = std::make_shared<TelemetryScript>();
+        pScript->durationMs_ = durationMs;
+        // all waveforms complete a whole number of cycles over the duration so that looping is seamless
+        const auto Wave = [durationMs](double t, double cycles, double mid, double amp) {
+            return mid + amp * std::sin(2. * std::numbers::pi * cycles * t / durationMs);
+        };
+        for (double t = 0.; t < durationMs; t += periodMs) {
+            GpuTelemetryStep g{ .offsetMs = t };
+            g.info.gpu_power_w = Wave(t, 5., 150., 50.);
+            g.info.gpu_sustained_power_limit_w = 200.;
+            g.info.gpu_voltage_v = Wave(t, 5., 0.9, 0.1);
+            g.info.gpu_frequency_mhz = Wave(t, 5., 1800., 300.);
+            g.info.gpu_temperature_c = Wave(t, 1., 65., 10.);
+            g.info.gpu_utilization = Wave(t, 10., 70., 25.);
+            g.info.gpu_render_compute_utilization = Wave(t, 10., 60., 25.);
+            g.info.gpu_media_utilization = Wave(t, 2., 10., 5.);
+            g.info.vram_power_w = Wave(t, 5., 20., 5.);
+            g.info.vram_frequency_mhz = 2000.;
+            g.info.vram_temperature_c = Wave(t, 1., 70., 8.);
+            g.info.fan_speed_rpm[0] = Wave(t, 1., 1500., 500.);
+            g.info.gpu_mem_total_size_b = 8ull << 30;
+            g.info.gpu_mem_used_b = uint64_t(Wave(t, 2., double(4ull << 30), double(1ull << 30)));
+            g.info.gpu_mem_max_bandwidth_bps = 512ull << 30;
+            g.info.gpu_power_limited = g.info.gpu_power_w > 195.;
+            g.info.gpu_temperature_limited = g.info.gpu_temperature_c > 74.;
+            for (auto b : { GB::gpu_power, GB::gpu_sustained_power_limit, GB::gpu_voltage, GB::gpu_frequency,
+                GB::gpu_temperature, GB::gpu_utilization, GB::gpu_render_compute_utilization,
+                GB::gpu_media_utilization, GB::vram_power, GB::vram_frequency, GB::vram_temperature,
+                GB::fan_speed_0, GB::gpu_mem_size, GB::gpu_mem_used, GB::gpu_mem_max_bandwidth,
+                GB::gpu_power_limited, GB::gpu_temperature_limited }) {
+                g.caps.set(size_t(b));
+            }
+            pScript->gpuSteps_.push_back(g);
+
+            CpuTelemetryStep c{ .offsetMs = t };
+            c.info.cpu_utilization = Wave(t, 10., 40., 30.);
+            c.info.cpu_power_w = Wave(t, 5., 65., 20.);
+            c.info.cpu_power_limit_w = 125.;
+            c.info.cpu_temperature = Wave(t, 1., 55., 10.);
+            c.info.cpu_frequency = Wave(t, 5., 3600., 600.);
+            for (auto b : { CB::cpu_utilization, CB::cpu_power, CB::cpu_power_limit,
+                CB::cpu_temperature, CB::cpu_frequency }) {
+                c.caps.set(size_t(b));
+            }
+            pScript->cpuSteps_.push_back(c);
+        }
+        return pScript;
+    }
+
+    double TelemetryScript::WrapTime_(double timeMs) const noexcept
+    {
+        if (IsLooping()) {
+            return std::fmod(timeMs, durationMs_);
+        }
+        return timeMs;
+    }
+
+    template<class S>
+    const S* TelemetryScript::FindStep_(const std::vector<S>& steps, double timeMs) const noexcept
+    {
+        if (steps.empty() || timeMs < steps.front().offsetMs) {
+            return nullptr;
+        }
+        const auto it = std::ranges::upper_bound(steps, WrapTime_(timeMs), {}, &S::offsetMs);
+        // wrapped around to before the first step: still holding the tail of the previous loop
+        if (it == steps.begin()) {
+            return &steps.back();
+        }
+        return &*std::prev(it);
+    }
+
+    const GpuTelemetryStep* TelemetryScript::FindGpuStep(double timeMs) const noexcept
+    {
+        return FindStep_(gpuSteps_, timeMs);
+    }
+
+    const CpuTelemetryStep* TelemetryScript::FindCpuStep(double timeMs) const noexcept
+    {
+        return FindStep_(cpuSteps_, timeMs);
+    }
+
+    GpuTelemetryBitset TelemetryScript::GetAllGpuCaps() const noexcept
+    {
+        // caps carry forward so the last step holds the union
+        return gpuSteps_.empty() ? GpuTelemetryBitset{} : gpuSteps_.back().caps;
+    }
+
+    CpuTelemetryBitset TelemetryScript::GetAllCpuCaps() const noexcept
+    {
+        return cpuSteps_.empty() ? CpuTelemetryBitset{} : cpuSteps_.back().caps;
+    }
+
+    double TelemetryScript::GetDurationMs() const noexcept
+    {
+        return durationMs_;
+    }
+
+    bool TelemetryScript::IsLooping() const noexcept
+    {
+        return durationMs_ > 0.;
+    }
+
+    std::optional<PM_DEVICE_VENDOR> TelemetryScript::GetVendor() const noexcept
+    {
+        return vendor_;
+    }
+}
@@ -0,0 +1,77 @@
+// Copyright (C) 2022 Intel Corporation
+// SPDX-License-Identifier: MIT
+#pragma once
+#include <vector>
+#include <string>
+#include <memory>
+#include <optional>
+#include <istream>
+#include <filesystem>
+#include "PresentMonPowerTelemetry.h"
+#include "CpuTelemetryInfo.h"
+#include "../PresentMonAPI2/PresentMonAPI.h"
+
+namespace pwr::sim
+{
+    // telemetry values (and the capability bits they enable) taking effect at a given offset into the script
+    template<class I, class B>
+    struct TelemetryStep
+    {
+        double offsetMs;
+        I info;
+        B caps;
+    };
+    using GpuTelemetryStep = TelemetryStep<PresentMonPowerTelemetryInfo, GpuTelemetryBitset>;
+    using CpuTelemetryStep = TelemetryStep<CpuTelemetryInfo, CpuTelemetryBitset>;
+
+    // scripted or recorded time series that drives the simulated telemetry backend
+    // playback is a step function of time since start: the last step with offset <= t is reported
+    // when looping, time wraps at durationMs so that playback is deterministic for any run length
+    //
+    // text format, one step per line, fields carry over from the previous step of the same kind:
+    //   # comment
+    //   duration <ms>
+    //   vendor intel|nvidia|amd|unknown
+    //   gpu <offsetMs> gpu_power=120.5 gpu_temperature=65 gpu_power_limited=1
+    //   cpu <offsetMs> cpu_utilization=35 cpu_frequency=3600
+    // field names are the names of the GpuTelemetryCapBits / CpuTelemetryCapBits enumerators,
+    // and each field present sets the corresponding capability bit from that step onwards
+    class TelemetryScript
+    {
+    public:
+        // parse script text, throws std::runtime_error on malformed input
+        static std::shared_ptr<const TelemetryScript> Parse(std::istream& in);
+        static std::shared_ptr<const TelemetryScript> Load(const std::filesystem::path& path);
+        // synthetic waveforms for all common gpu/cpu fields, one step every periodMs
+        static std::shared_ptr<const TelemetryScript> MakeDefault(double durationMs = 10'000., double periodMs = 10.);
+        const GpuTelemetryStep* FindGpuStep(double timeMs) const noexcept;
+        const CpuTelemetryStep* FindCpuStep(double timeMs) const noexcept;
+        // union of all capability bits that appear anywhere in the script
+        GpuTelemetryBitset GetAllGpuCaps() const noexcept;
+        CpuTelemetryBitset GetAllCpuCaps() const noexcept;
+        double GetDurationMs() const noexcept;
+        bool IsLooping() const noexcept;
+        // vendor the simulated adapters report, empty when the script does not set one
+        std::optional<PM_DEVICE_VENDOR> GetVendor() const noexcept;
+    private:
+        // functions
+        double WrapTime_(double timeMs) const noexcept;
+        template<class S>
+        const S* FindStep_(const std::vector<S>& steps, double timeMs) const noexcept;
+        // data
+        std::vector<GpuTelemetryStep> gpuSteps_;
+        std::vector<CpuTelemetryStep> cpuSteps_;
+        double durationMs_ = 0.;
+        std::optional<PM_DEVICE_VENDOR> vendor_;
+    };
+
+    // configuration for the simulated telemetry provider and cpu
+    struct SimulatedTelemetryConfig
+    {
+        std::shared_ptr<const TelemetryScript> pScript;
+        uint32_t adapterCount = 1;
+        // time spent inside each Sample() call, emulating driver query cost
+        double samplingLatencyMs = 0.;
+        PM_DEVICE_VENDOR vendor = PM_DEVICE_VENDOR_UNKNOWN;
+    };
+}
@@ -315,6 +315,31 @@ namespace p2c::gfx
         fastRenderer->EmitLineRectTop(rect, color);
     }
 
+    uint64_t Graphics::FastRetainedMakeKey()
+    {
+        return fastRenderer->MakeRetainedKey();
+    }
+
+    bool Graphics::FastRetainedDraw(uint64_t key, uint64_t signature)
+    {
+        return fastRenderer->UseRetained(key, signature);
+    }
+
+    void Graphics::FastRetainedRecordStart(uint64_t key, uint64_t signature)
+    {
+        fastRenderer->StartRetained(key, signature);
+    }
+
+    void Graphics::FastRetainedRecordEnd()
+    {
+        fastRenderer->EndRetained();
+    }
+
+    const impl::FastRenderer::FrameStats& Graphics::GetFastFrameStats() const
+    {
+        return fastRenderer->GetLastFrameStats();
+    }
+
     void Graphics::FreeBackbufferDependentResources_()
     {
         pTarget.Reset();
@@ -50,6 +50,14 @@ namespace p2c::gfx
         void FastLineRectEmit(const Rect& rect, Color color);
         // "upside down U" shape
         void FastLineRectTopEmit(const Rect& rect, Color color);
+        // retained fastline interface: geometry that rarely changes is recorded once under a key
+        // and drawn from persistent buffers while its signature stays the same
+        uint64_t FastRetainedMakeKey();
+        // false if the geometry must be recorded again (between RecordStart/RecordEnd)
+        bool FastRetainedDraw(uint64_t key, uint64_t signature);
+        void FastRetainedRecordStart(uint64_t key, uint64_t signature);
+        void FastRetainedRecordEnd();
+        const impl::FastRenderer::FrameStats& GetFastFrameStats() const;
     private:
         // functions
         void FreeBackbufferDependentResources_();
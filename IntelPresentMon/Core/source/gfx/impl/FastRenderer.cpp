@@ -194,7 +194,18 @@ namespace p2c::gfx::impl
         vertexMapping = std::nullopt;
         indexMapping = std::nullopt;
 
-        if (batches.empty())
+        // drop retained geometry not drawn this frame, and upload again if anything changed
+        if (retained.Collect())
+        {
+            UploadRetained(context);
+        }
+        lastFrameStats = {
+            .emittedVertices = nVertices + recordedVertices,
+            .retainedVertices = UINT(retained.GetVertices().size()) - recordedVertices,
+        };
+        recordedVertices = 0;
+
+        if (batches.empty() && retained.GetBatches().empty())
         {
             return;
         }
@@ -202,13 +213,6 @@ namespace p2c::gfx::impl
         context.PSSetShader(pPixelShader.Get(), nullptr, 0);
         context.VSSetShader(pVertexShader.Get(), nullptr, 0);
         context.IASetInputLayout(pInputLayout.Get());
-        // vertex buffer
-        {
-            const UINT stride = sizeof(Point);
-            const UINT offset = 0;
-            context.IASetVertexBuffers(0, 1, pVertexBuffer.GetAddressOf(), &stride, &offset);
-        }
-        context.IASetIndexBuffer(pIndexBuffer.Get(), DXGI_FORMAT_R16_UINT, 0);
         context.OMSetDepthStencilState(pDepthStencil.Get(), 0);
         context.OMSetBlendState(pBlender.Get(), nullptr, 0xFFFFFFFF);
         // viewport
@@ -225,7 +229,27 @@ namespace p2c::gfx::impl
             context.RSSetViewports(1, &vp);
         }
 
-        for (const auto& b : batches)
+        // retained geometry (grids etc.) is drawn under the dynamic geometry
+        if (pRetainedVertexBuffer && pRetainedIndexBuffer)
+        {
+            DrawBatches(context, pRetainedVertexBuffer.Get(), pRetainedIndexBuffer.Get(), retained.GetBatches());
+        }
+        DrawBatches(context, pVertexBuffer.Get(), pIndexBuffer.Get(), batches);
+
+        nVertices = 0;
+        nIndices = 0;
+        batches.clear();
+	}
+
+    void FastRenderer::DrawBatches(ID3D11DeviceContext& context, ID3D11Buffer* pVertices, ID3D11Buffer* pIndices, const std::vector<Batch>& batchesToDraw)
+    {
+        {
+            const UINT stride = sizeof(Point);
+            const UINT offset = 0;
+            context.IASetVertexBuffers(0, 1, &pVertices, &stride, &offset);
+        }
+        context.IASetIndexBuffer(pIndices, DXGI_FORMAT_R16_UINT, 0);
+        for (const auto& b : batchesToDraw)
         {
             {
                 const D3D11_RECT scissor{
@@ -247,15 +271,15 @@ namespace p2c::gfx::impl
             }
             context.DrawIndexed(b.indexEnd - b.indexBegin, b.indexBegin, b.vertexOffset);
         }
-
-        nVertices = 0;
-        nIndices = 0;
-        batches.clear();
-	}
+    }
 
     void FastRenderer::WriteVertex(Vec2 pt)
     {
-        if (nVertices < vertexBufferSize) {
+        if (pRecordingBlock) {
+            pRecordingBlock->vertices.push_back({ ConvertPoint(pt), chainColor });
+            nVertices++;
+        }
+        else if (nVertices < vertexBufferSize) {
             reinterpret_cast<Point*>(vertexMapping->pData)[nVertices++] = { ConvertPoint(pt), chainColor };
         }
         else  {
@@ -275,7 +299,11 @@ namespace p2c::gfx::impl
             p2clog.warn(std::format(L"writing index out of range: {}", i)).commit();
         }
 #endif
-        if (nIndices < indexBufferSize) {
+        if (pRecordingBlock) {
+            pRecordingBlock->indices.push_back(UINT16(i - activeBatch->vertexOffset));
+            nIndices++;
+        }
+        else if (nIndices < indexBufferSize) {
             reinterpret_cast<UINT16*>(indexMapping->pData)[nIndices++] = UINT16(i - activeBatch->vertexOffset);
         }
         else {
@@ -358,7 +386,12 @@ namespace p2c::gfx::impl
         }
 #endif
         activeBatch->indexEnd = nIndices;
-        batches.push_back(*activeBatch);
+        if (pRecordingBlock) {
+            pRecordingBlock->batches.push_back(*activeBatch);
+        }
+        else {
+            batches.push_back(*activeBatch);
+        }
         activeBatch = std::nullopt;
 	}
 
@@ -595,6 +628,96 @@ namespace p2c::gfx::impl
     void FastRenderer::Resize(const DimensionsI& dims_)
     {
         dims = dims_;
+        // retained vertices were converted with the old dimensions
+        retained.InvalidateAll();
+    }
+
+    uint64_t FastRenderer::MakeRetainedKey()
+    {
+        return retained.MakeKey();
+    }
+
+    bool FastRenderer::UseRetained(uint64_t key, uint64_t signature)
+    {
+        return retained.Use(key, signature);
+    }
+
+    void FastRenderer::StartRetained(uint64_t key, uint64_t signature)
+    {
+#ifdef _DEBUG
+        if (activeBatch)
+        {
+            p2clog.warn(L"Batch still open").commit();
+        }
+        if (pRecordingBlock)
+        {
+            p2clog.warn(L"Retained geometry already being recorded").commit();
+        }
+#endif
+        // geometry is written to the block instead of the dynamic buffers until EndRetained
+        pRecordingBlock = &retained.Record(key, signature);
+        savedVertices = nVertices;
+        savedIndices = nIndices;
+        nVertices = 0;
+        nIndices = 0;
+    }
+
+    void FastRenderer::EndRetained()
+    {
+#ifdef _DEBUG
+        if (!pRecordingBlock)
+        {
+            p2clog.warn(L"Retained geometry not being recorded").commit();
+        }
+#endif
+        recordedVertices += nVertices;
+        nVertices = savedVertices;
+        nIndices = savedIndices;
+        pRecordingBlock = nullptr;
+    }
+
+    const FastRenderer::FrameStats& FastRenderer::GetLastFrameStats() const
+    {
+        return lastFrameStats;
+    }
+
+    void FastRenderer::UploadRetained(ID3D11DeviceContext& context)
+    {
+        pRetainedVertexBuffer.Reset();
+        pRetainedIndexBuffer.Reset();
+        const auto& vertices = retained.GetVertices();
+        const auto& indices = retained.GetIndices();
+        if (vertices.empty() || indices.empty())
+        {
+            return;
+        }
+        ComPtr<ID3D11Device> pDevice;
+        context.GetDevice(&pDevice);
+        // retained geometry only changes with layout, so it lives in immutable buffers
+        {
+            D3D11_BUFFER_DESC bd = {};
+            bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+            bd.Usage = D3D11_USAGE_IMMUTABLE;
+            bd.ByteWidth = UINT(vertices.size() * sizeof(Point));
+            bd.StructureByteStride = sizeof(Point);
+            const D3D11_SUBRESOURCE_DATA data{ .pSysMem = vertices.data() };
+            if (auto hr = pDevice->CreateBuffer(&bd, &data, &pRetainedVertexBuffer); FAILED(hr))
+            {
+                p2clog.hr(hr).commit();
+            }
+        }
+        {
+            D3D11_BUFFER_DESC ibd = {};
+            ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;
+            ibd.Usage = D3D11_USAGE_IMMUTABLE;
+            ibd.ByteWidth = UINT(indices.size() * sizeof(UINT16));
+            ibd.StructureByteStride = sizeof(UINT16);
+            const D3D11_SUBRESOURCE_DATA data{ .pSysMem = indices.data() };
+            if (auto hr = pDevice->CreateBuffer(&ibd, &data, &pRetainedIndexBuffer); FAILED(hr))
+            {
+                p2clog.hr(hr).commit();
+            }
+        }
     }
 
     void FastRenderer::ResizeGeometryBuffersIfNecessary(ID3D11Device& device)
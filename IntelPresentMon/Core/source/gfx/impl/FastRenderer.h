@@ -7,12 +7,22 @@
 #include <d3d11_2.h>
 #include <optional>
 #include <vector>
+#include "RetainedGeometryCache.h"
 
 namespace p2c::gfx::impl
 {
     class FastRenderer
     {
     public:
+        // types
+        struct FrameStats
+        {
+            // vertices written this frame (dynamic geometry plus any retained geometry recorded)
+            UINT emittedVertices = 0;
+            // vertices drawn from retained geometry without being written
+            UINT retainedVertices = 0;
+        };
+        // functions
         FastRenderer(ID3D11Device& device, const DimensionsI& dims);
         void StartFrame(ID3D11DeviceContext& context);
         void EndFrame(ID3D11DeviceContext& context);
@@ -30,6 +40,12 @@ namespace p2c::gfx::impl
         void EmitLineRectTop(const Rect& rect, Color c);
         void Resize(const DimensionsI& dims);
         void ResizeGeometryBuffersIfNecessary(ID3D11Device& device);
+        // retained geometry: recorded once and drawn every frame it is used, from persistent buffers
+        uint64_t MakeRetainedKey();
+        bool UseRetained(uint64_t key, uint64_t signature);
+        void StartRetained(uint64_t key, uint64_t signature);
+        void EndRetained();
+        const FrameStats& GetLastFrameStats() const;
     private:
         // types
         class FastDimensions
@@ -69,6 +85,8 @@ namespace p2c::gfx::impl
         void WriteIndex(UINT32 i);
         void MakeVertexBuffer(ID3D11Device& device);
         void MakeIndexBuffer(ID3D11Device& device);
+        void UploadRetained(ID3D11DeviceContext& context);
+        void DrawBatches(ID3D11DeviceContext& context, ID3D11Buffer* pVertices, ID3D11Buffer* pIndices, const std::vector<Batch>& batchesToDraw);
         // converts pixel coordinates to ndc
         Vec2 ConvertPoint(Vec2 pt) const;
         // data
@@ -79,6 +97,14 @@ namespace p2c::gfx::impl
         UINT nIndices = 0;
         std::optional<Batch> activeBatch; // current batch being built, also serves to indicate whether a batch is open
         std::vector<Batch> batches;
+        // retained geometry, and the block being recorded into (if any) along with the
+        // dynamic buffer counts saved while recording
+        RetainedGeometryCache<Point, Batch> retained;
+        RetainedGeometryCache<Point, Batch>::Block* pRecordingBlock = nullptr;
+        UINT savedVertices = 0;
+        UINT savedIndices = 0;
+        UINT recordedVertices = 0;
+        FrameStats lastFrameStats;
         // chain variables
         Color chainColor;
         int chainSize = 0;
@@ -89,6 +115,8 @@ namespace p2c::gfx::impl
         ComPtr<ID3D11VertexShader> pVertexShader;
         ComPtr<ID3D11Buffer> pVertexBuffer;
         ComPtr<ID3D11Buffer> pIndexBuffer;
+        ComPtr<ID3D11Buffer> pRetainedVertexBuffer;
+        ComPtr<ID3D11Buffer> pRetainedIndexBuffer;
         ComPtr<ID3D11InputLayout> pInputLayout;
         ComPtr<ID3D11RasterizerState> pRasterizer;
         ComPtr<ID3D11RasterizerState> pRasterizerAnti;
@@ -0,0 +1,130 @@
+// Copyright (C) 2022 Intel Corporation
+// SPDX-License-Identifier: MIT
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace p2c::gfx::impl
+{
+    // holds fast geometry that rarely changes (grids etc.) so that it is recorded once and then drawn
+    // every frame from persistent buffers, and packs it into a single vertex/index range for upload
+    // kept free of d3d so that it can be tested on its own
+    // V: vertex type, B: batch type with indexBegin, indexEnd and vertexOffset members
+    template<class V, class B>
+    class RetainedGeometryCache
+    {
+    public:
+        // types
+        struct Block
+        {
+            std::vector<V> vertices;
+            // relative to the vertexOffset of their batch, as in the dynamic buffers
+            std::vector<uint16_t> indices;
+            // positions of indices and vertices are relative to the block
+            std::vector<B> batches;
+        private:
+            friend RetainedGeometryCache;
+            uint64_t signature = 0;
+            uint64_t generation = 0;
+            bool used = false;
+        };
+        // functions
+        // make a key for an owner of geometry to identify it by
+        uint64_t MakeKey()
+        {
+            return nextKey_++;
+        }
+        // mark the geometry of key as drawn this frame; false if there is none, or if it was recorded
+        // with a different signature (the owner's parameters changed) or before the last invalidation
+        bool Use(uint64_t key, uint64_t signature)
+        {
+            if (auto i = blocks_.find(key); i != blocks_.end() &&
+                i->second.signature == signature && i->second.generation == generation_) {
+                i->second.used = true;
+                return true;
+            }
+            return false;
+        }
+        // start (re)recording the geometry of key, which is drawn this frame
+        Block& Record(uint64_t key, uint64_t signature)
+        {
+            auto& block = blocks_[key];
+            block = Block{};
+            block.signature = signature;
+            block.generation = generation_;
+            block.used = true;
+            changed_ = true;
+            return block;
+        }
+        // all geometry needs to be recorded again (e.g. the mapping to device coordinates changed)
+        void InvalidateAll()
+        {
+            generation_++;
+        }
+        // drop geometry that was not drawn this frame; returns true if the packed geometry
+        // changed and needs to be uploaded again
+        bool Collect()
+        {
+            if (std::erase_if(blocks_, [](const auto& e) { return !e.second.used; }) > 0) {
+                changed_ = true;
+            }
+            for (auto& [key, block] : blocks_) {
+                block.used = false;
+            }
+            if (!changed_) {
+                return false;
+            }
+            changed_ = false;
+            Pack_();
+            return true;
+        }
+        // packed geometry of all blocks (as of the last Collect), batches with absolute positions
+        const std::vector<V>& GetVertices() const
+        {
+            return vertices_;
+        }
+        const std::vector<uint16_t>& GetIndices() const
+        {
+            return indices_;
+        }
+        const std::vector<B>& GetBatches() const
+        {
+            return batches_;
+        }
+        size_t GetBlockCount() const
+        {
+            return blocks_.size();
+        }
+    private:
+        // functions
+        void Pack_()
+        {
+            vertices_.clear();
+            indices_.clear();
+            batches_.clear();
+            // blocks are packed in key order, so geometry keeps the order its owners were created in
+            for (auto& [key, block] : blocks_) {
+                const auto vertexBase = (uint32_t)vertices_.size();
+                const auto indexBase = (uint32_t)indices_.size();
+                vertices_.insert(vertices_.end(), block.vertices.begin(), block.vertices.end());
+                indices_.insert(indices_.end(), block.indices.begin(), block.indices.end());
+                for (auto b : block.batches) {
+                    b.indexBegin += indexBase;
+                    b.indexEnd += indexBase;
+                    b.vertexOffset += vertexBase;
+                    batches_.push_back(b);
+                }
+            }
+        }
+        // data
+        std::map<uint64_t, Block> blocks_;
+        uint64_t nextKey_ = 1;
+        uint64_t generation_ = 0;
+        bool changed_ = false;
+        std::vector<V> vertices_;
+        std::vector<uint16_t> indices_;
+        std::vector<B> batches_;
+    };
+}
@@ -2,74 +2,136 @@
 // SPDX-License-Identifier: MIT
 #include "GraphData.h"
 #include <algorithm>
-#include <ranges>
-
-namespace rn = std::ranges;
+#include <bit>
 
 namespace p2c::gfx::lay
 {
-	GraphData::GraphData(double timeWindow)
+	GraphData::GraphData(double timeWindow, size_t capacity)
 		:
-		timeWindow{ timeWindow }
+		timeWindow{ timeWindow },
+		mask{ std::bit_ceil(std::max(capacity, size_t(2))) - 1 },
+		times(mask + 1),
+		values(mask + 1),
+		valid(mask + 1),
+		min{ mask + 1 },
+		max{ mask + 1 }
 	{}
-	DataPoint& GraphData::operator[](size_t i)
+	template<class F>
+	void GraphData::ForEachHistogram_(F&& f)
+	{
+		for (auto& w : histograms) {
+			if (auto pHist = w.lock()) {
+				f(*pHist);
+			}
+		}
+	}
+	size_t GraphData::Slot_(size_t i) const
 	{
-		return data[i];
+		// logical index 0 is the newest entry
+		return size_t(head - 1 - i) & mask;
 	}
-	const DataPoint& GraphData::operator[](size_t i) const
+	DataPoint GraphData::operator[](size_t i) const
 	{
-		return data[i];
+		return { .value = ValueAt(i), .time = TimeAt(i) };
 	}
-	DataPoint& GraphData::Front()
+	DataPoint GraphData::Front() const
 	{
-		return data.front();
+		return (*this)[0];
 	}
-	const DataPoint& GraphData::Front() const
+	DataPoint GraphData::Back() const
 	{
-		return data.front();
+		return (*this)[Size() - 1];
 	}
-	DataPoint& GraphData::Back()
+	double GraphData::TimeAt(size_t i) const
 	{
-		return data.back();
+		return times[Slot_(i)];
 	}
-	const DataPoint& GraphData::Back() const
+	std::optional<float> GraphData::ValueAt(size_t i) const
 	{
-		return data.back();
+		const auto slot = Slot_(i);
+		if (valid[slot]) {
+			return values[slot];
+		}
+		return std::nullopt;
 	}
 	void GraphData::Push(const DataPoint& dp)
 	{
-		data.push_front(dp);
+		PushOne_(dp);
+	}
+	void GraphData::Push(std::span<const DataPoint> batch)
+	{
+		// grow once up front instead of potentially multiple times during the batch
+		while (Size() + batch.size() > mask + 1) {
+			Grow_();
+		}
+		for (const auto& dp : batch) {
+			PushOne_(dp);
+		}
+	}
+	void GraphData::PushOne_(const DataPoint& dp)
+	{
+		if (Size() == mask + 1) {
+			Grow_();
+		}
+		const auto idx = head++;
+		const auto slot = size_t(idx) & mask;
+		times[slot] = dp.time;
 		if (dp.value.has_value()) {
-			min.Push(*dp.value);
-			max.Push(*dp.value);
+			values[slot] = *dp.value;
+			valid[slot] = 1;
+			min.Push(idx, *dp.value, values, mask);
+			max.Push(idx, *dp.value, values, mask);
+			ForEachHistogram_([&](WindowedHistogram& h) { h.Add(*dp.value); });
+		}
+		else {
+			valid[slot] = 0;
+		}
+	}
+	void GraphData::PopBack_()
+	{
+		const auto idx = tail++;
+		const auto slot = size_t(idx) & mask;
+		if (valid[slot]) {
+			min.Pop(idx);
+			max.Pop(idx);
+			ForEachHistogram_([&](WindowedHistogram& h) { h.Remove(values[slot]); });
+		}
+	}
+	void GraphData::Grow_()
+	{
+		// relocate live entries to the slots they map to in the doubled ring
+		// absolute indices don't change so the extreme rings stay valid
+		const auto newCapacity = (mask + 1) * 2;
+		const auto newMask = newCapacity - 1;
+		std::vector<double> newTimes(newCapacity);
+		std::vector<float> newValues(newCapacity);
+		std::vector<uint8_t> newValid(newCapacity);
+		for (auto idx = tail; idx != head; idx++) {
+			const auto oldSlot = size_t(idx) & mask;
+			const auto newSlot = size_t(idx) & newMask;
+			newTimes[newSlot] = times[oldSlot];
+			newValues[newSlot] = values[oldSlot];
+			newValid[newSlot] = valid[oldSlot];
 		}
+		times = std::move(newTimes);
+		values = std::move(newValues);
+		valid = std::move(newValid);
+		mask = newMask;
+		min.Grow(newCapacity);
+		max.Grow(newCapacity);
 	}
 	size_t GraphData::Size() const
 	{
-		return data.size();
+		return size_t(head - tail);
 	}
 	void GraphData::Trim(double now)
 	{
 		const auto cutoff = now - timeWindow;
-		// find iterator pair that marks all data points that are
-		// outside the time window, except the last one, by reverse scan
-		auto ri = data.rbegin();
-		const auto rend = data.rend();
-		while (rend - ri > 2 && std::next(ri)->time < cutoff) {
-			ri++;
-		}
-		// convert iterator pair to normal iterators
-		const auto i = ri.base();
-		const auto end = data.end();
-		// remove all in range from the extreme queue
-		for (const auto& d : rn::subrange{ i, end }) {
-			if (d.value.has_value()) {
-				min.Pop(*d.value);
-				max.Pop(*d.value);
-			}
+		// remove all data points that are outside the time window, except the last one
+		// (checking time of the 2nd oldest entry) so that lines extend to the edge of the plot
+		while (Size() > 2 && times[size_t(tail + 1) & mask] < cutoff) {
+			PopBack_();
 		}
-		// erase all in range from data buffer
-		data.erase(i, end);
 	}
 	void GraphData::Resize(double window)
 	{
@@ -77,14 +139,40 @@ namespace p2c::gfx::lay
 	}
 	std::optional<float> GraphData::Min() const
 	{
-		return min.GetCurrent();
+		if (const auto idx = min.GetCurrent()) {
+			return values[size_t(*idx) & mask];
+		}
+		return std::nullopt;
 	}
 	std::optional<float> GraphData::Max() const
 	{
-		return max.GetCurrent();
+		if (const auto idx = max.GetCurrent()) {
+			return values[size_t(*idx) & mask];
+		}
+		return std::nullopt;
 	}
 	double GraphData::GetWindowSize() const
 	{
 		return timeWindow;
 	}
-}
\ No newline at end of file
+	std::shared_ptr<const WindowedHistogram> GraphData::GetHistogram(const WindowedHistogram::Spec& spec)
+	{
+		// drop histograms that no consumer is holding anymore
+		std::erase_if(histograms, [](const auto& w) { return w.expired(); });
+		// share existing histogram if one matches the requested binning
+		for (auto& w : histograms) {
+			if (auto pHist = w.lock(); pHist->GetSpec() == spec) {
+				return pHist;
+			}
+		}
+		// otherwise build a new one from the data currently in the window
+		auto pHist = std::make_shared<WindowedHistogram>(spec);
+		for (auto idx = tail; idx != head; idx++) {
+			if (const auto slot = size_t(idx) & mask; valid[slot]) {
+				pHist->Add(values[slot]);
+			}
+		}
+		histograms.push_back(pHist);
+		return pHist;
+	}
+}
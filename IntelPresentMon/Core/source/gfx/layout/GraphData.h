@@ -4,6 +4,12 @@
 #include <deque>
 #include <Core/source/infra/util/Assert.h>
 #include <functional>
+#include <memory>
+#include <vector>
+#include <span>
+#include <optional>
+#include <cstdint>
+#include "WindowedHistogram.h"
 #include <Core/source/gfx/base/Geometry.h>
 #include <Core/source/gfx/layout/Enums.h>
 
@@ -76,32 +82,104 @@ namespace p2c::gfx::lay
 	using MaxQueue = ExtremeQueue<std::less<float>, std::greater<float>>;
 	using MinQueue = ExtremeQueue<std::greater<float>, std::less<float>>;
 
+	// ExtremeIndexRing tracks min or max over a sliding window of GraphData samples
+	// it is a monotonic queue of absolute sample indices into the GraphData value storage
+	// Comp(a, b) true means a is more extreme than b (greater => max, less => min)
+	template<class Comp>
+	class ExtremeIndexRing
+	{
+	public:
+		ExtremeIndexRing(size_t capacity)
+			:
+			ring(capacity),
+			mask{ capacity - 1 }
+		{}
+		// value is the sample at absolute index idx, values is the backing storage (indexed by idx & valueMask)
+		void Push(uint64_t idx, float value, const std::vector<float>& values, size_t valueMask)
+		{
+			// discard all candidates that can no longer be the extreme while idx is in window
+			while (first != last && !Comp{}(values[size_t(ring[size_t(last - 1) & mask]) & valueMask], value)) {
+				last--;
+			}
+			ring[size_t(last++) & mask] = idx;
+		}
+		// call with the absolute index of every sample leaving the window (oldest first)
+		void Pop(uint64_t idx)
+		{
+			if (first != last && ring[size_t(first) & mask] == idx) {
+				first++;
+			}
+		}
+		std::optional<uint64_t> GetCurrent() const
+		{
+			if (first != last) {
+				return ring[size_t(first) & mask];
+			}
+			return std::nullopt;
+		}
+		void Grow(size_t capacity)
+		{
+			std::vector<uint64_t> newRing(capacity);
+			const auto newMask = capacity - 1;
+			for (auto i = first; i != last; i++) {
+				newRing[size_t(i) & newMask] = ring[size_t(i) & mask];
+			}
+			ring = std::move(newRing);
+			mask = newMask;
+		}
+	private:
+		std::vector<uint64_t> ring;
+		size_t mask;
+		uint64_t first = 0;
+		uint64_t last = 0;
+	};
+
 	// GraphData is a container for data to be displayed in a GraphElement
-	// conceptually it is a circular buffer
+	// it is a power-of-two circular buffer with time/value/valid stored in separate arrays
+	// index 0 (Front) is the newest entry, Back is the oldest
 	// time of entries must be added in increasing order
 	class GraphData
 	{
 	public:
-		GraphData(double timeWindow);
-		DataPoint& operator[](size_t i);
-		const DataPoint& operator[](size_t i) const;
-		DataPoint& Front();
-		const DataPoint& Front() const;
-		DataPoint& Back();
-		const DataPoint& Back() const;
+		GraphData(double timeWindow, size_t capacity = 1024);
+		DataPoint operator[](size_t i) const;
+		DataPoint Front() const;
+		DataPoint Back() const;
+		double TimeAt(size_t i) const;
+		std::optional<float> ValueAt(size_t i) const;
 		void Push(const DataPoint& data);
+		// push a batch of points (oldest first), e.g. all samples gathered during one overlay frame
+		void Push(std::span<const DataPoint> batch);
 		size_t Size() const;
 		void Trim(double now);
 		void Resize(double window);
 		std::optional<float> Min() const;
 		std::optional<float> Max() const;
 		double GetWindowSize() const;
+		// get a histogram over the data in the window that is kept updated on Push/Trim
+		// histograms with the same spec are shared among all consumers of this data
+		std::shared_ptr<const WindowedHistogram> GetHistogram(const WindowedHistogram::Spec& spec);
 	private:
+		// functions
+		template<class F>
+		void ForEachHistogram_(F&& f);
+		size_t Slot_(size_t i) const;
+		void PushOne_(const DataPoint& dp);
+		void PopBack_();
+		void Grow_();
 		// data
 		double timeWindow;
-		std::deque<DataPoint> data;
-		MinQueue min;
-		MaxQueue max;
+		size_t mask;
+		std::vector<double> times;
+		std::vector<float> values;
+		std::vector<uint8_t> valid;
+		// absolute index of the oldest entry and one past the newest entry
+		uint64_t tail = 0;
+		uint64_t head = 0;
+		ExtremeIndexRing<std::less<float>> min;
+		ExtremeIndexRing<std::greater<float>> max;
+		// histograms are owned by consumers (plot elements) and expire when no longer used
+		std::vector<std::weak_ptr<WindowedHistogram>> histograms;
 	}; // TODO: only track min/max when auto range adjustment is active (might be tricky)
 
 	// GraphLinePack combines graph data (which may be shared among widgets)
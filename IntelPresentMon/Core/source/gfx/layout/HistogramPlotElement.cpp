@@ -26,7 +26,7 @@ namespace p2c::gfx::lay
 
 	void HistogramPlotElement::Draw_(Graphics& gfx) const
 	{
-		const auto& data = *pPack->data;
+		auto& data = *pPack->data;
 
 		const auto port = GetContentRect();
 		const auto dims = port.GetDimensions();
@@ -34,29 +34,13 @@ namespace p2c::gfx::lay
 		const auto yBias = minCount;
 		const auto yOffset = port.bottom;
 
-		// initialize histogram bins
-		bins.resize(binCount);
-		std::ranges::fill(bins, 0);
-		const auto binSize = (maxValue - minValue) / float(binCount);
-		autoMaxCount = 0; // for autosizing
-
-		// sort datapoints into bins
-		const auto dataSize = data.Size();
-		const auto cutoff = (dataSize > 0 ? data.Front().time : 0.f) - timeWindow;
-		for (size_t i = 0; i < dataSize; i++)
-		{
-			const auto& d = data[i];
-			// exit early if outside of time window of considering, or not valid data
-			if (d.time <= cutoff || !d.value)
-			{
-				break;
-			}
-			const int iBin = int((*d.value - minValue) / binSize);
-			if (iBin >= 0 && iBin < binCount)
-			{
-				autoMaxCount = std::max(autoMaxCount, bins[size_t(iBin)] += 1);
-			}
+		// histogram bins are kept up to date as data is pushed/trimmed, only need
+		// to get a new histogram (and rebin) when range or bin count changes
+		const WindowedHistogram::Spec spec{ .minValue = minValue, .maxValue = maxValue, .binCount = binCount };
+		if (!pHistogram || pHistogram->GetSpec() != spec) {
+			pHistogram = data.GetHistogram(spec);
 		}
+		const auto& bins = pHistogram->GetBins();
 
 		DrawGrid(gfx, port, hDivs, vDivs, gridColor);
 
@@ -110,9 +94,9 @@ namespace p2c::gfx::lay
 		maxValue = max;
 	}
 
-	void HistogramPlotElement::SetTimeWindow(float dt)
+	void HistogramPlotElement::SetTimeWindow(float)
 	{
-		timeWindow = dt;
+		// the histogram covers exactly the graph data's window, which owns the time span
 	}
 
 	void HistogramPlotElement::SetCountRange(int min, int max)
@@ -123,6 +107,6 @@ namespace p2c::gfx::lay
 
 	int HistogramPlotElement::GetMaxCount() const
 	{
-		return autoMaxCount;
+		return pHistogram ? pHistogram->GetMaxCount() : 0;
 	}
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 namespace p2c::gfx::lay
 {
 	struct GraphLinePack;
+	class WindowedHistogram;
 
 	class HistogramPlotElement : public PlotElement
 	{
@@ -25,15 +26,14 @@ namespace p2c::gfx::lay
 		// data
 		float minValue = 0;
 		float maxValue = 100;
-		float timeWindow = 5.f;
 		int minCount = 0;
 		int maxCount = 100;
 		int binCount = 40;
 		int hDivs = 20;
 		int vDivs = 4;
 		Color gridColor{};
-		mutable std::vector<int> bins;
-		mutable int autoMaxCount = 0;
+		// histogram is maintained incrementally by the graph data, reacquired when binning changes
+		mutable std::shared_ptr<const WindowedHistogram> pHistogram;
 		std::shared_ptr<GraphLinePack> pPack;
 	};
 }
\ No newline at end of file
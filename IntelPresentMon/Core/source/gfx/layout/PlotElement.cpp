@@ -2,18 +2,36 @@
 // SPDX-License-Identifier: MIT
 #pragma once
 #include "PlotElement.h"
+#include <Core/source/infra/util/Hash.h>
 
 
 namespace p2c::gfx::lay
 {
 	// TODO: better handling of clipping edges (floor + 1)
-	void PlotElement::DrawGrid(Graphics& gfx, const Rect& port, int hDivs, int vDivs, Color gridColor)
+	void PlotElement::DrawGrid(Graphics& gfx, const Rect& port, int hDivs, int vDivs, Color gridColor) const
 	{
 		if (gridColor.a == 0.f)
 		{
 			return;
 		}
 
+		using infra::util::HashCombine;
+		using infra::util::DualHash;
+		const auto signature = HashCombine(
+			HashCombine(DualHash(port.left, port.top), DualHash(port.right, port.bottom)),
+			HashCombine(DualHash(hDivs, vDivs),
+				HashCombine(DualHash(gridColor.r, gridColor.g), DualHash(gridColor.b, gridColor.a)))
+		);
+		if (!gridGeometryKey)
+		{
+			gridGeometryKey = gfx.FastRetainedMakeKey();
+		}
+		if (gfx.FastRetainedDraw(gridGeometryKey, signature))
+		{
+			return;
+		}
+
+		gfx.FastRetainedRecordStart(gridGeometryKey, signature);
 		const auto dims = port.GetDimensions();
 		gfx.FastLineBatchStart(port);
 		for (int i = 1; i < vDivs; i++)
@@ -29,5 +47,6 @@ namespace p2c::gfx::lay
 			gfx.FastLineEnd({ x, port.bottom });
 		}
 		gfx.FastBatchEnd();
+		gfx.FastRetainedRecordEnd();
 	}
 }
\ No newline at end of file
@@ -10,10 +10,13 @@ namespace p2c::gfx::lay
 	{
 	protected:
 		using FlexElement::FlexElement;
-		static void DrawGrid(Graphics& gfx, const Rect& port, int hDivs, int vDivs, Color gridColor);
+		// grid only changes with layout/style, so it is retained between frames
+		void DrawGrid(Graphics& gfx, const Rect& port, int hDivs, int vDivs, Color gridColor) const;
 	public:
 		virtual void SetValueRangeLeft(float min, float max) = 0;
 		virtual void SetValueRangeRight(float min, float max) = 0;
 		virtual void SetTimeWindow(float dt) = 0;
+	private:
+		mutable uint64_t gridGeometryKey = 0;
 	};
-}
\ No newline at end of file
+}
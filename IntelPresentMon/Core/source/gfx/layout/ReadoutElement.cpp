@@ -30,11 +30,8 @@ namespace p2c::gfx::lay
 
 	void ReadoutElement::Draw_(Graphics& gfx) const
 	{
-		if (*pValueText != lastValueText)
-		{
-			pVal->SetText(*pValueText);
-			lastValueText = *pValueText;
-		}
+		// text element skips relayout when the value text has not changed
+		pVal->SetText(*pValueText);
 		FlexElement::Draw_(gfx);
 	}
 
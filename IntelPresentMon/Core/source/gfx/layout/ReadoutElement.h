@@ -30,6 +30,5 @@ namespace p2c::gfx::lay
 		std::wstring label;
 		std::wstring units;
 		bool textOutput;
-		mutable std::wstring lastValueText;
 	};
 }
\ No newline at end of file
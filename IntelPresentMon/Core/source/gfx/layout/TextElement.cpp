@@ -68,10 +68,14 @@ namespace p2c::gfx::lay
 		pText->Draw(gfx);
 	}
 
-	void TextElement::SetText(std::wstring newText)
+	void TextElement::SetText(const std::wstring& newText)
 	{
-		text = std::move(newText);
-		textDirty = true;
+		// unchanged text does not need a new layout
+		if (newText != text)
+		{
+			text = newText;
+			textDirty = true;
+		}
 	}
 
 	std::shared_ptr<TextElement> TextElement::Make(std::wstring text, std::vector<std::string> classes)
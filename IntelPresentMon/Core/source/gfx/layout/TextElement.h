@@ -17,7 +17,7 @@ namespace p2c::gfx::lay
 	public:
 		TextElement(std::wstring text, std::vector<std::string> classes = {});
 		~TextElement();
-		void SetText(std::wstring newText);
+		void SetText(const std::wstring& newText);
 		static std::shared_ptr<TextElement> Make(std::wstring text, std::vector<std::string> classes = {});
 	protected:
 		LayoutConstraints QueryLayoutConstraints_(std::optional<float> width, sty::StyleProcessor& sp, Graphics& gfx) const override;
@@ -0,0 +1,73 @@
+// Copyright (C) 2022 Intel Corporation
+// SPDX-License-Identifier: MIT
+#include "WindowedHistogram.h"
+#include <algorithm>
+#include <Core/source/infra/log/Logging.h>
+
+
+namespace p2c::gfx::lay
+{
+	WindowedHistogram::WindowedHistogram(const Spec& spec_)
+		:
+		spec{ spec_ },
+		binSize{ (spec_.maxValue - spec_.minValue) / float(std::max(spec_.binCount, 1)) },
+		bins(size_t(std::max(spec_.binCount, 0)), 0),
+		countFrequencies(1, std::max(spec_.binCount, 0))
+	{}
+
+	void WindowedHistogram::Add(float value)
+	{
+		if (const auto iBin = MapToBin_(value)) {
+			auto& count = bins[*iBin];
+			countFrequencies[size_t(count)]--;
+			count++;
+			if (size_t(count) >= countFrequencies.size()) {
+				countFrequencies.resize(size_t(count) + 1, 0);
+			}
+			countFrequencies[size_t(count)]++;
+			maxCount = std::max(maxCount, count);
+		}
+	}
+
+	void WindowedHistogram::Remove(float value)
+	{
+		if (const auto iBin = MapToBin_(value)) {
+			auto& count = bins[*iBin];
+			if (count <= 0) {
+				p2clog.warn(L"Trying to remove value from empty histogram bin").commit();
+				return;
+			}
+			countFrequencies[size_t(count)]--;
+			if (count == maxCount && countFrequencies[size_t(count)] == 0) {
+				maxCount--;
+			}
+			count--;
+			countFrequencies[size_t(count)]++;
+		}
+	}
+
+	const std::vector<int>& WindowedHistogram::GetBins() const
+	{
+		return bins;
+	}
+
+	int WindowedHistogram::GetMaxCount() const
+	{
+		return maxCount;
+	}
+
+	const WindowedHistogram::Spec& WindowedHistogram::GetSpec() const
+	{
+		return spec;
+	}
+
+	std::optional<size_t> WindowedHistogram::MapToBin_(float value) const
+	{
+		// binning must be deterministic so that Remove always hits the bin that Add did
+		const int iBin = int((value - spec.minValue) / binSize);
+		if (value >= spec.minValue && iBin >= 0 && iBin < spec.binCount) {
+			return size_t(iBin);
+		}
+		return std::nullopt;
+	}
+}
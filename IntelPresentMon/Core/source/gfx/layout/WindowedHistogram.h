@@ -0,0 +1,43 @@
+// Copyright (C) 2022 Intel Corporation
+// SPDX-License-Identifier: MIT
+#pragma once
+#include <vector>
+#include <optional>
+
+
+namespace p2c::gfx::lay
+{
+	// WindowedHistogram holds bin counts for the data points currently inside a GraphData window
+	// it is kept up to date incrementally by GraphData as points are pushed and trimmed, so drawing
+	// does not need to rebin the whole window; max count is tracked in O(1) for autoscaling
+	class WindowedHistogram
+	{
+	public:
+		// types
+		struct Spec
+		{
+			float minValue;
+			float maxValue;
+			int binCount;
+			bool operator==(const Spec&) const = default;
+		};
+		// functions
+		WindowedHistogram(const Spec& spec);
+		void Add(float value);
+		void Remove(float value);
+		const std::vector<int>& GetBins() const;
+		int GetMaxCount() const;
+		const Spec& GetSpec() const;
+	private:
+		// functions
+		std::optional<size_t> MapToBin_(float value) const;
+		// data
+		Spec spec;
+		float binSize;
+		std::vector<int> bins;
+		// number of bins having each count value (index is the count)
+		// lets us drop the max count when its last bin is decremented without scanning
+		std::vector<int> countFrequencies;
+		int maxCount = 0;
+	};
+}
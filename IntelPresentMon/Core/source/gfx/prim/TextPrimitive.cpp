@@ -7,20 +7,24 @@
 #include "../base/InternalGeometry.h"
 #include "EnumConversion.h"
 #include <Core/source/infra/log/Logging.h>
+#include <Core/source/infra/util/DebugCounter.h>
+#include <algorithm>
 
 namespace p2c::gfx::prim
 {
-	TextPrimitive::TextPrimitive(const std::wstring& text, const TextStylePrimitive& style, const Dimensions& dims, std::shared_ptr<BrushPrimitive> pBrushPrim_, Graphics& gfx, std::optional<Vec2> pos)
+	TextPrimitive::TextPrimitive(const std::wstring& text_, const TextStylePrimitive& style, const Dimensions& dims, std::shared_ptr<BrushPrimitive> pBrushPrim_, Graphics& gfx, std::optional<Vec2> pos)
 		:
 		pBrushPrim{ std::move(pBrushPrim_) },
 		pBrush{ Brush(*pBrushPrim) },
-		position{ pos }
+		position{ pos },
+		text{ text_ }
 	{
 		p2chrlog << Write(gfx).CreateTextLayout(text.c_str(), (UINT32)text.size(), style, dims.width, dims.height, &pLayout);
 	}
 
 	void TextPrimitive::SetMaxDimensions(const Dimensions& dims)
 	{
+		ClearLayoutCache();
 		p2chrlog << pLayout->SetMaxWidth(dims.width);
 		p2chrlog << pLayout->SetMaxHeight(dims.height);
 	}
@@ -44,20 +48,51 @@ namespace p2c::gfx::prim
 
 	void TextPrimitive::SetAlignment(Alignment align)
 	{
+		ClearLayoutCache();
 		p2chrlog << pLayout->SetParagraphAlignment(ConvertAlignment(align));
 	}
 
 	void TextPrimitive::SetJustification(Justification justify)
 	{
+		ClearLayoutCache();
 		p2chrlog << pLayout->SetTextAlignment(ConvertJustification(justify));
 	}
 
 	TextPrimitive::~TextPrimitive() {}
 
-	void TextPrimitive::SetText(const std::wstring& text, Graphics& gfx)
+	void TextPrimitive::SetText(const std::wstring& newText, Graphics& gfx)
 	{
-		auto pOld = std::move(pLayout);
-		p2chrlog << Write(gfx).CreateTextLayout(text.c_str(), (UINT32)text.size(), pOld.Get(), pOld->GetMaxWidth(), pOld->GetMaxHeight(), &pLayout);
+		if (newText == text)
+		{
+			return;
+		}
+		auto i = std::ranges::find(layoutCache, newText, &CachedLayout::text);
+		if (i == layoutCache.end())
+		{
+			// miss: lay out the text in a new slot, or in the least recently used one when full
+			if (layoutCache.size() < layoutCacheSize)
+			{
+				i = layoutCache.insert(layoutCache.end(), CachedLayout{});
+			}
+			else
+			{
+				i = layoutCache.begin();
+			}
+			i->text = newText;
+			i->pLayout.Reset();
+			p2chrlog << Write(gfx).CreateTextLayout(newText.c_str(), (UINT32)newText.size(), pLayout.Get(),
+				pLayout->GetMaxWidth(), pLayout->GetMaxHeight(), &i->pLayout);
+			infra::util::TextAllocationCounter().Tick();
+		}
+		// swap the layout in, and move the current one into the slot as the most recently used
+		std::swap(i->text, text);
+		std::swap(i->pLayout, pLayout);
+		std::rotate(i, std::next(i), layoutCache.end());
+	}
+
+	void TextPrimitive::ClearLayoutCache()
+	{
+		layoutCache.clear();
 	}
 
 	void TextPrimitive::Draw(Graphics& gfx) const
@@ -10,6 +10,7 @@
 #include "Enums.h"
 #include "ForwardInterfaces.h"
 #include <memory>
+#include <vector>
 
 
 namespace p2c::gfx::prim
@@ -28,11 +29,25 @@ namespace p2c::gfx::prim
 		~TextPrimitive() override;
 		void Draw(Graphics& gfx) const override;
 	private:
+		// types
+		struct CachedLayout
+		{
+			std::wstring text;
+			ComPtr<IDWriteTextLayout> pLayout;
+		};
+		// functions
+		void ClearLayoutCache();
+		// data
 		// dependent
 		std::shared_ptr<BrushPrimitive> pBrushPrim;
 		ComPtr<ID2D1Brush> pBrush;
 		// independent
 		std::optional<Vec2> position;
+		std::wstring text;
 		ComPtr<IDWriteTextLayout> pLayout;
+		// layouts of recently shown text (same style and dimensions as the current layout),
+		// least recently used first; readouts tend to cycle through a handful of values
+		static constexpr size_t layoutCacheSize = 8;
+		std::vector<CachedLayout> layoutCache;
 	};
 }
\ No newline at end of file
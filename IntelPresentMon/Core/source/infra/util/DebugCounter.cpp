@@ -0,0 +1,23 @@
+// Copyright (C) 2022 Intel Corporation
+// SPDX-License-Identifier: MIT
+#include "DebugCounter.h"
+
+
+namespace p2c::infra::util
+{
+	void DebugCounter::Tick(uint64_t n)
+	{
+		count_.fetch_add(n, std::memory_order_relaxed);
+	}
+
+	uint64_t DebugCounter::Take()
+	{
+		return count_.exchange(0, std::memory_order_relaxed);
+	}
+
+	DebugCounter& TextAllocationCounter()
+	{
+		static DebugCounter counter;
+		return counter;
+	}
+}
@@ -0,0 +1,23 @@
+// Copyright (C) 2022 Intel Corporation
+// SPDX-License-Identifier: MIT
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+
+namespace p2c::infra::util
+{
+	// tally of events on a hot path (e.g. heap allocations) for profiling; producers tick it
+	// from anywhere, and whoever owns the measurement period takes the tally
+	class DebugCounter
+	{
+	public:
+		void Tick(uint64_t n = 1);
+		uint64_t Take();
+	private:
+		std::atomic<uint64_t> count_ = 0;
+	};
+
+	// allocations made rendering readout text (text buffers growing, text layouts created)
+	DebugCounter& TextAllocationCounter();
+}
@@ -4,6 +4,7 @@
 #include <Core/source/pmon/metric/MetricFetcher.h>
 #include <Core/source/gfx/layout/GraphData.h>
 #include <memory>
+#include <vector>
 
 namespace p2c::kern
 {
@@ -13,17 +14,29 @@ namespace p2c::kern
 		void Populate(double timestamp)
 		{
 			if (graphData) {
-				graphData->Push({ gfx::lay::DataPoint{.value = pFetcher->ReadValue(), .time = timestamp} });
-				graphData->Trim(timestamp);
+				// samples are gathered here and pushed to the graph as a batch in Flush
+				pendingPoints.push_back(gfx::lay::DataPoint{ .value = pFetcher->ReadValue(), .time = timestamp });
 			}
 			if (textData) {
-				*textData = pFetcher->ReadStringValue();
+				// copy only on change; assignment reuses the readout's buffer
+				if (const auto& text = pFetcher->ReadStringValue(); text != *textData) {
+					*textData = text;
+				}
 			}
 		}
+		void Flush()
+		{
+			if (graphData && !pendingPoints.empty()) {
+				graphData->Push(pendingPoints);
+				graphData->Trim(pendingPoints.back().time);
+			}
+			pendingPoints.clear();
+		}
 		
 		// data
 		std::shared_ptr<pmon::met::MetricFetcher> pFetcher;
 		std::shared_ptr<gfx::lay::GraphData> graphData;
 		std::shared_ptr<std::wstring> textData;
+		std::vector<gfx::lay::DataPoint> pendingPoints;
 	};
 }
\ No newline at end of file
@@ -117,6 +117,13 @@ namespace p2c::kern
         }
     }
 
+    std::optional<double> Kernel::GetOverlayCpuCost() const
+    {
+        HandleMarshalledException_();
+        std::lock_guard lk{ mtx };
+        return overlayCpuCost;
+    }
+
     void Kernel::SetCapture(bool active)
     {
         HandleMarshalledException_();
@@ -244,6 +251,7 @@ namespace p2c::kern
             // checking thread sync signals
             {
                 std::lock_guard lk{ mtx };
+                overlayCpuCost = pOverlayContainer->GetCpuCostMsPerSecond();
                 if (dying || clearRequested)
                 {
                     pOverlayContainer->InitiateClose();
@@ -292,6 +300,10 @@ namespace p2c::kern
                         }
                         inhibitTargetLostSignal = false;
                         pOverlayContainer.reset();
+                        {
+                            std::lock_guard lk{ mtx };
+                            overlayCpuCost.reset();
+                        }
                         break;
                     }
                     TranslateMessage(&msg);
@@ -50,6 +50,9 @@ namespace p2c::kern
         std::vector<pmon::AdapterInfo> EnumerateAdapters() const;
         void SetCapture(bool active);
         const pmapi::intro::Root& GetIntrospectionRoot() const;
+        // cpu time (ms per second) spent by the overlay thread, empty when there is no overlay
+        // or it has not yet completed a measurement span
+        std::optional<double> GetOverlayCpuCost() const;
     private:
         // functions
         bool IsIdle_() const;
@@ -67,6 +70,8 @@ namespace p2c::kern
         bool clearRequested = false;
         bool inhibitTargetLostSignal = false;
         std::optional<bool> pushedCaptureActive;
+        // copied from the overlay each pass of the overlay loop
+        std::optional<double> overlayCpuCost;
         std::unique_ptr<OverlaySpec> pPushedSpec;
         std::unique_ptr<OverlayContainer> pOverlayContainer;
         mutable std::condition_variable cv;
@@ -6,6 +6,8 @@
 #include <CommonUtilities\Hash.h>
 #include <unordered_map>
 #include <ranges>
+#include <algorithm>
+#include <vector>
 
 namespace std
 {
@@ -92,16 +94,65 @@ namespace p2c::kern
 			}
 			usageMap_[qmet].text = true;
 		}
-		void Populate(const pmapi::ProcessTracker& tracker, double timestamp)
+		// gather nSamples points spaced sampleInterval seconds apart and ending at timestamp,
+		// polling the query once for all of them
+		void Populate(const pmapi::ProcessTracker& tracker, double timestamp, double sampleInterval, uint32_t nSamples)
 		{
 			// if query is empty, don't do anything (empty loadout)
 			if (pQuery_) {
-				pQuery_->Poll(tracker);
-				for (auto&& [qmet, pPack] : metricPackMap_) {
-					pPack.Populate(timestamp);
+				pQuery_->PollRange(tracker, sampleInterval * 1'000., nSamples);
+				// the query only populates the most recent points it has frame history for;
+				// points before that are skipped rather than populated with no data
+				const auto nPopulated = pQuery_->GetRangeSampleCount();
+				for (uint32_t i = 0; i < nPopulated; i++) {
+					pQuery_->SelectRangeSample(i);
+					const auto sampleTime = timestamp - sampleInterval * (nPopulated - 1 - i);
+					for (auto&& [qmet, pPack] : metricPackMap_) {
+						pPack.Populate(sampleTime);
+					}
 				}
 			}
 		}
+		// fill graphs that have no data yet (just added) with the history still held in
+		// the process's frame ring, so that they do not start out empty
+		void Backfill(const pmapi::ProcessTracker& tracker, double timestamp, double sampleInterval)
+		{
+			if (!pQuery_) {
+				return;
+			}
+			std::vector<DataFetchPack*> packs;
+			double window = 0.;
+			for (auto&& [qmet, pPack] : metricPackMap_) {
+				if (pPack.graphData && pPack.graphData->Size() == 0) {
+					packs.push_back(&pPack);
+					window = (std::max)(window, pPack.graphData->GetWindowSize());
+				}
+			}
+			if (packs.empty()) {
+				return;
+			}
+			// history does not need to be as dense as live sampling
+			const auto interval = (std::max)(sampleInterval, window / maxBackfillSamples_);
+			const auto nSamples = (std::max)(uint32_t(window / interval), 1u);
+			pQuery_->PollRange(tracker, interval * 1'000., nSamples);
+			const auto nPopulated = pQuery_->GetRangeSampleCount();
+			for (uint32_t i = 0; i < nPopulated; i++) {
+				pQuery_->SelectRangeSample(i);
+				for (auto pPack : packs) {
+					pPack->Populate(timestamp - interval * (nPopulated - 1 - i));
+				}
+			}
+			for (auto pPack : packs) {
+				pPack->Flush();
+			}
+		}
+		// push all samples gathered by Populate since the last flush into graph data
+		void Flush()
+		{
+			for (auto&& [qmet, pPack] : metricPackMap_) {
+				pPack.Flush();
+			}
+		}
 		DataFetchPack& operator[](const QualifiedMetric& qmet)
 		{
 			return metricPackMap_.at(qmet);
@@ -114,6 +165,7 @@ namespace p2c::kern
 			bool text = false;
 		};
 		// data
+		static constexpr double maxBackfillSamples_ = 512.;
 		std::unordered_map<QualifiedMetric, DataFetchPack> metricPackMap_;
 		// we might need a class that encapsulates all pollable sources, including DynamicQuery
 		std::shared_ptr<pmon::DynamicQuery> pQuery_;
@@ -13,13 +13,17 @@
 #include <Core/source/win/StandardWindow.h>
 #include <Core/source/win/OverlayWindow.h>
 #include <Core/source/infra/opt/Options.h>
+#include <Core/source/infra/util/DebugCounter.h>
 #include <ranges>
+#include <algorithm>
 #include <set>
 #include <chrono>
 #include <format>
 #include <thread>
 #include <array>
 #include <cassert>
+#include <cmath>
+#include <limits>
 #include "TargetLostException.h"
 #include "MetricPackMapper.h"
 #include <PresentMonAPIWrapper/StaticQuery.h>
@@ -97,6 +101,26 @@ namespace p2c::kern
 
             return pRoot;
         }
+
+        // seconds of cpu time (user and kernel) used by the calling thread
+        double GetThreadCpuTime_()
+        {
+            FILETIME creation, exit, kernel, user;
+            if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+                return 0.;
+            }
+            const auto toTicks = [](const FILETIME& ft) {
+                return (uint64_t(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+            };
+            // filetime ticks are 100ns
+            return double(toTicks(kernel) + toTicks(user)) / 10'000'000.;
+        }
+
+        // seconds between refreshes for a rate in Hz; a rate of 0 means no bound
+        double RefreshInterval_(double rate, double unbounded)
+        {
+            return rate > 0. ? 1. / rate : unbounded;
+        }
     }
 
 
@@ -127,15 +151,19 @@ namespace p2c::kern
         gfx{ pWindow->GetHandle(), graphicsDimensions, upscaleFactor, infra::opt::get().allowTearing },
         samplingPeriodMs{ pSpec->samplingPeriodMs },
         samplesPerFrame{ pSpec->samplesPerFrame },
+        maxRefreshInterval{ RefreshInterval_(pSpec->minRefreshRate, std::numeric_limits<double>::infinity()) },
+        minRefreshInterval{ RefreshInterval_(pSpec->maxRefreshRate, 0.) },
         hideDuringCapture{ pSpec->hideDuringCapture },
         hideAlways{ pSpec->hideAlways },
-        samplingWaiter{ float(pSpec->samplingPeriodMs) / 1'000.f }
+        samplingWaiter{ float(pSpec->samplingPeriodMs * pSpec->samplesPerFrame) / 1'000.f }
     {
         UpdateDataSets_();
         pRoot = MakeDocument_(gfx, *pSpec, *pPackMapper, fetcherFactory, pCaptureIndicatorText);
         UpdateCaptureStatusText_();
         AdjustOverlaySituation_(position);
         pm->StartTracking(proc.pid);
+        costSpanStartTime = pmon::Timekeeper::Now();
+        costSpanStartCpuTime = GetThreadCpuTime_();
     }
 
     Overlay::~Overlay()
@@ -165,6 +193,8 @@ namespace p2c::kern
         // remove stale data packs, register new query, fill new fetchers
         pPackMapper->CommitChanges(proc.pid, pSpec->averagingWindowSize,
             pSpec->metricsOffset, fetcherFactory);
+        // newly added graphs are filled from existing history on the next tick
+        backfillPending = true;
     }
 
     std::unique_ptr<win::KernelWindow> Overlay::MakeWindow_(std::optional<Vec2I> pos_)
@@ -222,8 +252,12 @@ namespace p2c::kern
         pRoot = MakeDocument_(gfx, *pSpec, *pPackMapper, fetcherFactory, pCaptureIndicatorText);
         UpdateCaptureStatusText_();
         samplingPeriodMs = pSpec->samplingPeriodMs;
-        samplingWaiter.SetInterval(pSpec->samplingPeriodMs / 1'000.f);
+        samplingWaiter.SetInterval(pSpec->samplingPeriodMs * pSpec->samplesPerFrame / 1'000.f);
         samplesPerFrame = pSpec->samplesPerFrame;
+        maxRefreshInterval = RefreshInterval_(pSpec->minRefreshRate, std::numeric_limits<double>::infinity());
+        minRefreshInterval = RefreshInterval_(pSpec->maxRefreshRate, 0.);
+        // redraw the new document on the next tick even if no new frames arrive
+        lastRefreshTime.reset();
         hideDuringCapture = pSpec->hideDuringCapture;
         hideAlways = pSpec->hideAlways;
         AdjustOverlaySituation_(pSpec->overlayPosition);
@@ -265,7 +299,18 @@ namespace p2c::kern
         if (!IsTargetLive()) {
             throw TargetLostException{};
         }
-        pPackMapper->Populate(pm->GetTracker(), timestamp);
+        const auto samplingPeriod = samplingPeriodMs / 1'000.;
+        auto nSamples = uint32_t((std::max)(samplesPerFrame, 1));
+        // when refreshes were skipped for lack of new frames, cover the whole span since the
+        // last refresh at the usual sampling density
+        if (lastRefreshTime) {
+            // with no minimum refresh rate, the graph is not backfilled past one time range
+            const auto maxSpan = (std::max)(minRefreshInterval,
+                std::isfinite(maxRefreshInterval) ? maxRefreshInterval : pSpec->graphDataWindowSize);
+            const auto maxSamples = (std::max)(nSamples, uint32_t(maxSpan / samplingPeriod) + 1);
+            nSamples = std::clamp(uint32_t(std::round((timestamp - *lastRefreshTime) / samplingPeriod)), 1u, maxSamples);
+        }
+        pPackMapper->Populate(pm->GetTracker(), timestamp, samplingPeriod, nSamples);
     }
 
     void Overlay::UpdateTargetRect(const RectI& newRect)
@@ -371,6 +416,7 @@ namespace p2c::kern
     void Overlay::RunTick()
     {
         using namespace std::chrono_literals;
+        bool refreshed = false;
         // polling data sources multiple times per drawn overlay frame
         if (IsHidden_())
         {
@@ -380,11 +426,35 @@ namespace p2c::kern
         }
         else
         {
-            for (int i = 0; i < samplesPerFrame; i++)
+            if (backfillPending)
             {
-                samplingWaiter.Wait();
+                if (!IsTargetLive()) {
+                    throw TargetLostException{};
+                }
                 pmon::Timekeeper::LockNow();
-                UpdateGraphData_(pmon::Timekeeper::GetLockedNow());
+                pPackMapper->Backfill(pm->GetTracker(), pmon::Timekeeper::GetLockedNow(), samplingPeriodMs / 1'000.);
+                backfillPending = false;
+            }
+            // wait out the sampling period of the whole frame (the fastest the overlay refreshes)
+            samplingWaiter.Wait();
+            pmon::Timekeeper::LockNow();
+            const auto now = pmon::Timekeeper::GetLockedNow();
+            if (!IsTargetLive()) {
+                throw TargetLostException{};
+            }
+            // only poll and draw when the target has written frames since the last refresh (telemetry
+            // is delivered with frames) and the maximum refresh rate allows, or when the display
+            // would otherwise go stale
+            const auto sinceRefresh = lastRefreshTime ? now - *lastRefreshTime : std::numeric_limits<double>::infinity();
+            if (const auto frameCount = pm->GetTracker().GetFrameCount();
+                (frameCount != lastFrameCount && sinceRefresh >= minRefreshInterval) || sinceRefresh >= maxRefreshInterval) {
+                lastFrameCount = frameCount;
+                // gather all samples since the last refresh with a single poll
+                UpdateGraphData_(now);
+                // commit samples gathered this frame to graphs in one batch
+                pPackMapper->Flush();
+                lastRefreshTime = now;
+                refreshed = true;
             }
         }
 
@@ -399,14 +469,45 @@ namespace p2c::kern
                 lastMoveTime = {};
                 if (!IsHidden_()) {
                     pWindow->Show();
+                    lastRefreshTime.reset();
                 }
             }
         }
 
-        if (!IsHidden_())
+        if (refreshed && !IsHidden_())
         {
             Render_();
+            costSpanRefreshCount++;
         }
+        if (refreshed)
+        {
+            // covers the sampling of readout text as well as its layout for this frame
+            textAllocationsPerFrame = infra::util::TextAllocationCounter().Take();
+        }
+
+        MeasureCpuCost_();
+    }
+
+    void Overlay::MeasureCpuCost_()
+    {
+        const auto now = pmon::Timekeeper::Now();
+        if (now - costSpanStartTime < costSpanPeriod_) {
+            return;
+        }
+        const auto cpuTime = GetThreadCpuTime_();
+        cpuCostMsPerSecond = (cpuTime - costSpanStartCpuTime) * 1'000. / (now - costSpanStartTime);
+        const auto& fastStats = gfx.GetFastFrameStats();
+        p2clog.verbose(std::format(L"overlay-cpu-cost | pid:{:5} ms/s:{:.2f} refreshes/s:{:.1f} vtx-emitted:{} vtx-retained:{} text-allocs/frame:{}",
+            proc.pid, *cpuCostMsPerSecond, costSpanRefreshCount / (now - costSpanStartTime),
+            fastStats.emittedVertices, fastStats.retainedVertices, textAllocationsPerFrame)).commit();
+        costSpanStartTime = now;
+        costSpanStartCpuTime = cpuTime;
+        costSpanRefreshCount = 0;
+    }
+
+    std::optional<double> Overlay::GetCpuCostMsPerSecond() const
+    {
+        return cpuCostMsPerSecond;
     }
 
     void Overlay::SetCaptureState(bool active, std::wstring path, std::wstring name)
@@ -446,6 +547,7 @@ namespace p2c::kern
 
         // update indicator on overlay
         UpdateCaptureStatusText_();
+        lastRefreshTime.reset();
     }
 
     bool Overlay::IsTargetLive() const
@@ -9,6 +9,7 @@
 #include <memory>
 #include <vector>
 #include <atomic>
+#include <optional>
 #include <unordered_map>
 #include "WindowMoveHandler.h"
 #include "WindowActivateHandler.h"
@@ -56,6 +57,8 @@ namespace p2c::kern
         std::unique_ptr<Overlay> SacrificeClone(std::optional<HWND> hWnd_ = {}, std::shared_ptr<OverlaySpec> pSpec_ = {});
         std::unique_ptr<Overlay> RetargetPidClone(win::Process proc_);
         const gfx::RectI& GetTargetRect() const;
+        // overlay thread cpu time (ms) per second over the last completed measurement span
+        std::optional<double> GetCpuCostMsPerSecond() const;
     private:
         // functions
         void AdjustOverlaySituation_(OverlaySpec::OverlayPosition position);
@@ -63,6 +66,7 @@ namespace p2c::kern
         void Render_();
         void UpdateCaptureStatusText_();
         void UpdateDataSets_();
+        void MeasureCpuCost_();
         std::unique_ptr<win::KernelWindow> MakeWindow_(std::optional<gfx::Vec2I> pos_);
         gfx::Vec2I CalculateOverlayPosition_() const;
         bool IsHidden_() const;
@@ -95,7 +99,23 @@ namespace p2c::kern
         std::shared_ptr<gfx::lay::TextElement> pCaptureIndicatorText;
         int samplingPeriodMs;
         int samplesPerFrame;
+        // paces overlay frames; each frame gathers samplesPerFrame samples
         infra::util::IntervalWaiter samplingWaiter;
+        // frames are only polled and drawn when the target has written new frames since the
+        // last refresh, but at least once per maxRefreshInterval and at most once per
+        // minRefreshInterval (seconds, from the spec's refresh rate bounds)
+        double maxRefreshInterval;
+        double minRefreshInterval;
+        uint64_t lastFrameCount = 0;
+        std::optional<double> lastRefreshTime;
+        // overlay thread cpu cost, measured over spans of costSpanPeriod_ (seconds)
+        static constexpr double costSpanPeriod_ = 1.;
+        double costSpanStartTime = 0.;
+        double costSpanStartCpuTime = 0.;
+        int costSpanRefreshCount = 0;
+        std::optional<double> cpuCostMsPerSecond;
+        uint64_t textAllocationsPerFrame = 0;
+        bool backfillPending = false;
         bool hideDuringCapture;
         bool hideAlways;
         std::optional<std::chrono::high_resolution_clock::time_point> lastMoveTime;
@@ -95,6 +95,10 @@ namespace p2c::kern
     {
         return pOverlay->GetProcess();
     }
+    std::optional<double> OverlayContainer::GetCpuCostMsPerSecond() const
+    {
+        return pOverlay->GetCpuCostMsPerSecond();
+    }
     void OverlayContainer::UpdateTargetFullscreenStatus()
     {
         pOverlay->UpdateTargetFullscreenStatus();
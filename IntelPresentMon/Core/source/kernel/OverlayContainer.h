@@ -26,6 +26,7 @@ namespace p2c::kern
         void SetCaptureState(bool active, std::wstring path, std::wstring name);
         bool IsTargetLive() const;
         const win::Process& GetProcess() const;
+        std::optional<double> GetCpuCostMsPerSecond() const;
         void UpdateTargetFullscreenStatus();
         const OverlaySpec& GetSpec() const;
         void CheckAndProcessFullscreenTransition();
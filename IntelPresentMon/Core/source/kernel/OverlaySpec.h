@@ -78,6 +78,10 @@ namespace p2c::kern
         float upscaleFactor;
         int samplingPeriodMs = 4;
         int samplesPerFrame = 4;
+        // bounds on how often the overlay polls and redraws (Hz): at least minRefreshRate even when
+        // the target presents no new frames, at most maxRefreshRate; 0 leaves that side unbounded
+        double minRefreshRate = 4.;
+        double maxRefreshRate = 0.;
         uint32_t telemetrySamplingPeriodMs;
         bool hideDuringCapture;
         bool hideAlways;
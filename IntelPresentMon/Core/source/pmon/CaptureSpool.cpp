@@ -0,0 +1,149 @@
+// Copyright (C) 2022 Intel Corporation
+// SPDX-License-Identifier: MIT
+#include "CaptureSpool.h"
+#include <Core/source/win/WinAPI.h>
+#include <Core/source/infra/log/Logging.h>
+#include <stdexcept>
+
+namespace p2c::pmon
+{
+	namespace
+	{
+		double GetThreadCpuTime_()
+		{
+			FILETIME creation, exit, kernel, user;
+			if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+				return 0.;
+			}
+			const auto toTicks = [](const FILETIME& ft) {
+				return (uint64_t(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+			};
+			// filetime ticks are 100ns
+			return double(toTicks(kernel) + toTicks(user)) / 10'000'000.;
+		}
+	}
+
+	CaptureSpool::CaptureSpool(std::ostream& out, size_t blobSize, Formatter formatter, size_t maxPendingBytes)
+		:
+		out_{ out },
+		blobSize_{ blobSize },
+		formatter_{ std::move(formatter) },
+		maxPendingBytes_{ maxPendingBytes },
+		thread_{ &CaptureSpool::WriterProcedure_, this }
+	{}
+
+	CaptureSpool::~CaptureSpool()
+	{
+		// hand over whatever is left once the writer has taken the last batch, and have it drain
+		{
+			std::unique_lock lk{ mtx_ };
+			cv_.wait(lk, [this] { return pending_.empty() || failed_; });
+			std::swap(spool_, pending_);
+			stopping_ = true;
+		}
+		cv_.notify_all();
+		thread_.join();
+	}
+
+	void CaptureSpool::Push(const uint8_t* pBlob)
+	{
+		spool_.insert(spool_.end(), pBlob, pBlob + blobSize_);
+	}
+
+	void CaptureSpool::Submit()
+	{
+		if (spool_.empty()) {
+			return;
+		}
+		std::unique_lock lk{ mtx_ };
+		if (failed_) {
+			spool_.clear();
+			return;
+		}
+		// writer has fallen too far behind: wait for it rather than let the spool grow
+		if (spool_.size() >= maxPendingBytes_) {
+			cv_.wait(lk, [this] { return pending_.empty() || failed_; });
+		}
+		// otherwise if the writer is still busy, keep spooling until the next submit
+		if (pending_.empty()) {
+			// the buffer swapped back is empty but keeps its capacity
+			std::swap(spool_, pending_);
+			lk.unlock();
+			cv_.notify_all();
+		}
+	}
+
+	void CaptureSpool::Drain()
+	{
+		std::unique_lock lk{ mtx_ };
+		cv_.wait(lk, [this] { return pending_.empty() || failed_; });
+		if (failed_) {
+			spool_.clear();
+			return;
+		}
+		if (!spool_.empty()) {
+			std::swap(spool_, pending_);
+			cv_.notify_all();
+		}
+		cv_.wait(lk, [this] { return (pending_.empty() && !writing_) || failed_; });
+	}
+
+	uint64_t CaptureSpool::GetFramesWritten() const
+	{
+		return framesWritten_;
+	}
+
+	double CaptureSpool::GetWriterCpuSeconds() const
+	{
+		return writerCpuSeconds_;
+	}
+
+	void CaptureSpool::WriterProcedure_()
+	{
+		std::vector<uint8_t> working;
+		std::string text;
+		try {
+			while (true) {
+				{
+					std::unique_lock lk{ mtx_ };
+					cv_.wait(lk, [this] { return !pending_.empty() || stopping_; });
+					if (pending_.empty()) {
+						break;
+					}
+					std::swap(pending_, working);
+					writing_ = true;
+				}
+				// producer might be waiting for the pending batch to be taken
+				cv_.notify_all();
+				for (size_t offset = 0; offset + blobSize_ <= working.size(); offset += blobSize_) {
+					formatter_(working.data() + offset, text);
+				}
+				out_.write(text.data(), std::streamsize(text.size()));
+				out_.flush();
+				if (out_.fail()) {
+					throw std::runtime_error{ "Capture stream write failed" };
+				}
+				framesWritten_ += working.size() / blobSize_;
+				writerCpuSeconds_ = GetThreadCpuTime_();
+				text.clear();
+				working.clear();
+				{
+					std::lock_guard lk{ mtx_ };
+					writing_ = false;
+				}
+				// producer might be draining
+				cv_.notify_all();
+			}
+		}
+		catch (...) {
+			p2clog.warn(L"Failed writing spooled capture frames; remaining frames dropped").commit();
+			{
+				std::lock_guard lk{ mtx_ };
+				failed_ = true;
+				writing_ = false;
+				pending_.clear();
+			}
+			cv_.notify_all();
+		}
+	}
+}
@@ -0,0 +1,61 @@
+// Copyright (C) 2022 Intel Corporation
+// SPDX-License-Identifier: MIT
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace p2c::pmon
+{
+	// spools fixed-size frame blobs to a background thread that formats and writes them out, so that
+	// the capture loop only copies bytes; buffers are double-buffered and recycled, and the producer
+	// is held back when the writer falls maxPendingBytes behind, so memory stays bounded
+	class CaptureSpool
+	{
+	public:
+		// formats one blob, appending the text to out
+		using Formatter = std::function<void(const uint8_t* pBlob, std::string& out)>;
+		static constexpr size_t defaultMaxPendingBytes = 4 * 1024 * 1024;
+		CaptureSpool(std::ostream& out, size_t blobSize, Formatter formatter, size_t maxPendingBytes = defaultMaxPendingBytes);
+		CaptureSpool(const CaptureSpool&) = delete;
+		CaptureSpool& operator=(const CaptureSpool&) = delete;
+		// writes out everything spooled before returning
+		~CaptureSpool();
+		void Push(const uint8_t* pBlob);
+		// hand blobs pushed so far to the writer (if it is not still busy with the last batch)
+		void Submit();
+		// hand over everything pushed so far and wait until the writer has written it out
+		void Drain();
+		uint64_t GetFramesWritten() const;
+		// cpu time used by the writer thread so far
+		double GetWriterCpuSeconds() const;
+	private:
+		// functions
+		void WriterProcedure_();
+		// data
+		std::ostream& out_;
+		size_t blobSize_;
+		Formatter formatter_;
+		size_t maxPendingBytes_;
+		// filled by the producer
+		std::vector<uint8_t> spool_;
+		// handed over to the writer, guarded by mtx_
+		std::vector<uint8_t> pending_;
+		bool stopping_ = false;
+		// the writer is formatting and writing a batch it has taken
+		bool writing_ = false;
+		// a write to the stream failed; spooled frames are dropped from then on
+		bool failed_ = false;
+		std::mutex mtx_;
+		std::condition_variable cv_;
+		std::atomic<uint64_t> framesWritten_ = 0;
+		std::atomic<double> writerCpuSeconds_ = 0.;
+		std::jthread thread_;
+	};
+}
@@ -27,6 +27,7 @@ namespace p2c::pmon
 
 	void DynamicQuery::Poll(const pmapi::ProcessTracker& tracker)
 	{
+		selectedRangeSample.reset();
 		if (query) {
 			query.Poll(tracker, blobs);
 		}
@@ -35,8 +36,38 @@ namespace p2c::pmon
 		}
 	}
 
+	void DynamicQuery::PollRange(const pmapi::ProcessTracker& tracker, double sampleIntervalMs, uint32_t nSamples)
+	{
+		selectedRangeSample = nSamples;
+		if (query) {
+			if (rangeBlobs.GetBlobCount() != nSamples) {
+				rangeBlobs = query.MakeBlobContainer(nSamples);
+			}
+			query.PollRange(tracker, sampleIntervalMs, rangeBlobs);
+		}
+		else {
+			p2clog.warn(L"Polling empty dynamic query").commit();
+		}
+	}
+
+	uint32_t DynamicQuery::GetRangeSampleCount() const
+	{
+		return rangeBlobs.GetNumBlobsPopulated();
+	}
+
+	void DynamicQuery::SelectRangeSample(uint32_t index)
+	{
+		selectedRangeSample = index;
+	}
+
 	const uint8_t* DynamicQuery::GetBlobData() const
 	{
+		if (selectedRangeSample) {
+			if (*selectedRangeSample >= GetRangeSampleCount()) {
+				return nullptr;
+			}
+			return rangeBlobs[*selectedRangeSample];
+		}
 		if (blobs.GetNumBlobsPopulated() == 0) {
 			return nullptr;
 		}
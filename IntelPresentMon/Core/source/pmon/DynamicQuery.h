@@ -21,11 +21,20 @@ namespace p2c::pmon
 	public:
 		DynamicQuery(pmapi::Session& session, double winSizeMs, double metricOffsetMs, std::span<const kern::QualifiedMetric> qmet);
 		void Poll(const pmapi::ProcessTracker& tracker);
+		// poll nSamples time points sampleIntervalMs apart, ending now, in a single call
+		void PollRange(const pmapi::ProcessTracker& tracker, double sampleIntervalMs, uint32_t nSamples);
+		// number of points the last PollRange populated (the most recent ones)
+		uint32_t GetRangeSampleCount() const;
+		// make GetBlobData return point index of the last PollRange (no data if out of range)
+		// until the next Poll
+		void SelectRangeSample(uint32_t index);
 		const uint8_t* GetBlobData() const;
 		std::vector<PM_QUERY_ELEMENT> ExtractElements();
 	private:
 		pmapi::DynamicQuery query;
 		std::vector<PM_QUERY_ELEMENT> elements;
 		pmapi::BlobContainer blobs;
+		pmapi::BlobContainer rangeBlobs;
+		std::optional<uint32_t> selectedRangeSample;
 	};
 }
\ No newline at end of file
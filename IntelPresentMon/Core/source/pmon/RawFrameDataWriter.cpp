@@ -8,6 +8,7 @@
 #include <PresentMonAPIWrapperCommon/EnumMap.h>
 #include <format>
 #include <array>
+#include <charconv>
 #include "RawFrameDataMetricList.h"
 
 namespace p2c::pmon
@@ -21,10 +22,26 @@ namespace p2c::pmon
         // type to activate special templatate specialization for time
         struct TimeAnnotationType_{};
 
+        // appends a number as ostream would format it by default (%g with precision 6 for floating point)
+        // but without going through a stream
+        template<typename T>
+        void AppendNumber_(std::string& out, T val)
+        {
+            std::array<char, 32> buffer;
+            std::to_chars_result result;
+            if constexpr (std::floating_point<T>) {
+                result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), val, std::chars_format::general, 6);
+            }
+            else {
+                result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), val);
+            }
+            out.append(buffer.data(), result.ptr);
+        }
+
         struct Annotation_
         {
             virtual ~Annotation_() = default;
-            virtual void Write(std::ostream& out, const uint8_t* pBytes) const = 0;
+            virtual void Write(std::string& out, const uint8_t* pBytes) const = 0;
             std::string columnName;
             static std::unique_ptr<Annotation_> MakeTyped(PM_METRIC metricId, uint32_t deviceId,
                 const pmapi::intro::MetricView& metric);
@@ -34,22 +51,25 @@ namespace p2c::pmon
         {
         public:
             TypedAnnotation_(bool zeroForNA = false) : zeroForNA_{ zeroForNA } {}
-            void Write(std::ostream& out, const uint8_t* pBytes) const override
+            void Write(std::string& out, const uint8_t* pBytes) const override
             {
                 if constexpr (std::same_as<T, const char*>) {
-                    out << reinterpret_cast<T>(pBytes);
+                    out += reinterpret_cast<T>(pBytes);
+                }
+                else if constexpr (std::same_as<T, bool>) {
+                    out += *reinterpret_cast<const T*>(pBytes) ? '1' : '0';
                 }
                 else if constexpr (std::floating_point<T>) {
                     const auto val = *reinterpret_cast<const T*>(pBytes);
                     if (std::isnan(val)) {
-                        out << (zeroForNA_ ? "0" : "NA");
+                        out += (zeroForNA_ ? "0" : "NA");
                     }
                     else {
-                        out << val;
+                        AppendNumber_(out, val);
                     }
                 }
                 else {
-                    out << *reinterpret_cast<const T*>(pBytes);
+                    AppendNumber_(out, *reinterpret_cast<const T*>(pBytes));
                 }
             }
         private:
@@ -58,32 +78,32 @@ namespace p2c::pmon
         template<>
         struct TypedAnnotation_<void> : public Annotation_
         {
-            void Write(std::ostream& out, const uint8_t* pBytes) const override
+            void Write(std::string& out, const uint8_t* pBytes) const override
             {
-                out << "NA";
+                out += "NA";
             }
         };
         template<>
         struct TypedAnnotation_<PM_ENUM> : public Annotation_
         {
             TypedAnnotation_(PM_ENUM enumId) : pKeyMap{ pmapi::EnumMap::GetKeyMap(enumId) } {}
-            void Write(std::ostream& out, const uint8_t* pBytes) const override
+            void Write(std::string& out, const uint8_t* pBytes) const override
             {
-                out << pKeyMap->at(*reinterpret_cast<const int*>(pBytes)).narrowName;
+                out += pKeyMap->at(*reinterpret_cast<const int*>(pBytes)).narrowName;
             }
             std::shared_ptr<const pmapi::EnumMap::KeyMap> pKeyMap;
         };
         template<>
         struct TypedAnnotation_<TimeAnnotationType_> : public Annotation_
         {
-            void Write(std::ostream& out, const uint8_t* pBytes) const override
+            void Write(std::string& out, const uint8_t* pBytes) const override
             {
                 if (startTime) {
-                    out << (*reinterpret_cast<const double*>(pBytes) - *startTime) * 0.001;
+                    AppendNumber_(out, (*reinterpret_cast<const double*>(pBytes) - *startTime) * 0.001);
                 }
                 else {
                     startTime = *reinterpret_cast<const double*>(pBytes);
-                    out << 0.;
+                    out += '0';
                 }
             }
             mutable std::optional<double> startTime;
@@ -200,20 +220,22 @@ namespace p2c::pmon
         {
             return reinterpret_cast<const double&>(pBlob[queryElements_[frametimeElementIdx_].dataOffset]);
         }
-        void WriteFrame(uint32_t pid, const std::string& procName, std::ostream& out, const uint8_t* pBlob)
+        void WriteFrame(uint32_t pid, const std::string& procName, std::string& out, const uint8_t* pBlob) const
         {
             // TODO: use metrics from procname and pid
             // process details are hardcoded here
-            out << procName << ',' << pid;
+            out += procName;
+            out += ',';
+            AppendNumber_(out, pid);
             // loop over each element (column/field) in a frame of data
             for (auto&& [pAnno, query] : std::views::zip(annotationPtrs_, queryElements_)) {
-                out << ',';
+                out += ',';
                 // using output from the query registration of get offset of column's data
                 const auto pBytes = pBlob + query.dataOffset;
                 // annotation contains polymorphic info to reinterpret and convert bytes
                 pAnno->Write(out, pBytes);
             }
-            out << "\n";
+            out += '\n';
         }
         void WriteHeader(std::ostream& out)
         {
@@ -249,6 +271,12 @@ namespace p2c::pmon
                 
         // write header
         pQueryElementContainer->WriteHeader(file);
+
+        // frames are formatted to csv on the spool's writer thread
+        pSpool = std::make_unique<CaptureSpool>(file, blobs.GetBlobSize(),
+            [this, pid = procTracker.GetPid()](const uint8_t* pBlob, std::string& out) {
+                pQueryElementContainer->WriteFrame(pid, procName, out, pBlob);
+            });
     }
 
     void RawFrameDataWriter::Process()
@@ -270,10 +298,10 @@ namespace p2c::pmon
                     // tracking frame times
                     pStatsTracker->Push(pQueryElementContainer->ExtractFrameTimeFromBlob(pBlob));
                 }
-                pQueryElementContainer->WriteFrame(procTracker.GetPid(), procName, file, pBlob);
+                pSpool->Push(pBlob);
             }
         } while (blobs.AllBlobsPopulated()); // if container filled, means more might be left
-        file << std::flush;
+        pSpool->Submit();
     }
 
     double RawFrameDataWriter::GetDuration_() const
@@ -330,6 +358,8 @@ namespace p2c::pmon
     RawFrameDataWriter::~RawFrameDataWriter()
     {
         try {
+            // finish writing out spooled frames before anything they reference goes away
+            pSpool.reset();
             if (pStatsTracker) {
                 WriteStats_();
             }
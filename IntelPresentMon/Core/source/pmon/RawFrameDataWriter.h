@@ -6,6 +6,7 @@
 #include <optional>
 #include <string>
 #include "StatisticsTracker.h"
+#include "CaptureSpool.h"
 #include <PresentMonAPI2/PresentMonAPI.h>
 #include <PresentMonAPIWrapper/Session.h>
 #include <PresentMonAPIWrapper/BlobContainer.h>
@@ -40,5 +41,7 @@ namespace p2c::pmon
 		double startTime = -1.;
 		double endTime = -1.;
 		std::ofstream file;
+		// declared after everything the writer thread references
+		std::unique_ptr<CaptureSpool> pSpool;
 	};
 }
@@ -5,6 +5,7 @@
 #include <ranges>
 #include <algorithm>
 #include <numeric>
+#include <cmath>
 #include <Core/source/infra/util/Assert.h>
 
 namespace rn = std::ranges;
@@ -12,62 +13,88 @@ namespace vi = rn::views;
 
 namespace p2c::pmon
 {
+	StatisticsTracker::StatisticsTracker()
+		:
+		buckets(bucketCount_)
+	{}
 	void StatisticsTracker::Push(double value)
 	{
-		values.push_back(value);
-		sorted = false;
+		if (count == 0) {
+			min = value;
+			max = value;
+		}
+		else {
+			min = (std::min)(min, value);
+			max = (std::max)(max, value);
+		}
+		count++;
+		sum += value;
+		buckets[GetBucketIndex_(value)]++;
+		if (count <= exactLimit_) {
+			values.push_back(value);
+			sorted = false;
+		}
+		else if (!values.empty()) {
+			// from here on percentiles come from the histogram
+			values.clear();
+			values.shrink_to_fit();
+		}
 	}
 	double StatisticsTracker::GetPercentile(double percentile)
 	{
-		Sort_();
-		if (values.empty()) {
+		if (count == 0) {
 			return -1.;
 		}
-		if (values.size() == 1) {
-			return values.front();
-		}
-		if (percentile <= 0.) {
-			return values.front();
+		if (count == 1 || percentile <= 0.) {
+			return min / 1000.;
 		}
 		if (percentile >= 1.) {
-			return values.back();
+			return max / 1000.;
 		}
 
-		double index = (values.size() - 1) * percentile;
+		double index = (count - 1) * percentile;
 		const auto lower = static_cast<size_t>(index);
 		const auto upper = lower + 1;
 		const auto weight = index - double(lower);
 
-		const double percentileMs = values[lower] * (1 - weight) + values[upper] * weight;
+		double lowerMs, upperMs;
+		if (count <= exactLimit_) {
+			Sort_();
+			lowerMs = values[lower];
+			upperMs = values[upper];
+		}
+		else {
+			lowerMs = GetHistogramValue_(lower);
+			upperMs = GetHistogramValue_(upper);
+		}
+		const double percentileMs = lowerMs * (1 - weight) + upperMs * weight;
 		return percentileMs / 1000.;
 	}
 	double StatisticsTracker::GetMin()
 	{
-		Sort_();
-		if (values.empty()) {
+		if (count == 0) {
 			return -1.;
 		}
-		return values.front() / 1000.;
+		return min / 1000.;
 	}
 	double StatisticsTracker::GetMax()
 	{
-		Sort_();
-		if (values.empty()) {
+		if (count == 0) {
 			return -1.;
 		}
-		return values.back() / 1000.;
+		return max / 1000.;
 	}
 	double StatisticsTracker::GetMean() const
 	{
-		if (values.empty()) {
+		if (count == 0) {
 			return -1.;
 		}
-		const double meanMs = std::accumulate(values.begin(), values.end(), 0.) / GetCount();
+		const double meanMs = sum / GetCount();
 		return meanMs / 1000.;
 	}
 	size_t StatisticsTracker::GetCount() const
 	{
-		return values.size();
+		return count;
 	}
 	void StatisticsTracker::Sort_()
 	{
@@ -76,4 +103,25 @@ namespace p2c::pmon
 			sorted = true;
 		}
 	}
-}
\ No newline at end of file
+	size_t StatisticsTracker::GetBucketIndex_(double value)
+	{
+		if (!(value > bucketMin_)) {
+			return 0;
+		}
+		const auto index = 1 + size_t(std::log(value / bucketMin_) / std::log(bucketGrowth_));
+		return (std::min)(index, bucketCount_ - 1);
+	}
+	double StatisticsTracker::GetHistogramValue_(size_t rank) const
+	{
+		size_t cumulative = 0;
+		for (size_t i = 0; i < bucketCount_; i++) {
+			cumulative += buckets[i];
+			if (cumulative > rank) {
+				// geometric middle of the bucket, but never outside of what was actually seen
+				const auto estimate = i == 0 ? bucketMin_ : bucketMin_ * std::pow(bucketGrowth_, double(i) - 0.5);
+				return std::clamp(estimate, min, max);
+			}
+		}
+		return max;
+	}
+}
@@ -2,12 +2,20 @@
 // SPDX-License-Identifier: MIT
 #pragma once
 #include <vector>
+#include <cstddef>
+#include <cstdint>
 
 namespace p2c::pmon
 {
+	// summary stats of frame times (ms in, seconds out) computed incrementally in bounded memory
+	// values are kept (for exact percentiles) until exactLimit_ are pushed; past that, percentiles
+	// come from a log-bucketed histogram with ~0.5% relative error, so long captures do not grow
+	// every getter returns seconds (-1 when empty), including GetPercentile's edge cases: a single
+	// sample, percentile <= 0 (the min) and percentile >= 1 (the max), which used to return ms
 	class StatisticsTracker
 	{
 	public:
+		StatisticsTracker();
 		void Push(double value);
 		double GetPercentile(double percentile);
 		double GetMin();
@@ -15,8 +23,24 @@ namespace p2c::pmon
 		double GetMean() const;
 		size_t GetCount() const;
 	private:
+		// functions
 		void Sort_();
+		static size_t GetBucketIndex_(double value);
+		// value of the sample at rank (0-based, ascending) as estimated by the histogram
+		double GetHistogramValue_(size_t rank) const;
+		// data
+		static constexpr size_t exactLimit_ = 1 << 16;
+		// bucket 0 holds values up to bucketMin_, each bucket after spans a factor of bucketGrowth_
+		// so that buckets cover up to ~1000 seconds
+		static constexpr double bucketMin_ = 0.001;
+		static constexpr double bucketGrowth_ = 1.01;
+		static constexpr size_t bucketCount_ = 2100;
 		bool sorted = false;
 		std::vector<double> values;
+		std::vector<uint64_t> buckets;
+		size_t count = 0;
+		double sum = 0.;
+		double min = 0.;
+		double max = 0.;
 	};
 }
@@ -17,10 +17,8 @@ namespace p2c::pmon::met
         // overlay will always indicate preferred unit in the widget labels
         // so we must scale from output unit if necessary to match
         const auto metric = introRoot.FindMetric(qel.metric);
-        const auto type = metric.GetDataTypeInfo().GetPolledType();
         if (metric.GetUnit() != metric.GetPreferredUnitHint()) {
-            scale_ = (float)introRoot.FindUnit(metric.GetUnit())
-                .MakeConversionFactor(metric.GetPreferredUnitHint());
+            scale_ = (float)metric.GetPreferredUnitScale();
         }
     }
 
@@ -30,12 +28,20 @@ namespace p2c::pmon::met
         DynamicPollingFetcher{ qel, introRoot, std::move(pQuery) },
         pKeyMap_{ std::move(pKeyMap) }
     {}
-    std::wstring TypedDynamicPollingFetcher<PM_ENUM>::ReadStringValue()
+    const std::wstring& TypedDynamicPollingFetcher<PM_ENUM>::ReadStringValue()
     {
         if (auto pBlobBytes = pQuery_->GetBlobData()) {
-            return pKeyMap_->at(*reinterpret_cast<const int*>(&pBlobBytes[offset_])).wideName;
+            // only look up the key name when the value changes
+            if (const auto key = *reinterpret_cast<const int*>(&pBlobBytes[offset_]); key != lastKey_) {
+                SetText_(pKeyMap_->at(key).wideName);
+                lastKey_ = key;
+            }
         }
-        return {};
+        else {
+            SetText_(L"");
+            lastKey_.reset();
+        }
+        return text_;
     }
 
     std::optional<float> TypedDynamicPollingFetcher<PM_ENUM>::ReadValue()
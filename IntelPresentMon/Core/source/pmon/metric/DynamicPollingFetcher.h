@@ -6,9 +6,11 @@
 #include <Core/source/kernel/OverlaySpec.h>
 #include "MetricFetcher.h"
 #include "../DynamicQuery.h"
+#include <Core/source/infra/util/DebugCounter.h>
 #include <CommonUtilities//str/String.h>
 #include <concepts>
 #include <limits>
+#include <string>
 
 
 namespace p2c::pmon::met
@@ -50,21 +52,39 @@ namespace p2c::pmon::met
             }
             return {};
         }
-        std::wstring ReadStringValue() override
+        const std::wstring& ReadStringValue() override
         {
             if constexpr (std::integral<T> || std::floating_point<T>) {
                 return MetricFetcher::ReadStringValue();
             }
             else if constexpr (std::same_as<T, const char*>) {
                 if (auto pBlobBytes = pQuery_->GetBlobData()) {
-                    return ::pmon::util::str::ToWide(reinterpret_cast<const char*>(&pBlobBytes[offset_]));
+                    // string metrics rarely change, so only widen when they do
+                    const auto pString = reinterpret_cast<const char*>(&pBlobBytes[offset_]);
+                    if (lastString_ != pString) {
+                        const auto capacity = lastString_.capacity();
+                        lastString_ = pString;
+                        if (lastString_.capacity() != capacity) {
+                            infra::util::TextAllocationCounter().Tick();
+                        }
+                        // the widened temporary allocates too once it outgrows the small string buffer
+                        const auto wide = ::pmon::util::str::ToWide(lastString_);
+                        if (wide.capacity() > std::wstring{}.capacity()) {
+                            infra::util::TextAllocationCounter().Tick();
+                        }
+                        SetText_(wide);
+                    }
+                    return text_;
                 }
             }
             else {
                 p2clog.warn(L"Unknown type").commit();
             }
-            return {};
+            SetText_(L"");
+            return text_;
         }
+    private:
+        std::string lastString_;
     };
 
     template<>
@@ -73,10 +93,12 @@ namespace p2c::pmon::met
     public:
         TypedDynamicPollingFetcher(const PM_QUERY_ELEMENT& qel, const pmapi::intro::Root& introRoot,
             std::shared_ptr<DynamicQuery> pQuery, std::shared_ptr<const pmapi::EnumMap::KeyMap> pKeyMap);
-        std::wstring ReadStringValue() override;
+        const std::wstring& ReadStringValue() override;
         std::optional<float> ReadValue() override;
     private:
         std::shared_ptr<const pmapi::EnumMap::KeyMap> pKeyMap_;
+        // key whose name is currently in the text buffer
+        std::optional<int> lastKey_;
     };
 
     std::shared_ptr<DynamicPollingFetcher> MakeDynamicPollingFetcher(const PM_QUERY_ELEMENT& qel,
@@ -1,18 +1,66 @@
 // Copyright (C) 2022 Intel Corporation
 // SPDX-License-Identifier: MIT
 #include "MetricFetcher.h"
-#include <format>
+#include <Core/source/infra/util/DebugCounter.h>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
 
 namespace p2c::pmon::met
 {
+    namespace
+    {
+        // enough for any float in fixed notation
+        constexpr size_t textCapacity_ = 64;
+    }
+
+    MetricFetcher::MetricFetcher()
+    {
+        text_.reserve(textCapacity_);
+    }
+
     MetricFetcher::~MetricFetcher() = default;
-    std::wstring MetricFetcher::ReadStringValue()
+
+    const std::wstring& MetricFetcher::ReadStringValue()
+    {
+        const auto val = ReadValue();
+        if (!val) {
+            SetText_(L"NA");
+            return text_;
+        }
+        // render with to_chars into a stack buffer and widen into the fixed text buffer
+        // so that readouts sampled every frame do not allocate
+        const auto digitsBeforeDecimal = (std::isfinite(*val) && *val != 0.f) ?
+            (std::max)(int(log10(std::abs(*val))), 0) : 0;
+        const int maxFractionalDigits = 2;
+        std::array<char, textCapacity_> buffer;
+        const auto [pEnd, ec] = std::to_chars(buffer.data(), buffer.data() + buffer.size(), *val,
+            std::chars_format::fixed, (std::max)(maxFractionalDigits - digitsBeforeDecimal, 0));
+        if (ec != std::errc{}) {
+            SetText_(L"NA");
+            return text_;
+        }
+        const auto capacity = text_.capacity();
+        text_.resize(size_t(pEnd - buffer.data()));
+        std::copy(buffer.data(), pEnd, text_.begin());
+        if (text_.capacity() != capacity) {
+            infra::util::TextAllocationCounter().Tick();
+        }
+        return text_;
+    }
+
+    void MetricFetcher::SetText_(const wchar_t* pText)
     {
-        if (const auto val = ReadValue()) {
-            const auto digitsBeforeDecimal = std::max(int(log10(std::abs(*val))), 0);
-            const int maxFractionalDigits = 2;
-            return std::format(L"{:.{}f}", *val, std::max(maxFractionalDigits - digitsBeforeDecimal, 0));
+        const auto capacity = text_.capacity();
+        text_.assign(pText);
+        if (text_.capacity() != capacity) {
+            infra::util::TextAllocationCounter().Tick();
         }
-        return L"NA";
     }
-}
\ No newline at end of file
+
+    void MetricFetcher::SetText_(const std::wstring& text)
+    {
+        SetText_(text.c_str());
+    }
+}
@@ -9,14 +9,22 @@ namespace p2c::pmon::met
     class MetricFetcher
     {
     public:
-        MetricFetcher() = default;
+        MetricFetcher();
         virtual ~MetricFetcher();
-        virtual std::wstring ReadStringValue();
+        // text is rendered into a buffer owned by the fetcher, valid until the next read
+        virtual const std::wstring& ReadStringValue();
         virtual std::optional<float> ReadValue() = 0;
 
         MetricFetcher(const MetricFetcher&) = delete;
         MetricFetcher & operator=(const MetricFetcher&) = delete;
         MetricFetcher(MetricFetcher&&) = delete;
         MetricFetcher & operator=(MetricFetcher&&) = delete;
+    protected:
+        // functions
+        // assign text, counting any growth of the buffer as an allocation
+        void SetText_(const wchar_t* pText);
+        void SetText_(const std::wstring& text);
+        // data
+        std::wstring text_;
     };
-}
\ No newline at end of file
+}
@@ -6,7 +6,12 @@
 #include <boost/interprocess/sync/interprocess_sharable_mutex.hpp>
 #include <boost/interprocess/sync/interprocess_semaphore.hpp>
 #include <boost/interprocess/sync/sharable_lock.hpp>
+#include <atomic>
 #include <chrono>
+#include <format>
+#include <map>
+#include <mutex>
+#include <vector>
 #include "../../PresentMonService/GlobalIdentifiers.h"
 #include <windows.h>
 #include <sddl.h>
@@ -24,6 +29,90 @@ namespace pmon::ipc
 			static constexpr const char* introspectionRootName_ = "in-root";
 			static constexpr const char* introspectionMutexName_ = "in-mtx";
 			static constexpr const char* introspectionSemaphoreName_ = "in-sem";
+			static constexpr const char* introspectionImageInfoName_ = "in-img";
+			// bump whenever the layout of the PM_INTROSPECTION_* structures changes, so that
+			// clients built against a different layout fall back to cloning
+			static constexpr uint32_t introspectionImageFormat_ = 1;
+			// Describes the CAPI introspection structure the service builds once introspection
+			// is finalized, in a separate read-only mapping. The structure's pointers are only
+			// valid where the service mapped it, so clients must map it at the same address.
+			struct IntrospectionImageInfo_
+			{
+				// zero until an image is published; stored last, so the other fields are
+				// valid once it is seen to be nonzero
+				std::atomic<uint64_t> generation = 0;
+				uint32_t format = introspectionImageFormat_;
+				uint64_t baseAddress = 0;
+				uint64_t size = 0;
+				uint64_t rootOffset = 0;
+			};
+			static std::string MakeImageMappingName_(const std::string& segmentName, uint64_t generation)
+			{
+				return std::format("{}-in-img-{}", segmentName, generation);
+			}
+		};
+
+		// A client's read-only view of a published introspection image. Only one view can
+		// occupy the image's address, so views are shared by every comms object in the
+		// process (i.e. every session) that uses the same image.
+		class ImageView_
+		{
+		public:
+			ImageView_(const ImageView_&) = delete;
+			ImageView_& operator=(const ImageView_&) = delete;
+			~ImageView_()
+			{
+				{
+					std::lock_guard lk{ registryMutex_ };
+					if (auto i = registry_.find(mappingName_); i != registry_.end() && i->second.expired()) {
+						registry_.erase(i);
+					}
+				}
+				UnmapViewOfFile(pView_);
+				CloseHandle(hMapping_);
+			}
+			// returns empty if the image cannot be mapped at its base address in this process
+			static std::shared_ptr<ImageView_> Open(const std::string& mappingName, uint64_t baseAddress, uint64_t size, uint64_t rootOffset)
+			{
+				std::lock_guard lk{ registryMutex_ };
+				if (auto i = registry_.find(mappingName); i != registry_.end()) {
+					if (auto pView = i->second.lock()) {
+						return pView;
+					}
+				}
+				const auto hMapping = OpenFileMappingA(FILE_MAP_READ, FALSE, mappingName.c_str());
+				if (!hMapping) {
+					return {};
+				}
+				const auto pView = MapViewOfFileEx(hMapping, FILE_MAP_READ, 0, 0, (SIZE_T)size, (void*)baseAddress);
+				if (!pView) {
+					CloseHandle(hMapping);
+					return {};
+				}
+				std::shared_ptr<ImageView_> pImage{ new ImageView_{ mappingName, hMapping, pView,
+					reinterpret_cast<const PM_INTROSPECTION_ROOT*>(static_cast<const char*>(pView) + rootOffset) } };
+				registry_[mappingName] = pImage;
+				return pImage;
+			}
+			const PM_INTROSPECTION_ROOT* GetRoot() const
+			{
+				return pRoot_;
+			}
+		private:
+			ImageView_(std::string mappingName, HANDLE hMapping, void* pView, const PM_INTROSPECTION_ROOT* pRoot)
+				:
+				mappingName_{ std::move(mappingName) },
+				hMapping_{ hMapping },
+				pView_{ pView },
+				pRoot_{ pRoot }
+			{}
+			// views in use in this process by mapping name
+			static inline std::mutex registryMutex_;
+			static inline std::map<std::string, std::weak_ptr<ImageView_>> registry_;
+			std::string mappingName_;
+			HANDLE hMapping_;
+			void* pView_;
+			const PM_INTROSPECTION_ROOT* pRoot_;
 		};
 
 		class ServiceComms_ : public ServiceComms, CommsBase_
@@ -31,17 +120,27 @@ namespace pmon::ipc
 		public:
 			ServiceComms_(std::optional<std::string> sharedMemoryName)
 				:
-				shm_{ bip::create_only, sharedMemoryName.value_or(defaultSegmentName_).c_str(),
+				segmentName_{ sharedMemoryName.value_or(defaultSegmentName_) },
+				shm_{ bip::create_only, segmentName_.c_str(),
 					0x10'0000, nullptr, Permissions_{} },
 				pIntroMutex_{ ShmMakeNamedUnique<bip::interprocess_sharable_mutex>(
 					introspectionMutexName_, shm_.get_segment_manager()) },
 				pIntroSemaphore_{ ShmMakeNamedUnique<bip::interprocess_semaphore>(
 					introspectionSemaphoreName_, shm_.get_segment_manager(), 0) },
 				pRoot_{ ShmMakeNamedUnique<intro::IntrospectionRoot>(introspectionRootName_,
-					shm_.get_segment_manager(), shm_.get_segment_manager()) }
+					shm_.get_segment_manager(), shm_.get_segment_manager()) },
+				pImageInfo_{ ShmMakeNamedUnique<IntrospectionImageInfo_>(introspectionImageInfoName_,
+					shm_.get_segment_manager()) }
 			{
 				PreInitializeIntrospection_();
 			}
+			~ServiceComms_()
+			{
+				for (auto& [hMapping, pView] : images_) {
+					UnmapViewOfFile(pView);
+					CloseHandle(hMapping);
+				}
+			}
 			intro::IntrospectionRoot& GetIntrospectionRoot() override
 			{
 				return *pRoot_;
@@ -87,6 +186,10 @@ namespace pmon::ipc
 				{
 					return bip::permissions{ &secAttr_ };
 				}
+				SECURITY_ATTRIBUTES* GetAttributes()
+				{
+					return &secAttr_;
+				}
 			private:
 				SECURITY_ATTRIBUTES secAttr_{ sizeof(secAttr_) };
 			};
@@ -106,9 +209,40 @@ namespace pmon::ipc
 			{
 				// sort all ordered introspection entities in their pricipal containers
 				pRoot_->Sort();
+				PublishIntrospectionImage_();
 				// release semaphore holdoff once construction is complete
 				for (int i = 0; i < 8; i++) { pIntroSemaphore_->post(); }
 			}
+			void PublishIntrospectionImage_()
+			{
+				// the image is best-effort: if it cannot be built, clients keep cloning
+				intro::ProbeAllocator<void> probeAllocator;
+				pRoot_->ApiClone(probeAllocator);
+				const uint64_t size = probeAllocator.GetTotalSize();
+				const auto generation = pImageInfo_->generation.load() + 1;
+				Permissions_ permissions;
+				const auto hMapping = CreateFileMappingA(INVALID_HANDLE_VALUE, permissions.GetAttributes(), PAGE_READWRITE,
+					DWORD(size >> 32), DWORD(size), MakeImageMappingName_(segmentName_, generation).c_str());
+				if (!hMapping) {
+					return;
+				}
+				const auto pView = MapViewOfFile(hMapping, FILE_MAP_WRITE, 0, 0, (SIZE_T)size);
+				if (!pView) {
+					CloseHandle(hMapping);
+					return;
+				}
+				intro::BlockAllocator<void> blockAllocator{ static_cast<char*>(pView) };
+				const auto pApiRoot = pRoot_->ApiClone(blockAllocator);
+				// the image is immutable once published
+				DWORD oldProtect;
+				VirtualProtect(pView, (SIZE_T)size, PAGE_READONLY, &oldProtect);
+				// earlier images (if introspection was finalized again) stay mapped; clients may still be using them
+				images_.emplace_back(hMapping, pView);
+				pImageInfo_->baseAddress = reinterpret_cast<uint64_t>(pView);
+				pImageInfo_->size = size;
+				pImageInfo_->rootOffset = uint64_t(reinterpret_cast<const char*>(pApiRoot) - static_cast<const char*>(pView));
+				pImageInfo_->generation.store(generation, std::memory_order_release);
+			}
 			bip::scoped_lock<bip::interprocess_sharable_mutex> LockIntrospectionMutexExclusive_()
 			{
 				const auto result = shm_.find<bip::interprocess_sharable_mutex>(introspectionMutexName_);
@@ -118,10 +252,14 @@ namespace pmon::ipc
 				return bip::scoped_lock{ *result.first };
 			}
 			// data
+			std::string segmentName_;
 			ShmSegment shm_;
 			ShmUniquePtr<bip::interprocess_sharable_mutex> pIntroMutex_;
 			ShmUniquePtr<bip::interprocess_semaphore> pIntroSemaphore_;
 			ShmUniquePtr<intro::IntrospectionRoot> pRoot_;
+			ShmUniquePtr<IntrospectionImageInfo_> pImageInfo_;
+			// published introspection images: mapping handle and view
+			std::vector<std::pair<HANDLE, void*>> images_;
 			uint32_t nextDeviceIndex_ = 1;
 			bool introGpuComplete_ = false;
 			bool introCpuComplete_ = false;
@@ -132,12 +270,22 @@ namespace pmon::ipc
 		public:
 			MiddlewareComms_(std::optional<std::string> sharedMemoryName)
 				:
-				shm_{ bip::open_only, sharedMemoryName.value_or(defaultSegmentName_).c_str() }
+				segmentName_{ sharedMemoryName.value_or(defaultSegmentName_) },
+				shm_{ bip::open_only, segmentName_.c_str() }
 			{}
 			const PM_INTROSPECTION_ROOT* GetIntrospectionRoot() override
 			{
+				// use the service's published image in place when possible; this needs
+				// neither the holdoff (the image is only published once finalized) nor the lock
+				if (const auto pRoot = FindIntrospectionImage_()) {
+					return pRoot;
+				}
 				// make sure holdoff semaphore has been released
 				WaitOnIntrospectionHoldoff_();
+				// the image may have been published while we waited
+				if (const auto pRoot = FindIntrospectionImage_()) {
+					return pRoot;
+				}
 				// acquire shared lock on introspection data
 				auto sharedLock = LockIntrospectionMutexForShare_();
 				// find the introspection structure in shared memory
@@ -155,8 +303,51 @@ namespace pmon::ipc
 				// create the CAPI introspection struct on the heap, it is now the caller's responsibility to track this resource
 				return root.ApiClone(blockAllocator);
 			}
+			void FreeIntrospectionRoot(const PM_INTROSPECTION_ROOT* pRoot) override
+			{
+				{
+					std::lock_guard lk{ imageViewsMutex_ };
+					for (auto& pView : imageViews_) {
+						if (pView->GetRoot() == pRoot) {
+							// mapped images are released with this object
+							return;
+						}
+					}
+				}
+				free(const_cast<PM_INTROSPECTION_ROOT*>(pRoot));
+			}
 		private:
 			// functions
+			const PM_INTROSPECTION_ROOT* FindIntrospectionImage_()
+			{
+				std::lock_guard lk{ imageViewsMutex_ };
+				if (!pImageInfo_) {
+					pImageInfo_ = shm_.find<IntrospectionImageInfo_>(introspectionImageInfoName_).first;
+					if (!pImageInfo_) {
+						// service predates introspection images
+						return nullptr;
+					}
+				}
+				const auto generation = pImageInfo_->generation.load(std::memory_order_acquire);
+				if (generation == 0 || generation == unmappableGeneration_ || pImageInfo_->format != introspectionImageFormat_) {
+					return nullptr;
+				}
+				if (imageGeneration_ == generation) {
+					return imageViews_.back()->GetRoot();
+				}
+				auto pView = ImageView_::Open(MakeImageMappingName_(segmentName_, generation),
+					pImageInfo_->baseAddress, pImageInfo_->size, pImageInfo_->rootOffset);
+				if (!pView) {
+					// e.g. the address is taken in this process (as when the service runs in-process);
+					// don't retry for this image
+					unmappableGeneration_ = generation;
+					return nullptr;
+				}
+				// views of earlier generations are kept since their roots may still be in use
+				imageViews_.push_back(std::move(pView));
+				imageGeneration_ = generation;
+				return imageViews_.back()->GetRoot();
+			}
 			void WaitOnIntrospectionHoldoff_()
 			{
 				using namespace std::chrono_literals;
@@ -182,7 +373,13 @@ namespace pmon::ipc
 				return bip::sharable_lock{ *result.first };
 			}
 			// data
+			std::string segmentName_;
 			ShmSegment shm_;
+			std::mutex imageViewsMutex_;
+			const IntrospectionImageInfo_* pImageInfo_ = nullptr;
+			std::vector<std::shared_ptr<ImageView_>> imageViews_;
+			uint64_t imageGeneration_ = 0;
+			uint64_t unmappableGeneration_ = 0;
 		};
 	}
 
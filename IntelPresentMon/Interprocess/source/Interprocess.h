@@ -29,7 +29,10 @@ namespace pmon::ipc
 	{
 	public:
 		virtual ~MiddlewareComms() = default;
+		// returns the service's published read-only introspection image when it can be
+		// mapped in place, otherwise a heap clone; either way release with FreeIntrospectionRoot
 		virtual const PM_INTROSPECTION_ROOT* GetIntrospectionRoot() = 0;
+		virtual void FreeIntrospectionRoot(const PM_INTROSPECTION_ROOT* pRoot) = 0;
 	};
 
 	std::unique_ptr<ServiceComms> MakeServiceComms(std::optional<std::string> sharedMemoryName = {});
@@ -39,6 +39,8 @@ namespace pmon::ipc::intro
 	public:
 		using value_type = T;
 		BlockAllocator(size_t nBytes) : pBytes{ reinterpret_cast<char*>(malloc(nBytes)) } {}
+		// allocate from a block owned by the caller (which must be suitably aligned)
+		explicit BlockAllocator(char* pBlock) : pBytes{ pBlock } {}
 		BlockAllocator(const BlockAllocator<void>& other)
 			:
 			pTotalSize(other.pTotalSize),
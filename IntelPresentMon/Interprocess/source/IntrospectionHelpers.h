@@ -1,7 +1,17 @@
 #pragma once
 #include "../../PresentMonAPI2/PresentMonAPI.h"
+#include "IntrospectionDataTypeMapping.h"
 
 namespace pmon::ipc::intro
 {
-	size_t GetDataTypeSize(PM_DATA_TYPE v);
-}
\ No newline at end of file
+	template<PM_DATA_TYPE dt> struct DataTypeSizeBridger {
+		static size_t Invoke() { return DataTypeToStaticType_sz<dt>; }
+		static size_t Default() { return 0ull; }
+	};
+
+	// inline so that code outside of Interprocess (e.g. the API wrapper) can use it without linking
+	inline size_t GetDataTypeSize(PM_DATA_TYPE dt)
+	{
+		return BridgeDataType<DataTypeSizeBridger>(dt);
+	}
+}
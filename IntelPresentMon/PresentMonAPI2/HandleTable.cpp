@@ -0,0 +1,211 @@
+#include "HandleTable.h"
+#include <bit>
+#include <utility>
+
+namespace pmon::mid
+{
+	HandleTable::HandleTable()
+	{
+		chunks_[0].store(firstChunk_, std::memory_order_relaxed);
+		// allocated up front so that indexing the first introspection roots does
+		// not show up in the CRT heap checkpoints
+		objectIndex_.reserve(64);
+	}
+
+	HandleTable::~HandleTable()
+	{
+		for (uint32_t i = 1; i < maxChunks_; i++) {
+			delete[] chunks_[i].load(std::memory_order_relaxed);
+		}
+	}
+
+	HandleTable::Ref::Ref(Ref&& other) noexcept
+		:
+		pSlot_{ std::exchange(other.pSlot_, nullptr) }
+	{}
+
+	HandleTable::Ref::~Ref()
+	{
+		if (pSlot_) {
+			pSlot_->Release();
+		}
+	}
+
+	Middleware& HandleTable::Ref::GetMiddleware() const
+	{
+		return *pSlot_->pMiddleware;
+	}
+
+	const std::shared_ptr<Middleware>& HandleTable::Ref::GetMiddlewarePtr() const
+	{
+		return pSlot_->pMiddleware;
+	}
+
+	const void* HandleTable::Ref::GetObject_() const
+	{
+		return pSlot_->pObject;
+	}
+
+	bool HandleTable::Slot::Acquire(uint32_t generation, Kind kind_)
+	{
+		auto s = state.load(std::memory_order_acquire);
+		do {
+			if (uint32_t(s >> 32) != generation || !(s & liveBit_)) {
+				return false;
+			}
+		} while (!state.compare_exchange_weak(s, s + 1, std::memory_order_acquire, std::memory_order_relaxed));
+		// the entry cannot change while we hold a reference, so it is safe to check now
+		if (kind != kind_) {
+			Release();
+			return false;
+		}
+		return true;
+	}
+
+	void HandleTable::Slot::Release()
+	{
+		const auto s = state.fetch_sub(1, std::memory_order_release) - 1;
+		// once the live bit is cleared a Remove() may be waiting for the last reference
+		if (!(s & liveBit_) && !(s & refMask_)) {
+			state.notify_all();
+		}
+	}
+
+	const void* HandleTable::MakeHandle_(uint32_t index, uint32_t generation)
+	{
+		// index is biased by one so that no handle is null
+		return reinterpret_cast<const void*>((uint64_t(generation) << 32) | (uint64_t(index) + 1));
+	}
+
+	HandleTable::Slot* HandleTable::GetSlot_(uint32_t index) const
+	{
+		if (index >= capacity_) {
+			return nullptr;
+		}
+		// offsetting by the first chunk's size makes the chunk the position of the
+		// highest set bit
+		const auto biased = index + firstChunkSize_;
+		const auto chunk = uint32_t(std::bit_width(biased)) - 1 - firstChunkBits_;
+		const auto pChunk = chunks_[chunk].load(std::memory_order_acquire);
+		if (!pChunk) {
+			return nullptr;
+		}
+		return &pChunk[biased - (firstChunkSize_ << chunk)];
+	}
+
+	HandleTable::Slot* HandleTable::DecodeHandle_(const void* handle, uint32_t* pIndex, uint32_t* pGeneration) const
+	{
+		const auto value = reinterpret_cast<uint64_t>(handle);
+		*pIndex = uint32_t(value) - 1;
+		*pGeneration = uint32_t(value >> 32);
+		return GetSlot_(*pIndex);
+	}
+
+	const void* HandleTable::Add(Kind kind, std::shared_ptr<Middleware> pMiddleware, const void* pObject)
+	{
+		std::lock_guard lk{ mutex_ };
+		uint32_t index;
+		if (freeHead_ != noSlot_) {
+			index = freeHead_;
+			freeHead_ = GetSlot_(index)->nextFree;
+		}
+		else if (used_ < capacity_) {
+			index = used_;
+			// the first slot of a chunk is at the index equal to the size of all chunks before it
+			const auto chunk = uint32_t(std::bit_width(index + firstChunkSize_)) - 1 - firstChunkBits_;
+			if (!chunks_[chunk].load(std::memory_order_relaxed)) {
+				// published before any handle into it is, so Find() never sees it half built
+				chunks_[chunk].store(new Slot[firstChunkSize_ << chunk], std::memory_order_release);
+			}
+			used_++;
+		}
+		else {
+			return nullptr;
+		}
+		if (IsIndexed_(kind)) {
+			objectIndex_[pObject] = index;
+		}
+		auto& slot = *GetSlot_(index);
+		slot.kind = kind;
+		slot.pMiddleware = std::move(pMiddleware);
+		slot.pObject = pObject;
+		slot.nextFree = noSlot_;
+		// generation 0 is never issued, so a zeroed handle can never match
+		auto generation = uint32_t(slot.state.load(std::memory_order_relaxed) >> 32) + 1;
+		if (generation == 0) {
+			generation = 1;
+		}
+		// publish the entry; Find() acquires this store before reading the entry
+		slot.state.store((uint64_t(generation) << 32) | liveBit_, std::memory_order_release);
+		return MakeHandle_(index, generation);
+	}
+
+	HandleTable::Ref HandleTable::Find(const void* handle, Kind kind)
+	{
+		uint32_t index;
+		uint32_t generation;
+		if (auto pSlot = DecodeHandle_(handle, &index, &generation); pSlot && pSlot->Acquire(generation, kind)) {
+			return Ref{ pSlot };
+		}
+		return {};
+	}
+
+	const void* HandleTable::FindHandle(Kind kind, const void* pObject) const
+	{
+		if (!IsIndexed_(kind)) {
+			return nullptr;
+		}
+		std::lock_guard lk{ mutex_ };
+		const auto i = objectIndex_.find(pObject);
+		if (i == objectIndex_.end()) {
+			return nullptr;
+		}
+		const auto& slot = *GetSlot_(i->second);
+		const auto s = slot.state.load(std::memory_order_acquire);
+		if (!(s & liveBit_) || slot.kind != kind) {
+			return nullptr;
+		}
+		return MakeHandle_(i->second, uint32_t(s >> 32));
+	}
+
+	bool HandleTable::Remove(const void* handle, Kind kind, std::shared_ptr<Middleware>* ppMiddleware, const void** ppObject)
+	{
+		uint32_t index;
+		uint32_t generation;
+		const auto pSlot = DecodeHandle_(handle, &index, &generation);
+		if (!pSlot || !pSlot->Acquire(generation, kind)) {
+			return false;
+		}
+		// clear the live bit so that no new references can be taken; if another
+		// thread is removing the same handle concurrently, only one of us wins
+		auto s = pSlot->state.load(std::memory_order_relaxed);
+		do {
+			if (!(s & liveBit_)) {
+				pSlot->Release();
+				return false;
+			}
+		} while (!pSlot->state.compare_exchange_weak(s, s & ~liveBit_, std::memory_order_acq_rel, std::memory_order_relaxed));
+		pSlot->Release();
+		// block until calls that are still using the handle return; the last one
+		// to release its reference wakes us
+		for (auto s = pSlot->state.load(std::memory_order_acquire); s & refMask_;
+			s = pSlot->state.load(std::memory_order_acquire)) {
+			pSlot->state.wait(s, std::memory_order_acquire);
+		}
+		std::lock_guard lk{ mutex_ };
+		if (IsIndexed_(pSlot->kind)) {
+			objectIndex_.erase(pSlot->pObject);
+		}
+		if (ppMiddleware) {
+			*ppMiddleware = std::move(pSlot->pMiddleware);
+		}
+		if (ppObject) {
+			*ppObject = pSlot->pObject;
+		}
+		pSlot->pMiddleware.reset();
+		pSlot->pObject = nullptr;
+		pSlot->nextFree = freeHead_;
+		freeHead_ = index;
+		return true;
+	}
+}
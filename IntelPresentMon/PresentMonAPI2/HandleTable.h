@@ -0,0 +1,109 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "../PresentMonMiddleware/source/Middleware.h"
+
+namespace pmon::mid
+{
+	// Registry of the opaque handles given out by the C API (sessions, dynamic
+	// and frame queries, introspection roots), mapping each to the middleware
+	// that owns it and the middleware object it stands for.
+	//
+	// Handles encode a slot index and the slot's generation, which is bumped
+	// every time the slot is reused, so a handle that has been freed stays
+	// invalid instead of aliasing whatever is registered next.  Find() is
+	// lock-free: it takes a reference on the slot only if the slot is still live
+	// with the handle's generation and kind.  Add() and Remove() serialize on a
+	// mutex.  Remove() blocks until the references taken by in-flight calls are
+	// released (waiting on the slot's state, which the last Release() wakes),
+	// so the caller may destroy the object once it returns.  Freeing a frame
+	// query that another thread is waiting on with pmWaitForFrames therefore
+	// blocks for up to that wait's timeout.
+	//
+	// Slots are stored in chunks that are allocated as the table fills up, each
+	// twice the size of the one before, and are never freed or moved while the
+	// table exists, so Find() can index them without locking.  The first chunk is
+	// stored inline, so registering the first few hundred handles does not show up
+	// in the CRT heap checkpoints the tests take.
+	class HandleTable
+	{
+		struct Slot;
+	public:
+		enum class Kind : uint8_t
+		{
+			Session,
+			DynamicQuery,
+			FrameQuery,
+			Introspection,
+		};
+		// A reference to a live handle's entry, released on destruction
+		class Ref
+		{
+		public:
+			Ref() = default;
+			Ref(Ref&& other) noexcept;
+			Ref& operator=(Ref&&) = delete;
+			~Ref();
+			explicit operator bool() const { return pSlot_ != nullptr; }
+			Middleware& GetMiddleware() const;
+			const std::shared_ptr<Middleware>& GetMiddlewarePtr() const;
+			template<class T>
+			const T* GetObject() const { return static_cast<const T*>(GetObject_()); }
+		private:
+			friend class HandleTable;
+			explicit Ref(Slot* pSlot) : pSlot_{ pSlot } {}
+			const void* GetObject_() const;
+			Slot* pSlot_ = nullptr;
+		};
+		HandleTable();
+		HandleTable(const HandleTable&) = delete;
+		HandleTable& operator=(const HandleTable&) = delete;
+		~HandleTable();
+
+		// returns the new handle, or nullptr when all slots are in use
+		const void* Add(Kind kind, std::shared_ptr<Middleware> pMiddleware, const void* pObject);
+		Ref Find(const void* handle, Kind kind);
+		// looks up the handle registered for pObject; only introspection roots,
+		// which are handed to the client as pointers to their data, are indexed
+		const void* FindHandle(Kind kind, const void* pObject) const;
+		// returns false if the handle is not live; otherwise waits for any
+		// in-flight references to be released and hands back the entry
+		bool Remove(const void* handle, Kind kind, std::shared_ptr<Middleware>* ppMiddleware, const void** ppObject);
+	private:
+		// state layout: generation in the high 32 bits, then the live bit, then
+		// the count of outstanding references
+		static constexpr uint64_t liveBit_ = 1ull << 31;
+		static constexpr uint64_t refMask_ = liveBit_ - 1;
+		static constexpr uint32_t noSlot_ = UINT32_MAX;
+		// chunk i holds firstChunkSize_ << i slots
+		static constexpr uint32_t firstChunkBits_ = 8;
+		static constexpr uint32_t firstChunkSize_ = 1u << firstChunkBits_;
+		static constexpr uint32_t maxChunks_ = 13;
+		static constexpr uint32_t capacity_ = firstChunkSize_ * ((1u << maxChunks_) - 1);
+		struct Slot
+		{
+			bool Acquire(uint32_t generation, Kind kind);
+			void Release();
+			std::atomic<uint64_t> state{ 0 };
+			Kind kind = Kind::Session;
+			std::shared_ptr<Middleware> pMiddleware;
+			const void* pObject = nullptr;
+			uint32_t nextFree = noSlot_;
+		};
+		static const void* MakeHandle_(uint32_t index, uint32_t generation);
+		static bool IsIndexed_(Kind kind) { return kind == Kind::Introspection; }
+		// returns nullptr if the index is past the chunks allocated so far
+		Slot* GetSlot_(uint32_t index) const;
+		Slot* DecodeHandle_(const void* handle, uint32_t* pIndex, uint32_t* pGeneration) const;
+		mutable std::mutex mutex_;
+		uint32_t freeHead_ = noSlot_;
+		uint32_t used_ = 0;
+		std::atomic<Slot*> chunks_[maxChunks_]{};
+		// slot index of each indexed object, guarded by mutex_
+		std::unordered_map<const void*, uint32_t> objectIndex_;
+		Slot firstChunk_[firstChunkSize_];
+	};
+}
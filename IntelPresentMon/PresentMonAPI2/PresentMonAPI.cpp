@@ -1,9 +1,11 @@
 #include <memory>
 #include <crtdbg.h>
-#include <unordered_map>
+#include <algorithm>
+#include <cmath>
 #include "../PresentMonMiddleware/source/MockMiddleware.h"
 #include "../PresentMonMiddleware/source/ConcreteMiddleware.h"
 #include "../PresentMonMiddleware/source/Exception.h"
+#include "HandleTable.h"
 #include "Internal.h"
 #include "PresentMonAPI.h"
 
@@ -15,43 +17,54 @@ bool useMockedMiddleware_ = false;
 bool useCrtHeapDebug_ = false;
 bool useLocalShmServer_ = false;
 // map handles (session, query, introspection) to middleware instances
-std::unordered_map<const void*, std::shared_ptr<Middleware>> handleMap_;
+// entries are looked up without locking, so endpoints can be called concurrently
+HandleTable handleTable_;
+using Kind = HandleTable::Kind;
 
 
 // private implementation functions
-Middleware& LookupMiddleware_(const void* handle)
+HandleTable::Ref LookupHandle_(const void* handle, Kind kind)
 {
-	try {
-		return *handleMap_.at(handle);
-	}
-	catch (...) {
+	auto ref = handleTable_.Find(handle, kind);
+	if (!ref) {
 		throw Exception{ PM_STATUS_SESSION_NOT_OPEN };
 	}
+	return ref;
+}
+
+Middleware& LookupMiddleware_(const HandleTable::Ref& ref)
+{
+	return ref.GetMiddleware();
 }
 
 void DestroyMiddleware_(PM_SESSION_HANDLE handle)
 {
-	try {
-		if (!handleMap_.erase(handle)) {
-			throw Exception{ PM_STATUS_SESSION_NOT_OPEN };
-		}
-	}
-	catch (...) {
+	// middleware is destroyed when the last handle depending on it is removed
+	if (!handleTable_.Remove(handle, Kind::Session, nullptr, nullptr)) {
 		throw Exception{ PM_STATUS_FAILURE };
 	}
 }
 
-void AddHandleMapping_(PM_SESSION_HANDLE sessionHandle, const void* dependentHandle)
+const void* AddHandleMapping_(const HandleTable::Ref& sessionRef, Kind kind, const void* pObject)
 {
-	handleMap_[dependentHandle] = handleMap_[sessionHandle];
+	const auto handle = handleTable_.Add(kind, sessionRef.GetMiddlewarePtr(), pObject);
+	if (!handle) {
+		// TODO: add error code to indicate handle exhaustion
+		throw Exception{ PM_STATUS_FAILURE };
+	}
+	return handle;
 }
 
-void RemoveHandleMapping_(const void* dependentHandle)
+// removes the mapping for a dependent handle (query, introspection), returning
+// the middleware it belonged to and the middleware object it referred to
+std::shared_ptr<Middleware> RemoveHandleMapping_(const void* dependentHandle, Kind kind, const void** ppObject)
 {
-	if (!handleMap_.erase(dependentHandle)) {
+	std::shared_ptr<Middleware> pMiddleware;
+	if (!handleTable_.Remove(dependentHandle, kind, &pMiddleware, ppObject)) {
 		// TODO: add error code to indicate a bad / missing handle (other than session handle)
 		throw Exception{ PM_STATUS_FAILURE };
 	}
+	return pMiddleware;
 }
 
 // private endpoints
@@ -78,7 +91,7 @@ PRESENTMON_API2_EXPORT _CrtMemState pmCreateHeapCheckpoint_()
 PRESENTMON_API2_EXPORT PM_STATUS pmMiddlewareSpeak_(PM_SESSION_HANDLE handle, char* buffer)
 {
 	try {
-		LookupMiddleware_(handle).Speak(buffer);
+		LookupMiddleware_(LookupHandle_(handle, Kind::Session)).Speak(buffer);
 		return PM_STATUS_SUCCESS;
 	}
 	catch (const Exception& e) {
@@ -92,8 +105,8 @@ PRESENTMON_API2_EXPORT PM_STATUS pmMiddlewareSpeak_(PM_SESSION_HANDLE handle, ch
 PRESENTMON_API2_EXPORT PM_STATUS pmMiddlewareAdvanceTime_(PM_SESSION_HANDLE handle, uint32_t milliseconds)
 {
 	try {
-		Middleware& mid = LookupMiddleware_(handle);
-		dynamic_cast<MockMiddleware&>(mid).AdvanceTime(milliseconds);
+		const auto ref = LookupHandle_(handle, Kind::Session);
+		dynamic_cast<MockMiddleware&>(LookupMiddleware_(ref)).AdvanceTime(milliseconds);
 		return PM_STATUS_SUCCESS;
 	}
 	catch (const Exception& e) {
@@ -126,8 +139,13 @@ PRESENTMON_API2_EXPORT PM_STATUS pmOpenSession_(PM_SESSION_HANDLE* pHandle, cons
 			}
 			pMiddleware = std::make_shared<ConcreteMiddleware>(std::move(pipeName), std::move(introNsm));
 		}
-		*pHandle = pMiddleware.get();
-		handleMap_[*pHandle] = std::move(pMiddleware);
+		const auto pObject = pMiddleware.get();
+		const auto handle = handleTable_.Add(Kind::Session, std::move(pMiddleware), pObject);
+		if (!handle) {
+			// TODO: add error code to indicate handle exhaustion
+			return PM_STATUS_FAILURE;
+		}
+		*pHandle = (PM_SESSION_HANDLE)handle;
 		return PM_STATUS_SUCCESS;
 	}
 	catch (const Exception& e) {
@@ -163,7 +181,33 @@ PRESENTMON_API2_EXPORT PM_STATUS pmStartTrackingProcess(PM_SESSION_HANDLE handle
 	try {
 		// TODO: consider tracking resource usage for process tracking to validate Start/Stop pairing
 		// TODO: middleware should not return status codes
-		return LookupMiddleware_(handle).StartStreaming(processId);
+		return LookupMiddleware_(LookupHandle_(handle, Kind::Session)).StartStreaming(processId, 0);
+	}
+	catch (const Exception& e) {
+		return e.GetErrorCode();
+	}
+	catch (...) {
+		return PM_STATUS_FAILURE;
+	}
+}
+
+PRESENTMON_API2_EXPORT PM_STATUS pmStartTrackingProcessWithCapacity(PM_SESSION_HANDLE handle, uint32_t processId, const PM_STREAM_CAPACITY* pCapacity)
+{
+	try {
+		if (!pCapacity) {
+			// TODO: error code to signal bad argument
+			return PM_STATUS_FAILURE;
+		}
+		uint32_t capacityFrames = pCapacity->frames;
+		if (capacityFrames == 0) {
+			const double frames = std::ceil(pCapacity->seconds * pCapacity->expectedFps);
+			if (!(frames >= 1.)) {
+				return PM_STATUS_OUT_OF_RANGE;
+			}
+			// service clamps to its own limits, just keep the request representable
+			capacityFrames = (uint32_t)(std::min)(frames, (double)UINT32_MAX);
+		}
+		return LookupMiddleware_(LookupHandle_(handle, Kind::Session)).StartStreaming(processId, capacityFrames);
 	}
 	catch (const Exception& e) {
 		return e.GetErrorCode();
@@ -178,7 +222,7 @@ PRESENTMON_API2_EXPORT PM_STATUS pmStopTrackingProcess(PM_SESSION_HANDLE handle,
 	try {
 		// TODO: consider tracking resource usage for process tracking to validate Start/Stop pairing
 		// TODO: middleware should not return status codes
-		return LookupMiddleware_(handle).StopStreaming(processId);
+		return LookupMiddleware_(LookupHandle_(handle, Kind::Session)).StopStreaming(processId);
 	}
 	catch (const Exception& e) {
 		return e.GetErrorCode();
@@ -195,8 +239,16 @@ PRESENTMON_API2_EXPORT PM_STATUS pmGetIntrospectionRoot(PM_SESSION_HANDLE handle
 			// TODO: error code to signal bad argument
 			return PM_STATUS_FAILURE;
 		}
-		const auto pIntro = LookupMiddleware_(handle).GetIntrospectionData();
-		AddHandleMapping_(handle, pIntro);
+		const auto ref = LookupHandle_(handle, Kind::Session);
+		const auto pIntro = LookupMiddleware_(ref).GetIntrospectionData();
+		try {
+			AddHandleMapping_(ref, Kind::Introspection, pIntro);
+		}
+		catch (...) {
+			LookupMiddleware_(ref).FreeIntrospectionData(pIntro);
+			throw;
+		}
+		// the root is handed out directly since clients read through it
 		*ppInterface = pIntro;
 		return PM_STATUS_SUCCESS;
 	}
@@ -214,9 +266,9 @@ PRESENTMON_API2_EXPORT PM_STATUS pmFreeIntrospectionRoot(const PM_INTROSPECTION_
 		if (!pInterface) {
 			return PM_STATUS_SUCCESS;
 		}
-		auto& mid = LookupMiddleware_(pInterface);
-		RemoveHandleMapping_(pInterface);
-		mid.FreeIntrospectionData(pInterface);
+		const auto pMiddleware = RemoveHandleMapping_(
+			handleTable_.FindHandle(Kind::Introspection, pInterface), Kind::Introspection, nullptr);
+		pMiddleware->FreeIntrospectionData(pInterface);
 		return PM_STATUS_SUCCESS;
 	}
 	catch (const Exception& e) {
@@ -230,7 +282,43 @@ PRESENTMON_API2_EXPORT PM_STATUS pmFreeIntrospectionRoot(const PM_INTROSPECTION_
 PRESENTMON_API2_EXPORT PM_STATUS pmSetTelemetryPollingPeriod(PM_SESSION_HANDLE handle, uint32_t deviceId, uint32_t timeMs)
 {
 	try {
-		LookupMiddleware_(handle).SetTelemetryPollingPeriod(deviceId, timeMs);
+		LookupMiddleware_(LookupHandle_(handle, Kind::Session)).SetTelemetryPollingPeriod(deviceId, timeMs);
+		return PM_STATUS_SUCCESS;
+	}
+	catch (const Exception& e) {
+		return e.GetErrorCode();
+	}
+	catch (...) {
+		return PM_STATUS_FAILURE;
+	}
+}
+
+PRESENTMON_API2_EXPORT PM_STATUS pmGetStreamFrameCount(PM_SESSION_HANDLE handle, uint32_t processId, uint64_t* pFrameCount)
+{
+	try {
+		if (!pFrameCount) {
+			// TODO: error code for bad args
+			return PM_STATUS_FAILURE;
+		}
+		*pFrameCount = LookupMiddleware_(LookupHandle_(handle, Kind::Session)).GetStreamFrameCount(processId);
+		return PM_STATUS_SUCCESS;
+	}
+	catch (const Exception& e) {
+		return e.GetErrorCode();
+	}
+	catch (...) {
+		return PM_STATUS_FAILURE;
+	}
+}
+
+PRESENTMON_API2_EXPORT PM_STATUS pmGetStreamFramesLost(PM_SESSION_HANDLE handle, uint32_t processId, uint64_t* pFramesLost)
+{
+	try {
+		if (!pFramesLost) {
+			// TODO: error code for bad args
+			return PM_STATUS_FAILURE;
+		}
+		*pFramesLost = LookupMiddleware_(LookupHandle_(handle, Kind::Session)).GetStreamFramesLost(processId);
 		return PM_STATUS_SUCCESS;
 	}
 	catch (const Exception& e) {
@@ -249,10 +337,44 @@ PRESENTMON_API2_EXPORT PM_STATUS pmRegisterDynamicQuery(PM_SESSION_HANDLE sessio
 			// TODO: error code for bad args
 			return PM_STATUS_FAILURE;
 		}
-		const auto queryHandle = LookupMiddleware_(sessionHandle).RegisterDynamicQuery(
+		const auto ref = LookupHandle_(sessionHandle, Kind::Session);
+		const auto pQuery = LookupMiddleware_(ref).RegisterDynamicQuery(
 			{pElements, numElements}, windowSizeMs, metricOffsetMs);
-		AddHandleMapping_(sessionHandle, queryHandle);
-		*pQueryHandle = queryHandle;
+		try {
+			*pQueryHandle = (PM_DYNAMIC_QUERY_HANDLE)AddHandleMapping_(ref, Kind::DynamicQuery, pQuery);
+		}
+		catch (...) {
+			LookupMiddleware_(ref).FreeDynamicQuery(pQuery);
+			throw;
+		}
+		return PM_STATUS_SUCCESS;
+	}
+	catch (const Exception& e) {
+		return e.GetErrorCode();
+	}
+	catch (...) {
+		return PM_STATUS_FAILURE;
+	}
+}
+
+PRESENTMON_API2_EXPORT PM_STATUS pmRegisterDynamicQueryMultiWindow(PM_SESSION_HANDLE sessionHandle, PM_DYNAMIC_QUERY_HANDLE* pQueryHandle,
+	PM_QUERY_ELEMENT* pElements, uint64_t numElements, const double* pWindowSizesMs, double metricOffsetMs)
+{
+	try {
+		if (!pElements || !numElements || !pWindowSizesMs) {
+			// TODO: error code for bad args
+			return PM_STATUS_FAILURE;
+		}
+		const auto ref = LookupHandle_(sessionHandle, Kind::Session);
+		const auto pQuery = LookupMiddleware_(ref).RegisterDynamicQueryMultiWindow(
+			{pElements, numElements}, {pWindowSizesMs, numElements}, metricOffsetMs);
+		try {
+			*pQueryHandle = (PM_DYNAMIC_QUERY_HANDLE)AddHandleMapping_(ref, Kind::DynamicQuery, pQuery);
+		}
+		catch (...) {
+			LookupMiddleware_(ref).FreeDynamicQuery(pQuery);
+			throw;
+		}
 		return PM_STATUS_SUCCESS;
 	}
 	catch (const Exception& e) {
@@ -269,9 +391,9 @@ PRESENTMON_API2_EXPORT PM_STATUS pmFreeDynamicQuery(PM_DYNAMIC_QUERY_HANDLE hand
 		if (!handle) {
 			return PM_STATUS_SUCCESS;
 		}
-		auto& mid = LookupMiddleware_(handle);
-		RemoveHandleMapping_(handle);
-		mid.FreeDynamicQuery(handle);
+		const void* pQuery = nullptr;
+		const auto pMiddleware = RemoveHandleMapping_(handle, Kind::DynamicQuery, &pQuery);
+		pMiddleware->FreeDynamicQuery(static_cast<const PM_DYNAMIC_QUERY*>(pQuery));
 		return PM_STATUS_SUCCESS;
 	}
 	catch (const Exception& e) {
@@ -289,7 +411,27 @@ PRESENTMON_API2_EXPORT PM_STATUS pmPollDynamicQuery(PM_DYNAMIC_QUERY_HANDLE hand
 			// TODO: error code for bad args
 			return PM_STATUS_FAILURE;
 		}
-		LookupMiddleware_(handle).PollDynamicQuery(handle, processId, pBlob, numSwapChains);
+		const auto ref = LookupHandle_(handle, Kind::DynamicQuery);
+		LookupMiddleware_(ref).PollDynamicQuery(ref.GetObject<PM_DYNAMIC_QUERY>(), processId, pBlob, numSwapChains);
+		return PM_STATUS_SUCCESS;
+	}
+	catch (const Exception& e) {
+		return e.GetErrorCode();
+	}
+	catch (...) {
+		return PM_STATUS_FAILURE;
+	}
+}
+
+PRESENTMON_API2_EXPORT PM_STATUS pmPollDynamicQueryRange(PM_DYNAMIC_QUERY_HANDLE handle, uint32_t processId, double sampleIntervalMs, uint8_t* pBlobs, uint32_t* pNumSamples)
+{
+	try {
+		if (!pBlobs || !pNumSamples || !(sampleIntervalMs >= 0.)) {
+			// TODO: error code for bad args
+			return PM_STATUS_FAILURE;
+		}
+		const auto ref = LookupHandle_(handle, Kind::DynamicQuery);
+		LookupMiddleware_(ref).PollDynamicQueryRange(ref.GetObject<PM_DYNAMIC_QUERY>(), processId, sampleIntervalMs, pBlobs, *pNumSamples);
 		return PM_STATUS_SUCCESS;
 	}
 	catch (const Exception& e) {
@@ -307,7 +449,7 @@ PRESENTMON_API2_EXPORT PM_STATUS pmPollStaticQuery(PM_SESSION_HANDLE sessionHand
 			// TODO: error code for bad args
 			return PM_STATUS_FAILURE;
 		}
-		LookupMiddleware_(sessionHandle).PollStaticQuery(*pElement, processId, pBlob);
+		LookupMiddleware_(LookupHandle_(sessionHandle, Kind::Session)).PollStaticQuery(*pElement, processId, pBlob);
 		return PM_STATUS_SUCCESS;
 	}
 	catch (const Exception& e) {
@@ -325,9 +467,15 @@ PRESENTMON_API2_EXPORT PM_STATUS pmRegisterFrameQuery(PM_SESSION_HANDLE sessionH
 			// TODO: error code for bad args
 			return PM_STATUS_FAILURE;
 		}
-		const auto queryHandle = LookupMiddleware_(sessionHandle).RegisterFrameEventQuery({ pElements, numElements }, *pBlobSize);
-		AddHandleMapping_(sessionHandle, queryHandle);
-		*pQueryHandle = queryHandle;
+		const auto ref = LookupHandle_(sessionHandle, Kind::Session);
+		const auto pQuery = LookupMiddleware_(ref).RegisterFrameEventQuery({ pElements, numElements }, *pBlobSize);
+		try {
+			*pQueryHandle = (PM_FRAME_QUERY_HANDLE)AddHandleMapping_(ref, Kind::FrameQuery, pQuery);
+		}
+		catch (...) {
+			LookupMiddleware_(ref).FreeFrameEventQuery(pQuery);
+			throw;
+		}
 		return PM_STATUS_SUCCESS;
 	}
 	catch (const Exception& e) {
@@ -345,7 +493,48 @@ PRESENTMON_API2_EXPORT PM_STATUS pmConsumeFrames(PM_FRAME_QUERY_HANDLE handle, u
 			// TODO: error code for bad args
 			return PM_STATUS_FAILURE;
 		}
-		LookupMiddleware_(handle).ConsumeFrameEvents(handle, processId, pBlob, *pNumFramesToRead);
+		const auto ref = LookupHandle_(handle, Kind::FrameQuery);
+		LookupMiddleware_(ref).ConsumeFrameEvents(ref.GetObject<PM_FRAME_QUERY>(), processId, pBlob, *pNumFramesToRead);
+		return PM_STATUS_SUCCESS;
+	}
+	catch (const Exception& e) {
+		return e.GetErrorCode();
+	}
+	catch (...) {
+		return PM_STATUS_FAILURE;
+	}
+}
+
+PRESENTMON_API2_EXPORT PM_STATUS pmConsumeFramesMultiProcess(PM_FRAME_QUERY_HANDLE handle, const uint32_t* pProcessIds, uint32_t numProcessIds, PM_CONSUME_ORDER order, uint8_t* pBlobs, uint32_t* pBlobProcessIds, uint32_t* pNumFramesToRead)
+{
+	try {
+		if (!handle || !pBlobs || !pBlobProcessIds || !pNumFramesToRead || (numProcessIds && !pProcessIds)) {
+			// TODO: error code for bad args
+			return PM_STATUS_FAILURE;
+		}
+		const auto ref = LookupHandle_(handle, Kind::FrameQuery);
+		LookupMiddleware_(ref).ConsumeFrameEventsMulti(ref.GetObject<PM_FRAME_QUERY>(),
+			std::span{ pProcessIds, numProcessIds }, order == PM_CONSUME_ORDER_BY_QPC,
+			pBlobs, pBlobProcessIds, *pNumFramesToRead);
+		return PM_STATUS_SUCCESS;
+	}
+	catch (const Exception& e) {
+		return e.GetErrorCode();
+	}
+	catch (...) {
+		return PM_STATUS_FAILURE;
+	}
+}
+
+PRESENTMON_API2_EXPORT PM_STATUS pmWaitForFrames(PM_FRAME_QUERY_HANDLE handle, uint32_t processId, uint32_t minFrames, uint32_t timeoutMs, uint32_t* pNumFramesAvailable)
+{
+	try {
+		if (!handle || !pNumFramesAvailable) {
+			// TODO: error code for bad args
+			return PM_STATUS_FAILURE;
+		}
+		const auto ref = LookupHandle_(handle, Kind::FrameQuery);
+		LookupMiddleware_(ref).WaitForFrames(ref.GetObject<PM_FRAME_QUERY>(), processId, minFrames, timeoutMs, *pNumFramesAvailable);
 		return PM_STATUS_SUCCESS;
 	}
 	catch (const Exception& e) {
@@ -359,9 +548,9 @@ PRESENTMON_API2_EXPORT PM_STATUS pmConsumeFrames(PM_FRAME_QUERY_HANDLE handle, u
 PRESENTMON_API2_EXPORT PM_STATUS pmFreeFrameQuery(PM_FRAME_QUERY_HANDLE handle)
 {
 	try {
-		auto& mid = LookupMiddleware_(handle);
-		RemoveHandleMapping_(handle);
-		mid.FreeFrameEventQuery(handle);
+		const void* pQuery = nullptr;
+		const auto pMiddleware = RemoveHandleMapping_(handle, Kind::FrameQuery, &pQuery);
+		pMiddleware->FreeFrameEventQuery(static_cast<const PM_FRAME_QUERY*>(pQuery));
 		return PM_STATUS_SUCCESS;
 	}
 	catch (const Exception& e) {
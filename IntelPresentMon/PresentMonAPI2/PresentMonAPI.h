@@ -335,6 +335,28 @@ extern "C" {
 		uint64_t dataSize;
 	};
 
+	// order of the frames written by pmConsumeFramesMultiProcess
+	enum PM_CONSUME_ORDER
+	{
+		PM_CONSUME_ORDER_BY_PROCESS, // each process's frames in turn, by ascending process id
+		PM_CONSUME_ORDER_BY_QPC, // frames of all processes merged by present start time
+	};
+
+	// requested size of the frame ring the service keeps for a tracked process
+	// frames takes precedence when nonzero, otherwise the ring is sized to hold
+	// seconds worth of frames at expectedFps; the service clamps the result to its limits
+	struct PM_STREAM_CAPACITY
+	{
+		uint32_t frames;
+		double seconds;
+		double expectedFps;
+	};
+
+	// handles are opaque and may be used from any thread concurrently
+	// polls of different dynamic queries, or of one query for different processes, run in parallel;
+	// polls of one query for the same process, and consumes of one frame query, are serialized
+	// freeing a handle waits for calls already using it to return, after which the handle is
+	// rejected with an error (freed handles are not reused)
 	typedef struct PM_DYNAMIC_QUERY* PM_DYNAMIC_QUERY_HANDLE;
 	typedef struct PM_FRAME_QUERY* PM_FRAME_QUERY_HANDLE;
 	typedef struct PM_SESSION* PM_SESSION_HANDLE;
@@ -342,16 +364,42 @@ extern "C" {
 	PRESENTMON_API2_EXPORT PM_STATUS pmOpenSession(PM_SESSION_HANDLE* pHandle);
 	PRESENTMON_API2_EXPORT PM_STATUS pmCloseSession(PM_SESSION_HANDLE handle);
 	PRESENTMON_API2_EXPORT PM_STATUS pmStartTrackingProcess(PM_SESSION_HANDLE handle, uint32_t process_id);
+	PRESENTMON_API2_EXPORT PM_STATUS pmStartTrackingProcessWithCapacity(PM_SESSION_HANDLE handle, uint32_t process_id, const PM_STREAM_CAPACITY* pCapacity);
 	PRESENTMON_API2_EXPORT PM_STATUS pmStopTrackingProcess(PM_SESSION_HANDLE handle, uint32_t process_id);
 	PRESENTMON_API2_EXPORT PM_STATUS pmGetIntrospectionRoot(PM_SESSION_HANDLE handle, const PM_INTROSPECTION_ROOT** ppRoot);
 	PRESENTMON_API2_EXPORT PM_STATUS pmFreeIntrospectionRoot(const PM_INTROSPECTION_ROOT* pRoot);
 	PRESENTMON_API2_EXPORT PM_STATUS pmSetTelemetryPollingPeriod(PM_SESSION_HANDLE handle, uint32_t deviceId, uint32_t timeMs);
+	// get the running count of frames the service has written for a tracked process (telemetry is delivered with
+	// frames); cheap enough to call every tick to check whether there is anything new before polling
+	PRESENTMON_API2_EXPORT PM_STATUS pmGetStreamFrameCount(PM_SESSION_HANDLE handle, uint32_t processId, uint64_t* pFrameCount);
+	// get the running count of frames this session missed for a tracked process because the stream ring was
+	// overwritten before they were consumed; consume more often or track with a larger capacity if it grows
+	PRESENTMON_API2_EXPORT PM_STATUS pmGetStreamFramesLost(PM_SESSION_HANDLE handle, uint32_t processId, uint64_t* pFramesLost);
 	PRESENTMON_API2_EXPORT PM_STATUS pmRegisterDynamicQuery(PM_SESSION_HANDLE sessionHandle, PM_DYNAMIC_QUERY_HANDLE* pHandle, PM_QUERY_ELEMENT* pElements, uint64_t numElements, double windowSizeMs, double metricOffsetMs = 0.f);
+	// register a dynamic query in which each element has its own window size (pWindowSizesMs holds one per element)
+	// all windows end at the point set by metricOffsetMs, so they nest; the frames are read once for the largest window,
+	// telemetry is gathered in one pass, and fps metrics are calculated over each distinct window's frames in turn;
+	// useful for reporting a metric over several horizons at once. Cannot be range polled
+	PRESENTMON_API2_EXPORT PM_STATUS pmRegisterDynamicQueryMultiWindow(PM_SESSION_HANDLE sessionHandle, PM_DYNAMIC_QUERY_HANDLE* pHandle, PM_QUERY_ELEMENT* pElements, uint64_t numElements, const double* pWindowSizesMs, double metricOffsetMs);
 	PRESENTMON_API2_EXPORT PM_STATUS pmFreeDynamicQuery(PM_DYNAMIC_QUERY_HANDLE handle);
 	PRESENTMON_API2_EXPORT PM_STATUS pmPollDynamicQuery(PM_DYNAMIC_QUERY_HANDLE handle, uint32_t processId, uint8_t* pBlob, uint32_t* numSwapChains);
+	// poll the query at *pNumSamples time points spaced sampleIntervalMs apart, ending at the time
+	// pmPollDynamicQuery would use now, writing one blob per point (first swap chain only), oldest first
+	// points from before the process's frame history are skipped; on return *pNumSamples holds the number
+	// written, which are always the most recent ones
+	PRESENTMON_API2_EXPORT PM_STATUS pmPollDynamicQueryRange(PM_DYNAMIC_QUERY_HANDLE handle, uint32_t processId, double sampleIntervalMs, uint8_t* pBlobs, uint32_t* pNumSamples);
 	PRESENTMON_API2_EXPORT PM_STATUS pmPollStaticQuery(PM_SESSION_HANDLE sessionHandle, const PM_QUERY_ELEMENT* pElement, uint32_t processId, uint8_t* pBlob);
 	PRESENTMON_API2_EXPORT PM_STATUS pmRegisterFrameQuery(PM_SESSION_HANDLE sessionHandle, PM_FRAME_QUERY_HANDLE* pHandle, PM_QUERY_ELEMENT* pElements, uint64_t numElements, uint32_t* pBlobSize);
 	PRESENTMON_API2_EXPORT PM_STATUS pmConsumeFrames(PM_FRAME_QUERY_HANDLE handle, uint32_t processId, uint8_t* pBlobs, uint32_t* pNumFramesToRead);
+	// consume frames of several tracked processes into one blob array in a single call; pProcessIds lists the
+	// processes (numProcessIds of them), or pass 0 to consume from all processes tracked by the session
+	// processes with no new frames are skipped cheaply, and exited processes are skipped and stop being tracked
+	// pBlobProcessIds receives the process id of each blob written; *pNumFramesToRead is the capacity in and count out
+	PRESENTMON_API2_EXPORT PM_STATUS pmConsumeFramesMultiProcess(PM_FRAME_QUERY_HANDLE handle, const uint32_t* pProcessIds, uint32_t numProcessIds, PM_CONSUME_ORDER order, uint8_t* pBlobs, uint32_t* pBlobProcessIds, uint32_t* pNumFramesToRead);
+	// block until at least minFrames frames of the process are ready to be consumed or timeoutMs elapses,
+	// woken by the service as frames are written instead of polling; minFrames is capped at the stream's
+	// ring capacity. On return *pNumFramesAvailable holds the number ready, which is below minFrames on timeout
+	PRESENTMON_API2_EXPORT PM_STATUS pmWaitForFrames(PM_FRAME_QUERY_HANDLE handle, uint32_t processId, uint32_t minFrames, uint32_t timeoutMs, uint32_t* pNumFramesAvailable);
 	PRESENTMON_API2_EXPORT PM_STATUS pmFreeFrameQuery(PM_FRAME_QUERY_HANDLE handle);
 
 #ifdef __cplusplus
@@ -0,0 +1,191 @@
+#include "CppUnitTest.h"
+#include "../PresentMonAPI2/PresentMonAPI.h"
+#include "../PresentMonAPI2/Internal.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "Utilities.h"
+#include "StatusComparison.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace PresentMonAPI2Mock
+{
+	TEST_CLASS(CAPIConcurrencyTests)
+	{
+	private:
+		PM_SESSION_HANDLE hSession_ = nullptr;
+		static constexpr PM_QUERY_ELEMENT dynamicElements_[]{
+			PM_QUERY_ELEMENT{.metric = PM_METRIC_CPU_UTILIZATION, .deviceId = 0, .arrayIndex = 0},
+			PM_QUERY_ELEMENT{.metric = PM_METRIC_GPU_POWER, .deviceId = 1, .arrayIndex = 0},
+		};
+		PM_DYNAMIC_QUERY_HANDLE RegisterDynamicQuery_()
+		{
+			PM_DYNAMIC_QUERY_HANDLE q = nullptr;
+			PM_QUERY_ELEMENT elements[std::size(dynamicElements_)];
+			std::ranges::copy(dynamicElements_, elements);
+			Assert::AreEqual(PM_STATUS_SUCCESS, pmRegisterDynamicQuery(hSession_, &q, elements, std::size(elements), 1000.));
+			return q;
+		}
+		// polls q from each of nThreads threads, returning the number of polls that
+		// produced the expected values
+		static size_t PollFromThreads_(PM_DYNAMIC_QUERY_HANDLE q, size_t nThreads, size_t pollsPerThread)
+		{
+			std::atomic<size_t> good = 0;
+			std::vector<std::jthread> threads;
+			for (size_t i = 0; i < nThreads; i++) {
+				threads.emplace_back([=, &good] {
+					uint8_t blob[16]{};
+					for (size_t j = 0; j < pollsPerThread; j++) {
+						uint32_t numSwapChains = 1;
+						// processes differ per thread so polls do not serialize on a process
+						if (pmPollDynamicQuery(q, 4004 + uint32_t(i), blob, &numSwapChains) == PM_STATUS_SUCCESS &&
+							reinterpret_cast<double&>(blob[0]) == (double)PM_METRIC_CPU_UTILIZATION &&
+							reinterpret_cast<double&>(blob[8]) == (double)PM_METRIC_GPU_POWER) {
+							good++;
+						}
+					}
+				});
+			}
+			threads.clear();
+			return good;
+		}
+	public:
+		TEST_METHOD_INITIALIZE(BeforeEachTestMethod)
+		{
+			pmSetMiddlewareAsMock_(true, true);
+			pmOpenSession(&hSession_);
+		}
+		TEST_METHOD_CLEANUP(AfterEachTestMethod)
+		{
+			pmCloseSession(hSession_);
+		}
+		TEST_METHOD(FreedHandlesAreRejected)
+		{
+			const auto q = RegisterDynamicQuery_();
+			Assert::AreEqual(PM_STATUS_SUCCESS, pmFreeDynamicQuery(q));
+
+			uint8_t blob[16]{};
+			uint32_t numSwapChains = 1;
+			Assert::AreEqual(PM_STATUS_SESSION_NOT_OPEN, pmPollDynamicQuery(q, 4004, blob, &numSwapChains));
+			Assert::AreEqual(PM_STATUS_FAILURE, pmFreeDynamicQuery(q));
+
+			// a new query reuses the slot but not the handle
+			const auto q2 = RegisterDynamicQuery_();
+			Assert::IsTrue(q != q2);
+			Assert::AreEqual(PM_STATUS_SESSION_NOT_OPEN, pmPollDynamicQuery(q, 4004, blob, &numSwapChains));
+			Assert::AreEqual(PM_STATUS_SUCCESS, pmPollDynamicQuery(q2, 4004, blob, &numSwapChains));
+			Assert::AreEqual(PM_STATUS_SUCCESS, pmFreeDynamicQuery(q2));
+		}
+		TEST_METHOD(HandlesOfWrongKindAreRejected)
+		{
+			const auto q = RegisterDynamicQuery_();
+			Assert::AreEqual(PM_STATUS_SESSION_NOT_OPEN, pmStartTrackingProcess((PM_SESSION_HANDLE)q, 4004));
+			Assert::AreEqual(PM_STATUS_FAILURE, pmFreeFrameQuery((PM_FRAME_QUERY_HANDLE)q));
+			Assert::AreEqual(PM_STATUS_SUCCESS, pmFreeDynamicQuery(q));
+		}
+		TEST_METHOD(TableGrowsPastFirstChunk)
+		{
+			// well past the slots stored inline, so several chunks are allocated
+			std::vector<PM_DYNAMIC_QUERY_HANDLE> queries;
+			for (size_t i = 0; i < 20'000; i++) {
+				queries.push_back(RegisterDynamicQuery_());
+			}
+			uint8_t blob[16]{};
+			uint32_t numSwapChains = 1;
+			Assert::AreEqual(PM_STATUS_SUCCESS, pmPollDynamicQuery(queries.front(), 4004, blob, &numSwapChains));
+			Assert::AreEqual(PM_STATUS_SUCCESS, pmPollDynamicQuery(queries.back(), 4004, blob, &numSwapChains));
+			for (auto q : queries) {
+				Assert::AreEqual(PM_STATUS_SUCCESS, pmFreeDynamicQuery(q));
+			}
+			Assert::AreEqual(PM_STATUS_SESSION_NOT_OPEN, pmPollDynamicQuery(queries.back(), 4004, blob, &numSwapChains));
+		}
+		TEST_METHOD(ClosedSessionIsRejected)
+		{
+			PM_SESSION_HANDLE hSession = nullptr;
+			Assert::AreEqual(PM_STATUS_SUCCESS, pmOpenSession(&hSession));
+			Assert::AreEqual(PM_STATUS_SUCCESS, pmCloseSession(hSession));
+			Assert::AreEqual(PM_STATUS_SESSION_NOT_OPEN, pmStartTrackingProcess(hSession, 4004));
+			Assert::AreEqual(PM_STATUS_FAILURE, pmCloseSession(hSession));
+		}
+		TEST_METHOD(ConcurrentPolls)
+		{
+			const auto q = RegisterDynamicQuery_();
+			Assert::AreEqual(size_t(8 * 500), PollFromThreads_(q, 8, 500));
+			Assert::AreEqual(PM_STATUS_SUCCESS, pmFreeDynamicQuery(q));
+		}
+		TEST_METHOD(ConcurrentFrameConsumption)
+		{
+			PM_FRAME_QUERY_HANDLE q = nullptr;
+			uint32_t blobSize = 0;
+			PM_QUERY_ELEMENT elements[]{
+				PM_QUERY_ELEMENT{.metric = PM_METRIC_GPU_POWER, .deviceId = 1, .arrayIndex = 0},
+			};
+			Assert::AreEqual(PM_STATUS_SUCCESS, pmRegisterFrameQuery(hSession_, &q, elements, std::size(elements), &blobSize));
+
+			// every pending frame is consumed exactly once between the threads
+			std::atomic<uint32_t> consumed = 0;
+			std::atomic<size_t> failures = 0;
+			{
+				std::vector<std::jthread> threads;
+				for (int i = 0; i < 8; i++) {
+					threads.emplace_back([&] {
+						auto pBlob = std::make_unique<uint8_t[]>(blobSize);
+						for (int j = 0; j < 100; j++) {
+							uint32_t numFrames = 1;
+							if (pmConsumeFrames(q, 4004, pBlob.get(), &numFrames) != PM_STATUS_SUCCESS) {
+								failures++;
+							}
+							consumed += numFrames;
+						}
+					});
+				}
+			}
+			Assert::AreEqual(size_t(0), size_t(failures));
+			Assert::AreEqual(2u, uint32_t(consumed));
+			Assert::AreEqual(PM_STATUS_SUCCESS, pmFreeFrameQuery(q));
+		}
+		TEST_METHOD(RegisterAndFreeWhilePolling)
+		{
+			const auto q = RegisterDynamicQuery_();
+			std::atomic<bool> done = false;
+			std::atomic<size_t> failures = 0;
+			std::jthread churn{ [&] {
+				while (!done) {
+					PM_DYNAMIC_QUERY_HANDLE q2 = nullptr;
+					PM_QUERY_ELEMENT elements[std::size(dynamicElements_)];
+					std::ranges::copy(dynamicElements_, elements);
+					if (pmRegisterDynamicQuery(hSession_, &q2, elements, std::size(elements), 1000.) != PM_STATUS_SUCCESS ||
+						pmFreeDynamicQuery(q2) != PM_STATUS_SUCCESS) {
+						failures++;
+					}
+				}
+			} };
+			const auto good = PollFromThreads_(q, 4, 500);
+			done = true;
+			churn.join();
+			Assert::AreEqual(size_t(4 * 500), good);
+			Assert::AreEqual(size_t(0), size_t(failures));
+			Assert::AreEqual(PM_STATUS_SUCCESS, pmFreeDynamicQuery(q));
+		}
+		TEST_METHOD(PollScalingReport)
+		{
+			// informational only; timings on shared test machines are too noisy to assert on
+			const auto q = RegisterDynamicQuery_();
+			constexpr size_t pollsPerThread = 2000;
+			for (size_t nThreads : { 1, 2, 4, 8 }) {
+				const auto start = std::chrono::high_resolution_clock::now();
+				const auto good = PollFromThreads_(q, nThreads, pollsPerThread);
+				const auto elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+				Assert::AreEqual(nThreads * pollsPerThread, good);
+				Logger::WriteMessage(std::format("{} threads: {:.0f} polls/s\n",
+					nThreads, double(good) / elapsed).c_str());
+			}
+			Assert::AreEqual(PM_STATUS_SUCCESS, pmFreeDynamicQuery(q));
+		}
+	};
+}
@@ -129,6 +129,87 @@ namespace PresentMonAPI2Mock
 			Assert::AreEqual(PM_STATUS_SUCCESS, pmFreeDynamicQuery(q));
 		}
 
+		TEST_METHOD(PollValuesRange)
+		{
+			PM_DYNAMIC_QUERY_HANDLE q = nullptr;
+			PM_QUERY_ELEMENT elements[]{
+				PM_QUERY_ELEMENT{.metric = PM_METRIC_CPU_UTILIZATION, .deviceId = 0, .arrayIndex = 0},
+				PM_QUERY_ELEMENT{.metric = PM_METRIC_PRESENT_MODE, .deviceId = 0, .arrayIndex = 0},
+			};
+			Assert::AreEqual(PM_STATUS_SUCCESS, pmRegisterDynamicQuery(hSession_, &q, elements, std::size(elements), 1000.));
+			Assert::IsNotNull(q);
+
+			const auto blobSize = elements[1].dataOffset + elements[1].dataSize;
+			auto pBlobs = std::make_unique<uint8_t[]>(blobSize * 5);
+
+			pmMiddlewareAdvanceTime_(hSession_, 3);
+
+			// points at t = -1, 0, 1, 2, 3; the one before time zero has no history
+			uint32_t numSamples = 5;
+			Assert::AreEqual(PM_STATUS_SUCCESS, pmPollDynamicQueryRange(q, 4004, 1., pBlobs.get(), &numSamples));
+			Assert::AreEqual(4u, numSamples);
+			for (uint32_t i = 0; i < numSamples; i++) {
+				const auto pBlob = &pBlobs[i * blobSize];
+				if (i % 2 == 0) {
+					Assert::AreEqual((double)PM_METRIC_CPU_UTILIZATION, reinterpret_cast<double&>(pBlob[elements[0].dataOffset]));
+					Assert::AreEqual((int)PM_PRESENT_MODE_HARDWARE_LEGACY_FLIP, reinterpret_cast<int&>(pBlob[elements[1].dataOffset]));
+				}
+				else {
+					Assert::AreEqual(0., reinterpret_cast<double&>(pBlob[elements[0].dataOffset]));
+					Assert::AreEqual((int)PM_PRESENT_MODE_HARDWARE_INDEPENDENT_FLIP, reinterpret_cast<int&>(pBlob[elements[1].dataOffset]));
+				}
+			}
+
+			// the newest point matches a regular poll
+			uint32_t numSwapChains = 1;
+			auto pBlob = std::make_unique<uint8_t[]>(blobSize);
+			Assert::AreEqual(PM_STATUS_SUCCESS, pmPollDynamicQuery(q, 4004, pBlob.get(), &numSwapChains));
+			Assert::AreEqual(0, memcmp(pBlob.get(), &pBlobs[3 * blobSize], blobSize));
+
+			Assert::AreEqual(PM_STATUS_SUCCESS, pmFreeDynamicQuery(q));
+		}
+
+		TEST_METHOD(PollValuesMultiWindow)
+		{
+			PM_DYNAMIC_QUERY_HANDLE q = nullptr;
+			PM_QUERY_ELEMENT elements[]{
+				PM_QUERY_ELEMENT{.metric = PM_METRIC_CPU_UTILIZATION, .deviceId = 0, .arrayIndex = 0},
+				PM_QUERY_ELEMENT{.metric = PM_METRIC_CPU_UTILIZATION, .deviceId = 0, .arrayIndex = 0},
+				PM_QUERY_ELEMENT{.metric = PM_METRIC_PRESENT_MODE, .deviceId = 0, .arrayIndex = 0},
+				PM_QUERY_ELEMENT{.metric = PM_METRIC_GPU_POWER, .deviceId = 1, .arrayIndex = 0},
+			};
+			const double windowSizes[]{ 250., 10000., 1000., 250. };
+			Assert::AreEqual(PM_STATUS_SUCCESS, pmRegisterDynamicQueryMultiWindow(hSession_, &q, elements, std::size(elements), windowSizes, 0.));
+			Assert::IsNotNull(q);
+
+			// elements keep their order in the blob whatever their windows
+			for (size_t i = 1; i < std::size(elements); i++) {
+				Assert::AreEqual(elements[i - 1].dataOffset + elements[i - 1].dataSize, elements[i].dataOffset);
+			}
+
+			auto pBlob = std::make_unique<uint8_t[]>(elements[3].dataOffset + elements[3].dataSize);
+			uint32_t numSwapChains = 1;
+			Assert::AreEqual(PM_STATUS_SUCCESS, pmPollDynamicQuery(q, 4004, pBlob.get(), &numSwapChains));
+			Assert::AreEqual((double)PM_METRIC_CPU_UTILIZATION, reinterpret_cast<double&>(pBlob[elements[0].dataOffset]));
+			Assert::AreEqual((double)PM_METRIC_CPU_UTILIZATION, reinterpret_cast<double&>(pBlob[elements[1].dataOffset]));
+			Assert::AreEqual((int)PM_PRESENT_MODE_HARDWARE_LEGACY_FLIP, reinterpret_cast<int&>(pBlob[elements[2].dataOffset]));
+			Assert::AreEqual((double)PM_METRIC_GPU_POWER, reinterpret_cast<double&>(pBlob[elements[3].dataOffset]));
+
+			Assert::AreEqual(PM_STATUS_SUCCESS, pmFreeDynamicQuery(q));
+		}
+
+		TEST_METHOD(MultiWindowRejectsBadWindows)
+		{
+			PM_DYNAMIC_QUERY_HANDLE q = nullptr;
+			PM_QUERY_ELEMENT elements[]{
+				PM_QUERY_ELEMENT{.metric = PM_METRIC_CPU_UTILIZATION, .deviceId = 0, .arrayIndex = 0},
+				PM_QUERY_ELEMENT{.metric = PM_METRIC_GPU_POWER, .deviceId = 1, .arrayIndex = 0},
+			};
+			const double windowSizes[]{ 1000., 0. };
+			Assert::AreEqual(PM_STATUS_FAILURE, pmRegisterDynamicQueryMultiWindow(hSession_, &q, elements, std::size(elements), windowSizes, 0.));
+			Assert::AreEqual(PM_STATUS_FAILURE, pmRegisterDynamicQueryMultiWindow(hSession_, &q, elements, std::size(elements), nullptr, 0.));
+		}
+
 		TEST_METHOD(UnsupportedMetric)
 		{
 			PM_DYNAMIC_QUERY_HANDLE q = nullptr;
@@ -71,6 +71,32 @@ namespace PresentMonAPI2Mock
 			const auto heapAfter = pmCreateHeapCheckpoint_();
 			Assert::IsFalse(CrtDiffHasMemoryLeaks(heapBefore, heapAfter));
 		}
+		TEST_METHOD(StreamFrameCountAdvances)
+		{
+			pmSetMiddlewareAsMock_(true, true);
+			Assert::AreEqual(PM_STATUS_SUCCESS, pmOpenSession(&hSession_));
+			Assert::AreEqual(PM_STATUS_SUCCESS, pmStartTrackingProcess(hSession_, 4004));
+
+			uint64_t before = 0;
+			Assert::AreEqual(PM_STATUS_SUCCESS, pmGetStreamFrameCount(hSession_, 4004, &before));
+			pmMiddlewareAdvanceTime_(hSession_, 3);
+			uint64_t after = 0;
+			Assert::AreEqual(PM_STATUS_SUCCESS, pmGetStreamFrameCount(hSession_, 4004, &after));
+			Assert::AreEqual(before + 3, after);
+
+			Assert::AreEqual(PM_STATUS_FAILURE, pmGetStreamFrameCount(hSession_, 4004, nullptr));
+		}
+		TEST_METHOD(StreamFramesLostQueryable)
+		{
+			pmSetMiddlewareAsMock_(true, true);
+			Assert::AreEqual(PM_STATUS_SUCCESS, pmOpenSession(&hSession_));
+			Assert::AreEqual(PM_STATUS_SUCCESS, pmStartTrackingProcess(hSession_, 4004));
+
+			uint64_t lost = 1;
+			Assert::AreEqual(PM_STATUS_SUCCESS, pmGetStreamFramesLost(hSession_, 4004, &lost));
+			Assert::AreEqual(0ull, lost);
+			Assert::AreEqual(PM_STATUS_FAILURE, pmGetStreamFramesLost(hSession_, 4004, nullptr));
+		}
 	};
 }
 
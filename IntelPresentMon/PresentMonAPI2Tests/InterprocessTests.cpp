@@ -272,7 +272,48 @@ namespace PresentMonAPI2Mock
 					Assert::AreEqual((int)PM_METRIC_AVAILABILITY_AVAILABLE, (int)pInfo->availability);
 				}
 			}
-			free((void*)pRoot);
+			pComm->FreeIntrospectionRoot(pRoot);
+
+			// ack to companion process so it can exit
+			in << "ack" << std::endl;
+
+			process.wait();
+
+			Assert::AreEqual(0, process.exit_code());
+		}
+		TEST_METHOD(SeparateProcessesSharedImage)
+		{
+			namespace bp = boost::process;
+			using namespace std::string_literals;
+
+			bp::ipstream out; // Stream for reading the process's output
+			bp::opstream in;  // Stream for writing to the process's input
+
+			const auto introNsm = "intro_shm_test_image"s;
+
+			bp::child process("InterprocessMock.exe"s,
+				"--basic-intro"s,
+				"--intro-nsm"s, introNsm,
+				bp::std_out > out, bp::std_in < in);
+
+			std::string output;
+			out >> output;
+
+			Assert::AreEqual("ready"s, output);
+
+			// the published image is mapped in place and shared, rather than cloned per connection
+			{
+				auto pComm1 = ipc::MakeMiddlewareComms(introNsm);
+				auto pComm2 = ipc::MakeMiddlewareComms(introNsm);
+				const auto pRoot1 = pComm1->GetIntrospectionRoot();
+				const auto pRoot2 = pComm2->GetIntrospectionRoot();
+				Assert::IsNotNull(pRoot1);
+				Assert::IsTrue(pRoot1 == pRoot2);
+				Assert::AreEqual(69ull, pRoot1->pMetrics->size);
+				Assert::AreEqual(3ull, pRoot1->pDevices->size);
+				pComm1->FreeIntrospectionRoot(pRoot1);
+				pComm2->FreeIntrospectionRoot(pRoot2);
+			}
 
 			// ack to companion process so it can exit
 			in << "ack" << std::endl;
@@ -2,6 +2,11 @@
 #include "../PresentMonUtils/PresentMonNamedPipe.h"
 #include "../PresentMonMiddleware/source/FrameEventQuery.h"
 #include "../PresentMonMiddleware/source/MockMiddleware.h"
+#include "../PresentMonMiddleware/source/MockCommon.h"
+#include "../PresentMonMiddleware/source/ConcreteMiddleware.h"
+#include <algorithm>
+#include <cstring>
+#include <format>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -409,6 +414,65 @@ namespace PresentMonAPI2Mock
 
 			mid.FreeFrameEventQuery(pQuery);
 		}
+		TEST_METHOD(TestQueryMiddlewareWaitForFrames)
+		{
+			PM_QUERY_ELEMENT queryElements[]{
+				{ PM_METRIC_GPU_POWER, PM_STAT_NONE, 1, 0 },
+				{ PM_METRIC_CPU_FRAME_QPC, PM_STAT_NONE, 0, 0 },
+			};
+			pmon::mid::MockMiddleware mid{ true };
+
+			uint32_t blobSize = 0;
+			auto pQuery = mid.RegisterFrameEventQuery(queryElements, blobSize);
+			auto pBlobs = std::make_unique<uint8_t[]>(blobSize);
+
+			// 2 frames are pending to begin with, so waiting for 1 returns at once
+			uint32_t nAvailable = 0;
+			mid.WaitForFrames(pQuery, 111, 1, 0, nAvailable);
+			Assert::AreEqual(2u, nAvailable);
+
+			// consuming 1 leaves 1 pending; waiting for more than that times out reporting 1
+			uint32_t nFrames = 1;
+			mid.ConsumeFrameEvents(pQuery, 111, pBlobs.get(), nFrames);
+			Assert::AreEqual(1u, nFrames);
+			mid.WaitForFrames(pQuery, 111, 2, 10, nAvailable);
+			Assert::AreEqual(1u, nAvailable);
+
+			mid.FreeFrameEventQuery(pQuery);
+		}
+		TEST_METHOD(TestQueryMiddlewareConsumeMultiProcess)
+		{
+			PM_QUERY_ELEMENT queryElements[]{
+				{ PM_METRIC_GPU_POWER, PM_STAT_NONE, 1, 0 },
+				{ PM_METRIC_CPU_FRAME_QPC, PM_STAT_NONE, 0, 0 },
+			};
+			pmon::mid::MockMiddleware mid{ true };
+			mid.StartStreaming(222, 0);
+			mid.StartStreaming(111, 0);
+
+			uint32_t blobSize = 0;
+			auto pQuery = mid.RegisterFrameEventQuery(queryElements, blobSize);
+			auto pBlobs = std::make_unique<uint8_t[]>(blobSize * 4);
+			uint32_t processIds[4]{};
+
+			// consuming from all tracked processes annotates each blob with its process
+			uint32_t nFrames = 4;
+			mid.ConsumeFrameEventsMulti(pQuery, {}, false, pBlobs.get(), processIds, nFrames);
+			Assert::AreEqual(2u, nFrames);
+			Assert::AreEqual(111u, processIds[0]);
+			Assert::AreEqual(111u, processIds[1]);
+			Assert::AreEqual(420., *(double*)&pBlobs[0]);
+			Assert::AreEqual(69920ull, *(uint64_t*)&pBlobs[blobSize + 8]);
+
+			// with no process tracked there is nothing to consume
+			mid.StopStreaming(111);
+			mid.StopStreaming(222);
+			nFrames = 4;
+			mid.ConsumeFrameEventsMulti(pQuery, {}, true, pBlobs.get(), processIds, nFrames);
+			Assert::AreEqual(0u, nFrames);
+
+			mid.FreeFrameEventQuery(pQuery);
+		}
 		//TEST_METHOD(TestQueryDuration)
 		//{
 		//	const PmNsmFrameData frame{
@@ -571,4 +635,158 @@ namespace PresentMonAPI2Mock
 		//	Assert::AreEqual(-double(13431ull), *(double*)pBlob.get());
 		//}
 	};
+
+	// concrete middleware connected only to the introspection nsm, polling over supplied frames
+	// in place of a process's stream
+	class DetachedMiddleware : public pmon::mid::ConcreteMiddleware
+	{
+	public:
+		DetachedMiddleware(std::string introNsm)
+			:
+			ConcreteMiddleware{ DetachedTag{}, std::move(introNsm) }
+		{}
+		// polls the query over the frames (oldest first), taking the window(s) to end at the last frame
+		void PollFrames(const PM_DYNAMIC_QUERY* pQuery, uint32_t processId, std::span<PmNsmFrameData* const> frames,
+			LARGE_INTEGER qpcFrequency, uint8_t* pBlob, uint32_t* numSwapChains)
+		{
+			const auto pProcessState = pQuery->GetProcessState(processId);
+			std::lock_guard processStateLock{ pProcessState->mutex };
+			ConcreteMiddleware::PollFrames(pQuery, *pProcessState, frames, frames.back()->present_event.PresentStartTime,
+				0., pBlob, numSwapChains, qpcFrequency);
+		}
+	};
+
+	TEST_CLASS(ConcreteMiddlewareTests)
+	{
+		static constexpr uint32_t pid_ = 4004;
+		static constexpr uint64_t qpcPerMs_ = 10'000;
+		std::unique_ptr<pmon::ipc::ServiceComms> pServiceComms_;
+		std::unique_ptr<DetachedMiddleware> pMid_;
+		std::vector<PmNsmFrameData> frameStore_;
+		std::vector<PmNsmFrameData*> frames_;
+
+		// 2s of frames, oldest first, alternating 8ms and 12ms apart with every
+		// 7th one discarded, so that pending presents span the window starts
+		void MakeFrames_()
+		{
+			frameStore_.resize(200);
+			uint64_t qpc = 1'000'000;
+			for (size_t i = 0; i < frameStore_.size(); i++) {
+				auto& f = frameStore_[i];
+				auto& p = f.present_event;
+				p.PresentStartTime = qpc;
+				p.ProcessId = pid_;
+				p.TimeInPresent = qpcPerMs_ / 2;
+				p.GPUStartTime = qpc + qpcPerMs_;
+				p.ReadyTime = qpc + qpcPerMs_ * 4;
+				p.GPUDuration = qpcPerMs_ * 3;
+				p.SwapChainAddress = 0x1000;
+				p.Runtime = Runtime::DXGI;
+				p.PresentMode = PresentMode::Hardware_Independent_Flip;
+				if (i % 7 == 3) {
+					p.FinalState = PresentResult::Discarded;
+				}
+				else {
+					p.FinalState = PresentResult::Presented;
+					p.ScreenTime = qpc + qpcPerMs_ * 6;
+				}
+				f.cpu_telemetry.cpu_utilization = double(i % 13);
+				qpc += qpcPerMs_ * (i % 2 ? 12 : 8);
+			}
+			for (auto& f : frameStore_) {
+				frames_.push_back(&f);
+			}
+		}
+		// the newest frames within the window, as a poll of the stream gathers them
+		std::span<PmNsmFrameData* const> FramesInWindow_(double windowMs) const
+		{
+			const auto newest = frames_.back()->present_event.PresentStartTime;
+			const auto start = newest - uint64_t(windowMs * qpcPerMs_);
+			const auto it = std::ranges::find_if(frames_, [=](const PmNsmFrameData* f) {
+				return f->present_event.PresentStartTime > start;
+			});
+			return { it, frames_.end() };
+		}
+		std::vector<double> Poll_(const PM_DYNAMIC_QUERY* pQuery, std::span<PmNsmFrameData* const> frames)
+		{
+			std::vector<uint8_t> blob(pQuery->GetBlobSize());
+			uint32_t numSwapChains = 1;
+			LARGE_INTEGER frequency{ .QuadPart = LONGLONG(qpcPerMs_ * 1000) };
+			pMid_->PollFrames(pQuery, pid_, frames, frequency, blob.data(), &numSwapChains);
+			Assert::AreEqual(1u, numSwapChains);
+			std::vector<double> values(blob.size() / sizeof(double));
+			std::memcpy(values.data(), blob.data(), values.size() * sizeof(double));
+			return values;
+		}
+	public:
+		TEST_METHOD_INITIALIZE(BeforeEachTestMethod)
+		{
+			pServiceComms_ = pmon::ipc::MakeServiceComms("concrete_mid_test_intro");
+			pmon::ipc::intro::RegisterMockIntrospectionDevices(*pServiceComms_);
+			pMid_ = std::make_unique<DetachedMiddleware>("concrete_mid_test_intro");
+			MakeFrames_();
+		}
+		TEST_METHOD_CLEANUP(AfterEachTestMethod)
+		{
+			pMid_.reset();
+			pServiceComms_.reset();
+		}
+		TEST_METHOD(MultiWindowMatchesSingleWindowPolls)
+		{
+			const PM_QUERY_ELEMENT elementTemplates[]{
+				{ PM_METRIC_PRESENTED_FPS, PM_STAT_AVG, 0, 0 },
+				{ PM_METRIC_DISPLAYED_FPS, PM_STAT_PERCENTILE_01, 0, 0 },
+				{ PM_METRIC_FRAME_TIME, PM_STAT_MAX, 0, 0 },
+				{ PM_METRIC_DISPLAY_LATENCY, PM_STAT_AVG, 0, 0 },
+				{ PM_METRIC_DROPPED_FRAMES, PM_STAT_AVG, 0, 0 },
+				{ PM_METRIC_CPU_UTILIZATION, PM_STAT_AVG, 0, 0 },
+			};
+			// windows starting at various points in the runs of pending presents (none right
+			// on a frame, so qpc rounding can't move a frame across the start), and one
+			// longer than the frames on hand
+			const double windowSizes[]{ 1003., 250., 97., 5000. };
+
+			// every template element under every window, in one query
+			std::vector<PM_QUERY_ELEMENT> multiElements;
+			std::vector<double> multiWindows;
+			for (auto w : windowSizes) {
+				for (auto& e : elementTemplates) {
+					multiElements.push_back(e);
+					multiWindows.push_back(w);
+				}
+			}
+			const auto pMulti = pMid_->RegisterDynamicQueryMultiWindow(multiElements, multiWindows, 0.);
+			const auto multiValues = Poll_(pMulti, frames_);
+
+			for (size_t iWindow = 0; iWindow < std::size(windowSizes); iWindow++) {
+				std::vector<PM_QUERY_ELEMENT> singleElements(std::begin(elementTemplates), std::end(elementTemplates));
+				const auto pSingle = pMid_->RegisterDynamicQuery(singleElements, windowSizes[iWindow], 0.);
+				const auto singleValues = Poll_(pSingle, FramesInWindow_(windowSizes[iWindow]));
+				for (size_t iElement = 0; iElement < singleElements.size(); iElement++) {
+					const auto& multi = multiElements[iWindow * std::size(elementTemplates) + iElement];
+					const auto& single = singleElements[iElement];
+					Assert::AreEqual(
+						singleValues[single.dataOffset / sizeof(double)],
+						multiValues[multi.dataOffset / sizeof(double)],
+						std::format(L"window {} element {}", windowSizes[iWindow], iElement).c_str());
+				}
+				pMid_->FreeDynamicQuery(pSingle);
+			}
+			pMid_->FreeDynamicQuery(pMulti);
+		}
+		TEST_METHOD(RepeatedMultiWindowPollsAgree)
+		{
+			PM_QUERY_ELEMENT elements[]{
+				{ PM_METRIC_PRESENTED_FPS, PM_STAT_AVG, 0, 0 },
+				{ PM_METRIC_PRESENTED_FPS, PM_STAT_AVG, 0, 0 },
+			};
+			const double windowSizes[]{ 1003., 97. };
+			const auto pQuery = pMid_->RegisterDynamicQueryMultiWindow(elements, windowSizes, 0.);
+			// no state carries from one poll to the next
+			const auto first = Poll_(pQuery, frames_);
+			const auto second = Poll_(pQuery, frames_);
+			Assert::IsTrue(first == second);
+			pMid_->FreeDynamicQuery(pQuery);
+		}
+	};
 }
\ No newline at end of file
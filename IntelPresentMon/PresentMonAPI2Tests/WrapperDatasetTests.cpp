@@ -210,6 +210,23 @@ namespace PresentMonAPI2Mock
 
 			Assert::AreEqual(0.000'001, data->FindUnit(PM_UNIT_HERTZ).MakeConversionFactor(PM_UNIT_MEGAHERTZ));
 		}
+		TEST_METHOD(IntrospectUnitIncompatibleConversion)
+		{
+			Assert::ExpectException<std::runtime_error>([this] {
+				data->FindUnit(PM_UNIT_HERTZ).MakeConversionFactor(PM_UNIT_WATTS);
+			});
+		}
+		TEST_METHOD(IntrospectPreferredUnitScale)
+		{
+			auto metric = data->FindMetric(PM_METRIC_GPU_MEM_SIZE);
+			Assert::AreEqual(data->FindUnit(PM_UNIT_BYTES).MakeConversionFactor(PM_UNIT_GIGABYTES),
+				metric.GetPreferredUnitScale());
+		}
+		TEST_METHOD(IntrospectDataSize)
+		{
+			Assert::AreEqual(260ull, data->FindMetric(PM_METRIC_APPLICATION).GetPolledDataSize());
+			Assert::AreEqual(8ull, data->FindMetric(PM_METRIC_GPU_FAN_SPEED).GetPolledDataSize());
+		}
 	private:
 		std::optional<pmapi::Session> session;
 		std::shared_ptr<pmapi::intro::Root> data;
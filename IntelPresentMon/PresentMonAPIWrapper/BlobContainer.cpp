@@ -97,7 +97,7 @@ namespace pmapi
 
     bool BlobContainer::Empty() const
     {
-        return (bool)pBlobArrayBytes_;
+        return !pBlobArrayBytes_;
     }
 
     BlobContainer:: operator bool() const { return !Empty(); }
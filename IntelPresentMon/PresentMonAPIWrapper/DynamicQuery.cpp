@@ -45,6 +45,21 @@ namespace pmapi
         Poll(tracker, blobs.GetFirst(), blobs.AcquireNumBlobsInRef_());
     }
 
+    void DynamicQuery::PollRange(const ProcessTracker& tracker, double sampleIntervalMs, uint8_t* pBlobs, uint32_t& numSamples) const
+    {
+        if (auto sta = pmPollDynamicQueryRange(hQuery_, tracker.GetPid(), sampleIntervalMs, pBlobs, &numSamples);
+            sta != PM_STATUS_SUCCESS) {
+            throw ApiErrorException{ sta, "dynamic range poll call failed" };
+        }
+    }
+
+    void DynamicQuery::PollRange(const ProcessTracker& tracker, double sampleIntervalMs, BlobContainer& blobs) const
+    {
+        assert(!Empty());
+        assert(blobs.CheckHandle(hQuery_));
+        PollRange(tracker, sampleIntervalMs, blobs.GetFirst(), blobs.AcquireNumBlobsInRef_());
+    }
+
     BlobContainer DynamicQuery::MakeBlobContainer(uint32_t nBlobs) const
     {
         assert(!Empty());
@@ -78,6 +93,20 @@ namespace pmapi
         }
     }
 
+    DynamicQuery::DynamicQuery(PM_SESSION_HANDLE hSession, std::span<PM_QUERY_ELEMENT> elements, std::span<const double> elementWinSizesMs, double metricOffsetMs)
+    {
+        if (elementWinSizesMs.size() != elements.size()) {
+            throw Exception{ "multi-window dynamic query needs one window size per element" };
+        }
+        if (auto sta = pmRegisterDynamicQueryMultiWindow(hSession, &hQuery_, elements.data(),
+            elements.size(), elementWinSizesMs.data(), metricOffsetMs); sta != PM_STATUS_SUCCESS) {
+            throw ApiErrorException{ sta, "multi-window dynamic query register call failed" };
+        }
+        if (elements.size() > 0) {
+            blobSize_ = elements.back().dataOffset + elements.back().dataSize;
+        }
+    }
+
     void DynamicQuery::Clear_() noexcept
     {
         hQuery_ = nullptr;
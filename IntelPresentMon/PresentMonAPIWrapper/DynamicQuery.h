@@ -33,6 +33,15 @@ namespace pmapi
         // numSwapChains: input indicates to API how many blobs available, output indicates how many were written
         // if the target process has multiple swap chains, will poll data for as many swaps as there are blobs available
         void Poll(const ProcessTracker& tracker, uint8_t* pBlob, uint32_t& numSwapChains) const;
+        // poll the specified process at evenly spaced time points over the recent past, in one call
+        // each blob in the container receives one time point (oldest first), sampleIntervalMs apart and
+        // ending at the time a regular poll would use now; only the first swap chain is reported
+        // points before the start of the process's frame history are skipped, so the populated blobs are
+        // the most recent GetNumBlobsPopulated() points
+        void PollRange(const ProcessTracker& tracker, double sampleIntervalMs, BlobContainer& blobs) const;
+        // poll range with raw blob memory
+        // numSamples: input indicates how many time points to poll, output indicates how many were written
+        void PollRange(const ProcessTracker& tracker, double sampleIntervalMs, uint8_t* pBlobs, uint32_t& numSamples) const;
         // create a blob container sized suited for this query
         // nBlobs parameter will control how many swaps can be polled maximum using the container
         BlobContainer MakeBlobContainer(uint32_t nBlobs) const;
@@ -45,6 +54,7 @@ namespace pmapi
     private:
         // function
         DynamicQuery(PM_SESSION_HANDLE hSession, std::span<PM_QUERY_ELEMENT> elements, double winSizeMs, double metricOffsetMs);
+        DynamicQuery(PM_SESSION_HANDLE hSession, std::span<PM_QUERY_ELEMENT> elements, std::span<const double> elementWinSizesMs, double metricOffsetMs);
         // zero out members, useful after emptying via move or reset
         void Clear_() noexcept;
         // data
@@ -46,6 +46,30 @@ namespace pmapi
         Consume(tracker, blobs.GetFirst(), blobs.AcquireNumBlobsInRef_());
     }
 
+    void FrameQuery::ConsumeAllTracked(BlobContainer& blobs, std::vector<uint32_t>& blobProcessIds, PM_CONSUME_ORDER order)
+    {
+        assert(!Empty());
+        assert(blobs.CheckHandle(hQuery_));
+        blobProcessIds.resize(blobs.GetBlobCount());
+        auto& numBlobsInOut = blobs.AcquireNumBlobsInRef_();
+        if (auto sta = pmConsumeFramesMultiProcess(hQuery_, nullptr, 0, order, blobs.GetFirst(),
+            blobProcessIds.data(), &numBlobsInOut); sta != PM_STATUS_SUCCESS) {
+            throw ApiErrorException{ sta, "consume frames multi-process call failed" };
+        }
+        blobProcessIds.resize(numBlobsInOut);
+    }
+
+    uint32_t FrameQuery::WaitForFrames(const ProcessTracker& tracker, uint32_t minFrames, uint32_t timeoutMs)
+    {
+        assert(!Empty());
+        uint32_t numFramesAvailable = 0;
+        if (auto sta = pmWaitForFrames(hQuery_, tracker.GetPid(), minFrames, timeoutMs, &numFramesAvailable);
+            sta != PM_STATUS_SUCCESS) {
+            throw ApiErrorException{ sta, "wait for frames call failed" };
+        }
+        return numFramesAvailable;
+    }
+
     BlobContainer FrameQuery::MakeBlobContainer(uint32_t nBlobs) const
     {
         assert(!Empty());
@@ -3,6 +3,7 @@
 #include "BlobContainer.h"
 #include "ProcessTracker.h"
 #include <span>
+#include <vector>
 
 namespace pmapi
 {
@@ -31,6 +32,12 @@ namespace pmapi
         // pBlobs: pointer to memory where frame query data is to be stored for consumed frames
         // NOTE: it is preferred to use above version of this function that takes in BlobContainer&
         void Consume(const ProcessTracker& tracker, uint8_t* pBlobs, uint32_t& numBlobsInOut);
+        // consume frames of all processes tracked in the session in one call using a managed blob container
+        // blobProcessIds: after function call contains the process id of each blob populated
+        void ConsumeAllTracked(BlobContainer& blobs, std::vector<uint32_t>& blobProcessIds, PM_CONSUME_ORDER order = PM_CONSUME_ORDER_BY_PROCESS);
+        // block until at least minFrames frames are pending for the process or timeoutMs elapses
+        // returns the number of frames pending, which is less than minFrames on timeout
+        uint32_t WaitForFrames(const ProcessTracker& tracker, uint32_t minFrames, uint32_t timeoutMs);
         // create a blob container whose size is suited to fit this query
         // nBlobs: number of frames worth of data that the container can contain
         BlobContainer MakeBlobContainer(uint32_t nBlobs) const;
@@ -31,6 +31,26 @@ namespace pmapi
         return pid_;
     }
 
+    uint64_t ProcessTracker::GetFrameCount() const
+    {
+        assert(!Empty());
+        uint64_t frameCount = 0;
+        if (auto sta = pmGetStreamFrameCount(hSession_, pid_, &frameCount); sta != PM_STATUS_SUCCESS) {
+            throw ApiErrorException{ sta, "get stream frame count call failed" };
+        }
+        return frameCount;
+    }
+
+    uint64_t ProcessTracker::GetFramesLost() const
+    {
+        assert(!Empty());
+        uint64_t framesLost = 0;
+        if (auto sta = pmGetStreamFramesLost(hSession_, pid_, &framesLost); sta != PM_STATUS_SUCCESS) {
+            throw ApiErrorException{ sta, "get stream frames lost call failed" };
+        }
+        return framesLost;
+    }
+
     void ProcessTracker::Reset() noexcept
     {
         if (!Empty()) {
@@ -47,12 +67,15 @@ namespace pmapi
 
     ProcessTracker::operator bool() const { return !Empty(); }
 
-    ProcessTracker::ProcessTracker(PM_SESSION_HANDLE hSession, uint32_t pid)
+    ProcessTracker::ProcessTracker(PM_SESSION_HANDLE hSession, uint32_t pid, const PM_STREAM_CAPACITY* pCapacity)
         :
         pid_{ pid },
         hSession_{ hSession }
     {
-        if (auto sta = pmStartTrackingProcess(hSession_, pid_); sta != PM_STATUS_SUCCESS) {
+        const auto sta = pCapacity ?
+            pmStartTrackingProcessWithCapacity(hSession_, pid_, pCapacity) :
+            pmStartTrackingProcess(hSession_, pid_);
+        if (sta != PM_STATUS_SUCCESS) {
             throw ApiErrorException{ sta, "start process tracking call failed" };
         }
     }
@@ -20,6 +20,10 @@ namespace pmapi
         ProcessTracker& operator=(ProcessTracker&& rhs) noexcept;
         // get the id of process being tracked
         uint32_t GetPid() const;
+        // get the running count of frames written for the tracked process, to check cheaply for new data
+        uint64_t GetFrameCount() const;
+        // get the running count of frames missed because they were overwritten before being consumed
+        uint64_t GetFramesLost() const;
         // empty this tracker (stop tracking process if any)
         void Reset() noexcept;
         // check if tracker is empty
@@ -28,7 +32,7 @@ namespace pmapi
         operator bool() const;
     private:
         // functions
-        ProcessTracker(PM_SESSION_HANDLE hSession, uint32_t pid);
+        ProcessTracker(PM_SESSION_HANDLE hSession, uint32_t pid, const PM_STREAM_CAPACITY* pCapacity = nullptr);
         // zero out members, useful after emptying via move or reset
         void Clear_() noexcept;
         // data
@@ -85,12 +85,24 @@ namespace pmapi
         return { handle_, pid };
     }
 
+    ProcessTracker Session::TrackProcess(uint32_t pid, const PM_STREAM_CAPACITY& capacity)
+    {
+        assert(handle_);
+        return { handle_, pid, &capacity };
+    }
+
     DynamicQuery Session::RegisterDyanamicQuery(std::span<PM_QUERY_ELEMENT> elements, double winSizeMs, double metricOffsetMs)
     {
         assert(handle_);
         return { handle_, elements, winSizeMs, metricOffsetMs };
     }
 
+    DynamicQuery Session::RegisterMultiWindowDynamicQuery(std::span<PM_QUERY_ELEMENT> elements, std::span<const double> elementWinSizesMs, double metricOffsetMs)
+    {
+        assert(handle_);
+        return { handle_, elements, elementWinSizesMs, metricOffsetMs };
+    }
+
     FrameQuery Session::RegisterFrameQuery(std::span<PM_QUERY_ELEMENT> elements)
     {
         assert(handle_);
@@ -51,8 +51,14 @@ namespace pmapi
         std::shared_ptr<intro::Root> GetIntrospectionRoot(bool forceRefresh = false) const;
         // begin tracking a process, necessary to consume frame data or query metrics involving that process
         ProcessTracker TrackProcess(uint32_t pid);
+        // begin tracking a process with a frame ring sized to the requested capacity
+        // use a larger capacity when consuming frames infrequently to avoid losing frames
+        ProcessTracker TrackProcess(uint32_t pid, const PM_STREAM_CAPACITY& capacity);
         // register (build/compile) a dynamic query used to poll metrics
         DynamicQuery RegisterDyanamicQuery(std::span<PM_QUERY_ELEMENT> elements, double winSizeMs, double metricOffsetMs);
+        // register a dynamic query where each element has its own window size (elementWinSizesMs holds one per element)
+        // all windows end at the same time point and are calculated together in a single pass over the frame data
+        DynamicQuery RegisterMultiWindowDynamicQuery(std::span<PM_QUERY_ELEMENT> elements, std::span<const double> elementWinSizesMs, double metricOffsetMs);
         // register (build/compile) a frame query used to consume frame events
         FrameQuery RegisterFrameQuery(std::span<PM_QUERY_ELEMENT> elements);
         // set the rate at which the service polls device telemetry data
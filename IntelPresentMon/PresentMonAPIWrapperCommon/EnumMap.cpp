@@ -11,10 +11,10 @@ namespace pmapi
         if (!singleton.initialized_) {
             throw Exception{ "Enum lookup accessed without being initialized" };
         }
-        try { return singleton.enumMap_.at(enumId); }
-        catch (const std::out_of_range&) {
+        if (size_t(enumId) >= singleton.enumMap_.size() || !singleton.enumMap_[size_t(enumId)]) {
             throw LookupException{ std::format("Enum lookup failed to find Enum id={}", int(enumId)) };
         }
+        return singleton.enumMap_[size_t(enumId)];
     }
 
     void EnumMap::Refresh(const pmapi::intro::Root& introRoot)
@@ -36,7 +36,10 @@ namespace pmapi
                     .wideDescription = ToWide(k.GetDescription()),
                 };
             }
-            singleton.enumMap_[e.GetId()] = std::move(pKeys);
+            if (size_t(e.GetId()) >= singleton.enumMap_.size()) {
+                singleton.enumMap_.resize(size_t(e.GetId()) + 1);
+            }
+            singleton.enumMap_[size_t(e.GetId())] = std::move(pKeys);
         }
         singleton.initialized_ = true;
     }
@@ -3,6 +3,7 @@
 #include "../CommonUtilities/str/String.h"
 #include "Introspection.h"
 #include <unordered_map>
+#include <vector>
 #include <string>
 #include <memory>
 #include <shared_mutex>
@@ -40,7 +41,8 @@ namespace pmapi
         static EnumMap& Get_();
         // data
         std::shared_mutex mtx_;
-        std::unordered_map<PM_ENUM, std::shared_ptr<KeyMap>> enumMap_;
+        // indexed by enum id (ids are small and dense)
+        std::vector<std::shared_ptr<KeyMap>> enumMap_;
         std::atomic<bool> initialized_ = false;
     };
 }
\ No newline at end of file
@@ -1,7 +1,12 @@
 #include "Introspection.h"
 #include <format>
 #include <cassert>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <optional>
 #include "Exception.h"
+#include "../Interprocess/source/IntrospectionHelpers.h"
 
 
 namespace pmapi::intro
@@ -16,8 +21,6 @@ namespace pmapi::intro
         return type == PM_METRIC_TYPE_FRAME_EVENT || type == PM_METRIC_TYPE_DYNAMIC_FRAME;
     }
 
-
-
     int EnumKeyView::GetId() const
     {
         return pBase->id;
@@ -307,11 +310,7 @@ namespace pmapi::intro
 
     double UnitView::MakeConversionFactor(PM_UNIT destinationUnitId) const
     {
-        auto destUnit = pRoot->FindUnit(destinationUnitId);
-        if (destUnit.GetBaseUnit() != GetBaseUnit()) {
-            throw std::runtime_error{ "cannot convert incompatible units" };
-        }
-        return GetScale() / destUnit.GetScale();
+        return pRoot->GetUnitConversionFactor(pBase->id, destinationUnitId);
     }
 
     const UnitView::SelfType* UnitView::operator->() const
@@ -389,6 +388,25 @@ namespace pmapi::intro
         return { GetDeviceMetricInfoBegin_(), GetDeviceMetricInfoEnd_() };
     }
 
+    size_t MetricView::GetPolledDataSize() const
+    {
+        return pRoot->GetMetricEntry_(pBase->id).polledDataSize;
+    }
+
+    size_t MetricView::GetFrameDataSize() const
+    {
+        return pRoot->GetMetricEntry_(pBase->id).frameDataSize;
+    }
+
+    double MetricView::GetPreferredUnitScale() const
+    {
+        const auto scale = pRoot->GetMetricEntry_(pBase->id).preferredUnitScale;
+        if (std::isnan(scale)) {
+            throw std::runtime_error{ "cannot convert incompatible units" };
+        }
+        return scale;
+    }
+
     const MetricView::SelfType* MetricView::operator->() const
     {
         return this;
@@ -435,23 +453,69 @@ namespace pmapi::intro
         assert(pRoot);
         assert(deleter);
         // building lookup tables for enum/key
+        // enum ids are small and dense, keys are dense within each enum so index by offset from min key
         for (auto e : GetEnums()) {
+            const auto id = size_t(e.GetId());
+            if (id >= enumTable.size()) {
+                enumTable.resize(id + 1);
+            }
+            auto& entry = enumTable[id];
+            entry.pEnum = e.GetBasePtr();
+            std::optional<int> minKey;
+            std::optional<int> maxKey;
             for (auto k : e.GetKeys()) {
-                enumKeyMap[MakeEnumKeyMapKey_(e.GetId(), k.GetId())] = k.GetBasePtr();
+                minKey = std::min(minKey.value_or(k.GetId()), k.GetId());
+                maxKey = std::max(maxKey.value_or(k.GetId()), k.GetId());
+            }
+            if (minKey) {
+                entry.minKey = *minKey;
+                entry.keys.resize(size_t(*maxKey - *minKey) + 1);
+                for (auto k : e.GetKeys()) {
+                    entry.keys[size_t(k.GetId() - *minKey)] = k.GetBasePtr();
+                }
             }
-            enumMap[e.GetId()] = e.GetBasePtr();
         }
         // building lookup table for devices
         for (auto d : GetDevices()) {
             deviceMap[d.GetId()] = d.GetBasePtr();
         }
-        // building lookup table for metrics
-        for (auto m : GetMetrics()) {
-            metricMap[m.GetId()] = m.GetBasePtr();
-        }
         // building lookup table for units
         for (auto u : GetUnits()) {
-            unitMap[u.GetId()] = u.GetBasePtr();
+            const auto id = size_t(u.GetId());
+            if (id >= unitTable.size()) {
+                unitTable.resize(id + 1);
+            }
+            unitTable[id] = u.GetBasePtr();
+        }
+        // precompute conversion factors between every pair of units
+        const auto nUnits = unitTable.size();
+        unitConversionTable.resize(nUnits * nUnits, std::numeric_limits<double>::quiet_NaN());
+        for (size_t from = 0; from < nUnits; from++) {
+            for (size_t to = 0; to < nUnits; to++) {
+                const auto pFrom = unitTable[from];
+                const auto pTo = unitTable[to];
+                if (pFrom && pTo && pFrom->baseUnitId == pTo->baseUnitId) {
+                    unitConversionTable[from * nUnits + to] = pFrom->scale / pTo->scale;
+                }
+            }
+        }
+        // building lookup table for metrics, including data sizes and preferred unit scale
+        for (auto m : GetMetrics()) {
+            const auto id = size_t(m.GetId());
+            if (id >= metricTable.size()) {
+                metricTable.resize(id + 1);
+            }
+            const auto typeInfo = m.GetDataTypeInfo();
+            auto& entry = metricTable[id];
+            entry.pMetric = m.GetBasePtr();
+            entry.polledDataSize = pmon::ipc::intro::GetDataTypeSize(typeInfo.GetPolledType());
+            entry.frameDataSize = pmon::ipc::intro::GetDataTypeSize(typeInfo.GetFrameType());
+            if (m.GetUnit() != m.GetPreferredUnitHint()) {
+                const auto from = size_t(m.GetUnit());
+                const auto to = size_t(m.GetPreferredUnitHint());
+                entry.preferredUnitScale = (from < nUnits && to < nUnits) ?
+                    unitConversionTable[from * nUnits + to] : std::numeric_limits<double>::quiet_NaN();
+            }
         }
     }
 
@@ -492,22 +556,22 @@ namespace pmapi::intro
 
     EnumKeyView Root::FindEnumKey(PM_ENUM enumId, int keyValue) const
     {
-        if (auto i = enumKeyMap.find(MakeEnumKeyMapKey_(enumId, keyValue)); i == enumKeyMap.end()) {
-            throw LookupException{ std::format("unable to find key value={} for enum ID={}", keyValue, (int)enumId) };
-        }
-        else {
-            return { this, i->second };
+        if (size_t(enumId) < enumTable.size()) {
+            const auto& entry = enumTable[size_t(enumId)];
+            const auto offset = int64_t(keyValue) - entry.minKey;
+            if (offset >= 0 && offset < (int64_t)entry.keys.size() && entry.keys[size_t(offset)]) {
+                return { this, entry.keys[size_t(offset)] };
+            }
         }
+        throw LookupException{ std::format("unable to find key value={} for enum ID={}", keyValue, (int)enumId) };
     }
 
     EnumView Root::FindEnum(PM_ENUM enumId) const
     {
-        if (auto i = enumMap.find(enumId); i == enumMap.end()) {
+        if (size_t(enumId) >= enumTable.size() || !enumTable[size_t(enumId)].pEnum) {
             throw LookupException{ std::format("unable to find enum ID={}", (int)enumId) };
         }
-        else {
-            return { this, i->second };
-        }
+        return { this, enumTable[size_t(enumId)].pEnum };
     }
 
     DeviceView Root::FindDevice(uint32_t deviceId) const
@@ -522,28 +586,35 @@ namespace pmapi::intro
 
     MetricView Root::FindMetric(PM_METRIC metricId) const
     {
-        if (auto i = metricMap.find(metricId); i == metricMap.end()) {
-            throw LookupException{ std::format("unable to find metric ID={}", (int)metricId) };
-        }
-        else {
-            return { this, i->second };
-        }
+        return { this, GetMetricEntry_(metricId).pMetric };
     }
 
     UnitView Root::FindUnit(PM_UNIT unitId) const
     {
-        if (auto i = unitMap.find(unitId); i == unitMap.end()) {
+        if (size_t(unitId) >= unitTable.size() || !unitTable[size_t(unitId)]) {
             throw LookupException{ std::format("unable to find unit ID={}", (int)unitId) };
         }
-        else {
-            return { this, i->second };
+        return { this, unitTable[size_t(unitId)] };
+    }
+
+    double Root::GetUnitConversionFactor(PM_UNIT from, PM_UNIT to) const
+    {
+        // lookup both to generate exception if either unit is unknown
+        FindUnit(from);
+        FindUnit(to);
+        const auto factor = unitConversionTable[size_t(from) * unitTable.size() + size_t(to)];
+        if (std::isnan(factor)) {
+            throw std::runtime_error{ "cannot convert incompatible units" };
         }
+        return factor;
     }
 
-    uint64_t Root::MakeEnumKeyMapKey_(PM_ENUM enumId, int keyValue)
+    const Root::MetricEntry_& Root::GetMetricEntry_(PM_METRIC metricId) const
     {
-        // pack 64-bit hash key as upper and lower 32-bit values
-        return (uint64_t(enumId) << 32) | uint64_t(keyValue);
+        if (size_t(metricId) >= metricTable.size() || !metricTable[size_t(metricId)].pMetric) {
+            throw LookupException{ std::format("unable to find metric ID={}", (int)metricId) };
+        }
+        return metricTable[size_t(metricId)];
     }
 
     ViewIterator<EnumView> Root::GetEnumsBegin_() const
@@ -6,6 +6,7 @@
 #include <memory>
 #include <functional>
 #include <unordered_map>
+#include <vector>
 
 namespace pmapi
 {
@@ -298,6 +299,11 @@ namespace pmapi
             ViewRange<StatInfoView> GetStatInfo() const;
             // which devices support this metric
             ViewRange<DeviceMetricInfoView> GetDeviceMetricInfo() const;
+            // size in bytes of the polled (dynamic/static) and frame event data types (from lookup table)
+            size_t GetPolledDataSize() const;
+            size_t GetFrameDataSize() const;
+            // factor converting values in the native unit to the preferred unit hint (from lookup table)
+            double GetPreferredUnitScale() const;
             const SelfType* operator->() const;
             const BaseType* GetBasePtr() const;
         private:
@@ -315,8 +321,11 @@ namespace pmapi
         // provides access to all introspection exposed by the service
         // including enums, metrics, hardware devices, units of measure
         // can iterate or perform lookup via id
+        // lookup tables indexed by id are built once at construction so that Find* are O(1)
         class Root
         {
+            friend class MetricView;
+            friend class UnitView;
         public:
             Root(const PM_INTROSPECTION_ROOT* pRoot_, std::function<void(const PM_INTROSPECTION_ROOT*)> deleter_);
             ~Root();
@@ -331,9 +340,27 @@ namespace pmapi
             DeviceView FindDevice(uint32_t deviceId) const;
             MetricView FindMetric(PM_METRIC metricId) const;
             UnitView FindUnit(PM_UNIT unitId) const;
+            // factor to convert values in unit "from" to unit "to", throws if units are incompatible
+            double GetUnitConversionFactor(PM_UNIT from, PM_UNIT to) const;
         private:
+            // types
+            struct MetricEntry_
+            {
+                const PM_INTROSPECTION_METRIC* pMetric = nullptr;
+                size_t polledDataSize = 0;
+                size_t frameDataSize = 0;
+                // NaN when unit and preferred unit are incompatible
+                double preferredUnitScale = 1.;
+            };
+            struct EnumEntry_
+            {
+                const PM_INTROSPECTION_ENUM* pEnum = nullptr;
+                // keys indexed by (key value - minKey)
+                int minKey = 0;
+                std::vector<const PM_INTROSPECTION_ENUM_KEY*> keys;
+            };
             // functions
-            static uint64_t MakeEnumKeyMapKey_(PM_ENUM enumId, int keyValue);
+            const MetricEntry_& GetMetricEntry_(PM_METRIC metricId) const;
             ViewIterator<EnumView> GetEnumsBegin_() const;
             ViewIterator<EnumView> GetEnumsEnd_() const;
             ViewIterator<MetricView> GetMetricsBegin_() const;
@@ -345,11 +372,12 @@ namespace pmapi
             // data
             const PM_INTROSPECTION_ROOT* pRoot = nullptr;
             std::function<void(const PM_INTROSPECTION_ROOT*)> deleter;
-            std::unordered_map<uint64_t, const PM_INTROSPECTION_ENUM_KEY*> enumKeyMap;
-            std::unordered_map<PM_ENUM, const PM_INTROSPECTION_ENUM*> enumMap;
+            std::vector<EnumEntry_> enumTable;
             std::unordered_map<uint32_t, const PM_INTROSPECTION_DEVICE*> deviceMap;
-            std::unordered_map<PM_METRIC, const PM_INTROSPECTION_METRIC*> metricMap;
-            std::unordered_map<PM_UNIT, const PM_INTROSPECTION_UNIT*> unitMap;
+            std::vector<MetricEntry_> metricTable;
+            std::vector<const PM_INTROSPECTION_UNIT*> unitTable;
+            // unitTable.size() squared matrix [from][to], NaN for incompatible units
+            std::vector<double> unitConversionTable;
         };
     }
 }
\ No newline at end of file
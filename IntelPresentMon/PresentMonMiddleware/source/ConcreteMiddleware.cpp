@@ -8,6 +8,9 @@
 #include <cstdlib>
 #include <Shlwapi.h>
 #include <numeric>
+#include <algorithm>
+#include <ranges>
+#include <chrono>
 #include "../../PresentMonUtils/NamedPipeHelper.h"
 #include "../../PresentMonUtils/QPCUtils.h"
 #include "../../PresentMonAPI2/Internal.h"
@@ -79,7 +82,24 @@ namespace pmon::mid
         clientProcessId = GetCurrentProcessId();
         // connect to the introspection nsm
         pComms = ipc::MakeMiddlewareComms(std::move(introNsmOverride));
+        CacheGpuDevices();
+        // Update the static GPU metric data from the service
+        GetStaticGpuMetrics();
+        GetStaticCpuMetrics();
+	}
 
+    ConcreteMiddleware::ConcreteMiddleware(DetachedTag, std::string introNsm)
+    {
+        clientProcessId = GetCurrentProcessId();
+        pComms = ipc::MakeMiddlewareComms(std::move(introNsm));
+        CacheGpuDevices();
+    }
+
+    
+    ConcreteMiddleware::~ConcreteMiddleware() = default;
+
+    void ConcreteMiddleware::CacheGpuDevices()
+    {
         // Get the introspection data
         auto& ispec = GetIntrospectionRoot();
         
@@ -93,12 +113,7 @@ namespace pmon::mid
                 gpuAdapterId++;
             }
         }
-        // Update the static GPU metric data from the service
-        GetStaticGpuMetrics();
-        GetStaticCpuMetrics();
-	}
-    
-    ConcreteMiddleware::~ConcreteMiddleware() = default;
+    }
     
     const PM_INTROSPECTION_ROOT* ConcreteMiddleware::GetIntrospectionData()
     {
@@ -107,7 +122,7 @@ namespace pmon::mid
 
     void ConcreteMiddleware::FreeIntrospectionData(const PM_INTROSPECTION_ROOT* pRoot)
     {
-        free(const_cast<PM_INTROSPECTION_ROOT*>(pRoot));
+        pComms->FreeIntrospectionRoot(pRoot);
     }
 
 	void ConcreteMiddleware::Speak(char* buffer) const
@@ -168,6 +183,7 @@ namespace pmon::mid
 
     PM_STATUS ConcreteMiddleware::CallPmService(MemBuffer* requestBuffer, MemBuffer* responseBuffer)
     {
+        std::lock_guard lk{ pipeMutex };
         PM_STATUS status;
 
         status = SendRequest(requestBuffer);
@@ -183,13 +199,13 @@ namespace pmon::mid
         return status;
     }
 
-    PM_STATUS ConcreteMiddleware::StartStreaming(uint32_t processId)
+    PM_STATUS ConcreteMiddleware::StartStreaming(uint32_t processId, uint32_t capacityFrames)
     {
         MemBuffer requestBuffer;
         MemBuffer responseBuffer;
 
         NamedPipeHelper::EncodeStartStreamingRequest(&requestBuffer, clientProcessId,
-            processId, nullptr);
+            processId, nullptr, capacityFrames);
 
         PM_STATUS status = CallPmService(&requestBuffer, &responseBuffer);
         if (status != PM_STATUS::PM_STATUS_SUCCESS) {
@@ -208,12 +224,13 @@ namespace pmon::mid
         std::string mapFileName(startStreamResponse.fileName);
 
         // Initialize client with returned mapfile name
+        std::lock_guard lk{ streamsMutex };
         auto iter = presentMonStreamClients.find(processId);
         if (iter == presentMonStreamClients.end()) {
             try {
-                std::unique_ptr<StreamClient> client =
-                    std::make_unique<StreamClient>(std::move(mapFileName), false);
-                presentMonStreamClients.emplace(processId, std::move(client));
+                auto pStream = std::make_shared<ProcessStream>();
+                pStream->pClient = std::make_unique<StreamClient>(std::move(mapFileName), false);
+                presentMonStreamClients.emplace(processId, std::move(pStream));
             }
             catch (...) {
                 return PM_STATUS::PM_STATUS_FAILURE;
@@ -243,9 +260,20 @@ namespace pmon::mid
         }
 
         // Remove client
-        auto iter = presentMonStreamClients.find(processId);
-        if (iter != presentMonStreamClients.end()) {
-            presentMonStreamClients.erase(std::move(iter));
+        {
+            std::lock_guard lk{ streamsMutex };
+            auto iter = presentMonStreamClients.find(processId);
+            if (iter != presentMonStreamClients.end()) {
+                presentMonStreamClients.erase(std::move(iter));
+            }
+        }
+
+        // Drop the state each query kept for polling the process
+        {
+            std::lock_guard lk{ dynamicQueriesMutex };
+            for (auto pQuery : dynamicQueries) {
+                pQuery->EraseProcessState(processId);
+            }
         }
 
         return status;
@@ -529,7 +557,7 @@ namespace pmon::mid
             }
 
             qe.dataOffset = offset;
-            qe.dataSize = GetDataTypeSize(metricView.GetDataTypeInfo().GetPolledType());
+            qe.dataSize = metricView.GetPolledDataSize();
             offset += qe.dataSize;
         }
 
@@ -542,9 +570,29 @@ namespace pmon::mid
             pQuery->cachedGpuInfoIndex = cachedGpuInfoIndex.value();
         }
 
+        // track the query so its per-process state can be pruned when a process stops streaming
+        std::lock_guard lk{ dynamicQueriesMutex };
+        dynamicQueries.insert(pQuery.get());
         return pQuery.release();
     }
 
+    PM_DYNAMIC_QUERY* ConcreteMiddleware::RegisterDynamicQueryMultiWindow(std::span<PM_QUERY_ELEMENT> queryElements, std::span<const double> elementWindowSizesMs, double metricOffsetMs)
+    {
+        if (elementWindowSizesMs.size() != queryElements.size() ||
+            std::ranges::any_of(elementWindowSizesMs, [](double w) { return !(w > 0.); })) {
+            throw std::runtime_error{ "Bad window size in multi-window dynamic query specification" };
+        }
+        const auto pQuery = RegisterDynamicQuery(queryElements, std::ranges::max(elementWindowSizesMs), metricOffsetMs);
+        try {
+            pQuery->SetElementWindows(elementWindowSizesMs);
+        }
+        catch (...) {
+            FreeDynamicQuery(pQuery);
+            throw;
+        }
+        return pQuery;
+    }
+
 namespace {
 
 struct FakePMTraceSession {
@@ -659,8 +707,6 @@ void ReportMetrics(
 
     void ConcreteMiddleware::PollDynamicQuery(const PM_DYNAMIC_QUERY* pQuery, uint32_t processId, uint8_t* pBlob, uint32_t* numSwapChains)
     {
-        std::unordered_map<uint64_t, fpsSwapChainData> swapChainData;
-        std::unordered_map<PM_METRIC, MetricInfo> metricInfo;
         bool allMetricsCalculated = false;
         bool fpsMetricsCalculated = false;
 
@@ -670,22 +716,18 @@ void ReportMetrics(
 
         if (pQuery->cachedGpuInfoIndex.has_value())
         {
-            if (pQuery->cachedGpuInfoIndex.value() != currentGpuInfoIndex)
-            {
-                // Set the adapter id 
-                SetActiveGraphicsAdapter(cachedGpuInfo[pQuery->cachedGpuInfoIndex.value()].deviceId);
-                // Set the current index to the queried one
-                currentGpuInfoIndex = pQuery->cachedGpuInfoIndex.value();
-            }
+            // Set the adapter id (does nothing if it is already the active one)
+            SetActiveGraphicsAdapter(cachedGpuInfo[pQuery->cachedGpuInfoIndex.value()].deviceId);
         }
 
-        auto iter = presentMonStreamClients.find(processId);
-        if (iter == presentMonStreamClients.end()) {
+        const auto pStream = FindProcessStream(processId);
+        if (!pStream) {
             return;
         }
+        std::shared_lock streamLock{ pStream->mutex };
 
         // Get the named shared memory associated with the stream client
-        StreamClient* client = iter->second.get();
+        StreamClient* client = pStream->pClient.get();
         auto nsm_view = client->GetNamedSharedMemView();
         auto nsm_hdr = nsm_view->GetHeader();
         if (!nsm_hdr->process_active) {
@@ -700,14 +742,16 @@ void ReportMetrics(
 
         uint64_t index = 0;
         double adjusted_window_size_in_ms = pQuery->windowSizeMs;
-        auto result = queryFrameDataDeltas.emplace(std::pair(std::pair(pQuery, processId), uint64_t()));
-        auto queryToFrameDataDelta = &result.first->second;
+        const auto pProcessState = pQuery->GetProcessState(processId);
+        auto& processState = *pProcessState;
+        std::lock_guard processStateLock{ processState.mutex };
         
-        PmNsmFrameData* frame_data = GetFrameDataStart(client, index, SecondsDeltaToQpc(pQuery->metricOffsetMs/1000., client->GetQpcFrequency()), *queryToFrameDataDelta, adjusted_window_size_in_ms);
+        PmNsmFrameData* frame_data = GetFrameDataStart(client, index, SecondsDeltaToQpc(pQuery->metricOffsetMs/1000., client->GetQpcFrequency()), processState.frameDataDelta, adjusted_window_size_in_ms);
         if (frame_data == nullptr) {
-            CopyMetricCacheToBlob(pQuery, processId, pBlob);
+            CopyMetricCacheToBlob(pQuery, pQuery->elements, processState, pBlob);
             return;
         }
+        const uint64_t newestQpc = frame_data->present_event.PresentStartTime;
 
         // Calculate the end qpc based on the current frame's qpc and
         // requested window size coverted to a qpc
@@ -732,36 +776,130 @@ void ReportMetrics(
             }
         }
 
-        FakePMTraceSession pmSession;
-        pmSession.mMilliSecondsPerQpc = 1000.0 / client->GetQpcFrequency().QuadPart;
+        // accumulate oldest first
+        std::ranges::reverse(frames);
+        // every window is shortened by the same amount as the largest one when the
+        // metric offset reaches past the newest frame
+        PollFrames(pQuery, processState, frames, newestQpc, pQuery->windowSizeMs - adjusted_window_size_in_ms,
+            pBlob, numSwapChains, client->GetQpcFrequency());
+    }
 
-        for (const auto& frame_data : frames | std::views::reverse) {
-            if (pQuery->accumFpsData)
-            {
-                auto result = swapChainData.emplace(
-                    frame_data->present_event.SwapChainAddress, fpsSwapChainData());
-                auto swap_chain = &result.first->second;
-
-                auto presentEvent = &frame_data->present_event;
-                auto chain = swap_chain;
-                if (!chain->mPresentInfoValid) {
-                    UpdateChain(chain, *presentEvent);
-                } else
-                if (presentEvent->FinalState == PresentResult::Presented) {
-                    for (auto const& pp : chain->mPendingPresents) {
-                        ReportMetrics(pmSession, chain, pp, presentEvent);
+    void ConcreteMiddleware::PollFrames(const PM_DYNAMIC_QUERY* pQuery, PM_DYNAMIC_QUERY::ProcessState& processState, std::span<PmNsmFrameData* const> frames, uint64_t newestQpc, double windowTrimMs, uint8_t* pBlob, uint32_t* numSwapChains, LARGE_INTEGER qpcFrequency)
+    {
+        if (!pQuery->windowGroups.empty()) {
+            PollWindowGroups(pQuery, processState, frames, newestQpc, windowTrimMs, pBlob, numSwapChains, qpcFrequency);
+            return;
+        }
+        std::unordered_map<uint64_t, fpsSwapChainData> swapChainData;
+        std::unordered_map<PM_METRIC, MetricInfo> metricInfo;
+        AccumulateFrames(pQuery, frames, qpcFrequency, swapChainData, metricInfo);
+
+        CalculateMetrics(pQuery, pQuery->elements, processState, pBlob, numSwapChains, qpcFrequency, swapChainData, metricInfo);
+    }
+
+    void ConcreteMiddleware::PollWindowGroups(const PM_DYNAMIC_QUERY* pQuery, PM_DYNAMIC_QUERY::ProcessState& processState, std::span<PmNsmFrameData* const> frames, uint64_t newestQpc, double windowTrimMs, uint8_t* pBlob, uint32_t* numSwapChains, LARGE_INTEGER qpcFrequency)
+    {
+        // The windows all end at the newest frame and so nest inside one another. Telemetry
+        // samples are independent per frame, so they are accumulated once, walking the frames
+        // oldest first and marking how many samples had been gathered on entering each group's
+        // window (largest first); each group then uses only the samples after its mark, copied
+        // out because calculating percentiles sorts them in place.
+        // The fps accumulation is stateful (pending presents, chain validity, first displayed
+        // frame), and a chain that starts at a window boundary does not end in the same state
+        // as one carried into it from an earlier frame, so its state can't be snapshotted at the
+        // boundaries; each group's swap chains are accumulated afresh from the start of its own
+        // window, giving exactly what a poll of just that window would.
+        std::vector<size_t> windowFirstFrame(pQuery->windowGroups.size());
+        std::vector<std::unordered_map<PM_METRIC, std::unordered_map<uint32_t, size_t>>> marks(pQuery->windowGroups.size());
+        std::unordered_map<PM_METRIC, MetricInfo> metricInfo;
+        size_t first = 0;
+        for (size_t i = 0; i < pQuery->windowGroups.size(); i++) {
+            const double windowMs = pQuery->windowGroups[i].windowSizeMs - windowTrimMs;
+            const uint64_t windowQpc = windowMs > 0. ? SecondsDeltaToQpc(windowMs/1000., qpcFrequency) : 0;
+            const uint64_t windowStart = newestQpc > windowQpc ? newestQpc - windowQpc : 0;
+            size_t last = first;
+            while (last < frames.size() && frames[last]->present_event.PresentStartTime <= windowStart) {
+                last++;
+            }
+            AccumulateTelemetryFrames(pQuery, frames.subspan(first, last - first), metricInfo);
+            first = last;
+            windowFirstFrame[i] = first;
+            for (const auto& [metric, info] : metricInfo) {
+                for (const auto& [arrayIndex, samples] : info.data) {
+                    marks[i][metric][arrayIndex] = samples.size();
+                }
+            }
+        }
+        AccumulateTelemetryFrames(pQuery, frames.subspan(first), metricInfo);
+
+        const auto requestedSwapChains = *numSwapChains;
+        for (size_t i = 0; i < pQuery->windowGroups.size(); i++) {
+            std::unordered_map<uint64_t, fpsSwapChainData> windowSwapChainData;
+            if (pQuery->accumFpsData) {
+                AccumulateFpsFrames(frames.subspan(windowFirstFrame[i]), qpcFrequency, windowSwapChainData);
+            }
+            std::unordered_map<PM_METRIC, MetricInfo> windowMetricInfo;
+            for (const auto& [metric, info] : metricInfo) {
+                const auto it = marks[i].find(metric);
+                for (const auto& [arrayIndex, samples] : info.data) {
+                    size_t from = 0;
+                    if (it != marks[i].end()) {
+                        if (const auto itIndex = it->second.find(arrayIndex); itIndex != it->second.end()) {
+                            from = itIndex->second;
+                        }
                     }
-                    chain->mPendingPresents.clear();
-                    chain->mPendingPresents.push_back(*presentEvent);
+                    windowMetricInfo[metric].data[arrayIndex].assign(samples.begin() + from, samples.end());
+                }
+            }
+            // each group reports the swap chains found in its own window
+            uint32_t groupSwapChains = requestedSwapChains;
+            CalculateMetrics(pQuery, pQuery->windowGroups[i].elements, processState, pBlob, &groupSwapChains, qpcFrequency, windowSwapChainData, windowMetricInfo);
+            *numSwapChains = (std::max)(*numSwapChains, groupSwapChains);
+        }
+    }
+
+    void ConcreteMiddleware::AccumulateFrames(const PM_DYNAMIC_QUERY* pQuery, std::span<PmNsmFrameData* const> frames, LARGE_INTEGER qpcFrequency, std::unordered_map<uint64_t, fpsSwapChainData>& swapChainData, std::unordered_map<PM_METRIC, MetricInfo>& metricInfo)
+    {
+        if (pQuery->accumFpsData) {
+            AccumulateFpsFrames(frames, qpcFrequency, swapChainData);
+        }
+        AccumulateTelemetryFrames(pQuery, frames, metricInfo);
+    }
+
+    void ConcreteMiddleware::AccumulateFpsFrames(std::span<PmNsmFrameData* const> frames, LARGE_INTEGER qpcFrequency, std::unordered_map<uint64_t, fpsSwapChainData>& swapChainData)
+    {
+        FakePMTraceSession pmSession;
+        pmSession.mMilliSecondsPerQpc = 1000.0 / qpcFrequency.QuadPart;
+
+        for (const auto& frame_data : frames) {
+            auto result = swapChainData.emplace(
+                frame_data->present_event.SwapChainAddress, fpsSwapChainData());
+            auto swap_chain = &result.first->second;
+
+            auto presentEvent = &frame_data->present_event;
+            auto chain = swap_chain;
+            if (!chain->mPresentInfoValid) {
+                UpdateChain(chain, *presentEvent);
+            } else
+            if (presentEvent->FinalState == PresentResult::Presented) {
+                for (auto const& pp : chain->mPendingPresents) {
+                    ReportMetrics(pmSession, chain, pp, presentEvent);
+                }
+                chain->mPendingPresents.clear();
+                chain->mPendingPresents.push_back(*presentEvent);
+            } else {
+                if (chain->mPendingPresents.empty()) {
+                    ReportMetrics(pmSession, chain, *presentEvent, nullptr);
                 } else {
-                    if (chain->mPendingPresents.empty()) {
-                        ReportMetrics(pmSession, chain, *presentEvent, nullptr);
-                    } else {
-                        chain->mPendingPresents.push_back(*presentEvent);
-                    }
+                    chain->mPendingPresents.push_back(*presentEvent);
                 }
             }
+        }
+    }
 
+    void ConcreteMiddleware::AccumulateTelemetryFrames(const PM_DYNAMIC_QUERY* pQuery, std::span<PmNsmFrameData* const> frames, std::unordered_map<PM_METRIC, MetricInfo>& metricInfo)
+    {
+        for (const auto& frame_data : frames) {
             for (size_t i = 0; i < pQuery->accumGpuBits.size(); ++i) {
                 if (pQuery->accumGpuBits[i])
                 {
@@ -776,8 +914,145 @@ void ReportMetrics(
                 }
             }
         }
+    }
+
+    void ConcreteMiddleware::PollDynamicQueryRange(const PM_DYNAMIC_QUERY* pQuery, uint32_t processId, double sampleIntervalMs, uint8_t* pBlobs, uint32_t& numSamples)
+    {
+        if (!pQuery->windowGroups.empty()) {
+            throw std::runtime_error{ "Multi-window dynamic queries cannot be range polled" };
+        }
+        const auto requestedSamples = numSamples;
+        numSamples = 0;
+        if (requestedSamples == 0) {
+            return;
+        }
+
+        if (pQuery->cachedGpuInfoIndex.has_value())
+        {
+            SetActiveGraphicsAdapter(cachedGpuInfo[pQuery->cachedGpuInfoIndex.value()].deviceId);
+        }
+
+        const auto pStream = FindProcessStream(processId);
+        if (!pStream) {
+            return;
+        }
+        std::shared_lock streamLock{ pStream->mutex };
+        StreamClient* client = pStream->pClient.get();
+        auto nsm_view = client->GetNamedSharedMemView();
+        if (!nsm_view->GetHeader()->process_active) {
+            return;
+        }
+
+        const auto pProcessState = pQuery->GetProcessState(processId);
+        auto& processState = *pProcessState;
+        std::lock_guard processStateLock{ processState.mutex };
+
+        // the newest sample is anchored exactly where PollDynamicQuery would be
+        const auto qpcFrequency = client->GetQpcFrequency();
+        uint64_t index = 0;
+        double newestWindowSizeMs = pQuery->windowSizeMs;
+        PmNsmFrameData* frame_data = GetFrameDataStart(client, index, SecondsDeltaToQpc(pQuery->metricOffsetMs/1000., qpcFrequency), processState.frameDataDelta, newestWindowSizeMs);
+        if (frame_data == nullptr) {
+            return;
+        }
+        const uint64_t newestQpc = frame_data->present_event.PresentStartTime;
+        const uint64_t newestWindowQpc = SecondsDeltaToQpc(newestWindowSizeMs/1000., qpcFrequency);
+        const uint64_t windowQpc = SecondsDeltaToQpc(pQuery->windowSizeMs/1000., qpcFrequency);
+        const uint64_t intervalQpc = SecondsDeltaToQpc(sampleIntervalMs/1000., qpcFrequency);
+        const uint64_t spanQpc = intervalQpc * (requestedSamples - 1) + windowQpc;
+        const uint64_t oldestWindowStart = newestQpc > spanQpc ? newestQpc - spanQpc : 0;
+
+        // read every frame that any sample's window covers in one pass back over the ring
+        std::vector<PmNsmFrameData*> frames;
+        while (frame_data->present_event.PresentStartTime > oldestWindowStart) {
+            frames.push_back(frame_data);
+            if (DecrementIndex(nsm_view, index) == false) {
+                break;
+            }
+            frame_data = client->ReadFrameByIdx(index);
+            if (frame_data == nullptr) {
+                break;
+            }
+        }
+        std::ranges::reverse(frames);
+
+        // slide a window of (sample - windowSize, sample] over the frames; both ends only move forward
+        const auto blobSize = pQuery->GetBlobSize();
+        uint8_t* pBlob = pBlobs;
+        size_t first = 0;
+        size_t last = 0;
+        for (uint32_t i = 0; i < requestedSamples; i++) {
+            const uint64_t offsetQpc = intervalQpc * (requestedSamples - 1 - i);
+            if (offsetQpc >= newestQpc) {
+                continue;
+            }
+            const uint64_t sampleQpc = newestQpc - offsetQpc;
+            const uint64_t sampleWindowQpc = i + 1 == requestedSamples ? newestWindowQpc : windowQpc;
+            const uint64_t windowStart = sampleQpc > sampleWindowQpc ? sampleQpc - sampleWindowQpc : 0;
+            while (last < frames.size() && frames[last]->present_event.PresentStartTime <= sampleQpc) {
+                last++;
+            }
+            while (first < last && frames[first]->present_event.PresentStartTime <= windowStart) {
+                first++;
+            }
+            if (first == last) {
+                // no frames in this window: skip samples from before the history begins,
+                // otherwise hold the previous sample like a poll returning cached metrics
+                if (numSamples > 0) {
+                    std::copy(pBlob - blobSize, pBlob, pBlob);
+                    pBlob += blobSize;
+                    numSamples++;
+                }
+                continue;
+            }
+            std::unordered_map<uint64_t, fpsSwapChainData> swapChainData;
+            std::unordered_map<PM_METRIC, MetricInfo> metricInfo;
+            AccumulateFrames(pQuery, std::span{ frames }.subspan(first, last - first), qpcFrequency, swapChainData, metricInfo);
+            uint32_t numSwapChains = 1;
+            CalculateMetrics(pQuery, pQuery->elements, processState, pBlob, &numSwapChains, qpcFrequency, swapChainData, metricInfo);
+            pBlob += blobSize;
+            numSamples++;
+        }
+    }
+
+    void ConcreteMiddleware::FreeDynamicQuery(const PM_DYNAMIC_QUERY* pQuery)
+    {
+        {
+            std::lock_guard lk{ dynamicQueriesMutex };
+            dynamicQueries.erase(pQuery);
+        }
+        delete pQuery;
+    }
 
-        CalculateMetrics(pQuery, processId, pBlob, numSwapChains, client->GetQpcFrequency(), swapChainData, metricInfo);
+    uint64_t ConcreteMiddleware::GetStreamFrameCount(uint32_t processId)
+    {
+        const auto pStream = FindProcessStream(processId);
+        if (!pStream) {
+            throw std::runtime_error{ "Failed to find stream for pid in GetStreamFrameCount" };
+        }
+        // only the writer's header is read, so sharing the lock with polls is enough
+        std::shared_lock streamLock{ pStream->mutex };
+        return pStream->pClient->GetNamedSharedMemView()->GetHeader()->num_frames_written;
+    }
+
+    uint64_t ConcreteMiddleware::GetStreamFramesLost(uint32_t processId)
+    {
+        const auto pStream = FindProcessStream(processId);
+        if (!pStream) {
+            throw std::runtime_error{ "Failed to find stream for pid in GetStreamFramesLost" };
+        }
+        // the client's count only changes while consuming, under the exclusive lock
+        std::shared_lock streamLock{ pStream->mutex };
+        return pStream->pClient->GetNumFramesLost();
+    }
+
+    std::shared_ptr<ConcreteMiddleware::ProcessStream> ConcreteMiddleware::FindProcessStream(uint32_t processId)
+    {
+        std::shared_lock lk{ streamsMutex };
+        if (auto iter = presentMonStreamClients.find(processId); iter != presentMonStreamClients.end()) {
+            return iter->second;
+        }
+        return {};
     }
 
     std::optional<size_t> ConcreteMiddleware::GetCachedGpuInfoIndex(uint32_t deviceId)
@@ -893,7 +1168,7 @@ void ReportMetrics(
             throw std::runtime_error{ "dynamic metric in static query poll" };
         }
 
-        auto elementSize = GetDataTypeSize(metricView.GetDataTypeInfo().GetPolledType());
+        const auto elementSize = metricView.GetPolledDataSize();
 
         CopyStaticMetricData(element.metric, element.deviceId, pBlob, 0, elementSize);
 
@@ -924,17 +1199,17 @@ void ReportMetrics(
         uint32_t frames_copied = 0;
         numFrames = 0;
 
-        StreamClient* pShmClient = nullptr;
-        try {
-            pShmClient = presentMonStreamClients.at(processId).get();
-        }
-        catch (...) {
+        const auto pStream = FindProcessStream(processId);
+        if (!pStream) {
             LOG(INFO)
                 << "Stream client for process " << processId
                 << " doesn't exist. Please call pmStartStream to initialize the "
                 "client.";
             throw std::runtime_error{ "Failed to find stream for pid in ConsumeFrameEvents" };
         }
+        // consuming advances the stream's read position
+        std::unique_lock streamLock{ pStream->mutex };
+        StreamClient* pShmClient = pStream->pClient.get();
 
         const auto nsm_view = pShmClient->GetNamedSharedMemView();
         const auto nsm_hdr = nsm_view->GetHeader();
@@ -979,6 +1254,177 @@ void ReportMetrics(
         numFrames = frames_copied;
     }
 
+    void ConcreteMiddleware::ConsumeFrameEventsMulti(const PM_FRAME_QUERY* pQuery, std::span<const uint32_t> processIds, bool orderByQpc, uint8_t* pBlobs, uint32_t* pBlobProcessIds, uint32_t& numFrames)
+    {
+        const auto frames_to_copy = numFrames;
+        numFrames = 0;
+
+        // streams are kept in process id order (the map's order), which is also the
+        // order their locks are taken in, so concurrent multi-consumes cannot deadlock
+        std::vector<std::pair<uint32_t, std::shared_ptr<ProcessStream>>> streams;
+        {
+            std::shared_lock lk{ streamsMutex };
+            if (processIds.empty()) {
+                streams.assign(presentMonStreamClients.begin(), presentMonStreamClients.end());
+            }
+            else {
+                for (auto processId : processIds) {
+                    auto iter = presentMonStreamClients.find(processId);
+                    if (iter == presentMonStreamClients.end()) {
+                        throw std::runtime_error{ "Failed to find stream for pid in ConsumeFrameEventsMulti" };
+                    }
+                    streams.emplace_back(*iter);
+                }
+                std::ranges::sort(streams, {}, &decltype(streams)::value_type::first);
+                const auto dupes = std::ranges::unique(streams, {}, &decltype(streams)::value_type::first);
+                streams.erase(dupes.begin(), dupes.end());
+            }
+        }
+
+        struct Source
+        {
+            uint32_t processId;
+            StreamClient* pClient;
+            std::unique_lock<std::shared_mutex> lock;
+            PM_FRAME_QUERY::Context ctx;
+        };
+        std::vector<Source> sources;
+        sources.reserve(streams.size());
+        std::vector<uint32_t> deadProcessIds;
+        for (auto& [processId, pStream] : streams) {
+            std::unique_lock streamLock{ pStream->mutex };
+            StreamClient* pShmClient = pStream->pClient.get();
+            const auto nsm_hdr = pShmClient->GetNamedSharedMemView()->GetHeader();
+            if (!nsm_hdr->process_active) {
+                // unlike a single-process consume, a process that has exited does not fail the batch
+                deadProcessIds.push_back(processId);
+                continue;
+            }
+            // idle streams are skipped on the writer's frame count alone
+            if (pShmClient->GetNumPendingFrames() == 0) {
+                continue;
+            }
+            sources.push_back(Source{ processId, pShmClient, std::move(streamLock),
+                PM_FRAME_QUERY::Context{ nsm_hdr->start_qpc, pShmClient->GetQpcFrequency().QuadPart } });
+        }
+
+        if (!sources.empty()) {
+            // make sure active device is the one referenced in this query
+            if (auto devId = pQuery->GetReferencedDevice()) {
+                SetActiveGraphicsAdapter(*devId);
+            }
+
+            uint32_t frames_copied = 0;
+            const auto consumeFrom = [&](Source& source) {
+                const PmNsmFrameData* pNsmFrameData = nullptr;
+                if (source.pClient->ConsumePtrToNextNsmFrameData(&pNsmFrameData) != PM_STATUS::PM_STATUS_SUCCESS) {
+                    throw std::runtime_error{ "Error while trying to get frame data from shared memory" };
+                }
+                if (!pNsmFrameData) {
+                    return false;
+                }
+                source.ctx.UpdateSourceData(pNsmFrameData,
+                    source.pClient->PeekNextDisplayedFrame(),
+                    source.pClient->PeekPreviousFrame());
+                pQuery->GatherToBlob(source.ctx, pBlobs);
+                pBlobs += pQuery->GetBlobSize();
+                pBlobProcessIds[frames_copied++] = source.processId;
+                return true;
+            };
+
+            if (orderByQpc) {
+                // merge the streams, each already in present order, by peeking at the next
+                // frame of each; linear in the number of streams, which stays small
+                std::vector<const PmNsmFrameData*> nextFrames;
+                for (auto& source : sources) {
+                    nextFrames.push_back(source.pClient->PeekNextNsmFrameData());
+                }
+                while (frames_copied < frames_to_copy) {
+                    std::optional<size_t> oldest;
+                    for (size_t i = 0; i < nextFrames.size(); i++) {
+                        if (nextFrames[i] && (!oldest || nextFrames[i]->present_event.PresentStartTime <
+                            nextFrames[*oldest]->present_event.PresentStartTime)) {
+                            oldest = i;
+                        }
+                    }
+                    if (!oldest || !consumeFrom(sources[*oldest])) {
+                        break;
+                    }
+                    nextFrames[*oldest] = sources[*oldest].pClient->PeekNextNsmFrameData();
+                }
+            }
+            else {
+                for (auto& source : sources) {
+                    while (frames_copied < frames_to_copy && consumeFrom(source)) {}
+                }
+            }
+
+            numFrames = frames_copied;
+        }
+
+        // release the stream locks before stopping the streams of exited processes
+        sources.clear();
+        for (auto processId : deadProcessIds) {
+            StopStreaming(processId);
+        }
+    }
+
+    void ConcreteMiddleware::WaitForFrames(const PM_FRAME_QUERY* pQuery, uint32_t processId, uint32_t minFrames, uint32_t timeoutMs, uint32_t& numFramesAvailable)
+    {
+        using namespace std::chrono_literals;
+        numFramesAvailable = 0;
+
+        const auto pStream = FindProcessStream(processId);
+        if (!pStream) {
+            throw std::runtime_error{ "Failed to find stream for pid in WaitForFrames" };
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds{ timeoutMs };
+        std::shared_ptr<void> frameEvent;
+        while (true) {
+            uint64_t numPending = 0;
+            uint64_t maxPending = 0;
+            {
+                // the stream lock is only held while checking, so that polls of the
+                // process are not blocked for the duration of the wait
+                std::unique_lock streamLock{ pStream->mutex };
+                StreamClient* pShmClient = pStream->pClient.get();
+                const auto nsm_view = pShmClient->GetNamedSharedMemView();
+                const auto nsm_hdr = nsm_view->GetHeader();
+                if (!nsm_hdr->process_active) {
+                    streamLock.unlock();
+                    StopStreaming(processId);
+                    throw std::runtime_error{ "Process died while waiting for frame events" };
+                }
+                frameEvent = nsm_view->GetFrameEvent();
+                // reset before checking, so a frame written after the check sets it again
+                if (frameEvent) {
+                    ResetEvent(frameEvent.get());
+                }
+                numPending = pShmClient->GetNumPendingFrames();
+                // the ring never holds more than this many unconsumed frames
+                maxPending = nsm_hdr->max_entries - 1;
+            }
+            const auto now = std::chrono::steady_clock::now();
+            if (numPending >= (std::min)((uint64_t)minFrames, maxPending) || now >= deadline) {
+                numFramesAvailable = (uint32_t)(std::min)(numPending, maxPending);
+                return;
+            }
+            // Every consumer of the stream resets the same event, so one can swallow
+            // a wake meant for another; waiting in slices bounds the delay that causes.
+            // Services without the event are polled instead.
+            const auto slice = std::chrono::ceil<std::chrono::milliseconds>(
+                (std::min)(std::chrono::steady_clock::duration{ deadline - now },
+                    std::chrono::steady_clock::duration{ frameEvent ? 100ms : 5ms }));
+            if (frameEvent) {
+                WaitForSingleObject(frameEvent.get(), (DWORD)slice.count());
+            }
+            else {
+                Sleep((DWORD)slice.count());
+            }
+        }
+    }
+
     void ConcreteMiddleware::CalculateFpsMetric(fpsSwapChainData& swapChain, const PM_QUERY_ELEMENT& element, uint8_t* pBlob, LARGE_INTEGER qpcFrequency)
     {
         auto& output = reinterpret_cast<double&>(pBlob[element.dataOffset]);
@@ -1468,29 +1914,26 @@ void ReportMetrics(
         return validCpuMetric;
     }
 
-    void ConcreteMiddleware::SaveMetricCache(const PM_DYNAMIC_QUERY* pQuery, uint32_t processId, uint8_t* pBlob)
+    void ConcreteMiddleware::SaveMetricCache(const PM_DYNAMIC_QUERY* pQuery, std::span<const PM_QUERY_ELEMENT> elements, PM_DYNAMIC_QUERY::ProcessState& processState, uint8_t* pBlob)
     {
-        auto it = cachedMetricDatas.find(std::pair(pQuery, processId));
-        if (it != cachedMetricDatas.end())
+        // caller holds the process state's mutex
+        if (!processState.pCachedBlob)
         {
-            auto& uniquePtr = it->second;
-            std::copy(pBlob, pBlob + pQuery->queryCacheSize, uniquePtr.get());
+            processState.pCachedBlob = std::make_unique<uint8_t[]>(pQuery->queryCacheSize);
         }
-        else
-        {
-            auto dataArray = std::make_unique<uint8_t[]>(pQuery->queryCacheSize);
-            std::copy(pBlob, pBlob + pQuery->queryCacheSize, dataArray.get());
-            cachedMetricDatas.emplace(std::pair(pQuery, processId), std::move(dataArray));
+        for (auto& qe : elements) {
+            std::copy(pBlob + qe.dataOffset, pBlob + qe.dataOffset + qe.dataSize, processState.pCachedBlob.get() + qe.dataOffset);
         }
     }
 
-    void ConcreteMiddleware::CopyMetricCacheToBlob(const PM_DYNAMIC_QUERY* pQuery, uint32_t processId, uint8_t* pBlob)
+    void ConcreteMiddleware::CopyMetricCacheToBlob(const PM_DYNAMIC_QUERY* pQuery, std::span<const PM_QUERY_ELEMENT> elements, PM_DYNAMIC_QUERY::ProcessState& processState, uint8_t* pBlob)
     {
-        auto it = cachedMetricDatas.find(std::pair(pQuery, processId));
-        if (it != cachedMetricDatas.end())
+        // caller holds the process state's mutex
+        if (processState.pCachedBlob)
         {
-            auto& uniquePtr = it->second;
-            std::copy(uniquePtr.get(), uniquePtr.get() + pQuery->queryCacheSize, pBlob);
+            for (auto& qe : elements) {
+                std::copy(processState.pCachedBlob.get() + qe.dataOffset, processState.pCachedBlob.get() + qe.dataOffset + qe.dataSize, pBlob + qe.dataOffset);
+            }
         }
     }
 
@@ -1498,17 +1941,18 @@ void ReportMetrics(
     // is encountered it will update the numSwapChains to the correct number and then copy the swap
     // chain frame information with the most presents. If the client does happen to specify two swap
     // chains this code will incorrectly copy the data. WIP.
-    void ConcreteMiddleware::CalculateMetrics(const PM_DYNAMIC_QUERY* pQuery, uint32_t processId, uint8_t* pBlob, uint32_t* numSwapChains, LARGE_INTEGER qpcFrequency, std::unordered_map<uint64_t, fpsSwapChainData>& swapChainData, std::unordered_map<PM_METRIC, MetricInfo>& metricInfo)
+    void ConcreteMiddleware::CalculateMetrics(const PM_DYNAMIC_QUERY* pQuery, std::span<const PM_QUERY_ELEMENT> elements, PM_DYNAMIC_QUERY::ProcessState& processState, uint8_t* pBlob, uint32_t* numSwapChains, LARGE_INTEGER qpcFrequency, std::unordered_map<uint64_t, fpsSwapChainData>& swapChainData, std::unordered_map<PM_METRIC, MetricInfo>& metricInfo)
     {
         // Find the swapchain with the most frame metrics
         uint32_t maxSwapChainPresents = 0;
         uint32_t maxSwapChainPresentsIndex = 0;
         uint32_t currentSwapChainIndex = 0;
-        auto CalcGpuMemUtilization = [this, metricInfo](PM_STAT stat)
+        auto CalcGpuMemUtilization = [this, pQuery, metricInfo](PM_STAT stat)
             {
                 double output = 0.;
-                if (cachedGpuInfo[currentGpuInfoIndex].gpuMemorySize.has_value()) {
-                    auto gpuMemSize = static_cast<double>(cachedGpuInfo[currentGpuInfoIndex].gpuMemorySize.value());
+                if (pQuery->cachedGpuInfoIndex.has_value() &&
+                    cachedGpuInfo[*pQuery->cachedGpuInfoIndex].gpuMemorySize.has_value()) {
+                    auto gpuMemSize = static_cast<double>(cachedGpuInfo[*pQuery->cachedGpuInfoIndex].gpuMemorySize.value());
                     if (gpuMemSize != 0.)
                     {
                         std::vector<double> memoryUtilization;
@@ -1570,7 +2014,7 @@ void ReportMetrics(
             {
                 continue;
             }
-            for (auto& qe : pQuery->elements) {
+            for (auto& qe : elements) {
                 switch (qe.metric)
                 {
                 case PM_METRIC_SWAP_CHAIN_ADDRESS:
@@ -1633,13 +2077,13 @@ void ReportMetrics(
         }
 
         if (useCache == true) {
-            CopyMetricCacheToBlob(pQuery, processId, pBlob);
+            CopyMetricCacheToBlob(pQuery, elements, processState, pBlob);
             return;
         }
 
         if (allMetricsCalculated == false)
         {
-            for (auto& qe : pQuery->elements)
+            for (auto& qe : elements)
             {
                 switch (qe.metric)
                 {
@@ -1701,11 +2145,12 @@ void ReportMetrics(
         }
 
         // Save calculated metrics blob to cache
-        SaveMetricCache(pQuery, processId, pBlob);
+        SaveMetricCache(pQuery, elements, processState, pBlob);
     }
 
     PM_STATUS ConcreteMiddleware::SetActiveGraphicsAdapter(uint32_t deviceId)
     {
+        std::lock_guard lk{ adapterMutex };
         if (activeDevice && *activeDevice == deviceId) {
             return PM_STATUS_SUCCESS;
         }
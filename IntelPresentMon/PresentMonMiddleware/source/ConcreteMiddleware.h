@@ -1,10 +1,16 @@
 #pragma once
 #include "Middleware.h"
+#include "DynamicQuery.h"
 #include "../../Interprocess/source/Interprocess.h"
 #include "../../PresentMonUtils/MemBuffer.h"
 #include "../../Streamer/StreamClient.h"
 #include <optional>
 #include <string>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_set>
 #include "../../CommonUtilities/Hash.h"
 
 namespace pmapi::intro
@@ -78,17 +84,39 @@ namespace pmon::mid
 		void Speak(char* buffer) const override;
 		const PM_INTROSPECTION_ROOT* GetIntrospectionData() override;
 		void FreeIntrospectionData(const PM_INTROSPECTION_ROOT* pRoot) override;
-		PM_STATUS StartStreaming(uint32_t processId) override;
+		PM_STATUS StartStreaming(uint32_t processId, uint32_t capacityFrames) override;
 		PM_STATUS StopStreaming(uint32_t processId) override;
 		PM_STATUS SetTelemetryPollingPeriod(uint32_t deviceId, uint32_t timeMs) override;
+		uint64_t GetStreamFrameCount(uint32_t processId) override;
+		uint64_t GetStreamFramesLost(uint32_t processId) override;
 		PM_DYNAMIC_QUERY* RegisterDynamicQuery(std::span<PM_QUERY_ELEMENT> queryElements, double windowSizeMs, double metricOffsetMs) override;
-		void FreeDynamicQuery(const PM_DYNAMIC_QUERY* pQuery) override {}
+		PM_DYNAMIC_QUERY* RegisterDynamicQueryMultiWindow(std::span<PM_QUERY_ELEMENT> queryElements, std::span<const double> elementWindowSizesMs, double metricOffsetMs) override;
+		void FreeDynamicQuery(const PM_DYNAMIC_QUERY* pQuery) override;
 		void PollDynamicQuery(const PM_DYNAMIC_QUERY* pQuery, uint32_t processId, uint8_t* pBlob, uint32_t* numSwapChains) override;
+		void PollDynamicQueryRange(const PM_DYNAMIC_QUERY* pQuery, uint32_t processId, double sampleIntervalMs, uint8_t* pBlobs, uint32_t& numSamples) override;
 		void PollStaticQuery(const PM_QUERY_ELEMENT& element, uint32_t processId, uint8_t* pBlob) override;
 		PM_FRAME_QUERY* RegisterFrameEventQuery(std::span<PM_QUERY_ELEMENT> queryElements, uint32_t& blobSize) override;
 		void FreeFrameEventQuery(const PM_FRAME_QUERY* pQuery) override;
 		void ConsumeFrameEvents(const PM_FRAME_QUERY* pQuery, uint32_t processId, uint8_t* pBlob, uint32_t& numFrames) override;
+		void WaitForFrames(const PM_FRAME_QUERY* pQuery, uint32_t processId, uint32_t minFrames, uint32_t timeoutMs, uint32_t& numFramesAvailable) override;
+		void ConsumeFrameEventsMulti(const PM_FRAME_QUERY* pQuery, std::span<const uint32_t> processIds, bool orderByQpc, uint8_t* pBlobs, uint32_t* pBlobProcessIds, uint32_t& numFrames) override;
+	protected:
+		// connects only to the introspection nsm, with no service; a derived test fixture can then
+		// register dynamic queries and poll them over frames it supplies through PollFrames
+		struct DetachedTag {};
+		ConcreteMiddleware(DetachedTag, std::string introNsm);
+		// calculates a poll of the query from the frames in its window, oldest first
+		void PollFrames(const PM_DYNAMIC_QUERY* pQuery, PM_DYNAMIC_QUERY::ProcessState& processState, std::span<PmNsmFrameData* const> frames, uint64_t newestQpc, double windowTrimMs, uint8_t* pBlob, uint32_t* numSwapChains, LARGE_INTEGER qpcFrequency);
 	private:
+		void CacheGpuDevices();
+		// A tracked process's stream. Dynamic polls only read the stream and share
+		// its mutex; consuming frame events advances the read position and takes
+		// it exclusively. Held by shared_ptr so that a call in flight keeps the
+		// stream alive if tracking of the process is stopped meanwhile.
+		struct ProcessStream {
+			std::shared_mutex mutex;
+			std::unique_ptr<StreamClient> pClient;
+		};
 		struct HandleDeleter {
 			void operator()(HANDLE handle) const {
 				// Custom deletion logic for HANDLE
@@ -104,6 +132,10 @@ namespace pmon::mid
 		PM_STATUS SetActiveGraphicsAdapter(uint32_t deviceId);
 		void GetStaticGpuMetrics();
 
+		// accumulate frames (oldest first) into per-swap-chain fps data and telemetry samples
+		void AccumulateFrames(const PM_DYNAMIC_QUERY* pQuery, std::span<PmNsmFrameData* const> frames, LARGE_INTEGER qpcFrequency, std::unordered_map<uint64_t, fpsSwapChainData>& swapChainData, std::unordered_map<PM_METRIC, MetricInfo>& metricInfo);
+		void AccumulateFpsFrames(std::span<PmNsmFrameData* const> frames, LARGE_INTEGER qpcFrequency, std::unordered_map<uint64_t, fpsSwapChainData>& swapChainData);
+		void AccumulateTelemetryFrames(const PM_DYNAMIC_QUERY* pQuery, std::span<PmNsmFrameData* const> frames, std::unordered_map<PM_METRIC, MetricInfo>& metricInfo);
 		void CalculateFpsMetric(fpsSwapChainData& swapChain, const PM_QUERY_ELEMENT& element, uint8_t* pBlob, LARGE_INTEGER qpcFrequency);
 		void CalculateGpuCpuMetric(std::unordered_map<PM_METRIC, MetricInfo>& metricInfo, const PM_QUERY_ELEMENT& element, uint8_t* pBlob);
 		void CalculateMetric(double& pBlob, std::vector<double>& inData, PM_STAT stat);
@@ -114,26 +146,33 @@ namespace pmon::mid
 		std::string GetProcessName(uint32_t processId);
 		void CopyStaticMetricData(PM_METRIC metric, uint32_t deviceId, uint8_t* pBlob, uint64_t blobOffset, size_t sizeInBytes = 0);
 
-		void CalculateMetrics(const PM_DYNAMIC_QUERY* pQuery, uint32_t processId, uint8_t* pBlob, uint32_t* numSwapChains, LARGE_INTEGER qpcFrequency, std::unordered_map<uint64_t, fpsSwapChainData>& swapChainData, std::unordered_map<PM_METRIC, MetricInfo>& metricInfo);
-		void SaveMetricCache(const PM_DYNAMIC_QUERY* pQuery, uint32_t processId, uint8_t* pBlob);
-		void CopyMetricCacheToBlob(const PM_DYNAMIC_QUERY* pQuery, uint32_t processId, uint8_t* pBlob);
+		// calculates the given elements of the query (all of them, or one window group's) into the blob
+		void CalculateMetrics(const PM_DYNAMIC_QUERY* pQuery, std::span<const PM_QUERY_ELEMENT> elements, PM_DYNAMIC_QUERY::ProcessState& processState, uint8_t* pBlob, uint32_t* numSwapChains, LARGE_INTEGER qpcFrequency, std::unordered_map<uint64_t, fpsSwapChainData>& swapChainData, std::unordered_map<PM_METRIC, MetricInfo>& metricInfo);
+		void SaveMetricCache(const PM_DYNAMIC_QUERY* pQuery, std::span<const PM_QUERY_ELEMENT> elements, PM_DYNAMIC_QUERY::ProcessState& processState, uint8_t* pBlob);
+		void CopyMetricCacheToBlob(const PM_DYNAMIC_QUERY* pQuery, std::span<const PM_QUERY_ELEMENT> elements, PM_DYNAMIC_QUERY::ProcessState& processState, uint8_t* pBlob);
+		// polls a query registered with per-element windows, frames oldest first
+		void PollWindowGroups(const PM_DYNAMIC_QUERY* pQuery, PM_DYNAMIC_QUERY::ProcessState& processState, std::span<PmNsmFrameData* const> frames, uint64_t newestQpc, double windowTrimMs, uint8_t* pBlob, uint32_t* numSwapChains, LARGE_INTEGER qpcFrequency);
 
 		std::optional<size_t> GetCachedGpuInfoIndex(uint32_t deviceId);
+		std::shared_ptr<ProcessStream> FindProcessStream(uint32_t processId);
 
 		const pmapi::intro::Root& GetIntrospectionRoot();
 
 		std::unique_ptr<void, HandleDeleter> pNamedPipeHandle;
+		// Requests and responses are paired on the one pipe, so service calls serialize
+		std::mutex pipeMutex;
 		uint32_t clientProcessId = 0;
 		// Stream clients mapping to process id
-		std::map<uint32_t, std::unique_ptr<StreamClient>> presentMonStreamClients;
+		std::shared_mutex streamsMutex;
+		std::map<uint32_t, std::shared_ptr<ProcessStream>> presentMonStreamClients;
+		// Dynamic queries registered and not yet freed
+		std::mutex dynamicQueriesMutex;
+		std::unordered_set<const PM_DYNAMIC_QUERY*> dynamicQueries;
 		std::unique_ptr<ipc::MiddlewareComms> pComms;
-		// Dynamic query handle to frame data delta
-		std::unordered_map<std::pair<const PM_DYNAMIC_QUERY*, uint32_t>, uint64_t> queryFrameDataDeltas;
-		// Dynamic query handle to cache data
-		std::unordered_map<std::pair<const PM_DYNAMIC_QUERY*, uint32_t>, std::unique_ptr<uint8_t[]>> cachedMetricDatas;
 		std::vector<DeviceInfo> cachedGpuInfo;
 		std::vector<DeviceInfo> cachedCpuInfo;
-		uint32_t currentGpuInfoIndex = UINT32_MAX;
+		// The service has a single active adapter per client
+		std::mutex adapterMutex;
 		std::optional<uint32_t> activeDevice;
 		std::unique_ptr<pmapi::intro::Root> pIntroRoot;
 	};
@@ -1,7 +1,14 @@
 #pragma once
 #include <vector>
+#include <algorithm>
 #include <bitset>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <unordered_map>
 #include "../../PresentMonAPI2/PresentMonAPI.h"
 #include "../../ControlLib/CpuTelemetryInfo.h"
 #include "../../ControlLib/PresentMonPowerTelemetry.h"
@@ -22,5 +29,53 @@ struct PM_DYNAMIC_QUERY
 	double metricOffsetMs = 0.;
 	size_t queryCacheSize = 0;
 	std::optional<uint32_t> cachedGpuInfoIndex;
+	// Queries registered with a window size per element keep their elements
+	// grouped by window size here, largest window first; windowSizeMs is then
+	// the largest window. Empty for queries with a single window.
+	struct WindowGroup
+	{
+		double windowSizeMs;
+		std::vector<PM_QUERY_ELEMENT> elements;
+	};
+	std::vector<WindowGroup> windowGroups;
+	void SetElementWindows(std::span<const double> elementWindowSizesMs)
+	{
+		for (size_t i = 0; i < elements.size(); i++) {
+			auto it = std::ranges::find(windowGroups, elementWindowSizesMs[i], &WindowGroup::windowSizeMs);
+			if (it == windowGroups.end()) {
+				it = windowGroups.insert(windowGroups.end(), WindowGroup{ elementWindowSizesMs[i] });
+			}
+			it->elements.push_back(elements[i]);
+		}
+		std::ranges::sort(windowGroups, std::greater{}, &WindowGroup::windowSizeMs);
+		windowSizeMs = windowGroups.front().windowSizeMs;
+	}
+	// State carried from one poll of a process to the next. Each process has its
+	// own mutex, held for the whole poll, so a query can be polled for different
+	// processes in parallel while polls of the same process serialize.
+	struct ProcessState
+	{
+		std::mutex mutex;
+		uint64_t frameDataDelta = 0;
+		std::unique_ptr<uint8_t[]> pCachedBlob;
+	};
+	std::shared_ptr<ProcessState> GetProcessState(uint32_t processId) const
+	{
+		std::lock_guard lk{ processStatesMutex };
+		auto& pState = processStates[processId];
+		if (!pState) {
+			pState = std::make_shared<ProcessState>();
+		}
+		return pState;
+	}
+	// called when the process stops streaming; a poll still in flight keeps
+	// its state alive until it returns
+	void EraseProcessState(uint32_t processId) const
+	{
+		std::lock_guard lk{ processStatesMutex };
+		processStates.erase(processId);
+	}
+	mutable std::mutex processStatesMutex;
+	mutable std::unordered_map<uint32_t, std::shared_ptr<ProcessState>> processStates;
 };
 
@@ -12,15 +12,23 @@ namespace pmon::mid
 		virtual void Speak(char* buffer) const = 0;
 		virtual const PM_INTROSPECTION_ROOT* GetIntrospectionData() = 0;
 		virtual void FreeIntrospectionData(const PM_INTROSPECTION_ROOT* pRoot) = 0;
-		virtual PM_STATUS StartStreaming(uint32_t processId) = 0;
+		virtual PM_STATUS StartStreaming(uint32_t processId, uint32_t capacityFrames) = 0;
 		virtual PM_STATUS StopStreaming(uint32_t processId) = 0;
 		virtual PM_STATUS SetTelemetryPollingPeriod(uint32_t deviceId, uint32_t timeMs) = 0;
+		virtual uint64_t GetStreamFrameCount(uint32_t processId) = 0;
+		virtual uint64_t GetStreamFramesLost(uint32_t processId) = 0;
 		virtual PM_DYNAMIC_QUERY* RegisterDynamicQuery(std::span<PM_QUERY_ELEMENT> queryElements, double windowSizeMs, double metricOffsetMs) = 0;
+		virtual PM_DYNAMIC_QUERY* RegisterDynamicQueryMultiWindow(std::span<PM_QUERY_ELEMENT> queryElements, std::span<const double> elementWindowSizesMs, double metricOffsetMs) = 0;
 		virtual void FreeDynamicQuery(const PM_DYNAMIC_QUERY* pQuery) = 0;
 		virtual void PollDynamicQuery(const PM_DYNAMIC_QUERY* pQuery, uint32_t processId, uint8_t* pBlob, uint32_t* numSwapChains) = 0;
+		virtual void PollDynamicQueryRange(const PM_DYNAMIC_QUERY* pQuery, uint32_t processId, double sampleIntervalMs, uint8_t* pBlobs, uint32_t& numSamples) = 0;
 		virtual void PollStaticQuery(const PM_QUERY_ELEMENT& element, uint32_t processId, uint8_t* pBlob) = 0;
 		virtual PM_FRAME_QUERY* RegisterFrameEventQuery(std::span<PM_QUERY_ELEMENT> queryElements, uint32_t& blobSize) { return nullptr; }
 		virtual void FreeFrameEventQuery(const PM_FRAME_QUERY* pQuery) {}
 		virtual void ConsumeFrameEvents(const PM_FRAME_QUERY* pQuery, uint32_t processId, uint8_t* pBlob, uint32_t& numFrames) {}
+		virtual void WaitForFrames(const PM_FRAME_QUERY* pQuery, uint32_t processId, uint32_t minFrames, uint32_t timeoutMs, uint32_t& numFramesAvailable) {}
+		// consume from several tracked processes (all of them when processIds is empty) into one blob array,
+		// writing the process of each blob to pBlobProcessIds; streams are drained in process id order or merged by qpc
+		virtual void ConsumeFrameEventsMulti(const PM_FRAME_QUERY* pQuery, std::span<const uint32_t> processIds, bool orderByQpc, uint8_t* pBlobs, uint32_t* pBlobProcessIds, uint32_t& numFrames) {}
 	};
 }
\ No newline at end of file
@@ -7,12 +7,12 @@
 #include <memory>
 #include <cassert>
 #include <cstdlib>
+#include <optional>
 #include "../../PresentMonAPI2/Internal.h"
 #include "../../PresentMonAPIWrapperCommon/Introspection.h"
 // TODO: don't need transfer if we can somehow get the PM_ struct generation working without inheritance
 // needed right now because even if we forward declare, we don't have the inheritance info
 #include "../../Interprocess/source/IntrospectionTransfer.h"
-#include "../../Interprocess/source/IntrospectionHelpers.h"
 #include "../../Interprocess/source/IntrospectionCloneAllocators.h"
 #include "../../PresentMonUtils/PresentMonNamedPipe.h"
 #include "MockCommon.h"
@@ -45,6 +45,20 @@ namespace pmon::mid
 		strcpy_s(buffer, 256, "mock-middle");
 	}
 
+	PM_STATUS MockMiddleware::StartStreaming(uint32_t processId, uint32_t capacityFrames)
+	{
+		std::lock_guard lk{ frameEventsMutex };
+		trackedProcessIds.insert(processId);
+		return PM_STATUS_SUCCESS;
+	}
+
+	PM_STATUS MockMiddleware::StopStreaming(uint32_t processId)
+	{
+		std::lock_guard lk{ frameEventsMutex };
+		trackedProcessIds.erase(processId);
+		return PM_STATUS_SUCCESS;
+	}
+
 	const PM_INTROSPECTION_ROOT* MockMiddleware::GetIntrospectionData()
 	{
 		return pMiddlewareComms->GetIntrospectionRoot();
@@ -52,7 +66,7 @@ namespace pmon::mid
 
 	void MockMiddleware::FreeIntrospectionData(const PM_INTROSPECTION_ROOT* pRoot)
 	{
-		free(const_cast<PM_INTROSPECTION_ROOT*>(pRoot));
+		pMiddlewareComms->FreeIntrospectionRoot(pRoot);
 	}
 
 	PM_DYNAMIC_QUERY* MockMiddleware::RegisterDynamicQuery(std::span<PM_QUERY_ELEMENT> queryElements, double windowSizeMs, double metricOffsetMs)
@@ -74,7 +88,7 @@ namespace pmon::mid
 			// TODO: validate device id
 			// TODO: validate array index
 			qe.dataOffset = offset;
-			qe.dataSize = GetDataTypeSize(metricView.GetDataTypeInfo().GetPolledType());
+			qe.dataSize = metricView.GetPolledDataSize();
 			offset += qe.dataSize;
 		}
 
@@ -83,17 +97,49 @@ namespace pmon::mid
 		return pQuery.release();
 	}
 
+	PM_DYNAMIC_QUERY* MockMiddleware::RegisterDynamicQueryMultiWindow(std::span<PM_QUERY_ELEMENT> queryElements, std::span<const double> elementWindowSizesMs, double metricOffsetMs)
+	{
+		if (elementWindowSizesMs.size() != queryElements.size() ||
+			std::ranges::any_of(elementWindowSizesMs, [](double w) { return !(w > 0.); })) {
+			throw std::runtime_error{ "Bad window size in multi-window dynamic query specification" };
+		}
+		std::unique_ptr<PM_DYNAMIC_QUERY> pQuery{ RegisterDynamicQuery(queryElements, std::ranges::max(elementWindowSizesMs), metricOffsetMs) };
+		pQuery->SetElementWindows(elementWindowSizesMs);
+		return pQuery.release();
+	}
+
 	void MockMiddleware::FreeDynamicQuery(const PM_DYNAMIC_QUERY* pQuery)
 	{
 		delete pQuery;
 	}
 
 	void MockMiddleware::PollDynamicQuery(const PM_DYNAMIC_QUERY* pQuery, uint32_t processId, uint8_t* pBlob, uint32_t* numSwapChains)
+	{
+		FillBlob(pQuery, t, pBlob);
+	}
+
+	void MockMiddleware::PollDynamicQueryRange(const PM_DYNAMIC_QUERY* pQuery, uint32_t processId, double sampleIntervalMs, uint8_t* pBlobs, uint32_t& numSamples)
+	{
+		// samples that would fall before time zero have no history and are not written
+		const auto now = t.load();
+		const auto requestedSamples = numSamples;
+		numSamples = 0;
+		for (uint32_t i = 0; i < requestedSamples; i++) {
+			const auto offset = sampleIntervalMs * (requestedSamples - 1 - i);
+			if (offset > (double)now) {
+				continue;
+			}
+			FillBlob(pQuery, now - (uint32_t)offset, pBlobs + numSamples * pQuery->GetBlobSize());
+			numSamples++;
+		}
+	}
+
+	void MockMiddleware::FillBlob(const PM_DYNAMIC_QUERY* pQuery, uint32_t time, uint8_t* pBlob) const
 	{
 		for (auto& qe : pQuery->elements) {
 			if (qe.metric == PM_METRIC_PRESENT_MODE) {
 				auto& output = reinterpret_cast<int&>(pBlob[qe.dataOffset]);
-				if (t % 2 == 0) {
+				if (time % 2 == 0) {
 					output = (int)PM_PRESENT_MODE_HARDWARE_LEGACY_FLIP;
 				}
 				else {
@@ -102,7 +148,7 @@ namespace pmon::mid
 			}
 			else {
 				auto& output = reinterpret_cast<double&>(pBlob[qe.dataOffset]);
-				if (t % 2 == 0) {
+				if (time % 2 == 0) {
 					output = (double)qe.metric;
 				}
 				else {
@@ -133,6 +179,7 @@ namespace pmon::mid
 
 	PM_FRAME_QUERY* MockMiddleware::RegisterFrameEventQuery(std::span<PM_QUERY_ELEMENT> queryElements, uint32_t& blobSize)
 	{
+		std::lock_guard lk{ frameEventsMutex };
 		if (!pendingFrameEvents.has_value()) {
 			pendingFrameEvents = std::make_any<std::deque<PmNsmFrameData>>(std::deque<PmNsmFrameData>{
 				PmNsmFrameData{
@@ -179,6 +226,7 @@ namespace pmon::mid
 
 	void MockMiddleware::ConsumeFrameEvents(const PM_FRAME_QUERY* pQuery, uint32_t processId, uint8_t* pBlob, uint32_t& numFrames)
 	{
+		std::lock_guard lk{ frameEventsMutex };
 		auto& frames = std::any_cast<std::deque<PmNsmFrameData>&>(pendingFrameEvents);
 		if (t > 0) {
 			frames.push_back(PmNsmFrameData{
@@ -210,4 +258,34 @@ namespace pmon::mid
 		numFrames = numFramesToProcess;
 	}
 
+	void MockMiddleware::ConsumeFrameEventsMulti(const PM_FRAME_QUERY* pQuery, std::span<const uint32_t> processIds, bool orderByQpc, uint8_t* pBlobs, uint32_t* pBlobProcessIds, uint32_t& numFrames)
+	{
+		// there is a single mock frame source, so its frames are attributed to the lowest process id
+		std::optional<uint32_t> processId;
+		{
+			std::lock_guard lk{ frameEventsMutex };
+			if (processIds.empty()) {
+				if (!trackedProcessIds.empty()) {
+					processId = *trackedProcessIds.begin();
+				}
+			}
+			else {
+				processId = std::ranges::min(processIds);
+			}
+		}
+		if (!processId) {
+			numFrames = 0;
+			return;
+		}
+		ConsumeFrameEvents(pQuery, *processId, pBlobs, numFrames);
+		std::fill_n(pBlobProcessIds, numFrames, *processId);
+	}
+
+	void MockMiddleware::WaitForFrames(const PM_FRAME_QUERY* pQuery, uint32_t processId, uint32_t minFrames, uint32_t timeoutMs, uint32_t& numFramesAvailable)
+	{
+		// mock frames only arrive when consumed, so there is nothing to wait for
+		std::lock_guard lk{ frameEventsMutex };
+		numFramesAvailable = (uint32_t)std::any_cast<std::deque<PmNsmFrameData>&>(pendingFrameEvents).size();
+	}
+
 }
\ No newline at end of file
@@ -2,6 +2,9 @@
 #include "Middleware.h"
 #include "../../Interprocess/source/Interprocess.h"
 #include <any>
+#include <atomic>
+#include <mutex>
+#include <set>
 
 namespace pmon::mid
 {
@@ -14,21 +17,34 @@ namespace pmon::mid
 		void Speak(char* buffer) const override;
 		const PM_INTROSPECTION_ROOT* GetIntrospectionData() override;
 		void FreeIntrospectionData(const PM_INTROSPECTION_ROOT* pRoot) override;
-		PM_STATUS StartStreaming(uint32_t processId) override { return PM_STATUS_SUCCESS; }
-		PM_STATUS StopStreaming(uint32_t processId) override { return PM_STATUS_SUCCESS; }
+		PM_STATUS StartStreaming(uint32_t processId, uint32_t capacityFrames) override;
+		PM_STATUS StopStreaming(uint32_t processId) override;
 		PM_STATUS SetTelemetryPollingPeriod(uint32_t deviceId, uint32_t timeMs) override { return PM_STATUS_SUCCESS; }
+		// the mock writes one frame per millisecond of mock time
+		uint64_t GetStreamFrameCount(uint32_t processId) override { return t; }
+		// mock frames are never overwritten
+		uint64_t GetStreamFramesLost(uint32_t processId) override { return 0; }
 		PM_DYNAMIC_QUERY* RegisterDynamicQuery(std::span<PM_QUERY_ELEMENT> queryElements, double windowSizeMs, double metricOffsetMs) override;
+		PM_DYNAMIC_QUERY* RegisterDynamicQueryMultiWindow(std::span<PM_QUERY_ELEMENT> queryElements, std::span<const double> elementWindowSizesMs, double metricOffsetMs) override;
 		void FreeDynamicQuery(const PM_DYNAMIC_QUERY* pQuery) override;
 		void PollDynamicQuery(const PM_DYNAMIC_QUERY* pQuery, uint32_t processId, uint8_t* pBlob, uint32_t* numSwapChains) override;
+		void PollDynamicQueryRange(const PM_DYNAMIC_QUERY* pQuery, uint32_t processId, double sampleIntervalMs, uint8_t* pBlobs, uint32_t& numSamples) override;
 		void PollStaticQuery(const PM_QUERY_ELEMENT& element, uint32_t processId, uint8_t* pBlob) override;
 		PM_FRAME_QUERY* RegisterFrameEventQuery(std::span<PM_QUERY_ELEMENT> queryElements, uint32_t& blobSize) override;
 		void FreeFrameEventQuery(const PM_FRAME_QUERY* pQuery) override;
 		void ConsumeFrameEvents(const PM_FRAME_QUERY* pQuery, uint32_t processId, uint8_t* pBlob, uint32_t& numFrames) override;
+		void WaitForFrames(const PM_FRAME_QUERY* pQuery, uint32_t processId, uint32_t minFrames, uint32_t timeoutMs, uint32_t& numFramesAvailable) override;
+		void ConsumeFrameEventsMulti(const PM_FRAME_QUERY* pQuery, std::span<const uint32_t> processIds, bool orderByQpc, uint8_t* pBlobs, uint32_t* pBlobProcessIds, uint32_t& numFrames) override;
 		// data
 		static constexpr const char* mockIntrospectionNsmName = "pm_api2_intro_nsm_mock";
 	private:
-		uint32_t t = 0;
+		// write the values the mock reports at the given time
+		void FillBlob(const PM_DYNAMIC_QUERY* pQuery, uint32_t time, uint8_t* pBlob) const;
+		std::atomic<uint32_t> t = 0;
+		// frame events are shared by all frame queries of the session
+		std::mutex frameEventsMutex;
 		std::any pendingFrameEvents;
+		std::set<uint32_t> trackedProcessIds;
 		bool holdoffReleased = false;
 		std::unique_ptr<ipc::ServiceComms> pServiceComms;
 		std::unique_ptr<ipc::MiddlewareComms> pMiddlewareComms;
@@ -12,7 +12,13 @@ namespace clio
 		Option<std::string> controlPipe{ this, "--control-pipe", "", "Name of the named pipe to use for the client-service control channel" };
 		Option<std::string> nsmPrefix{ this, "--nsm-prefix", "", "Prefix to use when naming named shared memory segments created for frame data circular buffers" };
 		Option<std::string> introNsm{ this, "--intro-nsm", "", "Name of the NSM used for introspection data" };
+		Option<int> nsmMinFrames{ this, "--nsm-min-frames", 60, "Smallest frame ring capacity a client may request when it starts streaming" };
+		Option<int> nsmMaxFrames{ this, "--nsm-max-frames", 0, "Largest frame ring capacity a client may request when it starts streaming (0 for the largest the service supports)" };
+		Option<long long> etlWriteTimeoutMs{ this, "--etl-write-timeout-ms", 500, "Time in milliseconds an offline ETL frame write may wait for the client to drain a full stream before timing out" };
 		Option<long long> timedStop{ this, "--timed-stop", -1, "Signal stop event after specified number of milliseconds" };
+		Option<std::string> simTelemetry{ this, "--sim-telemetry", "", "Replace vendor gpu and cpu telemetry with playback of the specified script file (\"default\" for built-in waveforms)" };
+		Option<int> simAdapters{ this, "--sim-adapters", 1, "Number of adapters to create when simulating telemetry" };
+		Option<double> simLatencyMs{ this, "--sim-latency-ms", 0., "Time in milliseconds spent in each simulated telemetry sample, emulating driver query cost" };
 		static constexpr const char* description = "Intel PresentMon service for frame and system performance measurement";
 		static constexpr const char* name = "PresentMonService.exe";
 	};
@@ -18,7 +18,8 @@ bool EncodeStartStream(PresentMon* pm, MemBuffer* rqstBuf, MemBuffer* rspBuf) {
   std::string nsmFileName;
   if (genRqstInfo->etlFileNameLength == 0) {
     rspStatus = pm->StartStreaming(genRqstInfo->clientProcessId,
-                                   genRqstInfo->targetProcessId, nsmFileName);
+                                   genRqstInfo->targetProcessId, nsmFileName,
+                                   genRqstInfo->ringCapacityFrames);
   } else {
     std::wstring wetlFileName(genRqstInfo->etlFileName, genRqstInfo->etlFileName + strlen(genRqstInfo->etlFileName));
     rspStatus = pm->ProcessEtlFile(genRqstInfo->clientProcessId, wetlFileName, nsmFileName);
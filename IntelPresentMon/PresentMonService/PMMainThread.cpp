@@ -5,6 +5,7 @@
 #include "PresentMon.h"
 #include "PowerTelemetryContainer.h"
 #include "..\ControlLib\WmiCpu.h"
+#include "..\ControlLib\SimulatedCpu.h"
 #include "..\PresentMonUtils\StringUtils.h"
 #include <filesystem>
 #include "../Interprocess/source/Interprocess.h"
@@ -291,6 +292,29 @@ void PresentMonMainThread(Service* const pSvc)
             return;
         }
 
+        // optionally replace vendor telemetry with scripted playback
+        std::optional<pwr::sim::SimulatedTelemetryConfig> simConfig;
+        if (opt.simTelemetry) {
+            try {
+                simConfig.emplace();
+                simConfig->pScript = *opt.simTelemetry == "default" ?
+                    pwr::sim::TelemetryScript::MakeDefault() :
+                    pwr::sim::TelemetryScript::Load(*opt.simTelemetry);
+                simConfig->adapterCount = *opt.simAdapters > 0 ? (uint32_t)*opt.simAdapters : 0u;
+                simConfig->samplingLatencyMs = *opt.simLatencyMs;
+                // scripts that do not name a vendor simulate intel adapters
+                simConfig->vendor = simConfig->pScript->GetVendor().value_or(PM_DEVICE_VENDOR_INTEL);
+                ptc.SetSimulatedTelemetry(*simConfig);
+                LOG(INFO) << "Using simulated telemetry: " << *opt.simTelemetry;
+            }
+            catch (const std::exception& e) {
+                LOG(ERROR) << "Failed loading simulated telemetry script> " << e.what() << std::endl;
+                google::FlushLogFiles(0);
+                pSvc->SignalServiceStop(-1);
+                return;
+            }
+        }
+
         // Set the created power telemetry container 
         pm.SetPowerTelemetryContainer(&ptc);
 
@@ -307,8 +331,13 @@ void PresentMonMainThread(Service* const pSvc)
         // Create CPU telemetry
         std::shared_ptr<pwr::cpu::CpuTelemetry> cpu;
         try {
-            // Try to use WMI for metrics sampling
-            cpu = std::make_shared<pwr::cpu::wmi::WmiCpu>();
+            if (simConfig) {
+                cpu = std::make_shared<pwr::cpu::sim::SimulatedCpu>(*simConfig);
+            }
+            else {
+                // Try to use WMI for metrics sampling
+                cpu = std::make_shared<pwr::cpu::wmi::WmiCpu>();
+            }
         }
         catch (const std::runtime_error& e) {
             LOG(ERROR) << "failed creating wmi cpu telemetry thread; Status: " << e.what() << std::endl;
@@ -13,16 +13,21 @@ bool PowerTelemetryContainer::Repopulate() {
     telemetry_adapters_.clear();
 
     // create providers
-    for (int iVendor = 0; iVendor < int(PM_DEVICE_VENDOR_UNKNOWN); iVendor++) {
-      try {
-        if (auto pProvider = pwr::PowerTelemetryProviderFactory::Make(
-                PM_DEVICE_VENDOR(iVendor))) {
-          telemetry_providers_.push_back(std::move(pProvider));
+    if (simulated_config_) {
+      telemetry_providers_.push_back(
+          pwr::PowerTelemetryProviderFactory::MakeSimulated(*simulated_config_));
+    } else {
+      for (int iVendor = 0; iVendor < int(PM_DEVICE_VENDOR_UNKNOWN); iVendor++) {
+        try {
+          if (auto pProvider = pwr::PowerTelemetryProviderFactory::Make(
+                  PM_DEVICE_VENDOR(iVendor))) {
+            telemetry_providers_.push_back(std::move(pProvider));
+          }
+        } catch (const std::runtime_error& e) {
+          LOG(INFO) << "Power Telemetry Failure: " << e.what() << std::endl;
+        } catch (...) {
+          LOG(INFO) << "Unknown Telemetry Failure.";
         }
-      } catch (const std::runtime_error& e) {
-        LOG(INFO) << "Power Telemetry Failure: " << e.what() << std::endl;
-      } catch (...) {
-        LOG(INFO) << "Unknown Telemetry Failure.";
       }
     }
     // collect all adapters together from providers
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: MIT
 #pragma once
 #include "../ControlLib/PowerTelemetryProviderFactory.h"
+#include <optional>
 
 class PowerTelemetryContainer {
  public:
@@ -10,7 +11,12 @@ class PowerTelemetryContainer {
     return telemetry_adapters_;
   }
   bool Repopulate();
+  // when set, Repopulate creates adapters from the simulated backend instead of vendor libraries
+  void SetSimulatedTelemetry(pwr::sim::SimulatedTelemetryConfig config) {
+    simulated_config_ = std::move(config);
+  }
  private:
+  std::optional<pwr::sim::SimulatedTelemetryConfig> simulated_config_;
   std::vector<std::unique_ptr<pwr::PowerTelemetryProvider>> telemetry_providers_;
   std::vector<std::shared_ptr<pwr::PowerTelemetryAdapter>> telemetry_adapters_;
 };
\ No newline at end of file
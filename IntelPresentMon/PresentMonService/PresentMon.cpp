@@ -4,10 +4,15 @@
 
 #include <VersionHelpers.h>
 #include <shlwapi.h>
+#include <algorithm>
 #include <span>
+#include <glog/logging.h>
+#include "../CommonUtilities/str/String.h"
 
 static const std::wstring kEtlSessionName = L"ETLProcessing";
 static const std::wstring kRealTimeSessionName = L"PMService";
+// How often the output thread logs a summary of the consumer stats
+static const ULONGLONG kConsumerStatsLogPeriodMs = 60000;
 
 PresentMonSession::PresentMonSession()
     : target_process_count_(0),
@@ -104,10 +109,49 @@ void PresentMonSession::StopTraceSession() {
   }
 
   if (pm_consumer_) {
+    LogConsumerStats(true);
     pm_consumer_.reset();
   }
 }
 
+void PresentMonSession::LogConsumerStats(bool detailed) {
+  auto stats = std::make_unique<ConsumerStatsSnapshot>();
+  pm_consumer_->GetStats(stats.get());
+
+  uint64_t lost_presents = 0;
+  for (size_t i = 0; i < (size_t)LostPresentReason::Count; ++i) {
+    lost_presents += stats->mLostPresentCount[i];
+  }
+
+  LARGE_INTEGER frequency{};
+  QueryPerformanceFrequency(&frequency);
+  double avg_handler_us =
+      stats->mSampledEventCount == 0
+          ? 0.0
+          : 1000000.0 * stats->mHandlerTime /
+                (stats->mSampledEventCount * (double)frequency.QuadPart);
+
+  LOG(INFO) << "Trace session " << util::str::ToNarrow(pm_session_name_)
+            << " consumed " << stats->mTotalEventCount << " events, "
+            << avg_handler_us << "us average handling time, "
+            << lost_presents << " lost presents, "
+            << stats->mRealtimeLostEvents << " realtime lost events";
+  if (!detailed) {
+    return;
+  }
+  for (size_t i = 0; i < (size_t)TrackingCollection::Count; ++i) {
+    LOG(INFO) << "  " << TrackingCollectionToString((TrackingCollection)i)
+              << " peak size: " << stats->mTrackingSizePeak[i];
+  }
+  for (size_t i = 0; i < (size_t)LostPresentReason::Count; ++i) {
+    LOG(INFO) << "  Lost presents (" << LostPresentReasonToString((LostPresentReason)i)
+              << "): " << stats->mLostPresentCount[i];
+  }
+  LOG(INFO) << "  Realtime losses: events=" << stats->mRealtimeLostEvents
+            << " buffers=" << stats->mRealtimeLostBuffers
+            << " files=" << stats->mRealtimeLostFiles;
+}
+
 PM_STATUS PresentMonSession::ProcessEtlFile(uint32_t client_process_id,
                                             const std::wstring& etl_file_name,
                                             std::string& nsm_file_name) {
@@ -233,6 +277,9 @@ void PresentMonSession::InitProcessInfo(ProcessInfo* processInfo, uint32_t proce
 void PresentMonSession::UpdateProcesses(
     std::vector<ProcessEvent> const& processEvents,
     std::vector<std::pair<uint32_t, uint64_t>>* terminatedProcesses) {
+  // processEvents is in QpcTime order, so the terminations appended here are
+  // too and only need to be merged with the pending ones.
+  const auto pendingCount = terminatedProcesses->size();
   for (auto const& processEvent : processEvents) {
     if (processEvent.IsStartEvent) {
       // This event is a new process starting, the pid should not already be
@@ -252,6 +299,23 @@ void PresentMonSession::UpdateProcesses(
                                         processEvent.QpcTime);
     }
   }
+  MergeTerminatedProcesses(terminatedProcesses, pendingCount);
+}
+
+// Merge the QPC-ordered terminations appended after pendingCount into the
+// QPC-ordered pending terminations, so that terminatedProcesses can be swept
+// once alongside the present events.
+void PresentMonSession::MergeTerminatedProcesses(
+    std::vector<std::pair<uint32_t, uint64_t>>* terminatedProcesses,
+    size_t pendingCount) {
+  const auto mid = terminatedProcesses->begin() + pendingCount;
+  if (mid == terminatedProcesses->begin() ||
+      mid == terminatedProcesses->end() || (mid - 1)->second <= mid->second) {
+    return;
+  }
+  std::inplace_merge(
+      terminatedProcesses->begin(), mid, terminatedProcesses->end(),
+      [](auto const& a, auto const& b) { return a.second < b.second; });
 }
 
 void PresentMonSession::AddPresents(
@@ -399,10 +463,11 @@ void PresentMonSession::ProcessEvents(
   size_t presentEventIndex = 0;
   size_t terminatedProcessIndex = 0;
 
-  // Iterate through the terminated process history. If we hit a present that
-  // started after the termination, we can handle the process termination and
-  // continue. Otherwise, we're done handling all the presents and any
-  // outstanding terminations will have to wait for the next batch of events.
+  // Sweep forward through the QPC-ordered terminated process history and the
+  // present events together. If we hit a present that started after the
+  // termination, we can handle the process termination and continue.
+  // Otherwise, we're done handling all the presents and any outstanding
+  // terminations will have to wait for the next batch of events.
   for (; terminatedProcessIndex < terminatedProcesses->size();
        ++terminatedProcessIndex) {
     auto const& pair = (*terminatedProcesses)[terminatedProcessIndex];
@@ -451,6 +516,7 @@ void PresentMonSession::ProcessEvents(
 // as long as we're still holding a handle to it.
 void PresentMonSession::CheckForTerminatedRealtimeProcesses(
     std::vector<std::pair<uint32_t, uint64_t>>* terminatedProcesses) {
+  const auto pendingCount = terminatedProcesses->size();
   std::lock_guard<std::mutex> lock(process_mutex_);
   for (auto& pair : processes_) {
     auto processId = pair.first;
@@ -475,6 +541,7 @@ void PresentMonSession::CheckForTerminatedRealtimeProcesses(
       }
     }
   }
+  MergeTerminatedProcesses(terminatedProcesses, pendingCount);
 }
 
 void PresentMonSession::Output() {
@@ -486,6 +553,7 @@ void PresentMonSession::Output() {
   processEvents.reserve(128);
   presentEvents.reserve(4096);
   terminatedProcesses.reserve(16);
+  auto next_stats_log_time = GetTickCount64() + kConsumerStatsLogPeriodMs;
 
   for (;;) {
     // Read quit_output_thread_ here, but then check it after processing
@@ -508,6 +576,14 @@ void PresentMonSession::Output() {
     // Update tracking information.
     CheckForTerminatedRealtimeProcesses(&terminatedProcesses);
 
+    // Publish a summary of the consumer stats periodically so that event
+    // loss and handling cost are visible while the session is running, not
+    // just when it stops.
+    if (GetTickCount64() >= next_stats_log_time) {
+      LogConsumerStats(false);
+      next_stats_log_time = GetTickCount64() + kConsumerStatsLogPeriodMs;
+    }
+
     // Sleep to reduce overhead.
     Sleep(100);
   }
@@ -525,7 +601,8 @@ void PresentMonSession::Output() {
 
 PM_STATUS PresentMonSession::StartStreaming(uint32_t client_process_id,
                                             uint32_t target_process_id,
-                                            std::string& nsmFileName) {
+                                            std::string& nsmFileName,
+                                            uint32_t ring_capacity_frames) {
   
   if (target_process_id != (uint32_t)StreamPidOverride::kStreamAllPid) {
     // Check to see if the target process is valid
@@ -537,8 +614,9 @@ PM_STATUS PresentMonSession::StartStreaming(uint32_t client_process_id,
     CloseHandle(target_process_handle);
   }
   
-  PM_STATUS status = streamer_.StartStreaming(client_process_id,
-                                              target_process_id, nsmFileName);
+  PM_STATUS status =
+      streamer_.StartStreaming(client_process_id, target_process_id,
+                               nsmFileName, ring_capacity_frames);
   if (status != PM_STATUS::PM_STATUS_SUCCESS) {
     return status;
   } else{
@@ -632,13 +710,15 @@ void PresentMon::StopTraceSession() {
 
 PM_STATUS PresentMon::StartStreaming(uint32_t client_process_id,
                                      uint32_t target_process_id,
-                                     std::string& nsm_file_name) {
+                                     std::string& nsm_file_name,
+                                     uint32_t ring_capacity_frames) {
   if (target_process_id == static_cast<uint32_t>(StreamPidOverride::kEtlPid)) {
     return etl_session_.StartStreaming(client_process_id, target_process_id,
-                                       nsm_file_name);
+                                       nsm_file_name, ring_capacity_frames);
   } else {
     return real_time_session_.StartStreaming(client_process_id,
-                                             target_process_id, nsm_file_name);
+                                             target_process_id, nsm_file_name,
+                                             ring_capacity_frames);
   }
   
 }
@@ -48,7 +48,8 @@ class PresentMonSession {
 
   PM_STATUS StartStreaming(uint32_t client_process_id,
                            uint32_t target_process_id,
-                           std::string& nsmFileName);
+                           std::string& nsmFileName,
+                           uint32_t ring_capacity_frames);
 
   void StopStreaming(uint32_t client_process_id, uint32_t target_process_id);
 
@@ -87,6 +88,9 @@ class PresentMonSession {
 
  private:
   void StartConsumerThread(TRACEHANDLE traceHandle);
+  // Log a summary of the consumer's stats, and if detailed also the peak
+  // tracking sizes and lost presents by reason.
+  void LogConsumerStats(bool detailed);
   void WaitForConsumerThreadToExit();
   void DequeueAnalyzedInfo(
       std::vector<ProcessEvent>* processEvents,
@@ -115,6 +119,9 @@ class PresentMonSession {
       std::vector<std::pair<uint32_t, uint64_t>>* terminatedProcesses);
   void CheckForTerminatedRealtimeProcesses(
       std::vector<std::pair<uint32_t, uint64_t>>* terminatedProcesses);
+  static void MergeTerminatedProcesses(
+      std::vector<std::pair<uint32_t, uint64_t>>* terminatedProcesses,
+      size_t pendingCount);
 
   std::wstring pm_session_name_;
 
@@ -168,7 +175,8 @@ class PresentMon {
 
   PM_STATUS StartStreaming(uint32_t client_process_id,
                            uint32_t target_process_id,
-                           std::string& nsm_file_name);
+                           std::string& nsm_file_name,
+                           uint32_t ring_capacity_frames);
   void StopStreaming(uint32_t client_process_id, uint32_t target_process_id);
 
   PM_STATUS ProcessEtlFile(uint32_t client_process_id,
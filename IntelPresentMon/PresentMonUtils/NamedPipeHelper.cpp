@@ -234,7 +234,7 @@ const IPMSMRequestHeader* NamedPipeHelper::GetRequestHeader(
 // an ETW log file
 PM_STATUS NamedPipeHelper::EncodeStartStreamingRequest(
     MemBuffer* rqst_buf, uint32_t client_process_id, uint32_t target_process_id,
-    char const* etl_file_name) {
+    char const* etl_file_name, uint32_t ring_capacity_frames) {
   IPMSMRequestHeader request;
 
   PopulateRequestHeader(request, PM_ACTION::START_STREAM, 1,
@@ -256,6 +256,7 @@ PM_STATUS NamedPipeHelper::EncodeStartStreamingRequest(
   } else {
     gen_request_info.clientProcessId = client_process_id;
     gen_request_info.targetProcessId = target_process_id;
+    gen_request_info.ringCapacityFrames = ring_capacity_frames;
   }
 
   rqst_buf->AddItem(&gen_request_info, sizeof(gen_request_info));
@@ -19,7 +19,8 @@ public:
     static PM_STATUS EncodeStartStreamingRequest(MemBuffer* rqst_buf,
                                                  uint32_t client_process_id,
                                                  uint32_t target_process_id,
-                                                 char const* etl_file_name);
+                                                 char const* etl_file_name,
+                                                 uint32_t ring_capacity_frames = 0);
     static PM_STATUS DecodeStartStreamingResponse(
         MemBuffer* rsp_buf, IPMSMStartStreamResponse* start_stream_response);
 
@@ -75,6 +75,9 @@ struct IPMSMGeneralRequestInfo
 	uint32_t    gpuTelemetrySamplePeriodMs;
     char        etlFileName[MAX_PATH];
     size_t      etlFileNameLength;
+    // Requested frame ring capacity for START_STREAM; zero selects the
+    // service default
+    uint32_t    ringCapacityFrames;
 };
 
 struct NamedSharedMemoryHeader {
@@ -85,6 +88,7 @@ struct NamedSharedMemoryHeader {
 	  max_entries(0),
 	  current_write_offset(0),
 	  num_frames_written(0),
+	  num_frames_overwritten(0),
 	  head_idx(0),
 	  tail_idx(0),
       process_active(true){};
@@ -96,7 +100,11 @@ struct NamedSharedMemoryHeader {
   uint64_t buf_size;
   uint64_t max_entries;
   uint64_t current_write_offset;
+  // Monotonic count of frames written to the ring
   uint64_t num_frames_written;
+  // Monotonic count of frames dropped from the ring unread because the
+  // writer wrapped onto them
+  uint64_t num_frames_overwritten;
   uint64_t head_idx;
   uint64_t tail_idx;
   bool process_active;
@@ -140,7 +148,7 @@ struct PmNsmPresentEvent {
   uint64_t DxgkContext;                // mPresentByDxgkContext
   uint64_t Hwnd;                       // mLastPresentByWindow
   uint32_t QueueSubmitSequence;        // mPresentBySubmitSequence
-  uint32_t mAllPresentsTrackingIndex;  // mAllPresents.
+  uint32_t AgingWheelIndex;            // mAgingWheel
 
   // How many PresentStop events from the thread to wait for before
   // enqueueing this present.
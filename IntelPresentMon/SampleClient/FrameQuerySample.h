@@ -135,13 +135,11 @@ int GenCsv(pmapi::Session& pSession, std::string processName, unsigned int proce
 
         while (!_kbhit()) {
             std::cout << "Checking for new frames...\n";
-            uint32_t numFrames = numberOfBlobs;
+            // wake as soon as a full container of frames is ready, or after 200ms with what there is
+            frameQuery.WaitForFrames(processTracker, numberOfBlobs, 200);
             frameQuery.Consume(processTracker, blobs);
-            if (blobs.GetNumBlobsPopulated() == 0) {
-                std::this_thread::sleep_for(200ms);
-            }
-            else {
-                std::cout << std::format("Dumping [{}] frames...\n", numFrames);
+            if (blobs.GetNumBlobsPopulated() > 0) {
+                std::cout << std::format("Dumping [{}] frames...\n", blobs.GetNumBlobsPopulated());
                 WriteToCSV(csvStream.value(), processName, processId, queryElements, blobs);
             }
         }
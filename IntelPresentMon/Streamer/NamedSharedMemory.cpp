@@ -84,6 +84,22 @@ HRESULT NamedSharedMem::CreateSharedMem(std::string mapfile_name, uint64_t buf_s
             buf_size_low,                // maximum object size (low-order DWORD)
             mapfile_name_.c_str());                 // name of mapping object
 
+        // Same access as the mapping so that clients can signal it
+        if (const auto space_event = CreateEventA(
+                &sa, FALSE, FALSE, GetSpaceEventName(mapfile_name_).c_str())) {
+            space_event_ = std::shared_ptr<void>(space_event, CloseHandle);
+        } else {
+            OutputErrorLog("Could not create space event. Error code: ",
+                           GetLastError());
+        }
+        if (const auto frame_event = CreateEventA(
+                &sa, TRUE, FALSE, GetFrameEventName(mapfile_name_).c_str())) {
+            frame_event_ = std::shared_ptr<void>(frame_event, CloseHandle);
+        } else {
+            OutputErrorLog("Could not create frame event. Error code: ",
+                           GetLastError());
+        }
+
         LocalFree(sa.lpSecurityDescriptor);
     }
     else {
@@ -179,6 +195,27 @@ void NamedSharedMem::OpenSharedMemView(std::string mapfile_name)
         }
     }
 
+    // Open the space event used to wake a writer blocked on a full ring.
+    // Not fatal when missing; the writer also polls.
+    if (const auto space_event =
+            OpenEventA(EVENT_MODIFY_STATE, FALSE,
+                       GetSpaceEventName(mapfile_name).c_str())) {
+        space_event_ = std::shared_ptr<void>(space_event, CloseHandle);
+    } else {
+        OutputErrorLog("Could not open space event. Error code: ",
+                       GetLastError());
+    }
+    // Open the frame event used to wake readers waiting for frames. Not fatal
+    // when missing; waiting readers fall back to polling.
+    if (const auto frame_event =
+            OpenEventA(SYNCHRONIZE | EVENT_MODIFY_STATE, FALSE,
+                       GetFrameEventName(mapfile_name).c_str())) {
+        frame_event_ = std::shared_ptr<void>(frame_event, CloseHandle);
+    } else {
+        OutputErrorLog("Could not open frame event. Error code: ",
+                       GetLastError());
+    }
+
     // Map header
     header_ = static_cast<NamedSharedMemoryHeader*>(MapViewOfFile(mapfile_handle_,    // handle to map object
         FILE_MAP_READ | FILE_MAP_WRITE ,  // read permission
@@ -192,7 +229,7 @@ void NamedSharedMem::OpenSharedMemView(std::string mapfile_name)
         return;
     }
     
-    if (header_->buf_size > kBufSize) {
+    if (header_->buf_size > kMaxBufSize) {
         OutputErrorLog("Named Shared Memory header is incorrect.",
                        0);
       return;
@@ -229,13 +266,9 @@ NamedSharedMem::~NamedSharedMem() {
 }
 
 void NamedSharedMem::WriteFrameData(PmNsmFrameData* data) {
-    uint64_t data_size_bytes = sizeof(PmNsmFrameData);
-
-    uint64_t write_to_offset = header_->current_write_offset;
-    if (write_to_offset + data_size_bytes >= header_->buf_size) {
-        // not enough space, move to front of the buffer
-        write_to_offset = data_offset_base_;
-    }
+    // Slots are whole frames, so the write position follows from tail_idx
+    uint64_t write_to_offset =
+        data_offset_base_ + header_->tail_idx * sizeof(PmNsmFrameData);
 
     uint64_t map_offset = (write_to_offset / alloc_granularity_) * alloc_granularity_;
     DWORD map_offset_low = map_offset & 0xFFFFFFFF;
@@ -245,8 +278,10 @@ void NamedSharedMem::WriteFrameData(PmNsmFrameData* data) {
 
     SIZE_T num_bytes_to_map = ((in_map_offset + sizeof(PmNsmFrameData)) > alloc_granularity_) ? 2 * alloc_granularity_ : alloc_granularity_;
 
-    num_bytes_to_map = num_bytes_to_map > header_->buf_size ? header_->buf_size
-                                                            : num_bytes_to_map;
+    // The view must not extend past the end of the mapping
+    num_bytes_to_map = num_bytes_to_map > header_->buf_size - map_offset
+                           ? SIZE_T(header_->buf_size - map_offset)
+                           : num_bytes_to_map;
 
     // Map data region
     buf_ = static_cast<void*>(MapViewOfFile(mapfile_handle_,   // handle to map object
@@ -266,6 +301,7 @@ void NamedSharedMem::WriteFrameData(PmNsmFrameData* data) {
 
     if (IsFull()) {
       header_->head_idx = (header_->head_idx + 1) % header_->max_entries;
+      header_->num_frames_overwritten++;
     }
 
     header_->tail_idx = (header_->tail_idx + 1) % header_->max_entries;
@@ -283,12 +319,19 @@ void NamedSharedMem::WriteFrameData(PmNsmFrameData* data) {
 
     UnmapViewOfFile(buf_);
     buf_ = NULL;
+
+    if (frame_event_) {
+        SetEvent(frame_event_.get());
+    }
 }
 
 // Pop the first frame and move the head_idx
 void NamedSharedMem::DequeueFrameData() {
   if (!IsEmpty()) {
     header_->head_idx = (header_->head_idx + 1) % header_->max_entries;
+    if (space_event_) {
+      SetEvent(space_event_.get());
+    }
   }
 }
 
@@ -313,9 +356,24 @@ bool NamedSharedMem::IsEmpty() {
     return false;
 }
 
+uint64_t NamedSharedMem::GetBufSizeForFrames(uint64_t capacity_frames) {
+  return sizeof(NamedSharedMemoryHeader) +
+         (capacity_frames + 1) * sizeof(PmNsmFrameData);
+}
+
+uint64_t NamedSharedMem::GetMaxCapacityFrames() {
+  return (kMaxBufSize - sizeof(NamedSharedMemoryHeader)) /
+             sizeof(PmNsmFrameData) -
+         1;
+}
+
 void NamedSharedMem::NotifyProcessKilled() {
   header_->process_active = false;
   FlushViewOfFile(header_, sizeof(NamedSharedMemoryHeader));
+  // wake readers waiting for frames so that they see the exit
+  if (frame_event_) {
+    SetEvent(frame_event_.get());
+  }
 }
 
 void NamedSharedMem::RecordFirstFrameTime(uint64_t start_qpc) {
@@ -2,10 +2,13 @@
 // SPDX-License-Identifier: MIT
 #pragma once
 #include <string>
+#include <memory>
 
 #include "../PresentMonUtils/PresentMonNamedPipe.h"
 
 static const uint64_t kBufSize = 65536 * 60;
+// Largest shared mem a client will map
+static const uint64_t kMaxBufSize = kBufSize * 16;
 static const std::string kGlobalPrefix = "Global\\NamedSharedMem_";
 
 class NamedSharedMem {
@@ -31,8 +34,17 @@ class NamedSharedMem {
           gpu_telemetry_cap_bits,
       std::bitset<static_cast<size_t>(CpuTelemetryCapBits::cpu_telemetry_count)>
           cpu_telemetry_cap_bits);
-  // Client only method to pop already read frame data
+  // Client only method to pop already read frame data. Signals the space
+  // event so that a writer blocked on a full ring can continue.
   void DequeueFrameData();
+  // Auto-reset event signaled whenever a client frees a slot in the ring.
+  // Shared ownership lets the writer wait on it without holding the stream
+  // map lock while the stream might be torn down.
+  std::shared_ptr<void> GetSpaceEvent() { return space_event_; }
+  // Manual-reset event set by the writer after every frame written and when
+  // the process exits. Readers reset it before checking for pending frames
+  // and then wait on it. Null if the writer predates it.
+  std::shared_ptr<void> GetFrameEvent() { return frame_event_; }
   // Client method to open a view into the shared mem
   void OpenSharedMemView(std::string mapfile_name);
   void NotifyProcessKilled();
@@ -52,11 +64,22 @@ class NamedSharedMem {
   void DecrementRefcount() { refcount_--; };
   int GetRefCount() { return refcount_; };
   uint64_t GetBufSize() { return buf_size_; };
+  // Size in bytes of a shared mem holding capacity_frames frames. The ring
+  // keeps one slot free to tell full from empty, so one extra is reserved.
+  static uint64_t GetBufSizeForFrames(uint64_t capacity_frames);
+  // Largest frame capacity that fits in kMaxBufSize
+  static uint64_t GetMaxCapacityFrames();
 
  private:
   // Server method to create a shared mem in buf_size bytes
   HRESULT CreateSharedMem(std::string mapfile_name, uint64_t buf_size);
   void OutputErrorLog(const char* error_string, DWORD last_error);
+  static std::string GetSpaceEventName(const std::string& mapfile_name) {
+    return mapfile_name + "_Space";
+  }
+  static std::string GetFrameEventName(const std::string& mapfile_name) {
+    return mapfile_name + "_Frames";
+  }
   std::string mapfile_name_;
   HANDLE mapfile_handle_;
   uint32_t data_offset_base_;
@@ -68,4 +91,6 @@ class NamedSharedMem {
   int refcount_;
   bool buf_created_;
   uint64_t buf_size_;
+  std::shared_ptr<void> space_event_;
+  std::shared_ptr<void> frame_event_;
 };
\ No newline at end of file
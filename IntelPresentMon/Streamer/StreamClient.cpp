@@ -248,34 +248,21 @@ PM_STATUS StreamClient::ConsumePtrToNextNsmFrameData(const PmNsmFrameData** pNsm
     }
 
     if (recording_frame_data_ == false) {
-        // Get the current number of frames written and set it as the current
-        // dequeue frame number. This will be used to track data overruns if
-        // the client does not read data fast enough.
-        recording_frame_data_ = true;
-        current_dequeue_frame_num_ = nsm_hdr->num_frames_written;
-        next_dequeue_idx_ = GetLatestFrameIndex();
+        StartRecording();
     }
 
-    // Check to see if the number of pending read frames is greater
-    // than the maximum number of entries. If so we have lost frame
+    // Check to see if the writer has wrapped onto frames we have not read
+    // yet. The ring holds max_entries - 1 frames. If so we have lost frame
     // data
     uint64_t num_pending_frames = CheckPendingReadFrames();
-    if (num_pending_frames > nsm_hdr->max_entries) {
-        recording_frame_data_ = false;
+    if (num_pending_frames >= nsm_hdr->max_entries) {
+        ResyncToWriter();
         return PM_STATUS::PM_STATUS_SUCCESS;
     }
     else if (num_pending_frames == 0) {
         return PM_STATUS::PM_STATUS_SUCCESS;
     }
 
-    if (nsm_hdr->tail_idx < next_dequeue_idx_) {
-        if (next_dequeue_idx_ - nsm_hdr->tail_idx < 500)
-        {
-            recording_frame_data_ = false;
-            return PM_STATUS::PM_STATUS_SUCCESS;
-        }
-    }
-
     *pNsmData = ReadFrameByIdx(next_dequeue_idx_);
     if (*pNsmData) {
         next_dequeue_idx_ = (next_dequeue_idx_ + 1) % nsm_hdr->max_entries;
@@ -643,6 +630,44 @@ uint64_t StreamClient::GetLatestFrameIndex() {
   }
 }
 
+void StreamClient::StartRecording() {
+  // Get the current number of frames written and set it as the current
+  // dequeue frame number. This will be used to track data overruns if
+  // the client does not read data fast enough.
+  recording_frame_data_ = true;
+  current_dequeue_frame_num_ = shared_mem_view_->GetHeader()->num_frames_written;
+  next_dequeue_idx_ = GetLatestFrameIndex();
+}
+
+const PmNsmFrameData* StreamClient::PeekNextNsmFrameData() {
+  const auto num_pending_frames = GetNumPendingFrames();
+  if (num_pending_frames >= shared_mem_view_->GetHeader()->max_entries) {
+    ResyncToWriter();
+    return nullptr;
+  } else if (num_pending_frames == 0) {
+    return nullptr;
+  }
+  return ReadFrameByIdx(next_dequeue_idx_);
+}
+
+uint64_t StreamClient::GetNumPendingFrames() {
+  if (recording_frame_data_ == false) {
+    StartRecording();
+  }
+  return CheckPendingReadFrames();
+}
+
+void StreamClient::ResyncToWriter() {
+  auto p_header = shared_mem_view_->GetHeader();
+  // Frame n always lands in slot n % max_entries. Deriving the slot from the
+  // count rather than reading tail_idx stays consistent even if the writer is
+  // between updating the two.
+  const uint64_t num_frames_written = p_header->num_frames_written;
+  num_frames_lost_ += num_frames_written - current_dequeue_frame_num_;
+  current_dequeue_frame_num_ = num_frames_written;
+  next_dequeue_idx_ = num_frames_written % p_header->max_entries;
+}
+
 // Calculate the number of frames written since the last dequue
 uint64_t StreamClient::CheckPendingReadFrames() {
   uint64_t num_pending_read_frames = 0;
@@ -24,10 +24,20 @@ class StreamClient {
   PM_STATUS RecordFrame(PM_FRAME_DATA** out_frame_data);
   // Dequeue a frame of data from shared mem and update the last_read_idx (just get pointer to NsmData)
   PM_STATUS ConsumePtrToNextNsmFrameData(const PmNsmFrameData** pNsmData);
+  // Frame the above would return next, without consuming it. Null if no frame
+  // is pending (or the writer has overrun this client, which resyncs it)
+  const PmNsmFrameData* PeekNextNsmFrameData();
   // Dequeue from the head idx and update the head pointer as soon as out_frame_data is populated.
   PM_STATUS DequeueFrame(PM_FRAME_DATA** out_frame_data);
   // Return the last frame id that holds valid data
   uint64_t GetLatestFrameIndex();
+  // Number of frames written that have not been consumed yet, starting to
+  // record if consumption has not started. Exceeds the ring capacity if the
+  // writer has overrun this client.
+  uint64_t GetNumPendingFrames();
+  // Number of frames skipped because the writer overran this client since it
+  // started consuming
+  uint64_t GetNumFramesLost() const { return num_frames_lost_; }
   NamedSharedMem* GetNamedSharedMemView() { return shared_mem_view_.get(); }
   void CloseSharedMemView();
   LARGE_INTEGER GetQpcFrequency() { return qpcFrequency_; };
@@ -48,6 +58,11 @@ class StreamClient {
 
  private:
   uint64_t CheckPendingReadFrames();
+  // Begin tracking the read position from the next frame written
+  void StartRecording();
+  // Skip ahead to the next frame to be written, counting pending frames as
+  // lost
+  void ResyncToWriter();
   void OutputErrorLog(const char* error_string, DWORD last_error);
   // Shared memory view that the client opened into based on mapfile name
   std::unique_ptr<NamedSharedMem> shared_mem_view_;
@@ -60,4 +75,5 @@ class StreamClient {
   bool recording_frame_data_;
   uint64_t current_dequeue_frame_num_;
   bool is_etl_stream_client_;
+  uint64_t num_frames_lost_ = 0;
 };
\ No newline at end of file
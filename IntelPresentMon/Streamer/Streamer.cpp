@@ -24,16 +24,35 @@
 
 static const std::chrono::milliseconds kTimeoutLimitMs =
     std::chrono::milliseconds(500);
+// Upper bound on a single wait for ring space, so that a client unable to
+// open the space event still makes progress by polling
+static const std::chrono::milliseconds kEtlSpacePollInterval =
+    std::chrono::milliseconds(10);
+// Smallest ring a client may request unless overridden on the command line
+static const uint64_t kDefaultMinRingCapacityFrames = 60;
 
 Streamer::Streamer()
     : shared_mem_size_(kBufSize),
     start_qpc_(0),
     stream_mode_(StreamMode::kDefault),
     write_timedout_(false),
-    mapfileNamePrefix_{ kGlobalPrefix }
+    etl_write_timeout_(kTimeoutLimitMs),
+    min_ring_capacity_frames_(kDefaultMinRingCapacityFrames),
+    max_ring_capacity_frames_(NamedSharedMem::GetMaxCapacityFrames()),
+    mapfileNamePrefix_{ kGlobalPrefix },
+    streams_{ std::make_shared<const StreamMap>() }
 {
     if (clio::Options::IsInitialized()) {
-        mapfileNamePrefix_ = clio::Options::Get().nsmPrefix.AsOptional().value_or(mapfileNamePrefix_);
+        auto& opt = clio::Options::Get();
+        mapfileNamePrefix_ = opt.nsmPrefix.AsOptional().value_or(mapfileNamePrefix_);
+        if (opt.etlWriteTimeoutMs) {
+            etl_write_timeout_ = std::chrono::milliseconds(*opt.etlWriteTimeoutMs);
+        }
+        SetRingCapacityLimits(
+            opt.nsmMinFrames ? uint64_t((std::max)(*opt.nsmMinFrames, 1))
+                             : min_ring_capacity_frames_,
+            opt.nsmMaxFrames && *opt.nsmMaxFrames > 0 ? uint64_t(*opt.nsmMaxFrames)
+                                                      : max_ring_capacity_frames_);
     }
 }
 
@@ -48,17 +67,21 @@ void Streamer::WriteFrameData(
         return;
     }
 
-    // Lock the nsm mutex as stop streaming calls can occur at any time
-    // and destory the named shared memory during writing of frame data.
-    std::lock_guard<std::mutex> lock(nsm_map_mutex_);
-    auto iter = process_shared_mem_map_.find(process_id);
-    if (iter == process_shared_mem_map_.end()) {
+    // Stop streaming calls can occur at any time; the snapshot keeps the
+    // stream alive while we write even if it is removed concurrently.
+    const auto streams = LoadStreams();
+    const auto stream = FindStream(*streams, process_id);
+    if (!stream) {
         LOG(INFO) << "Corresponding named shared memory doesn't exist. Please call StartStreaming(process_id) first.";
 
         return;
     }
 
-    auto shared_mem = iter->second.get();
+    std::lock_guard<std::mutex> lock(stream->write_mutex);
+    if (stream->stopped) {
+        return;
+    }
+    auto shared_mem = stream->nsm.get();
     
     // Record start time if it's the first frame.
     if (shared_mem->IsEmpty()) {
@@ -98,8 +121,7 @@ void Streamer::CopyFromPresentMonPresentEvent(
     nsm_present_event->DxgkContext = present_event->DxgkContext;
     nsm_present_event->Hwnd = present_event->Hwnd;
     nsm_present_event->QueueSubmitSequence = present_event->QueueSubmitSequence;
-    nsm_present_event->mAllPresentsTrackingIndex =
-        present_event->mAllPresentsTrackingIndex;
+    nsm_present_event->AgingWheelIndex = present_event->AgingWheelIndex;
 
     nsm_present_event->DeferredCompletionWaitCount =
         present_event->DeferredCompletionWaitCount;
@@ -142,46 +164,27 @@ void Streamer::ProcessPresentEvent(
     uint32_t process_id;
     if (stream_mode_ == StreamMode::kOfflineEtl) {
       process_id = static_cast<uint32_t>(StreamPidOverride::kEtlPid);
+      // Offline processing must not drop frames, so block until the client
+      // has consumed enough of the ring to make room for this one
+      if (!WaitForEtlSpace(process_id)) {
+        write_timedout_ = true;
+        return;
+      }
     } else {
       process_id = present_event->ProcessId;
     }
 
-    // Lock the nsm mutex as stop streaming calls can occur at any time
-    // and destroy the named shared memory during writing of frame data.
-    std::lock_guard<std::mutex> lock(nsm_map_mutex_);
+    // Stop streaming calls can occur at any time; the snapshot keeps the
+    // streams alive while we write even if they are removed concurrently.
+    const auto streams = LoadStreams();
 
-    // Search for the requested process
-    auto iter = process_shared_mem_map_.find(process_id);
-    NamedSharedMem* process_nsm = nullptr;
-    if (iter != process_shared_mem_map_.end()) {
-      process_nsm = iter->second.get();
-      // Record start time if it's the first frame.
-      if (process_nsm->IsEmpty()) {
-        if (start_qpc_ != 0 && stream_mode_ == StreamMode::kOfflineEtl) {
-          process_nsm->RecordFirstFrameTime(start_qpc_);
-        } else {
-          process_nsm->RecordFirstFrameTime(present_event->PresentStartTime);
-        }
-      }
-    }
+    // Search for the requested process, and in addition the stream all
+    // process
+    const auto process_stream = FindStream(*streams, process_id);
+    const auto stream_all_stream = FindStream(
+        *streams, (uint32_t)StreamPidOverride::kStreamAllPid);
 
-    // In addition search for the stream all process
-    auto stream_all_iter = process_shared_mem_map_.find(
-        (uint32_t)StreamPidOverride::kStreamAllPid);
-    NamedSharedMem* stream_all_nsm = nullptr;
-    if (stream_all_iter != process_shared_mem_map_.end()) {
-      stream_all_nsm = stream_all_iter->second.get();
-      // Record start time if it's the first frame.
-      if (stream_all_nsm->IsEmpty()) {
-        if (start_qpc_ != 0 && stream_mode_ == StreamMode::kOfflineEtl) {
-          stream_all_nsm->RecordFirstFrameTime(start_qpc_);
-        } else {
-          stream_all_nsm->RecordFirstFrameTime(present_event->PresentStartTime);
-        }
-      }
-    }
-
-    if ((process_nsm == nullptr) && (stream_all_nsm == nullptr)) {
+    if (!process_stream && !stream_all_stream) {
       // process is not being monitored. Skip.
       return;
     }
@@ -205,37 +208,96 @@ void Streamer::ProcessPresentEvent(
     memcpy_s(&data.cpu_telemetry, sizeof(CpuTelemetryInfo), cpu_telemetry_info,
              sizeof(CpuTelemetryInfo));
 
-    if (process_nsm) {
-      // Block write frame data only when in ETL mode and nsm is full
-      auto start = std::chrono::high_resolution_clock::now();
-      std::chrono::milliseconds time_elapsed =
-          std::chrono::milliseconds::zero();
-
-      while ((stream_mode_ == StreamMode::kOfflineEtl) &&
-             process_nsm->IsFull()) {
-        auto now = std::chrono::high_resolution_clock::now();
-        time_elapsed =
-            std::chrono::duration_cast<std::chrono::milliseconds>(now - start);
-        LOG(INFO) << "NSM is full ...";
-
-        if (time_elapsed >= kTimeoutLimitMs) {
-          LOG(ERROR) << "\nServer data write timed out.";
-          write_timedout_ = true;
-          return;
+    // Each stream is written under its own lock, so writes to different
+    // processes only meet on the stream all process
+    for (const auto& stream : {process_stream, stream_all_stream}) {
+      if (!stream) {
+        continue;
+      }
+      std::lock_guard<std::mutex> lock(stream->write_mutex);
+      if (stream->stopped) {
+        continue;
+      }
+      auto nsm = stream->nsm.get();
+      // Record start time if it's the first frame.
+      if (nsm->IsEmpty()) {
+        if (start_qpc_ != 0 && stream_mode_ == StreamMode::kOfflineEtl) {
+          nsm->RecordFirstFrameTime(start_qpc_);
+        } else {
+          nsm->RecordFirstFrameTime(present_event->PresentStartTime);
         }
       }
-      process_nsm->WriteTelemetryCapBits(gpu_telemetry_cap_bits,
-                                         cpu_telemetry_cap_bits);
-      process_nsm->WriteFrameData(&data);
+      nsm->WriteTelemetryCapBits(gpu_telemetry_cap_bits,
+                                 cpu_telemetry_cap_bits);
+      nsm->WriteFrameData(&data);
     }
+}
 
-    if (stream_all_nsm) {
-      stream_all_nsm->WriteTelemetryCapBits(gpu_telemetry_cap_bits,
-                                            cpu_telemetry_cap_bits);
-      stream_all_nsm->WriteFrameData(&data);
+
+// Wait until the stream for process_id has a free slot. No lock is held while
+// waiting, so other streams and control calls are not blocked while the client
+// drains the ring. The writer is woken by the client's dequeue through the
+// stream's space event. Returns false on timeout.
+bool Streamer::WaitForEtlSpace(uint32_t process_id) {
+  const auto deadline = std::chrono::steady_clock::now() + etl_write_timeout_;
+  bool logged_full = false;
+  while (true) {
+    std::shared_ptr<void> space_event;
+    {
+      const auto stream = FindStream(*LoadStreams(), process_id);
+      if (!stream || !stream->nsm->IsFull()) {
+        return true;
+      }
+      space_event = stream->nsm->GetSpaceEvent();
     }
+    if (!logged_full) {
+      LOG(INFO) << "NSM is full, waiting for client to consume frames.";
+      logged_full = true;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if (now >= deadline) {
+      LOG(ERROR) << "\nServer data write timed out.";
+      return false;
+    }
+    const auto wait = (std::min)(
+        std::chrono::ceil<std::chrono::milliseconds>(deadline - now),
+        kEtlSpacePollInterval);
+    if (space_event) {
+      WaitForSingleObject(space_event.get(), (DWORD)wait.count());
+    } else {
+      std::this_thread::sleep_for(wait);
+    }
+  }
 }
 
+std::shared_ptr<const Streamer::StreamMap> Streamer::LoadStreams() const {
+  return streams_.load(std::memory_order_acquire);
+}
+
+std::shared_ptr<Streamer::Stream> Streamer::FindStream(
+    const StreamMap& streams, DWORD process_id) {
+  auto iter = streams.find(process_id);
+  if (iter == streams.end()) {
+    return nullptr;
+  }
+  return iter->second;
+}
+
+// Make a new stream map visible to the writers and shut down the streams that
+// were dropped from it. Writers that loaded the old map may still hold a
+// retired stream; its write lock and stopped flag keep them from writing after
+// the client has been told the process is gone. The shared memory itself is
+// released once the last such writer lets go of its snapshot. Function
+// assumes the control mutex is held.
+void Streamer::PublishStreams(std::shared_ptr<const StreamMap> streams,
+                              const std::vector<std::shared_ptr<Stream>>& retired) {
+  streams_.store(std::move(streams), std::memory_order_release);
+  for (const auto& stream : retired) {
+    std::lock_guard<std::mutex> lock(stream->write_mutex);
+    stream->stopped = true;
+    stream->nsm->NotifyProcessKilled();
+  }
+}
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /// @brief StartStreaming with target process_id
@@ -243,7 +305,10 @@ void Streamer::ProcessPresentEvent(
 /// 
   PM_STATUS Streamer::StartStreaming(uint32_t client_process_id,
                                    uint32_t target_process_id,
-                                   std::string& mapfile_name) {
+                                   std::string& mapfile_name,
+                                   uint32_t ring_capacity_frames) {
+    std::lock_guard<std::mutex> lock(control_mutex_);
+
     auto target_range = client_map_.equal_range(client_process_id);
     auto found = std::any_of(target_range.first, target_range.second,
                              [target_process_id](auto client_entry) {
@@ -268,32 +333,51 @@ void Streamer::ProcessPresentEvent(
     }
     free(pValue);
 
+    // A capacity requested by the client takes precedence over the byte size
+    if (ring_capacity_frames != 0) {
+      const auto capacity_frames =
+          std::clamp<uint64_t>(ring_capacity_frames, min_ring_capacity_frames_,
+                               max_ring_capacity_frames_);
+      if (capacity_frames != ring_capacity_frames) {
+        LOG(INFO) << "Requested ring capacity of " << ring_capacity_frames
+                  << " frames clamped to " << capacity_frames;
+      }
+      mem_size = NamedSharedMem::GetBufSizeForFrames(capacity_frames);
+      if (LoadStreams()->contains(target_process_id)) {
+        LOG(INFO) << "Stream for process id:" << target_process_id
+                  << " already exists, keeping its ring capacity";
+      }
+    }
+
     // create new shared mem for particular process id
-    if (CreateNamedSharedMemory(target_process_id, mem_size) == false) {
+    if (CreateNamedSharedMemoryLocked(target_process_id, mem_size) == false) {
       return PM_STATUS::PM_STATUS_UNABLE_TO_CREATE_NSM;
     }
 
     client_map_.insert(std::make_pair(client_process_id, target_process_id));
     LOG(INFO) << "\nStarted streaming for process id:" << target_process_id;    
-    mapfile_name = GetMapFileName(target_process_id);
+    mapfile_name = FindStream(*LoadStreams(), target_process_id)->nsm->GetMapFileName();
 
     return PM_STATUS::PM_STATUS_SUCCESS;
 }
 
 // Update the named shared memory process attachments. If the number of
-// attachments drops to zero release the NSM. Function assumes the
-// NSM map mutex has been called PRIOR to calling this function.
-bool Streamer::UpdateNSMAttachments(uint32_t process_id, int& ref_count) {
+// attachments drops to zero remove the NSM from streams and add it to
+// retired. Function assumes the control mutex has been locked PRIOR to
+// calling this function.
+bool Streamer::UpdateNSMAttachments(
+    StreamMap& streams, uint32_t process_id, int& ref_count,
+    std::vector<std::shared_ptr<Stream>>& retired) {
   ref_count = 0;
-  auto iter = process_shared_mem_map_.find(process_id);
-  if (iter != process_shared_mem_map_.end()) {
+  auto iter = streams.find(process_id);
+  if (iter != streams.end()) {
     // Check if refcount is going to be zero
-    if (iter->second->GetRefCount() > 1) {
-      iter->second->DecrementRefcount();
-      ref_count = iter->second->GetRefCount();
+    if (iter->second->nsm->GetRefCount() > 1) {
+      iter->second->nsm->DecrementRefcount();
+      ref_count = iter->second->nsm->GetRefCount();
     } else {
-      iter->second->NotifyProcessKilled();
-      process_shared_mem_map_.erase(std::move(iter));
+      retired.push_back(iter->second);
+      streams.erase(iter);
       ref_count = 0;
     }
     return true;
@@ -307,19 +391,21 @@ bool Streamer::UpdateNSMAttachments(uint32_t process_id, int& ref_count) {
 /// Otherwise destroy corresponding mapfilename
 /// 
 void Streamer::StopStreaming(uint32_t process_id) {
-  // Lock the nsm map mutex as stop streaming calls can occur at any time
+  // Lock the control mutex as stop streaming calls can occur at any time
   // from both the client and the output thread when it detects processes
   // have terminated
-  std::lock_guard<std::mutex> lock(nsm_map_mutex_);
+  std::lock_guard<std::mutex> lock(control_mutex_);
 
+  auto streams = std::make_shared<StreamMap>(*LoadStreams());
+  std::vector<std::shared_ptr<Stream>> retired;
   int ref_count = 0;
   // Check to see if the incoming process id is a client process id
   if (client_map_.contains(process_id) == false) {
     // Not a client process id, assume a target process. Need to remove
     // the NSM.
-    bool status = UpdateNSMAttachments(process_id, ref_count);
+    bool status = UpdateNSMAttachments(*streams, process_id, ref_count, retired);
     while ((status == true) && (ref_count > 0)) {
-      status = UpdateNSMAttachments(process_id, ref_count);
+      status = UpdateNSMAttachments(*streams, process_id, ref_count, retired);
     }
     if ((status == true) && (ref_count == 0)) {
       // If the passed in target process id resulted in a destruction of the
@@ -336,22 +422,28 @@ void Streamer::StopStreaming(uint32_t process_id) {
   } else {
     auto client_range = client_map_.equal_range(process_id);
     for (auto i = client_range.first; i != client_range.second; ++i) {
-      UpdateNSMAttachments(i->second, ref_count);
+      UpdateNSMAttachments(*streams, i->second, ref_count, retired);
     }
     client_map_.erase(client_range.first, client_range.second);
   }
+  if (!retired.empty()) {
+    PublishStreams(std::move(streams), retired);
+  }
   return;
 }
 
 void Streamer::StopStreaming(uint32_t client_process_id,
     uint32_t target_process_id) {
-  // Lock the nsm map mutex as stop streaming calls can occur at any time
+  // Lock the control mutex as stop streaming calls can occur at any time
   // from both the client and the output thread when it detects processes
   // have terminated
-  std::lock_guard<std::mutex> lock(nsm_map_mutex_);
+  std::lock_guard<std::mutex> lock(control_mutex_);
   
+  auto streams = std::make_shared<StreamMap>(*LoadStreams());
+  std::vector<std::shared_ptr<Stream>> retired;
   int ref_count = 0;
-  bool status = UpdateNSMAttachments(target_process_id, ref_count);
+  bool status =
+      UpdateNSMAttachments(*streams, target_process_id, ref_count, retired);
   if ((status == true) && (ref_count == 0)) {
     // If the passed in target process id resulted in the destruction of the
     // named shared memory then go through the client maps and remove
@@ -363,6 +455,7 @@ void Streamer::StopStreaming(uint32_t client_process_id,
         ++i;
       }
     }
+    PublishStreams(std::move(streams), retired);
   } else if ((status == true) && (ref_count > 0)) {
     // Succesfully found the NSM of the target process id but other clients
     // are still monitoring it. Only remove it from this clients mapping.
@@ -378,28 +471,38 @@ void Streamer::StopStreaming(uint32_t client_process_id,
 }
 
 void Streamer::StopAllStreams() {
-  // Lock the nsm map mutex to ensure we don't destroy the NSMs
-  // while writing frame data.
-  std::lock_guard<std::mutex> lock(nsm_map_mutex_);
-  for (auto const& it : process_shared_mem_map_) {
-    it.second->NotifyProcessKilled();
+  std::lock_guard<std::mutex> lock(control_mutex_);
+  std::vector<std::shared_ptr<Stream>> retired;
+  for (auto const& it : *LoadStreams()) {
+    retired.push_back(it.second);
   }
-  process_shared_mem_map_.clear();
+  PublishStreams(std::make_shared<const StreamMap>(), retired);
   client_map_.clear();
   write_timedout_ = false;
 }
 
 bool Streamer::CreateNamedSharedMemory(DWORD process_id,
                                        uint64_t nsm_size_in_bytes) {
+  std::lock_guard<std::mutex> lock(control_mutex_);
+  return CreateNamedSharedMemoryLocked(process_id, nsm_size_in_bytes);
+}
+
+// Function assumes the control mutex has been locked PRIOR to calling this
+// function.
+bool Streamer::CreateNamedSharedMemoryLocked(DWORD process_id,
+                                             uint64_t nsm_size_in_bytes) {
   const std::string mapfile_name = mapfileNamePrefix_ + std::to_string(process_id);
 
-  std::lock_guard<std::mutex> lock(nsm_map_mutex_);
-  auto iter = process_shared_mem_map_.find(process_id);
-  if (iter == process_shared_mem_map_.end()) {
-    auto nsm =
+  const auto current = LoadStreams();
+  auto iter = current->find(process_id);
+  if (iter == current->end()) {
+    auto stream = std::make_shared<Stream>();
+    stream->nsm =
         std::make_unique<NamedSharedMem>(std::move(mapfile_name), nsm_size_in_bytes);
-    if (nsm->IsNSMCreated()) {
-        process_shared_mem_map_.emplace(process_id, std::move(nsm));
+    if (stream->nsm->IsNSMCreated()) {
+        auto streams = std::make_shared<StreamMap>(*current);
+        streams->emplace(process_id, std::move(stream));
+        PublishStreams(std::move(streams), {});
         return true;
     } else {
         LOG(INFO) << "Unabled to create NSM for process id:" << process_id;
@@ -409,19 +512,30 @@ bool Streamer::CreateNamedSharedMemory(DWORD process_id,
   } else {
     LOG(INFO) << "Shared mem for process(" << process_id
               << ") already exists. Increment recount.";
-    iter->second->IncrementRefcount();
+    iter->second->nsm->IncrementRefcount();
     return true;
   }
 }
 
 std::string Streamer::GetMapFileName(DWORD process_id) {
-  std::lock_guard<std::mutex> lock(nsm_map_mutex_);
-  auto iter = process_shared_mem_map_.find(process_id);
   std::string mapfile_name;
 
-  if (iter != process_shared_mem_map_.end()) {
-    mapfile_name = iter->second->GetMapFileName();
+  if (const auto stream = FindStream(*LoadStreams(), process_id)) {
+    mapfile_name = stream->nsm->GetMapFileName();
   }
 
   return mapfile_name;
-}
\ No newline at end of file
+}
+
+int Streamer::NumActiveStreams() const { return (int)LoadStreams()->size(); }
+
+void Streamer::SetRingCapacityLimits(uint64_t min_frames, uint64_t max_frames) {
+  max_ring_capacity_frames_ =
+      (std::min)(max_frames, NamedSharedMem::GetMaxCapacityFrames());
+  min_ring_capacity_frames_ =
+      (std::min)((std::max)(min_frames, uint64_t(1)), max_ring_capacity_frames_);
+}
+
+bool Streamer::HasStream(DWORD process_id) const {
+  return LoadStreams()->contains(process_id);
+}
@@ -6,6 +6,11 @@
 #include <thread>
 #include <string>
 #include <map>
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #include "../PresentMonUtils/PresentMonNamedPipe.h"
 #include "gtest/gtest.h"
@@ -23,10 +28,13 @@ class Streamer {
      Streamer();
   ~Streamer() = default;
 
-  // Client API, start streaming data for process by name
+  // Client API, start streaming data for process by name. A nonzero
+  // ring_capacity_frames sizes a newly created stream to hold that many
+  // frames, clamped to the service limits; an existing stream keeps its size.
   PM_STATUS StartStreaming(uint32_t client_process_id,
                            uint32_t target_process_id,
-                           std::string& mapfile_name);
+                           std::string& mapfile_name,
+                           uint32_t ring_capacity_frames = 0);
 
   // Set streaming mode. Default value is real time streaming for single process.
   void SetStreamMode(StreamMode mode) { stream_mode_ = mode; };
@@ -54,18 +62,50 @@ class Streamer {
   std::string GetMapFileName(DWORD process_id);
   void SetStartQpc(uint64_t start_qpc) { start_qpc_ = start_qpc; };
   bool IsTimedOut() { return write_timedout_; };
-  int NumActiveStreams() { return (int)process_shared_mem_map_.size(); }
+  // How long an offline ETL write may block waiting for the client to drain
+  // a full ring before the stream is considered stalled
+  void SetEtlWriteTimeout(std::chrono::milliseconds timeout) {
+    etl_write_timeout_ = timeout;
+  }
+  int NumActiveStreams() const;
+  // Range that requested ring capacities are clamped to
+  void SetRingCapacityLimits(uint64_t min_frames, uint64_t max_frames);
 
  private:
   FRIEND_TEST(NamedSharedMemoryTest, CreateNamedSharedMemory);
   FRIEND_TEST(NamedSharedMemoryTestCustomSize, CreateNamedSharedMemory);
+  // Shared mem of one target process. The write mutex serializes the writers
+  // of this stream only; stopped is set under it once the stream has been
+  // removed so that writers holding an older snapshot skip it.
+  struct Stream {
+    std::unique_ptr<NamedSharedMem> nsm;
+    std::mutex write_mutex;
+    bool stopped = false;
+  };
+  using StreamMap = std::map<DWORD, std::shared_ptr<Stream>>;
+
   bool CreateNamedSharedMemory(DWORD process_id, uint64_t nsm_size_in_bytes = kBufSize);
+  bool CreateNamedSharedMemoryLocked(DWORD process_id,
+                                     uint64_t nsm_size_in_bytes);
+  bool HasStream(DWORD process_id) const;
   void CopyFromPresentMonPresentEvent(PresentEvent* present_event,
                                       PmNsmPresentEvent* nsm_present_event);
-  bool UpdateNSMAttachments(uint32_t process_id, int& ref_count);
+  bool UpdateNSMAttachments(StreamMap& streams, uint32_t process_id,
+                            int& ref_count,
+                            std::vector<std::shared_ptr<Stream>>& retired);
+  bool WaitForEtlSpace(uint32_t process_id);
+  std::shared_ptr<const StreamMap> LoadStreams() const;
+  static std::shared_ptr<Stream> FindStream(const StreamMap& streams,
+                                            DWORD process_id);
+  void PublishStreams(std::shared_ptr<const StreamMap> streams,
+                      const std::vector<std::shared_ptr<Stream>>& retired);
   std::string mapfileNamePrefix_;
-  // Shared mem buffer map of process id and share mem handle
-  std::map<DWORD, std::unique_ptr<NamedSharedMem>> process_shared_mem_map_;
+  // Map of process id to stream. The map is immutable once published; control
+  // calls copy it, modify the copy and swap it in under control_mutex_, while
+  // the frame writers only load the current snapshot and never take a lock
+  // shared between processes.
+  std::atomic<std::shared_ptr<const StreamMap>> streams_;
+  // Clients of each target process, guarded by control_mutex_
   std::multimap<uint32_t, uint32_t> client_map_;
   uint64_t shared_mem_size_;
   StreamMode stream_mode_;
@@ -75,5 +115,9 @@ class Streamer {
   // write_timedout_ would be set to true and etl_session_ of PresentMon would 
   // stop the trace session. 
   bool write_timedout_;
-  mutable std::mutex nsm_map_mutex_;
+  std::chrono::milliseconds etl_write_timeout_;
+  uint64_t min_ring_capacity_frames_;
+  uint64_t max_ring_capacity_frames_;
+  // Serializes StartStreaming, StopStreaming and StopAllStreams
+  std::mutex control_mutex_;
 };
@@ -0,0 +1,124 @@
+#include "gtest/gtest.h"
+#include "../ControlLib/SimulatedTelemetryScript.h"
+#include <sstream>
+#include <stdexcept>
+
+using pwr::sim::TelemetryScript;
+
+namespace
+{
+    std::shared_ptr<const TelemetryScript> ParseText(const char* text)
+    {
+        std::istringstream in{ text };
+        return TelemetryScript::Parse(in);
+    }
+}
+
+TEST(SimulatedTelemetryScript, parseEmpty)
+{
+    const auto pScript = ParseText("");
+    EXPECT_EQ(nullptr, pScript->FindGpuStep(0.));
+    EXPECT_EQ(nullptr, pScript->FindCpuStep(0.));
+    EXPECT_TRUE(pScript->GetAllGpuCaps().none());
+    EXPECT_TRUE(pScript->GetAllCpuCaps().none());
+    EXPECT_FALSE(pScript->IsLooping());
+    EXPECT_FALSE(pScript->GetVendor().has_value());
+}
+
+TEST(SimulatedTelemetryScript, parseCommentsAndBlankLinesOnly)
+{
+    const auto pScript = ParseText("# nothing here\n\n   \n  # indented comment\n");
+    EXPECT_EQ(nullptr, pScript->FindGpuStep(100.));
+    EXPECT_EQ(nullptr, pScript->FindCpuStep(100.));
+}
+
+TEST(SimulatedTelemetryScript, parseValid)
+{
+    const auto pScript = ParseText(
+        "# two gpu steps and one cpu step\n"
+        "duration 1000\n"
+        "vendor nvidia\n"
+        "gpu 0 gpu_power=120.5 gpu_temperature=65 # trailing comment\n"
+        "gpu 500 gpu_power=150 gpu_power_limited=1\n"
+        "cpu 0 cpu_utilization=35 cpu_frequency=3600\n");
+    EXPECT_TRUE(pScript->IsLooping());
+    EXPECT_EQ(1000., pScript->GetDurationMs());
+    EXPECT_EQ(PM_DEVICE_VENDOR_NVIDIA, pScript->GetVendor());
+
+    const auto pFirst = pScript->FindGpuStep(250.);
+    ASSERT_NE(nullptr, pFirst);
+    EXPECT_EQ(120.5, pFirst->info.gpu_power_w);
+    EXPECT_EQ(65., pFirst->info.gpu_temperature_c);
+    EXPECT_FALSE(pFirst->caps.test(size_t(GpuTelemetryCapBits::gpu_power_limited)));
+
+    // fields carry over from the previous step of the same kind
+    const auto pSecond = pScript->FindGpuStep(750.);
+    ASSERT_NE(nullptr, pSecond);
+    EXPECT_EQ(150., pSecond->info.gpu_power_w);
+    EXPECT_EQ(65., pSecond->info.gpu_temperature_c);
+    EXPECT_TRUE(pSecond->info.gpu_power_limited);
+    EXPECT_TRUE(pSecond->caps.test(size_t(GpuTelemetryCapBits::gpu_temperature)));
+
+    // time wraps at the duration
+    EXPECT_EQ(pFirst, pScript->FindGpuStep(1250.));
+
+    const auto pCpu = pScript->FindCpuStep(999.);
+    ASSERT_NE(nullptr, pCpu);
+    EXPECT_EQ(35., pCpu->info.cpu_utilization);
+    EXPECT_EQ(3600., pCpu->info.cpu_frequency);
+
+    EXPECT_TRUE(pScript->GetAllGpuCaps().test(size_t(GpuTelemetryCapBits::gpu_power)));
+    EXPECT_FALSE(pScript->GetAllGpuCaps().test(size_t(GpuTelemetryCapBits::vram_power)));
+    EXPECT_TRUE(pScript->GetAllCpuCaps().test(size_t(CpuTelemetryCapBits::cpu_frequency)));
+    EXPECT_FALSE(pScript->GetAllCpuCaps().test(size_t(CpuTelemetryCapBits::cpu_power)));
+}
+
+TEST(SimulatedTelemetryScript, parseBeforeFirstStep)
+{
+    const auto pScript = ParseText("gpu 100 gpu_power=10\n");
+    EXPECT_FALSE(pScript->IsLooping());
+    EXPECT_EQ(nullptr, pScript->FindGpuStep(50.));
+    ASSERT_NE(nullptr, pScript->FindGpuStep(5000.));
+}
+
+TEST(SimulatedTelemetryScript, parseMalformed)
+{
+    const char* malformed[] = {
+        "frobnicate 10\n",                          // unknown directive
+        "gpu\n",                                    // missing time offset
+        "gpu soon gpu_power=1\n",                   // non-numeric time offset
+        "gpu 10 gpu_power\n",                       // missing '='
+        "gpu 10 gpu_warp_factor=9\n",               // unknown field
+        "cpu 10 gpu_power=1\n",                     // gpu field on a cpu step
+        "gpu 10 gpu_power=lots\n",                  // bad value
+        "gpu 10 gpu_power=1\ngpu 5 gpu_power=2\n",  // decreasing time offset
+        "duration -5\n",                            // negative duration
+        "duration\n",                               // missing duration
+        "vendor matrox\n",                          // unknown vendor
+        "vendor\n",                                 // missing vendor
+    };
+    for (auto text : malformed) {
+        EXPECT_THROW(ParseText(text), std::runtime_error) << text;
+    }
+}
+
+TEST(SimulatedTelemetryScript, malformedErrorNamesLine)
+{
+    try {
+        ParseText("# header\ngpu 0 gpu_power=1\ngpu 10 bogus=2\n");
+        FAIL() << "expected a parse error";
+    }
+    catch (const std::runtime_error& e) {
+        EXPECT_NE(std::string::npos, std::string{ e.what() }.find("line 3"));
+    }
+}
+
+TEST(SimulatedTelemetryScript, defaultScript)
+{
+    const auto pScript = TelemetryScript::MakeDefault(1000., 10.);
+    EXPECT_TRUE(pScript->IsLooping());
+    EXPECT_FALSE(pScript->GetVendor().has_value());
+    ASSERT_NE(nullptr, pScript->FindGpuStep(0.));
+    ASSERT_NE(nullptr, pScript->FindCpuStep(999.));
+    EXPECT_TRUE(pScript->GetAllGpuCaps().test(size_t(GpuTelemetryCapBits::gpu_power)));
+}
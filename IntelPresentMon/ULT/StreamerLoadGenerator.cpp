@@ -0,0 +1,330 @@
+#define GOOGLE_GLOG_DLL_DECL
+#define GLOG_NO_ABBREVIATED_SEVERITIES
+#include <glog/logging.h>
+
+#include "StreamerLoadGenerator.h"
+#include "..\Streamer\StreamClient.h"
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <thread>
+
+namespace {
+uint64_t GetQpc() {
+  LARGE_INTEGER qpc;
+  QueryPerformanceCounter(&qpc);
+  return (uint64_t)qpc.QuadPart;
+}
+
+// Shift every absolute qpc in the frame forward; zero means "not set" and is
+// left alone
+void ShiftFrameTimes(PmNsmPresentEvent& present_event, uint64_t shift) {
+  for (auto pTime :
+       {&present_event.PresentStartTime, &present_event.GPUStartTime,
+        &present_event.ReadyTime, &present_event.ScreenTime,
+        &present_event.InputTime, &present_event.last_present_qpc,
+        &present_event.last_displayed_qpc}) {
+    if (*pTime != 0) {
+      *pTime += shift;
+    }
+  }
+}
+
+void ToPresentEvent(const PmNsmPresentEvent& src, PresentEvent& dst) {
+  dst.PresentStartTime = src.PresentStartTime;
+  dst.ProcessId = src.ProcessId;
+  dst.ThreadId = src.ThreadId;
+  dst.TimeInPresent = src.TimeInPresent;
+  dst.GPUStartTime = src.GPUStartTime;
+  dst.ReadyTime = src.ReadyTime;
+  dst.GPUDuration = src.GPUDuration;
+  dst.GPUVideoDuration = src.GPUVideoDuration;
+  dst.ScreenTime = src.ScreenTime;
+  dst.InputTime = src.InputTime;
+  dst.SwapChainAddress = src.SwapChainAddress;
+  dst.SyncInterval = src.SyncInterval;
+  dst.PresentFlags = src.PresentFlags;
+  dst.QueueSubmitSequence = src.QueueSubmitSequence;
+  dst.Runtime = src.Runtime;
+  dst.PresentMode = src.PresentMode;
+  dst.FinalState = src.FinalState;
+  dst.SupportsTearing = src.SupportsTearing;
+  dst.IsCompleted = true;
+}
+}  // namespace
+
+std::string StreamerLoadGenerator::Report::ToString() const {
+  return std::format(
+      "frames written: {} ({:.0f} fps aggregate)\n"
+      "writer ns/frame: mean {:.0f}, p99 {:.0f}, max {:.0f}\n"
+      "frames read: {}, reader lag frames: mean {:.1f}, max {}\n"
+      "frames lost by readers: {}, frames overwritten in ring: {}\n"
+      "nsm footprint: {} bytes, control ops: {}",
+      frames_written, achieved_fps, writer_ns_per_frame_mean,
+      writer_ns_per_frame_p99, writer_ns_per_frame_max, frames_read,
+      reader_lag_mean_frames, reader_lag_max_frames, frames_lost,
+      frames_overwritten, nsm_bytes, control_ops);
+}
+
+StreamerLoadGenerator::StreamerLoadGenerator(const Config& config)
+    : config_{config} {
+  QueryPerformanceFrequency(&qpc_frequency_);
+  const double frames_per_second =
+      config_.fps_per_swap_chain * config_.swap_chains_per_process;
+  frame_interval_qpc_ = (std::max)(
+      uint64_t(1), uint64_t(double(qpc_frequency_.QuadPart) / frames_per_second));
+  frames_per_process_ =
+      uint64_t(frames_per_second * config_.duration_ms / 1000.);
+  gpu_telemetry_cap_bits_.set();
+  cpu_telemetry_cap_bits_.set();
+}
+
+void StreamerLoadGenerator::WriteFrame(Streamer& streamer,
+                                       ProcessStream& stream, uint64_t seq) {
+  const auto& templ =
+      stream.template_frames[size_t(seq % stream.template_frames.size())];
+  PmNsmFrameData data = templ;
+  ShiftFrameTimes(data.present_event,
+                  (seq / stream.template_frames.size()) *
+                      stream.template_span_qpc);
+  data.present_event.QueueSubmitSequence = uint32_t(seq);
+
+  const auto start = GetQpc();
+  if (config_.write_path == WritePath::kProcessPresentEvent) {
+    // Mirror the work the output thread does per present, including the
+    // PresentEvent -> NSM copy and app name conversion inside the streamer
+    PresentEvent present_event;
+    ToPresentEvent(data.present_event, present_event);
+    streamer.ProcessPresentEvent(
+        &present_event, &data.power_telemetry, &data.cpu_telemetry,
+        data.present_event.last_present_qpc,
+        data.present_event.last_displayed_qpc, L"load_test_app.exe",
+        gpu_telemetry_cap_bits_, cpu_telemetry_cap_bits_);
+  } else {
+    streamer.WriteFrameData(stream.target_pid, &data, gpu_telemetry_cap_bits_,
+                            cpu_telemetry_cap_bits_);
+  }
+  stream.write_ticks.push_back(GetQpc() - start);
+}
+
+void StreamerLoadGenerator::WriterThread(Streamer& streamer,
+                                         ProcessStream& stream) {
+  // Emit every frame that is due according to the wall clock, then back off;
+  // coarse sleep granularity turns into bursts but keeps the average rate
+  while (stream.frames_written < frames_per_process_) {
+    const auto due = (std::min)(
+        frames_per_process_, (GetQpc() - run_start_qpc_) / frame_interval_qpc_);
+    while (stream.frames_written < due) {
+      WriteFrame(streamer, stream, stream.frames_written++);
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(500));
+  }
+}
+
+void StreamerLoadGenerator::ReaderThread(const ProcessStream& stream,
+                                         bool dies_midway,
+                                         ReaderStats& stats) {
+  StreamClient client{stream.mapfile_name, false};
+  const auto header = client.GetNamedSharedMemView()->GetHeader();
+  const auto die_at_qpc =
+      run_start_qpc_ + uint64_t(qpc_frequency_.QuadPart) *
+                           config_.duration_ms / 2000;
+  bool have_last_seq = false;
+  uint32_t last_seq = 0;
+
+  while (true) {
+    if (dies_midway && GetQpc() >= die_at_qpc) {
+      // Stop consuming without detaching from the streamer
+      return;
+    }
+    const PmNsmFrameData* frame = nullptr;
+    if (client.ConsumePtrToNextNsmFrameData(&frame) !=
+        PM_STATUS::PM_STATUS_SUCCESS) {
+      return;
+    }
+    if (frame) {
+      const auto seq = frame->present_event.QueueSubmitSequence;
+      if (have_last_seq && seq > last_seq + 1) {
+        stats.frames_lost += seq - last_seq - 1;
+      }
+      have_last_seq = true;
+      last_seq = seq;
+      const auto lag = header->num_frames_written - (uint64_t(seq) + 1);
+      stats.frames_read++;
+      stats.lag_sum += lag;
+      stats.lag_max = (std::max)(stats.lag_max, lag);
+      continue;
+    }
+    if (writers_done_) {
+      return;
+    }
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(config_.reader_poll_interval_ms));
+  }
+}
+
+void StreamerLoadGenerator::ChurnThread(
+    Streamer& streamer, uint32_t index,
+    const std::vector<ProcessStream>& streams, uint64_t& ops) {
+  const uint32_t client_pid = kChurnClientPidBase + index;
+  const uint32_t churn_target_pid = kChurnTargetPidBase + index;
+  std::string mapfile_name;
+  // Creating and destroying the churn-only stream exercises the same paths
+  // as a client coming and going; attaching to a written process exercises
+  // refcounting on a stream that is being written to
+  for (size_t i = index; !writers_done_; i++) {
+    streamer.StartStreaming(client_pid, churn_target_pid, mapfile_name);
+    streamer.StartStreaming(client_pid, streams[i % streams.size()].target_pid,
+                            mapfile_name);
+    streamer.StopStreaming(client_pid);
+    ops += 3;
+    std::this_thread::yield();
+  }
+}
+
+StreamerLoadGenerator::Report StreamerLoadGenerator::Run(Streamer& streamer) {
+  Report report;
+  writers_done_ = false;
+
+  // Set up one stream per synthetic process. The first client of each
+  // process is the harness itself, used to inspect the header.
+  std::vector<ProcessStream> streams(config_.num_processes);
+  uint32_t next_client_pid = kClientPidBase;
+  for (uint32_t i = 0; i < config_.num_processes; i++) {
+    auto& stream = streams[i];
+    stream.target_pid = kTargetPidBase + i;
+    for (uint32_t c = 0; c < config_.readers_per_process + 1; c++) {
+      stream.client_pids.push_back(next_client_pid++);
+      if (streamer.StartStreaming(stream.client_pids.back(), stream.target_pid,
+                                  stream.mapfile_name) !=
+          PM_STATUS::PM_STATUS_SUCCESS) {
+        LOG(ERROR) << "Load generator failed to start stream for pid "
+                   << stream.target_pid;
+        for (uint32_t pid = kClientPidBase; pid < next_client_pid; pid++) {
+          streamer.StopStreaming(pid);
+        }
+        return report;
+      }
+    }
+
+    PmFrameGenerator::FrameParams params{};
+    params.process_id = stream.target_pid;
+    params.app_name = "load_test_app.exe";
+    PmFrameGenerator frame_gen{params};
+    frame_gen.SetNumberSwapChains(config_.swap_chains_per_process);
+    frame_gen.SetFps(config_.fps_per_swap_chain *
+                     config_.swap_chains_per_process);
+    frame_gen.GenerateFrames(config_.template_frames + 1);
+    for (size_t f = 0; f < frame_gen.GetNumFrames(); f++) {
+      stream.template_frames.push_back(frame_gen.GetFrameData(int(f)));
+    }
+    // Loop period continues the cadence from the last frame back to the first
+    stream.template_span_qpc =
+        stream.template_frames.back().present_event.PresentStartTime -
+        stream.template_frames.front().present_event.PresentStartTime +
+        frame_interval_qpc_;
+    stream.write_ticks.reserve(size_t(frames_per_process_));
+  }
+
+  std::vector<std::unique_ptr<StreamClient>> monitors;
+  for (const auto& stream : streams) {
+    monitors.push_back(
+        std::make_unique<StreamClient>(stream.mapfile_name, false));
+  }
+
+  // Start readers first so they observe the stream from its first frame
+  std::vector<ReaderStats> reader_stats(size_t(config_.num_processes) *
+                                        config_.readers_per_process);
+  std::vector<std::thread> readers;
+  run_start_qpc_ = GetQpc();
+  for (uint32_t i = 0; i < config_.num_processes; i++) {
+    for (uint32_t r = 0; r < config_.readers_per_process; r++) {
+      readers.emplace_back(&StreamerLoadGenerator::ReaderThread, this,
+                           std::cref(streams[i]),
+                           r < config_.dying_readers_per_process,
+                           std::ref(reader_stats[size_t(i) *
+                                                     config_.readers_per_process +
+                                                 r]));
+    }
+  }
+  std::vector<uint64_t> churn_ops(config_.churn_clients);
+  std::vector<std::thread> churners;
+  for (uint32_t i = 0; i < config_.churn_clients; i++) {
+    churners.emplace_back(&StreamerLoadGenerator::ChurnThread, this,
+                          std::ref(streamer), i, std::cref(streams),
+                          std::ref(churn_ops[i]));
+  }
+  std::vector<std::thread> writers;
+  for (auto& stream : streams) {
+    writers.emplace_back(&StreamerLoadGenerator::WriterThread, this,
+                         std::ref(streamer), std::ref(stream));
+  }
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  const auto run_end_qpc = GetQpc();
+  writers_done_ = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  for (auto& churner : churners) {
+    churner.join();
+  }
+  for (auto ops : churn_ops) {
+    report.control_ops += ops;
+  }
+
+  // Gather ring statistics before tearing the streams down
+  for (const auto& pMonitor : monitors) {
+    const auto header = pMonitor->GetNamedSharedMemView()->GetHeader();
+    report.nsm_bytes += header->buf_size;
+    report.frames_overwritten += header->num_frames_overwritten;
+  }
+  monitors.clear();
+  for (const auto& stream : streams) {
+    for (auto client_pid : stream.client_pids) {
+      streamer.StopStreaming(client_pid);
+    }
+  }
+
+  // Writer cost
+  std::vector<uint64_t> all_ticks;
+  for (const auto& stream : streams) {
+    report.frames_written += stream.frames_written;
+    all_ticks.insert(all_ticks.end(), stream.write_ticks.begin(),
+                     stream.write_ticks.end());
+  }
+  const double ns_per_tick = 1e9 / double(qpc_frequency_.QuadPart);
+  if (!all_ticks.empty()) {
+    std::ranges::sort(all_ticks);
+    uint64_t tick_sum = 0;
+    for (auto t : all_ticks) {
+      tick_sum += t;
+    }
+    report.writer_ns_per_frame_mean =
+        double(tick_sum) * ns_per_tick / double(all_ticks.size());
+    report.writer_ns_per_frame_p99 =
+        double(all_ticks[all_ticks.size() * 99 / 100]) * ns_per_tick;
+    report.writer_ns_per_frame_max = double(all_ticks.back()) * ns_per_tick;
+  }
+  report.achieved_fps =
+      double(report.frames_written) /
+      QpcDeltaToSeconds(run_end_qpc - run_start_qpc_, qpc_frequency_);
+
+  // Reader lag and loss
+  uint64_t lag_sum = 0;
+  for (const auto& stats : reader_stats) {
+    report.frames_read += stats.frames_read;
+    report.frames_lost += stats.frames_lost;
+    report.reader_lag_max_frames =
+        (std::max)(report.reader_lag_max_frames, stats.lag_max);
+    lag_sum += stats.lag_sum;
+  }
+  if (report.frames_read > 0) {
+    report.reader_lag_mean_frames =
+        double(lag_sum) / double(report.frames_read);
+  }
+
+  return report;
+}
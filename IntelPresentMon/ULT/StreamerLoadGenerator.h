@@ -0,0 +1,110 @@
+#pragma once
+
+#include <windows.h>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "..\Streamer\Streamer.h"
+#include "PmFrameGenerator.h"
+
+// Drives a Streamer with synthetic present traffic from many processes and
+// swap chains while StreamClient readers consume the resulting named shared
+// memory, and reports writer cost, reader lag and frame loss.
+//
+// Frames are taken from PmFrameGenerator templates and replayed at the
+// configured rate with their qpc times shifted forward on every pass. Each
+// frame carries a per-process sequence number in QueueSubmitSequence so that
+// readers can detect gaps caused by ring buffer overwrites.
+class StreamerLoadGenerator {
+ public:
+  enum class WritePath { kProcessPresentEvent, kWriteFrameData };
+
+  struct Config {
+    uint32_t num_processes = 1;
+    uint32_t swap_chains_per_process = 1;
+    double fps_per_swap_chain = 1000.;
+    uint32_t duration_ms = 1000;
+    uint32_t readers_per_process = 1;
+    // Of the readers per process, this many stop consuming halfway through
+    // the run without detaching, emulating a client that died mid-stream.
+    // They are detached when the run ends, as the service does when it
+    // notices the client pipe disconnect.
+    uint32_t dying_readers_per_process = 0;
+    uint32_t reader_poll_interval_ms = 1;
+    // Threads that start and stop streams for the whole run, each on its own
+    // churn-only target process and attached to the written processes, to
+    // measure writer cost under control call contention.
+    uint32_t churn_clients = 0;
+    WritePath write_path = WritePath::kProcessPresentEvent;
+    // Number of distinct frames generated per process before replaying.
+    int template_frames = 1000;
+  };
+
+  struct Report {
+    uint64_t frames_written = 0;
+    double achieved_fps = 0.;
+    double writer_ns_per_frame_mean = 0.;
+    double writer_ns_per_frame_p99 = 0.;
+    double writer_ns_per_frame_max = 0.;
+    uint64_t frames_read = 0;
+    double reader_lag_mean_frames = 0.;
+    uint64_t reader_lag_max_frames = 0;
+    // Frames skipped by readers, observed as sequence gaps
+    uint64_t frames_lost = 0;
+    // Frames written after the ring wrapped, summed over processes
+    uint64_t frames_overwritten = 0;
+    // Total size of the named shared memory backing all streams
+    uint64_t nsm_bytes = 0;
+    // Start and stop calls completed by the churn clients
+    uint64_t control_ops = 0;
+
+    std::string ToString() const;
+  };
+
+  explicit StreamerLoadGenerator(const Config& config);
+
+  Report Run(Streamer& streamer);
+
+  // Synthetic process ids chosen well away from real pids and from the
+  // StreamPidOverride values
+  static constexpr uint32_t kTargetPidBase = 0x7F000000;
+  static constexpr uint32_t kClientPidBase = 0x7F800000;
+  static constexpr uint32_t kChurnTargetPidBase = 0x7F400000;
+  static constexpr uint32_t kChurnClientPidBase = 0x7FC00000;
+
+ private:
+  struct ProcessStream {
+    uint32_t target_pid = 0;
+    std::string mapfile_name;
+    std::vector<uint32_t> client_pids;
+    std::vector<PmNsmFrameData> template_frames;
+    uint64_t template_span_qpc = 0;
+    std::vector<uint64_t> write_ticks;
+    uint64_t frames_written = 0;
+  };
+
+  struct ReaderStats {
+    uint64_t frames_read = 0;
+    uint64_t lag_sum = 0;
+    uint64_t lag_max = 0;
+    uint64_t frames_lost = 0;
+  };
+
+  void WriterThread(Streamer& streamer, ProcessStream& stream);
+  void ReaderThread(const ProcessStream& stream, bool dies_midway,
+                    ReaderStats& stats);
+  void ChurnThread(Streamer& streamer, uint32_t index,
+                   const std::vector<ProcessStream>& streams, uint64_t& ops);
+  void WriteFrame(Streamer& streamer, ProcessStream& stream, uint64_t seq);
+
+  Config config_;
+  LARGE_INTEGER qpc_frequency_ = {};
+  uint64_t run_start_qpc_ = 0;
+  uint64_t frame_interval_qpc_ = 0;
+  uint64_t frames_per_process_ = 0;
+  std::atomic<bool> writers_done_ = false;
+  GpuTelemetryBitset gpu_telemetry_cap_bits_;
+  CpuTelemetryBitset cpu_telemetry_cap_bits_;
+};
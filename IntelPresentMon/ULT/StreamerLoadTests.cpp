@@ -0,0 +1,115 @@
+#define GOOGLE_GLOG_DLL_DECL
+#define GLOG_NO_ABBREVIATED_SEVERITIES
+#include <glog/logging.h>
+
+#include "gtest/gtest.h"
+#include "..\Streamer\Streamer.h"
+#include "StreamerLoadGenerator.h"
+
+#include <iostream>
+
+// Load scenarios for the streamer. Each prints its report so that runs can be
+// compared across changes; assertions only cover invariants that must hold
+// regardless of machine speed.
+class StreamerLoadULT : public ::testing::Test {
+ public:
+  StreamerLoadGenerator::Report RunScenario(
+      const StreamerLoadGenerator::Config& config) {
+    StreamerLoadGenerator generator{config};
+    auto report = generator.Run(streamer_);
+    const auto name =
+        ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    std::cout << "[" << name << "]\n" << report.ToString() << std::endl;
+    LOG(INFO) << "Streamer load scenario " << name << "\n" << report.ToString();
+    return report;
+  }
+
+  static uint64_t ExpectedFrames(const StreamerLoadGenerator::Config& config) {
+    return uint64_t(config.fps_per_swap_chain *
+                    config.swap_chains_per_process * config.duration_ms /
+                    1000.) *
+           config.num_processes;
+  }
+
+  Streamer streamer_;
+};
+
+TEST_F(StreamerLoadULT, WriteFrameDataSingleProcess) {
+  StreamerLoadGenerator::Config config{
+      .num_processes = 1,
+      .swap_chains_per_process = 1,
+      .fps_per_swap_chain = 2000.,
+      .duration_ms = 1000,
+      .readers_per_process = 1,
+      .write_path = StreamerLoadGenerator::WritePath::kWriteFrameData,
+  };
+  const auto report = RunScenario(config);
+  EXPECT_EQ(report.frames_written, ExpectedFrames(config));
+  EXPECT_GT(report.frames_read, 0ull);
+  EXPECT_LE(report.frames_read + report.frames_lost, report.frames_written);
+  EXPECT_EQ(streamer_.NumActiveStreams(), 0);
+}
+
+TEST_F(StreamerLoadULT, ManyProcessesManySwapChains) {
+  StreamerLoadGenerator::Config config{
+      .num_processes = 8,
+      .swap_chains_per_process = 4,
+      .fps_per_swap_chain = 1000.,
+      .duration_ms = 1000,
+      .readers_per_process = 1,
+  };
+  const auto report = RunScenario(config);
+  EXPECT_EQ(report.frames_written, ExpectedFrames(config));
+  EXPECT_GT(report.frames_read, 0ull);
+  EXPECT_LE(report.frames_read + report.frames_lost, report.frames_written);
+  EXPECT_EQ(streamer_.NumActiveStreams(), 0);
+}
+
+TEST_F(StreamerLoadULT, ConcurrentReaders) {
+  StreamerLoadGenerator::Config config{
+      .num_processes = 2,
+      .swap_chains_per_process = 2,
+      .fps_per_swap_chain = 1000.,
+      .duration_ms = 1000,
+      .readers_per_process = 4,
+  };
+  const auto report = RunScenario(config);
+  EXPECT_EQ(report.frames_written, ExpectedFrames(config));
+  // every reader sees every frame at most once
+  EXPECT_LE(report.frames_read,
+            report.frames_written * config.readers_per_process);
+  EXPECT_EQ(streamer_.NumActiveStreams(), 0);
+}
+
+TEST_F(StreamerLoadULT, ClientDiesMidStream) {
+  StreamerLoadGenerator::Config config{
+      .num_processes = 2,
+      .swap_chains_per_process = 1,
+      .fps_per_swap_chain = 1000.,
+      .duration_ms = 1000,
+      .readers_per_process = 2,
+      .dying_readers_per_process = 1,
+  };
+  const auto report = RunScenario(config);
+  // the writer must not stall on a reader that stopped consuming
+  EXPECT_EQ(report.frames_written, ExpectedFrames(config));
+  EXPECT_GT(report.frames_read, 0ull);
+  EXPECT_EQ(streamer_.NumActiveStreams(), 0);
+}
+
+TEST_F(StreamerLoadULT, ControlChurnDuringWrites) {
+  StreamerLoadGenerator::Config config{
+      .num_processes = 4,
+      .swap_chains_per_process = 2,
+      .fps_per_swap_chain = 1000.,
+      .duration_ms = 1000,
+      .readers_per_process = 1,
+      .churn_clients = 4,
+  };
+  const auto report = RunScenario(config);
+  // writers must keep pace while streams are started and stopped around them
+  EXPECT_EQ(report.frames_written, ExpectedFrames(config));
+  EXPECT_GT(report.frames_read, 0ull);
+  EXPECT_GT(report.control_ops, 0ull);
+  EXPECT_EQ(streamer_.NumActiveStreams(), 0);
+}
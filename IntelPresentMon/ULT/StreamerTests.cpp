@@ -228,8 +228,7 @@ TEST(NamedSharedMemoryTest, CreateNamedSharedMemory) {
 
   std::unique_ptr<Streamer> streamer = std::make_unique<Streamer>();
   streamer->CreateNamedSharedMemory(proc_id);
-  EXPECT_NE(streamer->process_shared_mem_map_.find(proc_id),
-            streamer->process_shared_mem_map_.end());
+  EXPECT_TRUE(streamer->HasStream(proc_id));
   string mapfilename = streamer->GetMapFileName(proc_id);
   EXPECT_EQ(mapfilename, kGlobalPrefix + std::to_string(proc_id));
 
@@ -250,21 +249,18 @@ TEST(NamedSharedMemoryTestCustomSize, CreateNamedSharedMemory) {
   std::unique_ptr<Streamer> streamer = std::make_unique<Streamer>();
   // Buf size 0
   streamer->CreateNamedSharedMemory(proc_id, 0);
-  EXPECT_EQ(streamer->process_shared_mem_map_.find(proc_id),
-            streamer->process_shared_mem_map_.end());
+  EXPECT_FALSE(streamer->HasStream(proc_id));
 
   // Normal buf size
   streamer->CreateNamedSharedMemory(proc_id, kNsmBufSize);
-  EXPECT_NE(streamer->process_shared_mem_map_.find(proc_id),
-            streamer->process_shared_mem_map_.end());
+  EXPECT_TRUE(streamer->HasStream(proc_id));
   string mapfilename = streamer->GetMapFileName(proc_id);
   EXPECT_EQ(mapfilename, kGlobalPrefix + std::to_string(proc_id));
   streamer->StopAllStreams();
 
   // Oversized buf size
   streamer->CreateNamedSharedMemory(proc_id, kNsmBufSizeLarge);
-  EXPECT_EQ(streamer->process_shared_mem_map_.find(proc_id),
-            streamer->process_shared_mem_map_.end());
+  EXPECT_FALSE(streamer->HasStream(proc_id));
    mapfilename = streamer->GetMapFileName(proc_id);
 }
 
@@ -305,4 +301,167 @@ TEST_F(StreamerULT, ReadBeforeWrite) {
 	PmNsmFrameData* client_read_data = nullptr;
 	client_read_data = client.ReadLatestFrame();
 	EXPECT_EQ(client_read_data, nullptr);
-}
\ No newline at end of file
+}
+class StreamerEtlBackpressureULT : public ::testing::Test {
+ public:
+  static constexpr uint64_t kRingFrames = 16;
+
+  void SetUp() override {
+    // Small ring so that the writer has to wait on the client
+    const auto nsm_size = std::to_string(sizeof(NamedSharedMemoryHeader) +
+                                         kRingFrames * sizeof(PmNsmFrameData));
+    _putenv_s("PM2_NSM_SIZE", nsm_size.c_str());
+    streamer_.SetStreamMode(StreamMode::kOfflineEtl);
+    streamer_.StartStreaming(GetCurrentProcessId(), kEtlPid, mapfile_name_);
+    ASSERT_FALSE(mapfile_name_.empty());
+  }
+
+  void TearDown() override {
+    streamer_.StopAllStreams();
+    _putenv_s("PM2_NSM_SIZE", "");
+  }
+
+  void WriteFrames(int count) {
+    GpuTelemetryBitset gpu_telemetry_cap_bits;
+    CpuTelemetryBitset cpu_telemetry_cap_bits;
+    PresentMonPowerTelemetryInfo power_telemetry_info{};
+    CpuTelemetryInfo cpu_telemetry_info{};
+    for (int i = 0; i < count && !streamer_.IsTimedOut(); i++) {
+      PresentEvent present_event;
+      present_event.ProcessId = GetCurrentProcessId();
+      present_event.PresentStartTime = uint64_t(i) + 1;
+      streamer_.ProcessPresentEvent(&present_event, &power_telemetry_info,
+                                    &cpu_telemetry_info, 0, 0, L"etl.exe",
+                                    gpu_telemetry_cap_bits,
+                                    cpu_telemetry_cap_bits);
+    }
+  }
+
+  static constexpr uint32_t kEtlPid =
+      static_cast<uint32_t>(StreamPidOverride::kEtlPid);
+  Streamer streamer_;
+  string mapfile_name_;
+};
+
+TEST_F(StreamerEtlBackpressureULT, WriterWaitsForSlowClient) {
+  const int kNumFrames = int(kRingFrames) * 4;
+  streamer_.SetEtlWriteTimeout(std::chrono::milliseconds(2000));
+
+  int frames_read = 0;
+  std::thread client_thread([&] {
+    StreamClient client(mapfile_name_, true);
+    PM_FRAME_DATA frame_data{};
+    PM_FRAME_DATA* p_frame_data = &frame_data;
+    while (frames_read < kNumFrames) {
+      const auto status = client.DequeueFrame(&p_frame_data);
+      if (status == PM_STATUS::PM_STATUS_SUCCESS) {
+        frames_read++;
+      } else if (status == PM_STATUS::PM_STATUS_NO_DATA) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      } else {
+        break;
+      }
+    }
+  });
+
+  WriteFrames(kNumFrames);
+  client_thread.join();
+
+  EXPECT_FALSE(streamer_.IsTimedOut());
+  EXPECT_EQ(frames_read, kNumFrames);
+}
+
+TEST_F(StreamerEtlBackpressureULT, WriterTimesOutWithoutClient) {
+  streamer_.SetEtlWriteTimeout(std::chrono::milliseconds(50));
+
+  const auto start = std::chrono::steady_clock::now();
+  WriteFrames(int(kRingFrames) * 2);
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  EXPECT_TRUE(streamer_.IsTimedOut());
+  // one timeout period, not one per frame
+  EXPECT_LT(elapsed, std::chrono::milliseconds(1000));
+}
+
+class StreamerRingCapacityULT : public ::testing::Test {
+ public:
+  void TearDown() override { streamer_.StopAllStreams(); }
+
+  void WriteFrames(uint32_t first_seq, uint32_t count) {
+    GpuTelemetryBitset gpu_telemetry_cap_bits;
+    CpuTelemetryBitset cpu_telemetry_cap_bits;
+    for (uint32_t i = 0; i < count; i++) {
+      PmNsmFrameData data{};
+      data.present_event.ProcessId = GetCurrentProcessId();
+      data.present_event.QueueSubmitSequence = first_seq + i;
+      streamer_.WriteFrameData(GetCurrentProcessId(), &data,
+                               gpu_telemetry_cap_bits, cpu_telemetry_cap_bits);
+    }
+  }
+
+  Streamer streamer_;
+};
+
+TEST_F(StreamerRingCapacityULT, StartStreamingWithCapacity) {
+  const DWORD proc_id = GetCurrentProcessId();
+  string mapfile_name;
+  EXPECT_EQ(streamer_.StartStreaming(proc_id, proc_id, mapfile_name, 100),
+            PM_STATUS::PM_STATUS_SUCCESS);
+  StreamClient client(mapfile_name, false);
+  const auto header = client.GetNamedSharedMemView()->GetHeader();
+  // one slot is kept free to tell a full ring from an empty one
+  EXPECT_EQ(header->max_entries, 101ull);
+  EXPECT_EQ(header->buf_size, NamedSharedMem::GetBufSizeForFrames(100));
+}
+
+TEST_F(StreamerRingCapacityULT, CapacityClampedToLimits) {
+  const DWORD proc_id = GetCurrentProcessId();
+  streamer_.SetRingCapacityLimits(60, 200);
+
+  string mapfile_name;
+  streamer_.StartStreaming(proc_id, proc_id, mapfile_name, 1);
+  {
+    StreamClient client(mapfile_name, false);
+    EXPECT_EQ(client.GetNamedSharedMemView()->GetHeader()->max_entries, 61ull);
+  }
+  streamer_.StopAllStreams();
+
+  streamer_.StartStreaming(proc_id, proc_id, mapfile_name, 100000);
+  StreamClient client(mapfile_name, false);
+  EXPECT_EQ(client.GetNamedSharedMemView()->GetHeader()->max_entries, 201ull);
+}
+
+TEST_F(StreamerRingCapacityULT, OverrunCountedByWriterAndClient) {
+  const DWORD proc_id = GetCurrentProcessId();
+  streamer_.SetRingCapacityLimits(60, 60);
+  string mapfile_name;
+  streamer_.StartStreaming(proc_id, proc_id, mapfile_name, 60);
+  WriteFrames(0, 10);
+
+  StreamClient client(mapfile_name, false);
+  const auto header = client.GetNamedSharedMemView()->GetHeader();
+  const PmNsmFrameData* frame = nullptr;
+  // First consume starts tracking at the current write position
+  EXPECT_EQ(client.ConsumePtrToNextNsmFrameData(&frame),
+            PM_STATUS::PM_STATUS_SUCCESS);
+
+  // Lap the client without it consuming
+  WriteFrames(10, 200);
+  EXPECT_EQ(header->num_frames_written, 210ull);
+  EXPECT_EQ(header->num_frames_overwritten, 210ull - 60);
+
+  EXPECT_EQ(client.ConsumePtrToNextNsmFrameData(&frame),
+            PM_STATUS::PM_STATUS_SUCCESS);
+  EXPECT_EQ(frame, nullptr);
+  EXPECT_EQ(client.GetNumFramesLost(), 200ull);
+
+  // After skipping ahead the client sees every new frame in order
+  WriteFrames(210, 5);
+  for (uint32_t seq = 210; seq < 215; seq++) {
+    ASSERT_EQ(client.ConsumePtrToNextNsmFrameData(&frame),
+              PM_STATUS::PM_STATUS_SUCCESS);
+    ASSERT_NE(frame, nullptr);
+    EXPECT_EQ(frame->present_event.QueueSubmitSequence, seq);
+  }
+  EXPECT_EQ(client.GetNumFramesLost(), 200ull);
+}
@@ -0,0 +1,206 @@
+// Copyright (C) 2023 Intel Corporation
+// SPDX-License-Identifier: MIT
+#include <Core/source/win/WinAPI.h>
+#include <psapi.h>
+
+#include <CppUnitTest.h>
+
+#include <Core/source/pmon/CaptureSpool.h>
+#include <Core/source/pmon/StatisticsTracker.h>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <sstream>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+
+namespace AlgorithmTests
+{
+	using namespace p2c::pmon;
+
+	// stream that only counts what is written to it
+	class CountingBuffer : public std::streambuf
+	{
+	public:
+		size_t count = 0;
+	protected:
+		int_type overflow(int_type c) override
+		{
+			count++;
+			return traits_type::not_eof(c);
+		}
+		std::streamsize xsputn(const char*, std::streamsize n) override
+		{
+			count += size_t(n);
+			return n;
+		}
+	};
+
+	// stream that fails every write
+	class FailingBuffer : public std::streambuf
+	{
+	protected:
+		int_type overflow(int_type) override
+		{
+			return traits_type::eof();
+		}
+		std::streamsize xsputn(const char*, std::streamsize) override
+		{
+			return 0;
+		}
+	};
+
+	struct SoakFrame
+	{
+		uint64_t index;
+		double time;
+		std::array<double, 24> metrics;
+	};
+
+	void FormatSoakFrame(const uint8_t* pBlob, std::string& out)
+	{
+		SoakFrame frame;
+		std::memcpy(&frame, pBlob, sizeof(frame));
+		std::array<char, 32> buffer;
+		out.append(buffer.data(), std::to_chars(buffer.data(), buffer.data() + buffer.size(), frame.index).ptr);
+		for (auto v : frame.metrics) {
+			out += ',';
+			out.append(buffer.data(), std::to_chars(buffer.data(), buffer.data() + buffer.size(), v,
+				std::chars_format::general, 6).ptr);
+		}
+		out += '\n';
+	}
+
+	size_t GetWorkingSetBytes()
+	{
+		PROCESS_MEMORY_COUNTERS counters{};
+		GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+		return counters.WorkingSetSize;
+	}
+
+	TEST_CLASS(TestCaptureSpool)
+	{
+	public:
+		TEST_METHOD(WritesAllFramesInOrder)
+		{
+			std::ostringstream out;
+			{
+				CaptureSpool spool{ out, sizeof(uint64_t), [](const uint8_t* pBlob, std::string& text) {
+					uint64_t v;
+					std::memcpy(&v, pBlob, sizeof(v));
+					text += std::to_string(v);
+					text += '\n';
+				}, 64 };
+				for (uint64_t i = 0; i < 10'000; i++) {
+					spool.Push(reinterpret_cast<const uint8_t*>(&i));
+					if (i % 7 == 0) {
+						spool.Submit();
+					}
+				}
+			}
+			std::istringstream in{ out.str() };
+			uint64_t v, expected = 0;
+			while (in >> v) {
+				Assert::AreEqual(expected, v);
+				expected++;
+			}
+			Assert::AreEqual(uint64_t(10'000), expected);
+		}
+		TEST_METHOD(DrainWritesEverythingPushed)
+		{
+			std::ostringstream out;
+			CaptureSpool spool{ out, sizeof(uint64_t), [](const uint8_t* pBlob, std::string& text) {
+				uint64_t v;
+				std::memcpy(&v, pBlob, sizeof(v));
+				text += std::to_string(v);
+				text += '\n';
+			}, 64 };
+			for (uint64_t i = 0; i < 1'000; i++) {
+				spool.Push(reinterpret_cast<const uint8_t*>(&i));
+				if (i % 7 == 0) {
+					spool.Submit();
+				}
+			}
+			spool.Drain();
+			Assert::AreEqual(uint64_t(1'000), spool.GetFramesWritten());
+			Assert::IsTrue(out.str().ends_with("999\n"));
+		}
+		TEST_METHOD(WriteFailureDropsFrames)
+		{
+			FailingBuffer sink;
+			std::ostream out{ &sink };
+			CaptureSpool spool{ out, sizeof(uint64_t), [](const uint8_t*, std::string& text) {
+				text += "frame\n";
+			}, 64 };
+			for (uint64_t i = 0; i < 1'000; i++) {
+				spool.Push(reinterpret_cast<const uint8_t*>(&i));
+				spool.Submit();
+			}
+			// returns rather than waiting on a writer that has given up
+			spool.Drain();
+			Assert::AreEqual(uint64_t(0), spool.GetFramesWritten());
+		}
+		// soak benchmark: 4 hours of frames at 144fps through the spool and stats tracker, batched
+		// like the overlay consumes them; reports steady-state working set and writer cpu
+		// opt-in, as it takes minutes: runs only when PM_SOAK_TESTS is set in the environment
+		BEGIN_TEST_METHOD_ATTRIBUTE(SoakBoundedMemory)
+			TEST_METHOD_ATTRIBUTE(L"TestCategory", L"Soak")
+		END_TEST_METHOD_ATTRIBUTE()
+		TEST_METHOD(SoakBoundedMemory)
+		{
+			if (!GetEnvironmentVariableA("PM_SOAK_TESTS", nullptr, 0)) {
+				Logger::WriteMessage("soak: skipped, set PM_SOAK_TESTS to run\n");
+				return;
+			}
+			constexpr uint64_t nFrames = 144ull * 60 * 60 * 4;
+			constexpr uint64_t framesPerBatch = 150;
+			CountingBuffer sink;
+			std::ostream out{ &sink };
+			StatisticsTracker stats;
+			size_t warmWorkingSet = 0;
+			size_t finalWorkingSet = 0;
+			double writerCpuSeconds = 0.;
+			const auto start = std::chrono::steady_clock::now();
+			{
+				CaptureSpool spool{ out, sizeof(SoakFrame), FormatSoakFrame };
+				SoakFrame frame{};
+				for (uint64_t i = 0; i < nFrames; i++) {
+					frame.index = i;
+					frame.time = double(i) / 144.;
+					for (size_t m = 0; m < frame.metrics.size(); m++) {
+						frame.metrics[m] = 6.94 + double((i * 31 + m) % 97) * 0.01;
+					}
+					stats.Push(frame.metrics[0]);
+					spool.Push(reinterpret_cast<const uint8_t*>(&frame));
+					if (i % framesPerBatch == framesPerBatch - 1) {
+						spool.Submit();
+					}
+					// steady state is reached once the stats tracker has switched over to its histogram
+					if (i == nFrames / 4) {
+						warmWorkingSet = GetWorkingSetBytes();
+					}
+				}
+				spool.Submit();
+				spool.Drain();
+				// measured with everything written but the spool and its buffers still live
+				writerCpuSeconds = spool.GetWriterCpuSeconds();
+				finalWorkingSet = GetWorkingSetBytes();
+				Assert::AreEqual(nFrames, spool.GetFramesWritten());
+			}
+			const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			Logger::WriteMessage(std::format(
+				"soak: {} frames, {:.1f} MB csv, {:.2f}s wall, writer cpu {:.2f}s ({:.0f} ns/frame), "
+				"working set {:.1f} MB warm -> {:.1f} MB final\n",
+				nFrames, double(sink.count) / 1'000'000., elapsed, writerCpuSeconds,
+				writerCpuSeconds * 1e9 / double(nFrames),
+				double(warmWorkingSet) / 1'000'000., double(finalWorkingSet) / 1'000'000.).c_str());
+			Assert::AreEqual(size_t(nFrames), stats.GetCount());
+			Assert::IsTrue(sink.count > 0);
+			// memory must not grow with capture length once warm
+			Assert::IsTrue(finalWorkingSet < warmWorkingSet + 16 * 1024 * 1024);
+		}
+	};
+}
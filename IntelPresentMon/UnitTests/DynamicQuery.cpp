@@ -0,0 +1,71 @@
+// Copyright (C) 2023 Intel Corporation
+// SPDX-License-Identifier: MIT
+
+#include <CppUnitTest.h>
+#include <crtdbg.h>
+
+#include <Core/source/pmon/DynamicQuery.h>
+#include <PresentMonAPI2/Internal.h>
+#include <PresentMonAPIWrapper/PresentMonAPIWrapper.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+
+namespace AlgorithmTests
+{
+	TEST_CLASS(TestDynamicQueryRange)
+	{
+	public:
+		TEST_METHOD_INITIALIZE(BeforeEachTestMethod)
+		{
+			pmSetMiddlewareAsMock_(true);
+		}
+		TEST_METHOD(SelectsPopulatedRangeSamples)
+		{
+			pmapi::Session session;
+			auto tracker = session.TrackProcess(4004);
+			const p2c::kern::QualifiedMetric qmets[]{
+				{ .metricId = PM_METRIC_CPU_UTILIZATION, .statId = PM_STAT_AVG },
+			};
+			p2c::pmon::DynamicQuery query{ session, 1000., 0., qmets };
+			pmMiddlewareAdvanceTime_(session.GetHandle(), 3);
+
+			// points at t = -1, 0, 1, 2, 3; the one before time zero has no history
+			query.PollRange(tracker, 1., 5);
+			Assert::AreEqual(4u, query.GetRangeSampleCount());
+			for (uint32_t i = 0; i < 4; i++) {
+				query.SelectRangeSample(i);
+				const auto pBlob = query.GetBlobData();
+				Assert::IsNotNull(pBlob);
+				const auto expected = i % 2 == 0 ? (double)PM_METRIC_CPU_UTILIZATION : 0.;
+				Assert::AreEqual(expected, *reinterpret_cast<const double*>(pBlob));
+			}
+			// points past the populated ones have no data
+			query.SelectRangeSample(4);
+			Assert::IsNull(query.GetBlobData());
+
+			// a regular poll clears the selection and matches the newest point
+			query.Poll(tracker);
+			Assert::IsNotNull(query.GetBlobData());
+			Assert::AreEqual(0., *reinterpret_cast<const double*>(query.GetBlobData()));
+		}
+		TEST_METHOD(RepeatedRangePollsKeepTheirCount)
+		{
+			pmapi::Session session;
+			auto tracker = session.TrackProcess(4004);
+			const p2c::kern::QualifiedMetric qmets[]{
+				{ .metricId = PM_METRIC_CPU_UTILIZATION, .statId = PM_STAT_AVG },
+			};
+			p2c::pmon::DynamicQuery query{ session, 1000., 0., qmets };
+			pmMiddlewareAdvanceTime_(session.GetHandle(), 3);
+
+			// the range container is reused when the sample count is unchanged
+			query.PollRange(tracker, 1., 3);
+			Assert::AreEqual(3u, query.GetRangeSampleCount());
+			query.PollRange(tracker, 1., 3);
+			Assert::AreEqual(3u, query.GetRangeSampleCount());
+			query.SelectRangeSample(2);
+			Assert::IsNotNull(query.GetBlobData());
+		}
+	};
+}
@@ -0,0 +1,77 @@
+// Copyright (C) 2023 Intel Corporation
+// SPDX-License-Identifier: MIT
+
+#include <CppUnitTest.h>
+
+#include <Core/source/gfx/layout/GraphData.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+
+namespace AlgorithmTests
+{
+	using namespace p2c::gfx::lay;
+
+	TEST_CLASS(TestGraphData)
+	{
+	public:
+		TEST_METHOD(FrontIsNewest)
+		{
+			GraphData data{ 10. };
+			data.Push({ .value = 1.f, .time = 0. });
+			data.Push({ .value = std::nullopt, .time = 1. });
+			data.Push({ .value = 3.f, .time = 2. });
+			Assert::AreEqual(size_t(3), data.Size());
+			Assert::AreEqual(3.f, *data.Front().value);
+			Assert::AreEqual(2., data.Front().time);
+			Assert::IsFalse(data[1].value.has_value());
+			Assert::AreEqual(1.f, *data.Back().value);
+		}
+		TEST_METHOD(GrowsPastCapacity)
+		{
+			GraphData data{ 1000., 4 };
+			for (int i = 0; i < 100; i++) {
+				data.Push({ .value = float(i), .time = double(i) });
+			}
+			Assert::AreEqual(size_t(100), data.Size());
+			for (size_t i = 0; i < 100; i++) {
+				Assert::AreEqual(float(99 - i), *data[i].value);
+			}
+			Assert::AreEqual(0.f, *data.Min());
+			Assert::AreEqual(99.f, *data.Max());
+		}
+		TEST_METHOD(TrimUpdatesExtremes)
+		{
+			GraphData data{ 2., 4 };
+			const DataPoint batch[] = {
+				{ .value = 10.f, .time = 0. },
+				{ .value = 1.f, .time = 1. },
+				{ .value = 5.f, .time = 2. },
+				{ .value = 7.f, .time = 3. },
+				{ .value = 6.f, .time = 4. },
+			};
+			data.Push(batch);
+			Assert::AreEqual(1.f, *data.Min());
+			Assert::AreEqual(10.f, *data.Max());
+			// cutoff 2.0 keeps one point older than the window (t=2 is not < cutoff, so t=1 stays)
+			data.Trim(4.);
+			Assert::AreEqual(size_t(4), data.Size());
+			Assert::AreEqual(1.f, *data.Min());
+			Assert::AreEqual(7.f, *data.Max());
+			data.Trim(5.);
+			Assert::AreEqual(size_t(3), data.Size());
+			Assert::AreEqual(5.f, *data.Min());
+			Assert::AreEqual(7.f, *data.Max());
+		}
+		TEST_METHOD(InvalidPointsIgnoredByExtremes)
+		{
+			GraphData data{ 10. };
+			data.Push({ .value = std::nullopt, .time = 0. });
+			Assert::IsFalse(data.Min().has_value());
+			Assert::IsFalse(data.Max().has_value());
+			data.Push({ .value = 4.f, .time = 1. });
+			Assert::AreEqual(4.f, *data.Min());
+			Assert::AreEqual(4.f, *data.Max());
+		}
+	};
+}
@@ -0,0 +1,57 @@
+// Copyright (C) 2023 Intel Corporation
+// SPDX-License-Identifier: MIT
+
+#include <CppUnitTest.h>
+
+#include <Core/source/pmon/metric/MetricFetcher.h>
+#include <Core/source/infra/util/DebugCounter.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+
+namespace AlgorithmTests
+{
+	using namespace p2c::pmon::met;
+	using p2c::infra::util::TextAllocationCounter;
+
+	class FixedFetcher : public MetricFetcher
+	{
+	public:
+		std::optional<float> ReadValue() override
+		{
+			return value;
+		}
+		std::optional<float> value;
+	};
+
+	TEST_CLASS(TestMetricFetcherText)
+	{
+	public:
+		TEST_METHOD(FractionalDigitsShrinkWithMagnitude)
+		{
+			FixedFetcher f;
+			f.value = 0.f;
+			Assert::AreEqual(L"0.00", f.ReadStringValue().c_str());
+			f.value = 1.234f;
+			Assert::AreEqual(L"1.23", f.ReadStringValue().c_str());
+			f.value = 12.345f;
+			Assert::AreEqual(L"12.3", f.ReadStringValue().c_str());
+			f.value = 123.4f;
+			Assert::AreEqual(L"123", f.ReadStringValue().c_str());
+			f.value = -5.5f;
+			Assert::AreEqual(L"-5.50", f.ReadStringValue().c_str());
+			f.value = {};
+			Assert::AreEqual(L"NA", f.ReadStringValue().c_str());
+		}
+		TEST_METHOD(ReadingDoesNotAllocate)
+		{
+			FixedFetcher f;
+			TextAllocationCounter().Take();
+			for (int i = 0; i < 100; i++) {
+				f.value = float(i) * 1234.567f;
+				f.ReadStringValue();
+			}
+			Assert::AreEqual(uint64_t(0), TextAllocationCounter().Take());
+		}
+	};
+}
@@ -0,0 +1,91 @@
+// Copyright (C) 2023 Intel Corporation
+// SPDX-License-Identifier: MIT
+
+#include <CppUnitTest.h>
+
+#include <Core/source/gfx/impl/RetainedGeometryCache.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+
+namespace AlgorithmTests
+{
+	using namespace p2c::gfx::impl;
+
+	struct TestBatch
+	{
+		uint32_t indexBegin;
+		uint32_t indexEnd;
+		uint32_t vertexOffset;
+	};
+	using Cache = RetainedGeometryCache<float, TestBatch>;
+
+	TEST_CLASS(TestRetainedGeometryCache)
+	{
+	public:
+		TEST_METHOD(RecordPacksWithOffsets)
+		{
+			Cache c;
+			const auto k1 = c.MakeKey();
+			const auto k2 = c.MakeKey();
+			Assert::IsFalse(c.Use(k1, 5));
+			{
+				auto& b = c.Record(k1, 5);
+				b.vertices = { 1.f, 2.f };
+				b.indices = { 0, 1 };
+				b.batches.push_back({ 0, 2, 0 });
+			}
+			{
+				auto& b = c.Record(k2, 6);
+				b.vertices = { 3.f, 4.f, 5.f };
+				b.indices = { 0, 1, 2 };
+				b.batches.push_back({ 0, 3, 0 });
+			}
+			Assert::IsTrue(c.Collect());
+			Assert::AreEqual(size_t(5), c.GetVertices().size());
+			Assert::AreEqual(size_t(5), c.GetIndices().size());
+			Assert::AreEqual(size_t(2), c.GetBatches().size());
+			Assert::AreEqual(2u, c.GetBatches()[1].indexBegin);
+			Assert::AreEqual(5u, c.GetBatches()[1].indexEnd);
+			Assert::AreEqual(2u, c.GetBatches()[1].vertexOffset);
+		}
+		TEST_METHOD(ReuseDoesNotRepack)
+		{
+			Cache c;
+			const auto k = c.MakeKey();
+			c.Record(k, 5).vertices = { 1.f };
+			Assert::IsTrue(c.Collect());
+			Assert::IsTrue(c.Use(k, 5));
+			Assert::IsFalse(c.Collect());
+			Assert::AreEqual(size_t(1), c.GetVertices().size());
+		}
+		TEST_METHOD(UnusedBlocksCollected)
+		{
+			Cache c;
+			const auto k1 = c.MakeKey();
+			const auto k2 = c.MakeKey();
+			c.Record(k1, 5).vertices = { 1.f, 2.f };
+			c.Record(k2, 6).vertices = { 3.f };
+			Assert::IsTrue(c.Collect());
+			Assert::IsTrue(c.Use(k1, 5));
+			Assert::IsTrue(c.Collect());
+			Assert::AreEqual(size_t(1), c.GetBlockCount());
+			Assert::AreEqual(size_t(2), c.GetVertices().size());
+			Assert::IsFalse(c.Use(k2, 6));
+		}
+		TEST_METHOD(SignatureAndInvalidation)
+		{
+			Cache c;
+			const auto k = c.MakeKey();
+			c.Record(k, 5);
+			Assert::IsTrue(c.Collect());
+			Assert::IsFalse(c.Use(k, 7));
+			Assert::IsTrue(c.Use(k, 5));
+			c.InvalidateAll();
+			Assert::IsFalse(c.Use(k, 5));
+			c.Record(k, 5);
+			Assert::IsTrue(c.Collect());
+			Assert::IsTrue(c.Use(k, 5));
+		}
+	};
+}
@@ -0,0 +1,86 @@
+// Copyright (C) 2023 Intel Corporation
+// SPDX-License-Identifier: MIT
+
+#include <CppUnitTest.h>
+
+#include <Core/source/pmon/StatisticsTracker.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+
+namespace AlgorithmTests
+{
+	using namespace p2c::pmon;
+
+	TEST_CLASS(TestStatisticsTracker)
+	{
+	public:
+		TEST_METHOD(ExactForShortCaptures)
+		{
+			StatisticsTracker s;
+			for (int i = 1; i <= 100; i++) {
+				s.Push(double(i));
+			}
+			Assert::AreEqual(size_t(100), s.GetCount());
+			Assert::AreEqual(0.001, s.GetMin(), 1e-12);
+			Assert::AreEqual(0.1, s.GetMax(), 1e-12);
+			Assert::AreEqual(0.0505, s.GetMean(), 1e-12);
+			Assert::AreEqual(0.0505, s.GetPercentile(.5), 1e-12);
+			Assert::AreEqual(0.09901, s.GetPercentile(.99), 1e-12);
+		}
+		TEST_METHOD(SingleValueInSeconds)
+		{
+			StatisticsTracker s;
+			Assert::AreEqual(-1., s.GetPercentile(.5));
+			s.Push(16.);
+			Assert::AreEqual(0.016, s.GetPercentile(.5), 1e-12);
+			Assert::AreEqual(0.016, s.GetMin(), 1e-12);
+		}
+		TEST_METHOD(PercentileBoundsInSeconds)
+		{
+			StatisticsTracker s;
+			for (double v : { 8., 16., 33. }) {
+				s.Push(v);
+			}
+			// the bounds are the min and max, in the same units as every other percentile
+			Assert::AreEqual(0.008, s.GetPercentile(0.), 1e-12);
+			Assert::AreEqual(0.008, s.GetPercentile(-.5), 1e-12);
+			Assert::AreEqual(0.033, s.GetPercentile(1.), 1e-12);
+			Assert::AreEqual(0.033, s.GetPercentile(1.5), 1e-12);
+			Assert::AreEqual(s.GetMin(), s.GetPercentile(0.), 1e-12);
+			Assert::AreEqual(s.GetMax(), s.GetPercentile(1.), 1e-12);
+		}
+		TEST_METHOD(PercentileBoundsInSecondsForLongCaptures)
+		{
+			StatisticsTracker s;
+			// past the exact limit, so percentiles come from the histogram
+			for (int i = 0; i < 100'000; i++) {
+				s.Push(10. + double(i % 100));
+			}
+			Assert::AreEqual(0.010, s.GetPercentile(0.), 1e-12);
+			Assert::AreEqual(0.109, s.GetPercentile(1.), 1e-12);
+		}
+		TEST_METHOD(HistogramWithinOnePercentForLongCaptures)
+		{
+			StatisticsTracker s;
+			std::mt19937 rng{ 1 };
+			std::lognormal_distribution<double> dist{ 2.8, 0.3 };
+			std::vector<double> all;
+			for (int i = 0; i < 500'000; i++) {
+				const auto v = dist(rng);
+				s.Push(v);
+				all.push_back(v);
+			}
+			std::ranges::sort(all);
+			for (double p : { .5, .95, .99 }) {
+				const auto exact = all[size_t(double(all.size() - 1) * p)] / 1000.;
+				Assert::AreEqual(exact, s.GetPercentile(p), exact * 0.01);
+			}
+			Assert::AreEqual(all.front() / 1000., s.GetMin(), 1e-12);
+			Assert::AreEqual(all.back() / 1000., s.GetMax(), 1e-12);
+		}
+	};
+}
@@ -0,0 +1,88 @@
+// Copyright (C) 2023 Intel Corporation
+// SPDX-License-Identifier: MIT
+
+#include <CppUnitTest.h>
+
+#include <Core/source/gfx/layout/GraphData.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+
+namespace AlgorithmTests
+{
+	using namespace p2c::gfx::lay;
+
+	TEST_CLASS(TestWindowedHistogram)
+	{
+	public:
+		TEST_METHOD(AddRemoveTracksMax)
+		{
+			WindowedHistogram h{ { .minValue = 0.f, .maxValue = 10.f, .binCount = 10 } };
+			h.Add(1.5f);
+			h.Add(1.6f);
+			h.Add(5.f);
+			Assert::AreEqual(2, h.GetBins()[1]);
+			Assert::AreEqual(1, h.GetBins()[5]);
+			Assert::AreEqual(2, h.GetMaxCount());
+			h.Remove(1.5f);
+			Assert::AreEqual(1, h.GetMaxCount());
+			h.Remove(5.f);
+			Assert::AreEqual(1, h.GetMaxCount());
+			h.Remove(1.6f);
+			Assert::AreEqual(0, h.GetMaxCount());
+		}
+		TEST_METHOD(MaxHeldByOtherBin)
+		{
+			WindowedHistogram h{ { .minValue = 0.f, .maxValue = 10.f, .binCount = 10 } };
+			h.Add(1.f);
+			h.Add(1.f);
+			h.Add(7.f);
+			h.Add(7.f);
+			h.Remove(1.f);
+			Assert::AreEqual(2, h.GetMaxCount());
+			h.Remove(7.f);
+			Assert::AreEqual(1, h.GetMaxCount());
+		}
+		TEST_METHOD(OutOfRangeIgnored)
+		{
+			WindowedHistogram h{ { .minValue = 0.f, .maxValue = 10.f, .binCount = 10 } };
+			h.Add(-0.5f);
+			h.Add(10.f);
+			h.Add(42.f);
+			Assert::AreEqual(0, h.GetMaxCount());
+			h.Remove(42.f);
+			Assert::AreEqual(0, h.GetMaxCount());
+		}
+		TEST_METHOD(GraphDataPushTrim)
+		{
+			GraphData data{ 1. };
+			auto pHist = data.GetHistogram({ .minValue = 0.f, .maxValue = 10.f, .binCount = 10 });
+			data.Push({ .value = 2.f, .time = 0. });
+			data.Push({ .value = 2.f, .time = 0.5 });
+			data.Push({ .value = std::nullopt, .time = 0.75 });
+			data.Push({ .value = 8.f, .time = 1. });
+			Assert::AreEqual(2, pHist->GetBins()[2]);
+			Assert::AreEqual(2, pHist->GetMaxCount());
+			// trims all but the last point outside the window
+			data.Push({ .value = 8.f, .time = 2.5 });
+			data.Trim(2.5);
+			Assert::AreEqual(0, pHist->GetBins()[2]);
+			Assert::AreEqual(2, pHist->GetBins()[8]);
+			Assert::AreEqual(2, pHist->GetMaxCount());
+		}
+		TEST_METHOD(GraphDataSharesAndRebuilds)
+		{
+			GraphData data{ 10. };
+			data.Push({ .value = 2.f, .time = 0. });
+			data.Push({ .value = 6.f, .time = 1. });
+			auto pHist1 = data.GetHistogram({ .minValue = 0.f, .maxValue = 10.f, .binCount = 10 });
+			auto pHist2 = data.GetHistogram({ .minValue = 0.f, .maxValue = 10.f, .binCount = 10 });
+			Assert::IsTrue(pHist1 == pHist2);
+			// new binning builds new histogram from data already in window
+			auto pHist3 = data.GetHistogram({ .minValue = 0.f, .maxValue = 10.f, .binCount = 2 });
+			Assert::IsTrue(pHist1 != pHist3);
+			Assert::AreEqual(1, pHist3->GetBins()[0]);
+			Assert::AreEqual(1, pHist3->GetBins()[1]);
+		}
+	};
+}
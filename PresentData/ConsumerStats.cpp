@@ -0,0 +1,148 @@
+// Copyright (C) 2024 Intel Corporation
+// SPDX-License-Identifier: MIT
+
+#include "ConsumerStats.hpp"
+
+namespace {
+
+// Opcodes of the RT_LostEvent events (EVENT_TRACE_TYPE_RT_LOST_*)
+enum {
+    RT_LOST_EVENT  = 0x20,
+    RT_LOST_BUFFER = 0x21,
+    RT_LOST_FILE   = 0x22,
+};
+
+template<typename T, size_t N>
+void ZeroCounters(std::atomic<T> (&counters)[N])
+{
+    for (auto& counter : counters) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+}
+
+template<typename T, size_t N>
+void CopyCounters(uint64_t (&dst)[N], std::atomic<T> const (&src)[N])
+{
+    for (size_t i = 0; i < N; ++i) {
+        dst[i] = src[i].load(std::memory_order_relaxed);
+    }
+}
+
+}
+
+char const* ConsumerProviderToString(ConsumerProvider provider)
+{
+    switch (provider) {
+    case ConsumerProvider::DxgKrnl:       return "DxgKrnl";
+    case ConsumerProvider::DXGI:          return "DXGI";
+    case ConsumerProvider::D3D9:          return "D3D9";
+    case ConsumerProvider::Win32k:        return "Win32k";
+    case ConsumerProvider::DWM:           return "DWM";
+    case ConsumerProvider::Process:       return "Process";
+    case ConsumerProvider::EventMetadata: return "EventMetadata";
+    case ConsumerProvider::Win7DxgKrnl:   return "Win7DxgKrnl";
+    case ConsumerProvider::Win7DWM:       return "Win7DWM";
+    case ConsumerProvider::Other:         return "Other";
+    }
+    return "Unknown";
+}
+
+char const* TrackingCollectionToString(TrackingCollection collection)
+{
+    switch (collection) {
+    case TrackingCollection::PresentByThreadId:                    return "PresentByThreadId";
+    case TrackingCollection::OrderedPresentsByProcessId:           return "OrderedPresentsByProcessId";
+    case TrackingCollection::PresentBySubmitSequence:              return "PresentBySubmitSequence";
+    case TrackingCollection::PresentByWin32KPresentHistoryToken:   return "PresentByWin32KPresentHistoryToken";
+    case TrackingCollection::PresentByDxgkPresentHistoryToken:     return "PresentByDxgkPresentHistoryToken";
+    case TrackingCollection::PresentByDxgkPresentHistoryTokenData: return "PresentByDxgkPresentHistoryTokenData";
+    case TrackingCollection::PresentByDxgkContext:                 return "PresentByDxgkContext";
+    case TrackingCollection::LastPresentByWindow:                  return "LastPresentByWindow";
+    case TrackingCollection::PresentsWaitingForDWM:                return "PresentsWaitingForDWM";
+    case TrackingCollection::DeferredCompletions:                  return "DeferredCompletions";
+    case TrackingCollection::AgingWheel:                           return "AgingWheel";
+    }
+    return "Unknown";
+}
+
+char const* LostPresentReasonToString(LostPresentReason reason)
+{
+    switch (reason) {
+    case LostPresentReason::Age:             return "Age";
+    case LostPresentReason::UnexpectedEvent: return "UnexpectedEvent";
+    case LostPresentReason::ThreadReused:    return "ThreadReused";
+    case LostPresentReason::TokenReused:     return "TokenReused";
+    case LostPresentReason::UnsupportedMode: return "UnsupportedMode";
+    }
+    return "Unknown";
+}
+
+ConsumerStats::ConsumerStats()
+{
+    for (auto& counters : mEventCount) {
+        ZeroCounters(counters);
+    }
+    ZeroCounters(mHandlerTimeHistogram);
+    ZeroCounters(mTrackingSize);
+    ZeroCounters(mTrackingSizePeak);
+    ZeroCounters(mLostPresentCount);
+    mSampledEventCount   = 0;
+    mHandlerTime         = 0;
+    mDecodeTime          = 0;
+    mRealtimeLostEvents  = 0;
+    mRealtimeLostBuffers = 0;
+    mRealtimeLostFiles   = 0;
+}
+
+void ConsumerStats::AddSampledTime(uint64_t handlerTime, uint64_t decodeTime)
+{
+    uint32_t bucket = 0;
+    for (auto t = handlerTime >> 1; t != 0 && bucket + 1 < ConsumerStatsSnapshot::kHistogramBucketCount; t >>= 1) {
+        bucket += 1;
+    }
+
+    Increment(&mSampledEventCount);
+    Increment(&mHandlerTime, handlerTime);
+    Increment(&mDecodeTime, decodeTime);
+    Increment(&mHandlerTimeHistogram[bucket]);
+}
+
+void ConsumerStats::SetTrackingSize(TrackingCollection collection, size_t size)
+{
+    auto i = (size_t) collection;
+    mTrackingSize[i].store(size, std::memory_order_relaxed);
+    if (size > mTrackingSizePeak[i].load(std::memory_order_relaxed)) {
+        mTrackingSizePeak[i].store(size, std::memory_order_relaxed);
+    }
+}
+
+void ConsumerStats::CountRealtimeLoss(uint8_t opcode)
+{
+    switch (opcode) {
+    case RT_LOST_EVENT:  Increment(&mRealtimeLostEvents); break;
+    case RT_LOST_BUFFER: Increment(&mRealtimeLostBuffers); break;
+    case RT_LOST_FILE:   Increment(&mRealtimeLostFiles); break;
+    }
+}
+
+void ConsumerStats::GetSnapshot(ConsumerStatsSnapshot* snapshot) const
+{
+    snapshot->mTotalEventCount = 0;
+    for (size_t i = 0; i < (size_t) ConsumerProvider::Count; ++i) {
+        CopyCounters(snapshot->mEventCount[i], mEventCount[i]);
+        for (auto count : snapshot->mEventCount[i]) {
+            snapshot->mTotalEventCount += count;
+        }
+    }
+
+    snapshot->mSampledEventCount = mSampledEventCount.load(std::memory_order_relaxed);
+    snapshot->mHandlerTime       = mHandlerTime.load(std::memory_order_relaxed);
+    snapshot->mDecodeTime        = mDecodeTime.load(std::memory_order_relaxed);
+    CopyCounters(snapshot->mHandlerTimeHistogram, mHandlerTimeHistogram);
+    CopyCounters(snapshot->mTrackingSize, mTrackingSize);
+    CopyCounters(snapshot->mTrackingSizePeak, mTrackingSizePeak);
+    CopyCounters(snapshot->mLostPresentCount, mLostPresentCount);
+    snapshot->mRealtimeLostEvents  = mRealtimeLostEvents.load(std::memory_order_relaxed);
+    snapshot->mRealtimeLostBuffers = mRealtimeLostBuffers.load(std::memory_order_relaxed);
+    snapshot->mRealtimeLostFiles   = mRealtimeLostFiles.load(std::memory_order_relaxed);
+}
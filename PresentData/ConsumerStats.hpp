@@ -0,0 +1,146 @@
+// Copyright (C) 2024 Intel Corporation
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// ConsumerStats counts the work done by PMTraceConsumer: the events handled
+// from each provider, how long handling them takes, how many presents are in
+// each tracking collection, why presents were lost, and ETW's realtime loss
+// notifications.  Unlike PRESENTMON_ENABLE_DEBUG_TRACE, these are always
+// compiled in.
+//
+// The counters are only written by the consumer thread, so they are updated
+// without locked read-modify-write instructions, and any thread can read them
+// with PMTraceConsumer::GetStats().  Handling time is only measured for one in
+// every kTimingInterval events, and the tracking collection sizes are only
+// updated every kTrackingSizeInterval events.
+
+// Why a PresentEvent was considered lost.
+enum class LostPresentReason {
+    Age = 0,            // Still in progress after its present mode's lost-present age
+    UnexpectedEvent,    // An event was observed that the present's state does not allow for
+    ThreadReused,       // Another present started on the same thread
+    TokenReused,        // Another present was assigned the same DxgKrnl present history token
+    UnsupportedMode,    // The present uses a mode that is not tracked (e.g., DirectComposition)
+    Count
+};
+
+enum class ConsumerProvider {
+    DxgKrnl = 0,
+    DXGI,
+    D3D9,
+    Win32k,
+    DWM,
+    Process,
+    EventMetadata,
+    Win7DxgKrnl,
+    Win7DWM,
+    Other,
+    Count
+};
+
+enum class TrackingCollection {
+    PresentByThreadId = 0,
+    OrderedPresentsByProcessId,
+    PresentBySubmitSequence,
+    PresentByWin32KPresentHistoryToken,
+    PresentByDxgkPresentHistoryToken,
+    PresentByDxgkPresentHistoryTokenData,
+    PresentByDxgkContext,
+    LastPresentByWindow,
+    PresentsWaitingForDWM,
+    DeferredCompletions,
+    AgingWheel,
+    Count
+};
+
+char const* ConsumerProviderToString(ConsumerProvider provider);
+char const* TrackingCollectionToString(TrackingCollection collection);
+char const* LostPresentReasonToString(LostPresentReason reason);
+
+struct ConsumerStatsSnapshot {
+    static constexpr uint32_t kEventIdCount = 512;          // Event IDs >= this are counted together in the last element
+    static constexpr uint32_t kHistogramBucketCount = 32;
+
+    uint64_t mEventCount[(size_t) ConsumerProvider::Count][kEventIdCount + 1];
+    uint64_t mTotalEventCount;
+
+    // Timing of the sampled events, in QPC units.  mDecodeTime is the part of
+    // mHandlerTime spent looking up event properties.  mHandlerTimeHistogram[i]
+    // counts the sampled events that took [2^i, 2^(i+1)) units.
+    uint64_t mSampledEventCount;
+    uint64_t mHandlerTime;
+    uint64_t mDecodeTime;
+    uint64_t mHandlerTimeHistogram[kHistogramBucketCount];
+
+    // The number of presents in each collection, and the most there has been.
+    uint64_t mTrackingSize[(size_t) TrackingCollection::Count];
+    uint64_t mTrackingSizePeak[(size_t) TrackingCollection::Count];
+
+    uint64_t mLostPresentCount[(size_t) LostPresentReason::Count];
+
+    // RT_LostEvent notifications, only received by realtime sessions.
+    uint64_t mRealtimeLostEvents;
+    uint64_t mRealtimeLostBuffers;
+    uint64_t mRealtimeLostFiles;
+};
+
+class ConsumerStats {
+public:
+    static constexpr uint64_t kTimingInterval = 64;
+    static constexpr uint64_t kTrackingSizeInterval = 1024;
+
+    ConsumerStats();
+
+    // Returns whether the handling of the next event should be timed, and
+    // whether the tracking collection sizes should be updated after it.
+    bool BeginEvent(bool* updateTrackingSizes)
+    {
+        auto index = mEventIndex++;
+        *updateTrackingSizes = (index % kTrackingSizeInterval) == 0;
+        return (index % kTimingInterval) == 0;
+    }
+
+    void CountEvent(ConsumerProvider provider, uint32_t eventId)
+    {
+        if (eventId > ConsumerStatsSnapshot::kEventIdCount) {
+            eventId = ConsumerStatsSnapshot::kEventIdCount;
+        }
+        Increment(&mEventCount[(size_t) provider][eventId]);
+    }
+
+    void AddSampledTime(uint64_t handlerTime, uint64_t decodeTime);
+    void SetTrackingSize(TrackingCollection collection, size_t size);
+    void CountLostPresent(LostPresentReason reason) { Increment(&mLostPresentCount[(size_t) reason]); }
+    void CountRealtimeLoss(uint8_t opcode);
+
+    uint64_t GetLostPresentCount(LostPresentReason reason) const
+    {
+        return mLostPresentCount[(size_t) reason].load(std::memory_order_relaxed);
+    }
+
+    void GetSnapshot(ConsumerStatsSnapshot* snapshot) const;
+
+private:
+    static void Increment(std::atomic<uint64_t>* counter, uint64_t value = 1)
+    {
+        counter->store(counter->load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    uint64_t mEventIndex = 0; // Only used by the consumer thread
+
+    std::atomic<uint64_t> mEventCount[(size_t) ConsumerProvider::Count][ConsumerStatsSnapshot::kEventIdCount + 1];
+    std::atomic<uint64_t> mSampledEventCount;
+    std::atomic<uint64_t> mHandlerTime;
+    std::atomic<uint64_t> mDecodeTime;
+    std::atomic<uint64_t> mHandlerTimeHistogram[ConsumerStatsSnapshot::kHistogramBucketCount];
+    std::atomic<uint64_t> mTrackingSize[(size_t) TrackingCollection::Count];
+    std::atomic<uint64_t> mTrackingSizePeak[(size_t) TrackingCollection::Count];
+    std::atomic<uint64_t> mLostPresentCount[(size_t) LostPresentReason::Count];
+    std::atomic<uint64_t> mRealtimeLostEvents;
+    std::atomic<uint64_t> mRealtimeLostBuffers;
+    std::atomic<uint64_t> mRealtimeLostFiles;
+};
@@ -0,0 +1,263 @@
+// Copyright (C) 2024 Intel Corporation
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+// FlatHashMap is an open-addressing hash map used for PMTraceConsumer's
+// tracking indices, which are keyed by small integers or tuples and see an
+// insert and an erase for nearly every present.
+//
+// Entries are stored inline in a power-of-two sized array and found by linear
+// probing from their home slot.  A parallel array of control bytes holds 7
+// bits of each occupied slot's hash, so most non-matching slots are skipped
+// without comparing keys.  Erase shifts the following entries of the probe
+// sequence back into the hole instead of leaving a tombstone, so the table
+// does not degrade under churn.
+//
+// Hash only needs to distinguish keys; the table mixes its result itself, so
+// identity hashing is fine for integer keys.
+//
+// Unlike std::unordered_map, inserting may move every entry and erasing may
+// move entries after the erased one, which invalidates iterators, pointers,
+// and references into the map.
+struct FlatHashInteger {
+    size_t operator()(uint64_t key) const { return (size_t) key; }
+};
+
+template<typename Key, typename Value, typename Hash = FlatHashInteger>
+class FlatHashMap {
+public:
+    using value_type = std::pair<Key, Value>;
+
+    template<typename T>
+    class IteratorT {
+    public:
+        IteratorT() = default;
+
+        T& operator*() const { return *mSlot; }
+        T* operator->() const { return mSlot; }
+        bool operator==(IteratorT const& rhs) const { return mSlot == rhs.mSlot; }
+        bool operator!=(IteratorT const& rhs) const { return mSlot != rhs.mSlot; }
+
+        IteratorT& operator++()
+        {
+            ++mSlot;
+            ++mControl;
+            SkipEmpty();
+            return *this;
+        }
+
+    private:
+        friend class FlatHashMap;
+
+        IteratorT(T* slot, uint8_t const* control, uint8_t const* controlEnd)
+            : mSlot(slot)
+            , mControl(control)
+            , mControlEnd(controlEnd)
+        {
+            SkipEmpty();
+        }
+
+        void SkipEmpty()
+        {
+            while (mControl != mControlEnd && *mControl == kEmpty) {
+                ++mSlot;
+                ++mControl;
+            }
+        }
+
+        T* mSlot = nullptr;
+        uint8_t const* mControl = nullptr;
+        uint8_t const* mControlEnd = nullptr;
+    };
+
+    using iterator = IteratorT<value_type>;
+    using const_iterator = IteratorT<value_type const>;
+
+    size_t size() const { return mSize; }
+    bool empty() const { return mSize == 0; }
+
+    iterator begin() { return MakeIterator(0); }
+    iterator end() { return MakeIterator(mControl.size()); }
+    const_iterator begin() const { return MakeIterator(0); }
+    const_iterator end() const { return MakeIterator(mControl.size()); }
+
+    iterator find(Key const& key)
+    {
+        auto index = FindIndex(key);
+        return index == kNotFound ? end() : MakeIterator(index);
+    }
+
+    const_iterator find(Key const& key) const
+    {
+        auto index = FindIndex(key);
+        return index == kNotFound ? end() : MakeIterator(index);
+    }
+
+    template<typename V>
+    std::pair<iterator, bool> emplace(Key const& key, V&& value)
+    {
+        auto pr = InsertIndex(key);
+        if (pr.second) {
+            mSlots[pr.first].second = std::forward<V>(value);
+        }
+        return std::make_pair(MakeIterator(pr.first), pr.second);
+    }
+
+    Value& operator[](Key const& key)
+    {
+        return mSlots[InsertIndex(key).first].second;
+    }
+
+    size_t erase(Key const& key)
+    {
+        auto index = FindIndex(key);
+        if (index == kNotFound) {
+            return 0;
+        }
+        EraseIndex(index);
+        return 1;
+    }
+
+    void erase(iterator ii)
+    {
+        EraseIndex((size_t) (ii.mSlot - mSlots.data()));
+    }
+
+    void clear()
+    {
+        for (size_t i = 0, n = mControl.size(); i < n; ++i) {
+            if (mControl[i] != kEmpty) {
+                mControl[i] = kEmpty;
+                mSlots[i] = value_type();
+            }
+        }
+        mSize = 0;
+    }
+
+private:
+    static constexpr uint8_t kEmpty = 0;
+    static constexpr size_t kNotFound = SIZE_MAX;
+    static constexpr size_t kMinCapacity = 16;
+
+    // Fibonacci hashing: the home slot comes from the top bits of the
+    // product, and the control byte from bits in the middle.
+    static uint64_t MixHash(Key const& key) { return (uint64_t) Hash()(key) * 0x9E3779B97F4A7C15ull; }
+    static uint8_t ControlByte(uint64_t hash) { return (uint8_t) (0x80 | ((hash >> 32) & 0x7f)); }
+    size_t HomeIndex(uint64_t hash) const { return (size_t) (hash >> mShift); }
+
+    iterator MakeIterator(size_t index)
+    {
+        auto control = mControl.data();
+        auto controlEnd = control + mControl.size();
+        return iterator(mSlots.data() + index, control + index, controlEnd);
+    }
+
+    const_iterator MakeIterator(size_t index) const
+    {
+        auto control = mControl.data();
+        auto controlEnd = control + mControl.size();
+        return const_iterator(mSlots.data() + index, control + index, controlEnd);
+    }
+
+    size_t FindIndex(Key const& key) const
+    {
+        if (mSize == 0) {
+            return kNotFound;
+        }
+
+        auto hash = MixHash(key);
+        auto control = ControlByte(hash);
+        auto mask = mControl.size() - 1;
+        for (auto i = HomeIndex(hash); ; i = (i + 1) & mask) {
+            if (mControl[i] == kEmpty) {
+                return kNotFound;
+            }
+            if (mControl[i] == control && mSlots[i].first == key) {
+                return i;
+            }
+        }
+    }
+
+    // Returns the index of key's slot, and whether it was inserted.
+    std::pair<size_t, bool> InsertIndex(Key const& key)
+    {
+        auto index = FindIndex(key);
+        if (index != kNotFound) {
+            return std::make_pair(index, false);
+        }
+
+        // Keep the load factor at or below 3/4.
+        if ((mSize + 1) * 4 > mControl.size() * 3) {
+            Rehash(mControl.empty() ? kMinCapacity : mControl.size() * 2);
+        }
+
+        auto hash = MixHash(key);
+        index = PlaceIndex(hash);
+        mControl[index] = ControlByte(hash);
+        mSlots[index].first = key;
+        mSize += 1;
+        return std::make_pair(index, true);
+    }
+
+    // Find the first empty slot in hash's probe sequence.
+    size_t PlaceIndex(uint64_t hash) const
+    {
+        auto mask = mControl.size() - 1;
+        auto i = HomeIndex(hash);
+        while (mControl[i] != kEmpty) {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    void EraseIndex(size_t hole)
+    {
+        // Move each following entry in the probe sequence back into the hole,
+        // unless its home slot is after the hole (in which case it would no
+        // longer be found).
+        auto mask = mControl.size() - 1;
+        for (auto i = (hole + 1) & mask; mControl[i] != kEmpty; i = (i + 1) & mask) {
+            auto home = HomeIndex(MixHash(mSlots[i].first));
+            if (((i - home) & mask) >= ((i - hole) & mask)) {
+                mControl[hole] = mControl[i];
+                mSlots[hole] = std::move(mSlots[i]);
+                hole = i;
+            }
+        }
+
+        mControl[hole] = kEmpty;
+        mSlots[hole] = value_type();
+        mSize -= 1;
+    }
+
+    void Rehash(size_t capacity)
+    {
+        std::vector<uint8_t> control(capacity); // kEmpty
+        std::vector<value_type> slots(capacity);
+        control.swap(mControl);
+        slots.swap(mSlots);
+
+        mShift = 64;
+        for (auto c = capacity; c > 1; c >>= 1) {
+            mShift -= 1;
+        }
+
+        for (size_t i = 0, n = control.size(); i < n; ++i) {
+            if (control[i] != kEmpty) {
+                auto index = PlaceIndex(MixHash(slots[i].first));
+                mControl[index] = control[i];
+                mSlots[index] = std::move(slots[i]);
+            }
+        }
+    }
+
+    std::vector<uint8_t> mControl;      // kEmpty, or 0x80 | 7 bits of the slot's hash
+    std::vector<value_type> mSlots;     // Empty slots hold default-constructed entries
+    size_t mSize = 0;
+    uint32_t mShift = 64;               // 64 - log2(capacity)
+};
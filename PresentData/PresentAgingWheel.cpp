@@ -0,0 +1,165 @@
+// Copyright (C) 2024 Intel Corporation
+// SPDX-License-Identifier: MIT
+
+#include "PresentMonTraceConsumer.hpp"
+
+namespace {
+
+// PresentEvent::AgingWheelIndex is packed as (level, slot, position in slot)
+constexpr uint32_t kPositionBits = 24;
+constexpr uint32_t kSlotShift    = kPositionBits;
+constexpr uint32_t kLevelShift   = kPositionBits + PresentAgingWheel::kSlotBits;
+
+uint32_t PackIndex(uint32_t level, uint32_t slot, size_t position)
+{
+    DebugAssert(position < (1u << kPositionBits));
+    return (level << kLevelShift) | (slot << kSlotShift) | (uint32_t) position;
+}
+
+}
+
+void PresentAgingWheel::Start(uint64_t tickDuration, uint64_t now)
+{
+    DebugAssert(mSize == 0);
+    mTickDuration = tickDuration == 0 ? 1 : tickDuration;
+    mCurrentTick = now / mTickDuration;
+}
+
+void PresentAgingWheel::Insert(std::shared_ptr<PresentEvent> const& p, uint64_t deadline)
+{
+    DebugAssert(IsStarted());
+    DebugAssert(p->AgingWheelIndex == kInvalidIndex);
+
+    // Round up so that a present never expires before its deadline, and
+    // don't schedule anything before the next tick.
+    auto deadlineTick = (deadline + mTickDuration - 1) / mTickDuration;
+    if (deadlineTick <= mCurrentTick) {
+        deadlineTick = mCurrentTick + 1;
+    }
+
+    Place(Entry{ p, deadlineTick }, nullptr);
+}
+
+void PresentAgingWheel::Remove(PresentEvent* p)
+{
+    auto index = p->AgingWheelIndex;
+    if (index == kInvalidIndex) {
+        return;
+    }
+
+    auto level    = index >> kLevelShift;
+    auto slot     = (index >> kSlotShift) & (kSlotCount - 1);
+    auto position = index & ((1u << kPositionBits) - 1);
+
+    auto& entries = mSlots[level][slot];
+    DebugAssert(position < entries.size() && entries[position].mPresent.get() == p);
+    if (position + 1 != entries.size()) {
+        entries[position] = std::move(entries.back());
+        entries[position].mPresent->AgingWheelIndex = PackIndex(level, slot, position);
+    }
+    entries.pop_back();
+
+    p->AgingWheelIndex = kInvalidIndex;
+    mLevelSize[level] -= 1;
+    mSize -= 1;
+}
+
+void PresentAgingWheel::Advance(uint64_t now, std::vector<std::shared_ptr<PresentEvent>>* expired)
+{
+    if (!IsStarted()) {
+        return;
+    }
+
+    auto targetTick = now / mTickDuration;
+    while (mCurrentTick < targetTick) {
+        // Nothing happens until the next time a slot is processed in the
+        // lowest non-empty level, so skip directly to it.
+        uint32_t lowestLevel = 0;
+        while (lowestLevel < kLevelCount && mLevelSize[lowestLevel] == 0) {
+            lowestLevel += 1;
+        }
+        if (lowestLevel == kLevelCount) {
+            mCurrentTick = targetTick;
+            break;
+        }
+        if (lowestLevel > 0) {
+            auto shift = kSlotBits * lowestLevel;
+            auto nextSlotTick = ((mCurrentTick >> shift) + 1) << shift;
+            if (nextSlotTick > targetTick) {
+                mCurrentTick = targetTick;
+                break;
+            }
+            mCurrentTick = nextSlotTick - 1;
+        }
+
+        auto tick = ++mCurrentTick;
+
+        // Cascade the higher-level slots that start at this tick, from the
+        // highest level down so that entries can cascade through several
+        // levels in one step.
+        for (uint32_t level = kLevelCount - 1; level > 0; --level) {
+            auto shift = kSlotBits * level;
+            if ((tick & ((1ull << shift) - 1)) != 0) {
+                continue;
+            }
+
+            auto& slotEntries = mSlots[level][(tick >> shift) & (kSlotCount - 1)];
+            if (slotEntries.empty()) {
+                continue;
+            }
+
+            std::vector<Entry> entries;
+            entries.swap(slotEntries);
+            mLevelSize[level] -= entries.size();
+            mSize -= entries.size();
+            for (auto& entry : entries) {
+                entry.mPresent->AgingWheelIndex = kInvalidIndex;
+                Place(std::move(entry), expired);
+            }
+        }
+
+        // Everything in the level-0 slot for this tick has expired.
+        auto& slotEntries = mSlots[0][tick & (kSlotCount - 1)];
+        for (auto& entry : slotEntries) {
+            DebugAssert(entry.mDeadlineTick == tick);
+            entry.mPresent->AgingWheelIndex = kInvalidIndex;
+            expired->emplace_back(std::move(entry.mPresent));
+        }
+        mLevelSize[0] -= slotEntries.size();
+        mSize -= slotEntries.size();
+        slotEntries.clear();
+    }
+}
+
+void PresentAgingWheel::Place(Entry&& entry, std::vector<std::shared_ptr<PresentEvent>>* expired)
+{
+    if (entry.mDeadlineTick <= mCurrentTick) {
+        DebugAssert(expired != nullptr);
+        expired->emplace_back(std::move(entry.mPresent));
+        return;
+    }
+
+    // Clamp deadlines that are further out than the highest level can
+    // represent.  Such entries expire early and are re-inserted by the caller.
+    auto topShift = kSlotBits * (kLevelCount - 1);
+    auto maxTick = ((mCurrentTick >> topShift) + kSlotCount) << topShift;
+    if (entry.mDeadlineTick > maxTick) {
+        entry.mDeadlineTick = maxTick;
+    }
+
+    // Use the lowest level where the deadline falls within the current
+    // revolution of the next level up.  This guarantees the deadline's slot
+    // is processed after the current tick, and no later than the deadline.
+    uint32_t level = 0;
+    while (level + 1 < kLevelCount &&
+           (entry.mDeadlineTick >> (kSlotBits * (level + 1))) != (mCurrentTick >> (kSlotBits * (level + 1)))) {
+        level += 1;
+    }
+
+    auto slot = (uint32_t) (entry.mDeadlineTick >> (kSlotBits * level)) & (kSlotCount - 1);
+    auto& entries = mSlots[level][slot];
+    entry.mPresent->AgingWheelIndex = PackIndex(level, slot, entries.size());
+    entries.emplace_back(std::move(entry));
+    mLevelSize[level] += 1;
+    mSize += 1;
+}
@@ -0,0 +1,61 @@
+// Copyright (C) 2024 Intel Corporation
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+struct PresentEvent;
+
+// PresentAgingWheel is a hierarchical timer wheel used to detect in-progress
+// presents that have been waiting too long for their remaining events.  Each
+// present is stored in the slot for its deadline, so advancing time only
+// touches the slots passed and the presents that expire, regardless of how
+// many presents are in flight.
+//
+// Level 0 has kSlotCount slots of one tick each, and each higher level has
+// kSlotCount slots that are kSlotCount times wider than the level below.
+// Presents in a higher level are cascaded down once time reaches their slot.
+// Deadlines past the end of the highest level are clamped, so an expired
+// present may not actually have reached its deadline; the caller is expected
+// to check and re-insert it if so.
+//
+// The present's AgingWheelIndex records where it is stored so that it can be
+// removed in constant time when it completes.
+class PresentAgingWheel {
+public:
+    static constexpr uint32_t kSlotBits = 6;
+    static constexpr uint32_t kSlotCount = 1u << kSlotBits;
+    static constexpr uint32_t kLevelCount = 4;
+    static constexpr uint32_t kInvalidIndex = UINT32_MAX;
+
+    // Set the tick duration and the current time (both in QPC units).  This
+    // must be called before any presents are inserted.
+    void Start(uint64_t tickDuration, uint64_t now);
+    bool IsStarted() const { return mTickDuration != 0; }
+
+    void Insert(std::shared_ptr<PresentEvent> const& p, uint64_t deadline);
+    void Remove(PresentEvent* p);
+
+    // Advance the current time to now, appending any presents whose deadline
+    // has been reached to expired.  Expired presents are no longer stored in
+    // the wheel.
+    void Advance(uint64_t now, std::vector<std::shared_ptr<PresentEvent>>* expired);
+
+    size_t Size() const { return mSize; }
+
+private:
+    struct Entry {
+        std::shared_ptr<PresentEvent> mPresent;
+        uint64_t mDeadlineTick;
+    };
+
+    void Place(Entry&& entry, std::vector<std::shared_ptr<PresentEvent>>* expired);
+
+    std::vector<Entry> mSlots[kLevelCount][kSlotCount];
+    size_t mLevelSize[kLevelCount] = {};
+    size_t mSize = 0;
+    uint64_t mTickDuration = 0; // QPC duration of one level-0 slot
+    uint64_t mCurrentTick = 0;  // Time, in ticks, that the wheel has been advanced to
+};
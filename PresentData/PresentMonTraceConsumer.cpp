@@ -15,15 +15,10 @@
 #include <assert.h>
 #include <d3d9.h>
 #include <dxgi.h>
+#include <functional>
 #include <stdlib.h>
 #include <unordered_set>
 
-#ifdef DEBUG
-static constexpr int PRESENTEVENT_CIRCULAR_BUFFER_SIZE = 32768;
-#else
-static constexpr int PRESENTEVENT_CIRCULAR_BUFFER_SIZE = 8192;
-#endif
-
 namespace {
 
 // Detect if there are any missing expected events, and returns the number of
@@ -96,7 +91,7 @@ PresentEvent::PresentEvent()
     , DxgkContext(0)
     , Hwnd(0)
     , QueueSubmitSequence(0)
-    , mAllPresentsTrackingIndex(UINT32_MAX)
+    , AgingWheelIndex(PresentAgingWheel::kInvalidIndex)
 
     , DeferredCompletionWaitCount(0)
 
@@ -129,11 +124,50 @@ PresentEvent::PresentEvent()
 }
 
 PMTraceConsumer::PMTraceConsumer()
-    : mAllPresents(PRESENTEVENT_CIRCULAR_BUFFER_SIZE)
-    , mGpuTrace(this)
+    : mGpuTrace(this)
     , mLastInputDeviceReadTime(0)
     , mLastInputDeviceType(InputDeviceType::None)
 {
+    // Presents normally complete within a few frames, so these are generous
+    // enough to not affect presents that are merely slow (e.g., from a
+    // hitching application or a long DWM wait).
+    for (auto& ageMs : mLostPresentAgeMs) {
+        ageMs = 10000;
+    }
+}
+
+bool PMTraceConsumer::OrderedPresents::emplace(uint64_t presentStartTime, std::shared_ptr<PresentEvent> const& present)
+{
+    // Presents usually arrive in order, so check the end first.
+    if (mPresents.empty() || mPresents.back().first < presentStartTime) {
+        mPresents.emplace_back(presentStartTime, present);
+        return true;
+    }
+
+    auto ii = std::lower_bound(mPresents.begin(), mPresents.end(), presentStartTime,
+                               [](value_type const& pr, uint64_t t) { return pr.first < t; });
+    if (ii->first == presentStartTime) {
+        return false;
+    }
+    mPresents.emplace(ii, presentStartTime, present);
+    return true;
+}
+
+bool PMTraceConsumer::OrderedPresents::erase(uint64_t presentStartTime)
+{
+    auto ii = std::lower_bound(mPresents.begin(), mPresents.end(), presentStartTime,
+                               [](value_type const& pr, uint64_t t) { return pr.first < t; });
+    if (ii == mPresents.end() || ii->first != presentStartTime) {
+        return false;
+    }
+    mPresents.erase(ii);
+    return true;
+}
+
+PMTraceConsumer::OrderedPresents::iterator PMTraceConsumer::OrderedPresents::upper_bound(uint64_t presentStartTime)
+{
+    return std::upper_bound(mPresents.begin(), mPresents.end(), presentStartTime,
+                            [](uint64_t t, value_type const& pr) { return t < pr.first; });
 }
 
 void PMTraceConsumer::HandleD3D9Event(EVENT_RECORD* pEventRecord)
@@ -226,7 +260,7 @@ void PMTraceConsumer::HandleDxgkBlt(EVENT_HEADER const& hdr, uint64_t hwnd, bool
             break;
         }
 
-        RemoveLostPresent(presentEvent);
+        RemoveLostPresent(presentEvent, LostPresentReason::UnexpectedEvent);
     }
 
     TRACK_PRESENT_PATH_SAVE_GENERATED_ID(presentEvent);
@@ -265,7 +299,7 @@ void PMTraceConsumer::HandleDxgkFlip(EVENT_HEADER const& hdr, int32_t flipInterv
             break;
         }
 
-        RemoveLostPresent(presentEvent);
+        RemoveLostPresent(presentEvent, LostPresentReason::UnexpectedEvent);
     }
 
     TRACK_PRESENT_PATH_SAVE_GENERATED_ID(presentEvent);
@@ -340,9 +374,10 @@ void PMTraceConsumer::HandleDxgkQueueSubmit(
             }
 
             // We're done with DxgkContext tracking, if the present hasn't
-            // completed remove it from the tracking now.
+            // completed remove it from the tracking now.  CompletePresent()
+            // may have moved the entry, so erase by key.
             if (present->DxgkContext != 0) {
-                mPresentByDxgkContext.erase(eventIter);
+                mPresentByDxgkContext.erase(hContext);
                 present->DxgkContext = 0;
             }
         }
@@ -362,8 +397,10 @@ void PMTraceConsumer::HandleDxgkQueueSubmit(
             present->QueueSubmitSequence = submitSequence;
 
             auto presentsBySubmitSequence = &mPresentBySubmitSequence[submitSequence];
-            DebugAssert(presentsBySubmitSequence->find(hContext) == presentsBySubmitSequence->end());
-            (*presentsBySubmitSequence)[hContext] = present;
+            DebugAssert(std::find_if(presentsBySubmitSequence->begin(), presentsBySubmitSequence->end(),
+                                     [=](PresentsByContext::value_type const& pr) { return pr.first == hContext; }) == presentsBySubmitSequence->end());
+            presentsBySubmitSequence->emplace_back(hContext, present);
+            mSubmitSequencePresentCount += 1;
 
             if (isWin7 && present->PresentMode == PresentMode::Hardware_Legacy_Copy_To_Front_Buffer) {
                 mPresentByDxgkContext[hContext] = present;
@@ -384,7 +421,8 @@ void PMTraceConsumer::HandleDxgkQueueComplete(uint64_t timestamp, uint64_t hCont
     auto ii = mPresentBySubmitSequence.find(submitSequence);
     if (ii != mPresentBySubmitSequence.end()) {
         auto presentsBySubmitSequence = &ii->second;
-        auto jj = presentsBySubmitSequence->find(hContext);
+        auto jj = std::find_if(presentsBySubmitSequence->begin(), presentsBySubmitSequence->end(),
+                               [=](PresentsByContext::value_type const& pr) { return pr.first == hContext; });
         if (jj != presentsBySubmitSequence->end()) {
             auto pEvent = jj->second;
 
@@ -537,7 +575,7 @@ void PMTraceConsumer::HandleDxgkPresentHistory(
             break;
         }
 
-        RemoveLostPresent(presentEvent);
+        RemoveLostPresent(presentEvent, LostPresentReason::UnexpectedEvent);
     }
 
     TRACK_PRESENT_PATH_SAVE_GENERATED_ID(presentEvent);
@@ -551,7 +589,7 @@ void PMTraceConsumer::HandleDxgkPresentHistory(
 
     auto iter = mPresentByDxgkPresentHistoryToken.find(token);
     if (iter != mPresentByDxgkPresentHistoryToken.end()) {
-        RemoveLostPresent(iter->second);
+        RemoveLostPresent(iter->second, LostPresentReason::TokenReused);
     }
     DebugAssert(mPresentByDxgkPresentHistoryToken.find(token) == mPresentByDxgkPresentHistoryToken.end());
     mPresentByDxgkPresentHistoryToken[token] = presentEvent;
@@ -571,7 +609,7 @@ void PMTraceConsumer::HandleDxgkPresentHistory(
              * could not be diagnosed, so we removed support for this present mode for now...
             presentEvent->PresentMode = PresentMode::Composed_Composition_Atlas;
             */
-            RemoveLostPresent(presentEvent);
+            RemoveLostPresent(presentEvent, LostPresentReason::UnsupportedMode);
             return;
             /* END WORKAROUND */
         } else {
@@ -1247,10 +1285,12 @@ std::size_t PMTraceConsumer::Win32KPresentHistoryTokenHash::operator()(PMTraceCo
     auto CompositionSurfaceLuid = std::get<0>(v);
     auto PresentCount           = std::get<1>(v);
     auto BindId                 = std::get<2>(v);
-    PresentCount = (PresentCount << 32) | (PresentCount >> (64-32));
-    BindId       = (BindId       << 56) | (BindId       >> (64-56));
-    auto h64 = CompositionSurfaceLuid ^ PresentCount ^ BindId;
-    return std::hash<uint64_t>::operator()(h64);
+
+    // Consecutive presents to a surface differ only in PresentCount, so
+    // multiply it (and BindId) by distinct odd constants to spread those
+    // differences over all of the bits before combining.
+    auto h64 = CompositionSurfaceLuid ^ (PresentCount * 0x9E3779B97F4A7C15ull) ^ (BindId * 0xC2B2AE3D27D4EB4Full);
+    return (std::size_t) (h64 ^ (h64 >> 32));
 }
 
 void PMTraceConsumer::HandleWin32kEvent(EVENT_RECORD* pEventRecord)
@@ -1285,7 +1325,7 @@ void PMTraceConsumer::HandleWin32kEvent(EVENT_RECORD* pEventRecord)
                 break;
             }
 
-            RemoveLostPresent(present);
+            RemoveLostPresent(present, LostPresentReason::UnexpectedEvent);
         }
 
         TRACK_PRESENT_PATH(present);
@@ -1585,10 +1625,12 @@ void PMTraceConsumer::RemovePresentFromSubmitSequenceIdTracking(std::shared_ptr<
     if (presentsBySubmitSequence->size() == 1) {
         DebugAssert(presentsBySubmitSequence->begin()->second == present);
         mPresentBySubmitSequence.erase(ii);
+        mSubmitSequencePresentCount -= 1;
     } else {
         for (auto jj = presentsBySubmitSequence->begin(), je = presentsBySubmitSequence->end(); jj != je; ++jj) {
             if (jj->second == present) {
                 presentsBySubmitSequence->erase(jj);
+                mSubmitSequencePresentCount -= 1;
                 break;
             }
         }
@@ -1602,11 +1644,8 @@ void PMTraceConsumer::RemovePresentFromSubmitSequenceIdTracking(std::shared_ptr<
 // Remove the present from all temporary tracking structures.
 void PMTraceConsumer::RemovePresentFromTemporaryTrackingCollections(std::shared_ptr<PresentEvent> const& p)
 {
-    // mAllPresents
-    if (p->mAllPresentsTrackingIndex != UINT32_MAX) {
-        mAllPresents[p->mAllPresentsTrackingIndex] = nullptr;
-        p->mAllPresentsTrackingIndex = UINT32_MAX;
-    }
+    // mAgingWheel
+    mAgingWheel.Remove(p.get());
 
     // mPresentByThreadId
     //
@@ -1627,7 +1666,10 @@ void PMTraceConsumer::RemovePresentFromTemporaryTrackingCollections(std::shared_
     }
 
     // mOrderedPresentsByProcessId
-    mOrderedPresentsByProcessId[p->ProcessId].erase(p->PresentStartTime);
+    auto orderedIter = mOrderedPresentsByProcessId.find(p->ProcessId);
+    if (orderedIter != mOrderedPresentsByProcessId.end() && orderedIter->second.erase(p->PresentStartTime)) {
+        mOrderedPresentCount -= 1;
+    }
 
     // mPresentBySubmitSequence
     RemovePresentFromSubmitSequenceIdTracking(p);
@@ -1698,13 +1740,92 @@ void PMTraceConsumer::RemovePresentFromTemporaryTrackingCollections(std::shared_
     }
 }
 
-void PMTraceConsumer::RemoveLostPresent(std::shared_ptr<PresentEvent> p)
+void PMTraceConsumer::RemoveLostPresent(std::shared_ptr<PresentEvent> p, LostPresentReason reason)
 {
+    if (!p->IsCompleted) {
+        mStats.CountLostPresent(reason);
+    }
+
     VerboseTraceBeforeModifyingPresent(p.get());
     p->IsLost = true;
     CompletePresent(p);
 }
 
+void PMTraceConsumer::UpdateTrackingStats()
+{
+#if PRESENTMON_ENABLE_DEBUG_TRACE
+    {
+        size_t orderedPresentCount = 0;
+        for (auto const& pr : mOrderedPresentsByProcessId) {
+            orderedPresentCount += pr.second.size();
+        }
+
+        size_t submitSequenceCount = 0;
+        for (auto const& pr : mPresentBySubmitSequence) {
+            submitSequenceCount += pr.second.size();
+        }
+
+        size_t deferredCount = 0;
+        for (auto const& pr : mDeferredCompletions) {
+            for (auto const& pr2 : pr.second) {
+                deferredCount += pr2.second.mOrderedPresents.size();
+            }
+        }
+
+        DebugAssert(orderedPresentCount == mOrderedPresentCount);
+        DebugAssert(submitSequenceCount == mSubmitSequencePresentCount);
+        DebugAssert(deferredCount == mDeferredCompletionCount);
+    }
+#endif
+
+    mStats.SetTrackingSize(TrackingCollection::PresentByThreadId,                    mPresentByThreadId.size());
+    mStats.SetTrackingSize(TrackingCollection::OrderedPresentsByProcessId,           mOrderedPresentCount);
+    mStats.SetTrackingSize(TrackingCollection::PresentBySubmitSequence,              mSubmitSequencePresentCount);
+    mStats.SetTrackingSize(TrackingCollection::PresentByWin32KPresentHistoryToken,   mPresentByWin32KPresentHistoryToken.size());
+    mStats.SetTrackingSize(TrackingCollection::PresentByDxgkPresentHistoryToken,     mPresentByDxgkPresentHistoryToken.size());
+    mStats.SetTrackingSize(TrackingCollection::PresentByDxgkPresentHistoryTokenData, mPresentByDxgkPresentHistoryTokenData.size());
+    mStats.SetTrackingSize(TrackingCollection::PresentByDxgkContext,                 mPresentByDxgkContext.size());
+    mStats.SetTrackingSize(TrackingCollection::LastPresentByWindow,                  mLastPresentByWindow.size());
+    mStats.SetTrackingSize(TrackingCollection::PresentsWaitingForDWM,                mPresentsWaitingForDWM.size());
+    mStats.SetTrackingSize(TrackingCollection::DeferredCompletions,                  mDeferredCompletionCount);
+    mStats.SetTrackingSize(TrackingCollection::AgingWheel,                           mAgingWheel.Size());
+}
+
+uint64_t PMTraceConsumer::GetLostPresentAge(PresentMode presentMode) const
+{
+    auto index = (size_t) presentMode;
+    if (index >= PRESENT_MODE_COUNT) {
+        index = (size_t) PresentMode::Unknown;
+    }
+    return (uint64_t) mLostPresentAgeMs[index] * mTimestampFrequency / 1000;
+}
+
+void PMTraceConsumer::RemoveAgedPresents(uint64_t timestamp)
+{
+    DebugAssert(mExpiredPresents.empty());
+    mAgingWheel.Advance(timestamp, &mExpiredPresents);
+
+    for (auto const& p : mExpiredPresents) {
+        // Completing an earlier expired present may have also completed this
+        // one (e.g., as a DWM present's dependent).
+        if (p->IsCompleted) {
+            continue;
+        }
+
+        // The present was scheduled using the shortest age, or its present
+        // mode may have changed since it was scheduled, so check it against
+        // the age for its current mode.
+        auto age = GetLostPresentAge(p->PresentMode);
+        if (timestamp >= p->PresentStartTime + age) {
+            RemoveLostPresent(p, LostPresentReason::Age);
+        } else {
+            mAgingWheel.Insert(p, p->PresentStartTime + age);
+        }
+    }
+
+    mExpiredPresents.clear();
+}
+
 void PMTraceConsumer::CompletePresentHelper(std::shared_ptr<PresentEvent> const& p)
 {
     // First, protect against double-completion.  Double-completion is not
@@ -1720,7 +1841,9 @@ void PMTraceConsumer::CompletePresentHelper(std::shared_ptr<PresentEvent> const&
     // Complete the present.
     VerboseTraceBeforeModifyingPresent(p.get());
     p->IsCompleted = true;
-    mDeferredCompletions[p->ProcessId][p->SwapChainAddress].mOrderedPresents.emplace(p->PresentStartTime, p);
+    if (mDeferredCompletions[p->ProcessId][p->SwapChainAddress].mOrderedPresents.emplace(p->PresentStartTime, p)) {
+        mDeferredCompletionCount += 1;
+    }
 
     // If the present is still missing some expected events, defer it's
     // enqueuing for some number of presents for cases where the event may
@@ -1775,14 +1898,24 @@ void PMTraceConsumer::CompletePresentHelper(std::shared_ptr<PresentEvent> const&
     }
 
     // If presented, remove any earlier presents made on the same swap chain.
+    //
+    // CompletePresentHelper() removes presents from presentsByThisProcess,
+    // invalidating its iterators, so each search resumes after the completed
+    // present's start time.  Completion never adds a process to
+    // mOrderedPresentsByProcessId, so presentsByThisProcess itself stays valid.
     if (p->FinalState == PresentResult::Presented) {
-        auto presentsByThisProcess = &mOrderedPresentsByProcessId[p->ProcessId];
-        for (auto ii = presentsByThisProcess->begin(), ie = presentsByThisProcess->end(); ii != ie; ) {
-            auto p2 = ii->second;
-            ++ii; // increment iterator first as CompletePresentHelper() will remove it
-            if (p2->SwapChainAddress == p->SwapChainAddress) {
+        auto i1 = mOrderedPresentsByProcessId.find(p->ProcessId);
+        if (i1 != mOrderedPresentsByProcessId.end()) {
+            auto presentsByThisProcess = &i1->second;
+            for (auto ii = presentsByThisProcess->begin(); ii != presentsByThisProcess->end(); ) {
+                auto p2 = ii->second;
                 if (p2->PresentStartTime >= p->PresentStartTime) break;
-                CompletePresentHelper(p2);
+                if (p2->SwapChainAddress == p->SwapChainAddress) {
+                    CompletePresentHelper(p2);
+                    ii = presentsByThisProcess->upper_bound(p2->PresentStartTime);
+                } else {
+                    ++ii;
+                }
             }
         }
     }
@@ -1805,11 +1938,10 @@ void PMTraceConsumer::CompletePresent(std::shared_ptr<PresentEvent> const& p)
     if (!mHasCompletedAPresent && !p->IsLost) {
         mHasCompletedAPresent = true;
 
-        for (auto const& pr : mOrderedPresentsByProcessId) {
+        for (auto& pr : mOrderedPresentsByProcessId) {
             auto processPresents = &pr.second;
-            for (auto ii = processPresents->begin(), ie = processPresents->end(); ii != ie; ) {
+            for (auto ii = processPresents->begin(); ii != processPresents->end(); ) {
                 auto p2 = ii->second;
-                ++ii; // Increment before calling CompletePresentHelper(), which removes from processPresents
 
                 // Clear DependentPresents as an optimization to avoid the extra
                 // recursion in CompletePresentHelper(), since we know that we're
@@ -1820,6 +1952,10 @@ void PMTraceConsumer::CompletePresent(std::shared_ptr<PresentEvent> const& p)
                 VerboseTraceBeforeModifyingPresent(p2.get());
                 p2->IsLost = true;
                 CompletePresentHelper(p2);
+
+                // CompletePresentHelper() removed p2 from processPresents,
+                // invalidating ii.
+                ii = processPresents->upper_bound(p2->PresentStartTime);
             }
         }
     }
@@ -1871,7 +2007,7 @@ void PMTraceConsumer::EnqueueDeferredCompletions(DeferredCompletions* deferredCo
         DebugAssert(present->DxgkPresentHistoryTokenData == 0);
         DebugAssert(present->DxgkContext == 0);
         DebugAssert(present->Hwnd == 0);
-        DebugAssert(present->mAllPresentsTrackingIndex == UINT32_MAX);
+        DebugAssert(present->AgingWheelIndex == PresentAgingWheel::kInvalidIndex);
         DebugAssert(present->QueueSubmitSequence == 0);
         DebugAssert(present->PresentInDwmWaitingStruct == false);
 
@@ -1912,6 +2048,7 @@ void PMTraceConsumer::EnqueueDeferredCompletions(DeferredCompletions* deferredCo
         }
 
         deferredCompletions->mOrderedPresents.erase(iterBegin, iterEnqueueEnd);
+        mDeferredCompletionCount -= lostCount + completedCount;
     }
 }
 
@@ -1921,7 +2058,7 @@ void PMTraceConsumer::SetThreadPresent(uint32_t threadId, std::shared_ptr<Presen
     // has gone wrong with it's tracking so consider it lost.
     auto ii = mPresentByThreadId.find(threadId);
     if (ii != mPresentByThreadId.end()) {
-        RemoveLostPresent(ii->second);
+        RemoveLostPresent(ii->second, LostPresentReason::ThreadReused);
     }
 
     mPresentByThreadId.emplace(threadId, present);
@@ -1946,23 +2083,25 @@ std::shared_ptr<PresentEvent> PMTraceConsumer::FindOrCreatePresent(EVENT_HEADER
     // been deferred by the driver and submitted on a different thread.  Such
     // presents should have only seen present start/stop events so should not
     // have a known PresentMode, etc. yet.
-    auto presentsByThisProcess = &mOrderedPresentsByProcessId[hdr.ProcessId];
-    for (auto const& pr : *presentsByThisProcess) {
-        present = pr.second;
-        if (present->DriverThreadId == 0 &&
-            present->SeenDxgkPresent == false &&
-            present->SeenWin32KEvents == false &&
-            present->PresentMode == PresentMode::Unknown) {
-            VerboseTraceBeforeModifyingPresent(present.get());
-            present->DriverThreadId = hdr.ThreadId;
+    auto presentsByThisProcess = mOrderedPresentsByProcessId.find(hdr.ProcessId);
+    if (presentsByThisProcess != mOrderedPresentsByProcessId.end()) {
+        for (auto const& pr : presentsByThisProcess->second) {
+            present = pr.second;
+            if (present->DriverThreadId == 0 &&
+                present->SeenDxgkPresent == false &&
+                present->SeenWin32KEvents == false &&
+                present->PresentMode == PresentMode::Unknown) {
+                VerboseTraceBeforeModifyingPresent(present.get());
+                present->DriverThreadId = hdr.ThreadId;
 
-            // Set this present as the one the driver thread is working on.  We
-            // leave it assigned to the one the application thread is working
-            // on as well, in case we haven't yet seen application events such
-            // as Present::Stop.
-            SetThreadPresent(hdr.ThreadId, present);
+                // Set this present as the one the driver thread is working on.  We
+                // leave it assigned to the one the application thread is working
+                // on as well, in case we haven't yet seen application events such
+                // as Present::Stop.
+                SetThreadPresent(hdr.ThreadId, present);
 
-            return present;
+                return present;
+            }
         }
     }
 
@@ -1982,7 +2121,7 @@ std::shared_ptr<PresentEvent> PMTraceConsumer::FindOrCreatePresent(EVENT_HEADER
         present->ProcessId = hdr.ProcessId;
         present->ThreadId = hdr.ThreadId;
 
-        TrackPresent(present, presentsByThisProcess);
+        TrackPresent(present);
 
         return present;
     }
@@ -1990,23 +2129,30 @@ std::shared_ptr<PresentEvent> PMTraceConsumer::FindOrCreatePresent(EVENT_HEADER
     return nullptr;
 }
 
-void PMTraceConsumer::TrackPresent(
-    std::shared_ptr<PresentEvent> present,
-    OrderedPresents* presentsByThisProcess)
+void PMTraceConsumer::TrackPresent(std::shared_ptr<PresentEvent> present)
 {
-    // If there is an existing present that hasn't completed by the time the
-    // circular buffer has come around, consider it lost.
-    if (mAllPresents[mAllPresentsNextIndex] != nullptr) {
-        RemoveLostPresent(mAllPresents[mAllPresentsNextIndex]);
+    // Any existing presents that have been in progress for too long by the
+    // time this one starts are considered lost.
+    if (!mAgingWheel.IsStarted()) {
+        mAgingWheel.Start((std::max)(mTimestampFrequency / 1000, (uint64_t) 1), present->PresentStartTime);
+    }
+    RemoveAgedPresents(present->PresentStartTime);
+
+    // Add the present into the initial tracking data structures.  The present
+    // mode isn't known yet, so schedule the first age check for the shortest
+    // configured age; RemoveAgedPresents() re-schedules it once the mode is
+    // known.
+    uint64_t minAge = UINT64_MAX;
+    for (uint32_t i = 0; i < PRESENT_MODE_COUNT; ++i) {
+        minAge = (std::min)(minAge, GetLostPresentAge((PresentMode) i));
     }
 
-    // Add the present into the initial tracking data structures
     VerboseTraceBeforeModifyingPresent(present.get());
-    present->mAllPresentsTrackingIndex = mAllPresentsNextIndex;
-    mAllPresents[mAllPresentsNextIndex] = present;
-    mAllPresentsNextIndex = (mAllPresentsNextIndex + 1) % PRESENTEVENT_CIRCULAR_BUFFER_SIZE;
+    mAgingWheel.Insert(present, present->PresentStartTime + minAge);
 
-    presentsByThisProcess->emplace(present->PresentStartTime, present);
+    if (mOrderedPresentsByProcessId[present->ProcessId].emplace(present->PresentStartTime, present)) {
+        mOrderedPresentCount += 1;
+    }
 
     SetThreadPresent(present->ThreadId, present);
 
@@ -2043,7 +2189,7 @@ void PMTraceConsumer::RuntimePresentStart(Runtime runtime, EVENT_HEADER const& h
 
     TRACK_PRESENT_PATH_SAVE_GENERATED_ID(present);
 
-    TrackPresent(present, &mOrderedPresentsByProcessId[present->ProcessId]);
+    TrackPresent(present);
 }
 
 // No TRACK_PRESENT instrumentation here because each runtime Present::Start
@@ -2228,8 +2374,72 @@ void PMTraceConsumer::HandleProcessEvent(EVENT_RECORD* pEventRecord)
         }
     }
 
+    // Keep mProcessEvents in QpcTime order so that the caller can merge it
+    // without sorting.  Events normally arrive in order, so this is almost
+    // always an append.
     std::lock_guard<std::mutex> lock(mProcessEventMutex);
-    mProcessEvents.emplace_back(event);
+    auto ii = mProcessEvents.end();
+    while (ii != mProcessEvents.begin() && (ii - 1)->QpcTime > event.QpcTime) {
+        --ii;
+    }
+    mProcessEvents.emplace(ii, std::move(event));
+}
+
+void MergeProcessEvents(std::vector<ProcessEvent>* events, std::initializer_list<std::vector<ProcessEvent>*> sources)
+{
+    // Gather the non-empty sequences; if only one has events there is nothing
+    // to merge.
+    std::vector<std::vector<ProcessEvent>*> inputs;
+    size_t count = events->size();
+    if (!events->empty()) {
+        inputs.push_back(events);
+    }
+    for (auto source : sources) {
+        if (!source->empty()) {
+            inputs.push_back(source);
+            count += source->size();
+        }
+    }
+
+    if (inputs.empty()) {
+        return;
+    }
+    if (inputs.size() == 1) {
+        if (inputs[0] != events) {
+            events->swap(*inputs[0]);
+            inputs[0]->clear();
+        }
+        return;
+    }
+
+    // k-way merge using a min-heap of (QpcTime, input index, position).
+    using HeapEntry = std::tuple<uint64_t, size_t, size_t>;
+    std::vector<HeapEntry> heap;
+    heap.reserve(inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        heap.emplace_back((*inputs[i])[0].QpcTime, i, 0);
+    }
+    std::make_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+
+    std::vector<ProcessEvent> merged;
+    merged.reserve(count);
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+        auto i        = std::get<1>(heap.back());
+        auto position = std::get<2>(heap.back());
+        heap.pop_back();
+
+        merged.emplace_back(std::move((*inputs[i])[position]));
+        if (++position < inputs[i]->size()) {
+            heap.emplace_back((*inputs[i])[position].QpcTime, i, position);
+            std::push_heap(heap.begin(), heap.end(), std::greater<HeapEntry>());
+        }
+    }
+
+    for (auto input : inputs) {
+        input->clear();
+    }
+    events->swap(merged);
 }
 
 void PMTraceConsumer::HandleMetadataEvent(EVENT_RECORD* pEventRecord)
@@ -6,8 +6,9 @@
 #define NOMINMAX
 #endif
 
+#include <atomic>
 #include <deque>
-#include <map>
+#include <initializer_list>
 #include <memory>
 #include <mutex>
 #include <shared_mutex>
@@ -20,8 +21,11 @@
 #include <windows.h>
 #include <evntcons.h> // must include after windows.h
 
+#include "ConsumerStats.hpp"
 #include "Debug.hpp"
+#include "FlatHashMap.hpp"
 #include "GpuTrace.hpp"
+#include "PresentAgingWheel.hpp"
 #include "TraceConsumer.hpp"
 
 // PresentMode represents the different paths a present can take on windows.
@@ -98,6 +102,8 @@ enum class PresentMode {
     Hardware_Composed_Independent_Flip = 8,
 };
 
+static constexpr size_t PRESENT_MODE_COUNT = 9;
+
 enum class PresentResult {
     Unknown = 0,
     Presented = 1,
@@ -130,6 +136,12 @@ struct ProcessEvent {
     bool IsStartEvent;          // Whether this is a start event (true) or a stop event (false).
 };
 
+// Merge QpcTime-ordered ProcessEvent sequences from several sources into
+// *events, which must also be QpcTime-ordered.  Events with the same QpcTime
+// keep the order of their sources, with existing *events first.  The sources
+// are cleared.
+void MergeProcessEvents(std::vector<ProcessEvent>* events, std::initializer_list<std::vector<ProcessEvent>*> sources);
+
 struct PresentEvent {
     uint64_t PresentStartTime;  // QPC value of the first event related to the Present (D3D9, DXGI, or DXGK Present_Start)
     uint32_t ProcessId;         // ID of the process that presented
@@ -157,7 +169,7 @@ struct PresentEvent {
     uint64_t DxgkContext;                 // mPresentByDxgkContext
     uint64_t Hwnd;                        // mLastPresentByWindow
     uint32_t QueueSubmitSequence;         // mPresentBySubmitSequence
-    uint32_t mAllPresentsTrackingIndex;   // mAllPresents.
+    uint32_t AgingWheelIndex;             // mAgingWheel
     // Note: the following index tracking structures as well but are defined elsewhere:
     //       ProcessId                 -> mOrderedPresentsByProcessId
     //       ThreadId, DriverThreadId  -> mPresentByThreadId
@@ -221,6 +233,37 @@ struct PMTraceConsumer
     bool mTrackGPUVideo = false;        // Whether the analysis should track GPU video work separately
     bool mTrackInput = false;           // Whether to track keyboard/mouse click times
 
+    // In-progress presents that are still missing events this long (in
+    // milliseconds) after they started are considered lost.  The age is
+    // selected by the present's current PresentMode, so presents that have
+    // not been classified yet use the PresentMode::Unknown entry.
+    //
+    // These default to 10 seconds and are the configuration surface for
+    // applications; set them before the trace session is started (e.g., the
+    // console application sets every entry from --lost_present_age_ms).
+    //
+    // mTimestampFrequency is used to convert these into event timestamp units
+    // and is set by PMTraceSession::Start().
+    uint32_t mLostPresentAgeMs[PRESENT_MODE_COUNT];
+    uint64_t mTimestampFrequency = 10000000ull;
+
+    // Instrumentation of the consumer's work, including the number of presents
+    // that have been considered lost for each reason.  GetStats() can be
+    // called from any thread.
+    ConsumerStats mStats;
+
+    uint64_t GetLostPresentCount(LostPresentReason reason) const
+    {
+        return mStats.GetLostPresentCount(reason);
+    }
+
+    void GetStats(ConsumerStatsSnapshot* snapshot) const
+    {
+        mStats.GetSnapshot(snapshot);
+    }
+
+    void UpdateTrackingStats();
+
     // Whether we've completed any presents yet.  This is used to indicate that
     // all the necessary providers have started and it's safe to start tracking
     // presents.
@@ -279,6 +322,7 @@ struct PMTraceConsumer
         outPresentEvents.swap(mLostPresentEvents);
     }
 
+    // Process events are dequeued in QpcTime order.
     void DequeueProcessEvents(std::vector<ProcessEvent>& outProcessEvents)
     {
         std::lock_guard<std::mutex> lock(mProcessEventMutex);
@@ -289,9 +333,11 @@ struct PMTraceConsumer
     // These data structures store in-progress presents that are being
     // processed by PMTraceConsumer.
     //
-    // mAllPresents is a circular buffer storage for all in-progress presents.
-    // Presents that are still in-progress when the buffer wraps are considered
-    // lost due to age.
+    // mAgingWheel stores all in-progress presents, ordered by when they should
+    // be checked for age.  Presents that are still in-progress after their
+    // present mode's mLostPresentAgeMs are considered lost due to age.
+    // mExpiredPresents is scratch storage for presents pulled out of the
+    // wheel.
     //
     // mPresentByThreadId stores the in-progress present that was last operated
     // on by each thread.  This is used to look up the right present for event
@@ -335,27 +381,57 @@ struct PMTraceConsumer
     // DWM from each window.  It's needed to discard some legacy blts, which
     // don't always get a Win32K token Discarded transition.  The present is
     // either overwritten, or removed when DWM confirms the present.
-
-    using OrderedPresents = std::map<uint64_t, std::shared_ptr<PresentEvent>>;
+    //
+    // The indices are FlatHashMaps, so iterators and references into them are
+    // invalidated by any insert or erase (including those made while
+    // completing a present).  Look entries up again, or erase them by key,
+    // after anything that may modify the same map.
+
+    // OrderedPresents stores presents sorted by PresentStartTime.  They are
+    // almost always added in order and there are only a few in flight per
+    // process/swap chain, so this is a sorted vector rather than a tree.
+    class OrderedPresents {
+    public:
+        using value_type = std::pair<uint64_t, std::shared_ptr<PresentEvent>>;
+        using iterator = std::vector<value_type>::iterator;
+        using const_iterator = std::vector<value_type>::const_iterator;
+
+        iterator begin() { return mPresents.begin(); }
+        iterator end() { return mPresents.end(); }
+        const_iterator begin() const { return mPresents.begin(); }
+        const_iterator end() const { return mPresents.end(); }
+        size_t size() const { return mPresents.size(); }
+        bool empty() const { return mPresents.empty(); }
+
+        // These return whether a present was inserted/erased.
+        bool emplace(uint64_t presentStartTime, std::shared_ptr<PresentEvent> const& present);
+        bool erase(uint64_t presentStartTime);
+        void erase(iterator first, iterator last) { mPresents.erase(first, last); }
+        iterator upper_bound(uint64_t presentStartTime);
+
+    private:
+        std::vector<value_type> mPresents;
+    };
 
     using Win32KPresentHistoryToken = std::tuple<uint64_t, uint64_t, uint64_t>; // (composition surface pointer, present count, bind id)
-    struct Win32KPresentHistoryTokenHash : private std::hash<uint64_t> {
+    struct Win32KPresentHistoryTokenHash {
         std::size_t operator()(Win32KPresentHistoryToken const& v) const noexcept;
     };
 
-    unsigned int mAllPresentsNextIndex = 0;
-    std::vector<std::shared_ptr<PresentEvent>> mAllPresents;
+    using PresentsByContext = std::vector<std::pair<uint64_t, std::shared_ptr<PresentEvent>>>; // (hContext, PresentEvent)
 
-    std::unordered_map<uint32_t, std::shared_ptr<PresentEvent>> mPresentByThreadId;                     // ThreadId -> PresentEvent
-    std::unordered_map<uint32_t, OrderedPresents>               mOrderedPresentsByProcessId;            // ProcessId -> ordered PresentStartTime -> PresentEvent
-    std::unordered_map<uint32_t, std::unordered_map<uint64_t, std::shared_ptr<PresentEvent>>>
-                                                                mPresentBySubmitSequence;               // SubmitSequenceId -> hContext -> PresentEvent
-    std::unordered_map<Win32KPresentHistoryToken, std::shared_ptr<PresentEvent>,
-                       Win32KPresentHistoryTokenHash>           mPresentByWin32KPresentHistoryToken;    // Win32KPresentHistoryToken -> PresentEvent
-    std::unordered_map<uint64_t, std::shared_ptr<PresentEvent>> mPresentByDxgkPresentHistoryToken;      // DxgkPresentHistoryToken -> PresentEvent
-    std::unordered_map<uint64_t, std::shared_ptr<PresentEvent>> mPresentByDxgkPresentHistoryTokenData;  // DxgkPresentHistoryTokenData -> PresentEvent
-    std::unordered_map<uint64_t, std::shared_ptr<PresentEvent>> mPresentByDxgkContext;                  // DxgkContex -> PresentEvent
-    std::unordered_map<uint64_t, std::shared_ptr<PresentEvent>> mLastPresentByWindow;                   // HWND -> PresentEvent
+    PresentAgingWheel mAgingWheel;
+    std::vector<std::shared_ptr<PresentEvent>> mExpiredPresents;
+
+    FlatHashMap<uint32_t, std::shared_ptr<PresentEvent>> mPresentByThreadId;                    // ThreadId -> PresentEvent
+    FlatHashMap<uint32_t, OrderedPresents>               mOrderedPresentsByProcessId;           // ProcessId -> ordered PresentStartTime -> PresentEvent
+    FlatHashMap<uint32_t, PresentsByContext>             mPresentBySubmitSequence;              // SubmitSequenceId -> hContext -> PresentEvent
+    FlatHashMap<Win32KPresentHistoryToken, std::shared_ptr<PresentEvent>,
+                Win32KPresentHistoryTokenHash>           mPresentByWin32KPresentHistoryToken;   // Win32KPresentHistoryToken -> PresentEvent
+    FlatHashMap<uint64_t, std::shared_ptr<PresentEvent>> mPresentByDxgkPresentHistoryToken;     // DxgkPresentHistoryToken -> PresentEvent
+    FlatHashMap<uint64_t, std::shared_ptr<PresentEvent>> mPresentByDxgkPresentHistoryTokenData; // DxgkPresentHistoryTokenData -> PresentEvent
+    FlatHashMap<uint64_t, std::shared_ptr<PresentEvent>> mPresentByDxgkContext;                 // DxgkContex -> PresentEvent
+    FlatHashMap<uint64_t, std::shared_ptr<PresentEvent>> mLastPresentByWindow;                  // HWND -> PresentEvent
 
 
     // Once an in-progress present becomes lost, discarded, or displayed, it is
@@ -381,6 +457,13 @@ struct PMTraceConsumer
     std::unordered_map<uint32_t, std::unordered_map<uint64_t,
                                         DeferredCompletions>> mDeferredCompletions;   // ProcessId -> SwapChainAddress -> DeferredCompletions
 
+    // The number of presents in the nested collections above, kept up to date
+    // as presents are inserted and erased so that UpdateTrackingStats() does
+    // not have to walk them.
+    size_t mOrderedPresentCount = 0;        // mOrderedPresentsByProcessId
+    size_t mSubmitSequencePresentCount = 0; // mPresentBySubmitSequence
+    size_t mDeferredCompletionCount = 0;    // mDeferredCompletions
+
 
     // mGpuTrace tracks work executed on the GPU.
     GpuTrace mGpuTrace;
@@ -417,8 +500,10 @@ struct PMTraceConsumer
     void CompletePresentHelper(std::shared_ptr<PresentEvent> const& p);
     void EnqueueDeferredCompletions(DeferredCompletions* deferredCompletions);
     void EnqueueDeferredPresent(std::shared_ptr<PresentEvent> const& p);
-    void TrackPresent(std::shared_ptr<PresentEvent> present, OrderedPresents* presentsByThisProcess);
-    void RemoveLostPresent(std::shared_ptr<PresentEvent> present);
+    void TrackPresent(std::shared_ptr<PresentEvent> present);
+    void RemoveLostPresent(std::shared_ptr<PresentEvent> present, LostPresentReason reason);
+    void RemoveAgedPresents(uint64_t timestamp);
+    uint64_t GetLostPresentAge(PresentMode presentMode) const;
     void RemovePresentFromTemporaryTrackingCollections(std::shared_ptr<PresentEvent> const& present);
     void RemovePresentFromSubmitSequenceIdTracking(std::shared_ptr<PresentEvent> const& present);
     void RuntimePresentStart(Runtime runtime, EVENT_HEADER const& hdr, uint64_t swapchainAddr, uint32_t dxgiPresentFlags, int32_t syncInterval);
@@ -16,6 +16,11 @@
 
 namespace {
 
+// Realtime consumers receive events from this class when ETW drops events or
+// buffers, or fails to write the session's log file.
+struct __declspec(uuid("{6a399ae0-4bc6-4de9-870b-3657f8947e7e}")) RT_LOST_EVENT_GUID_STRUCT;
+static const auto RT_LOST_EVENT_GUID = __uuidof(RT_LOST_EVENT_GUID_STRUCT);
+
 struct TraceProperties : public EVENT_TRACE_PROPERTIES {
     wchar_t mSessionName[MAX_PATH];
 };
@@ -323,94 +328,139 @@ void DisableProviders(TRACEHANDLE sessionHandle)
     status = EnableTraceEx2(sessionHandle, &Microsoft_Windows_Win32k::GUID,         EVENT_CONTROL_CODE_DISABLE_PROVIDER, 0, 0, 0, 0, nullptr);
 }
 
+// Pass the event to the PMTraceConsumer handler for its provider, and return
+// which provider that was.
 template<
-    bool IS_REALTIME_SESSION,
     bool TRACK_DISPLAY,
     bool TRACK_INPUT>
-void CALLBACK EventRecordCallback(EVENT_RECORD* pEventRecord)
+ConsumerProvider DispatchEvent(PMTraceConsumer* consumer, EVENT_RECORD* pEventRecord)
 {
-    auto session = (PMTraceSession*) pEventRecord->UserContext;
     auto const& hdr = pEventRecord->EventHeader;
 
     #pragma warning(push)
     #pragma warning(disable: 4984) // c++17 extension
 
-    if constexpr (!IS_REALTIME_SESSION) {
-        if (session->mStartTimestamp.QuadPart == 0) {
-            session->mStartTimestamp = hdr.TimeStamp;
-        }
-    }
-
-    VerboseTraceEvent(session->mPMConsumer, pEventRecord, &session->mPMConsumer->mMetadata);
-
     if (hdr.ProviderId == Microsoft_Windows_DxgKrnl::GUID) {
-        session->mPMConsumer->HandleDXGKEvent(pEventRecord);
-        return;
+        consumer->HandleDXGKEvent(pEventRecord);
+        return ConsumerProvider::DxgKrnl;
     }
     if (hdr.ProviderId == Microsoft_Windows_DXGI::GUID) {
-        session->mPMConsumer->HandleDXGIEvent(pEventRecord);
-        return;
+        consumer->HandleDXGIEvent(pEventRecord);
+        return ConsumerProvider::DXGI;
     }
     if constexpr (TRACK_DISPLAY || TRACK_INPUT) {
         if (hdr.ProviderId == Microsoft_Windows_Win32k::GUID) {
-            session->mPMConsumer->HandleWin32kEvent(pEventRecord);
-            return;
+            consumer->HandleWin32kEvent(pEventRecord);
+            return ConsumerProvider::Win32k;
         }
     }
     if constexpr (TRACK_DISPLAY) {
         if (hdr.ProviderId == Microsoft_Windows_Dwm_Core::GUID) {
-            session->mPMConsumer->HandleDWMEvent(pEventRecord);
-            return;
+            consumer->HandleDWMEvent(pEventRecord);
+            return ConsumerProvider::DWM;
         }
     }
     if (hdr.ProviderId == Microsoft_Windows_D3D9::GUID) {
-        session->mPMConsumer->HandleD3D9Event(pEventRecord);
-        return;
+        consumer->HandleD3D9Event(pEventRecord);
+        return ConsumerProvider::D3D9;
     }
     if (hdr.ProviderId == Microsoft_Windows_Kernel_Process::GUID ||
         hdr.ProviderId == NT_Process::GUID) {
-        session->mPMConsumer->HandleProcessEvent(pEventRecord);
-        return;
+        consumer->HandleProcessEvent(pEventRecord);
+        return ConsumerProvider::Process;
     }
     if (hdr.ProviderId == Microsoft_Windows_DxgKrnl::Win7::PRESENTHISTORY_GUID) {
-        session->mPMConsumer->HandleWin7DxgkPresentHistory(pEventRecord);
-        return;
+        consumer->HandleWin7DxgkPresentHistory(pEventRecord);
+        return ConsumerProvider::Win7DxgKrnl;
     }
     if (hdr.ProviderId == Microsoft_Windows_EventMetadata::GUID) {
-        session->mPMConsumer->HandleMetadataEvent(pEventRecord);
-        return;
+        consumer->HandleMetadataEvent(pEventRecord);
+        return ConsumerProvider::EventMetadata;
     }
 
     if constexpr (TRACK_DISPLAY) {
         if (hdr.ProviderId == Microsoft_Windows_Dwm_Core::Win7::GUID) {
-            session->mPMConsumer->HandleDWMEvent(pEventRecord);
-            return;
+            consumer->HandleDWMEvent(pEventRecord);
+            return ConsumerProvider::Win7DWM;
         }
         if (hdr.ProviderId == Microsoft_Windows_DxgKrnl::Win7::BLT_GUID) {
-            session->mPMConsumer->HandleWin7DxgkBlt(pEventRecord);
-            return;
+            consumer->HandleWin7DxgkBlt(pEventRecord);
+            return ConsumerProvider::Win7DxgKrnl;
         }
         if (hdr.ProviderId == Microsoft_Windows_DxgKrnl::Win7::FLIP_GUID) {
-            session->mPMConsumer->HandleWin7DxgkFlip(pEventRecord);
-            return;
+            consumer->HandleWin7DxgkFlip(pEventRecord);
+            return ConsumerProvider::Win7DxgKrnl;
         }
         if (hdr.ProviderId == Microsoft_Windows_DxgKrnl::Win7::QUEUEPACKET_GUID) {
-            session->mPMConsumer->HandleWin7DxgkQueuePacket(pEventRecord);
-            return;
+            consumer->HandleWin7DxgkQueuePacket(pEventRecord);
+            return ConsumerProvider::Win7DxgKrnl;
         }
         if (hdr.ProviderId == Microsoft_Windows_DxgKrnl::Win7::VSYNCDPC_GUID) {
-            session->mPMConsumer->HandleWin7DxgkVSyncDPC(pEventRecord);
-            return;
+            consumer->HandleWin7DxgkVSyncDPC(pEventRecord);
+            return ConsumerProvider::Win7DxgKrnl;
         }
         if (hdr.ProviderId == Microsoft_Windows_DxgKrnl::Win7::MMIOFLIP_GUID) {
-            session->mPMConsumer->HandleWin7DxgkMMIOFlip(pEventRecord);
-            return;
+            consumer->HandleWin7DxgkMMIOFlip(pEventRecord);
+            return ConsumerProvider::Win7DxgKrnl;
         }
     }
 
+    if (hdr.ProviderId == RT_LOST_EVENT_GUID) {
+        consumer->mStats.CountRealtimeLoss(hdr.EventDescriptor.Opcode);
+    }
+
+    return ConsumerProvider::Other;
+
     #pragma warning(pop)
 }
 
+template<
+    bool IS_REALTIME_SESSION,
+    bool TRACK_DISPLAY,
+    bool TRACK_INPUT>
+void CALLBACK EventRecordCallback(EVENT_RECORD* pEventRecord)
+{
+    auto session = (PMTraceSession*) pEventRecord->UserContext;
+    auto consumer = session->mPMConsumer;
+    auto const& hdr = pEventRecord->EventHeader;
+
+    #pragma warning(push)
+    #pragma warning(disable: 4984) // c++17 extension
+
+    if constexpr (!IS_REALTIME_SESSION) {
+        if (session->mStartTimestamp.QuadPart == 0) {
+            session->mStartTimestamp = hdr.TimeStamp;
+        }
+    }
+
+    #pragma warning(pop)
+
+    VerboseTraceEvent(consumer, pEventRecord, &consumer->mMetadata);
+
+    // Only time a sample of the events, since timing costs about as much as
+    // handling the simplest events.
+    bool updateTrackingSizes = false;
+    ConsumerProvider provider;
+    if (consumer->mStats.BeginEvent(&updateTrackingSizes)) {
+        LARGE_INTEGER t0 = {};
+        LARGE_INTEGER t1 = {};
+        consumer->mMetadata.timeDecode_ = true;
+        consumer->mMetadata.decodeTime_ = 0;
+        QueryPerformanceCounter(&t0);
+        provider = DispatchEvent<TRACK_DISPLAY, TRACK_INPUT>(consumer, pEventRecord);
+        QueryPerformanceCounter(&t1);
+        consumer->mMetadata.timeDecode_ = false;
+        consumer->mStats.AddSampledTime((uint64_t) (t1.QuadPart - t0.QuadPart), consumer->mMetadata.decodeTime_);
+    } else {
+        provider = DispatchEvent<TRACK_DISPLAY, TRACK_INPUT>(consumer, pEventRecord);
+    }
+
+    consumer->mStats.CountEvent(provider, hdr.EventDescriptor.Id);
+    if (updateTrackingSizes) {
+        consumer->UpdateTrackingStats();
+    }
+}
+
 template<bool... Ts>
 PEVENT_RECORD_CALLBACK GetEventRecordCallback(bool t1)
 {
@@ -532,6 +582,10 @@ ULONG PMTraceSession::Start(
         mTimestampFrequency.QuadPart = 10000000ull;
     }
 
+    // The consumer needs the frequency to convert its lost-present ages into
+    // event timestamp units.
+    mPMConsumer->mTimestampFrequency = mTimestampFrequency.QuadPart;
+
     if (mIsRealtimeSession) {
         LARGE_INTEGER qpc1 = {};
         LARGE_INTEGER qpc2 = {};
@@ -180,10 +180,25 @@ void EventMetadata::AddMetadata(EVENT_RECORD* eventRecord)
     }
 }
 
+void EventMetadata::GetEventData(EVENT_RECORD* eventRecord, EventDataDesc* desc, uint32_t descCount, uint32_t optionalCount /*=0*/)
+{
+    if (!timeDecode_) {
+        FindEventData(eventRecord, desc, descCount, optionalCount);
+        return;
+    }
+
+    LARGE_INTEGER t0 = {};
+    LARGE_INTEGER t1 = {};
+    QueryPerformanceCounter(&t0);
+    FindEventData(eventRecord, desc, descCount, optionalCount);
+    QueryPerformanceCounter(&t1);
+    decodeTime_ += (uint64_t) (t1.QuadPart - t0.QuadPart);
+}
+
 // Look up metadata for this provider/event and use it to look up the property.
 // If the metadata isn't found look it up using TDH.  Then, look up each
 // property in the metadata to obtain it's data pointer and size.
-void EventMetadata::GetEventData(EVENT_RECORD* eventRecord, EventDataDesc* desc, uint32_t descCount, uint32_t optionalCount /*=0*/)
+void EventMetadata::FindEventData(EVENT_RECORD* eventRecord, EventDataDesc* desc, uint32_t descCount, uint32_t optionalCount)
 {
     // Look up stored metadata.  If not found, look up metadata using TDH and
     // cache it for future events.
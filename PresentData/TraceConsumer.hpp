@@ -67,8 +67,14 @@ template<> std::wstring EventDataDesc::GetData<std::wstring>() const;
 struct EventMetadata {
     std::unordered_map<EventMetadataKey, std::vector<uint8_t>, EventMetadataKeyHash, EventMetadataKeyEqual> metadata_;
 
+    // While timeDecode_ is set, the QPC time spent in GetEventData() is added
+    // to decodeTime_.
+    bool timeDecode_ = false;
+    uint64_t decodeTime_ = 0;
+
     void AddMetadata(EVENT_RECORD* eventRecord);
     void GetEventData(EVENT_RECORD* eventRecord, EventDataDesc* desc, uint32_t descCount, uint32_t optionalCount=0);
+    void FindEventData(EVENT_RECORD* eventRecord, EventDataDesc* desc, uint32_t descCount, uint32_t optionalCount);
 
     template<typename T> T GetEventData(EVENT_RECORD* eventRecord, wchar_t const* name)
     {
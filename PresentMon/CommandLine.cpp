@@ -335,10 +335,14 @@ bool ParseCommandLine(int argc, wchar_t** argv)
 
     args->mTargetProcessNames.clear();
     args->mExcludeProcessNames.clear();
+    args->mEtlBatch.clear();
     args->mOutputCsvFileName = nullptr;
     args->mEtlFileName = nullptr;
     args->mSessionName = L"PresentMon";
+    args->mBatchOutputDir = nullptr;
     args->mTargetPid = 0;
+    args->mBatchJobs = 0;
+    args->mLostPresentAgeMs = 0;
     args->mDelay = 0;
     args->mTimer = 0;
     args->mHotkeyModifiers = MOD_NOREPEAT;
@@ -358,6 +362,7 @@ bool ParseCommandLine(int argc, wchar_t** argv)
     args->mTryToElevate = false;
     args->mMultiCsv = false;
     args->mUseV1Metrics = false;
+    args->mPrintConsumerStats = false;
     args->mStopExistingSession = false;
 
     bool sessionNameSet  = false;
@@ -380,6 +385,7 @@ bool ParseCommandLine(int argc, wchar_t** argv)
         else if (ParseArg(argv[i], L"exclude"))      { if (ParseValue(argv, argc, &i, &args->mExcludeProcessNames)) continue; }
         else if (ParseArg(argv[i], L"process_id"))   { if (ParseValue(argv, argc, &i, &args->mTargetPid))           continue; }
         else if (ParseArg(argv[i], L"etl_file"))     { if (ParseValue(argv, argc, &i, &args->mEtlFileName))         continue; }
+        else if (ParseArg(argv[i], L"etl_batch"))    { if (ParseValue(argv, argc, &i, &args->mEtlBatch))            continue; }
 
         // Output options:
         else if (ParseArg(argv[i], L"output_file"))      { if (ParseValue(argv, argc, &i, &args->mOutputCsvFileName)) continue; }
@@ -392,6 +398,8 @@ bool ParseCommandLine(int argc, wchar_t** argv)
         else if (ParseArg(argv[i], L"date_time"))        { dtTime                = true;                              continue; }
         else if (ParseArg(argv[i], L"exclude_dropped"))  { args->mExcludeDropped = true;                              continue; }
         else if (ParseArg(argv[i], L"v1_metrics"))       { args->mUseV1Metrics   = true;                              continue; }
+        else if (ParseArg(argv[i], L"batch_output_dir")) { if (ParseValue(argv, argc, &i, &args->mBatchOutputDir))    continue; }
+        else if (ParseArg(argv[i], L"consumer_stats"))   { args->mPrintConsumerStats = true;                          continue; }
 
         // Recording options:
         else if (ParseArg(argv[i], L"hotkey"))           { if (ParseValue(argv, argc, &i) && AssignHotkey(argv[i], args)) continue; }
@@ -402,6 +410,7 @@ bool ParseCommandLine(int argc, wchar_t** argv)
         else if (ParseArg(argv[i], L"track_gpu_video"))  { args->mTrackGPUVideo       = true;  continue; }
         else if (ParseArg(argv[i], L"no_track_input"))   { args->mTrackInput          = false; continue; }
         else if (ParseArg(argv[i], L"no_track_display")) { args->mTrackDisplay        = false; continue; }
+        else if (ParseArg(argv[i], L"lost_present_age_ms")) { if (ParseValue(argv, argc, &i, &args->mLostPresentAgeMs)) continue; }
 
         // Execution options:
         else if (ParseArg(argv[i], L"session_name"))               { if (ParseValue(argv, argc, &i, &args->mSessionName)) { sessionNameSet = true; continue; } }
@@ -410,6 +419,7 @@ bool ParseCommandLine(int argc, wchar_t** argv)
         else if (ParseArg(argv[i], L"restart_as_admin"))           { args->mTryToElevate             = true; continue; }
         else if (ParseArg(argv[i], L"terminate_on_proc_exit"))     { args->mTerminateOnProcExit      = true; continue; }
         else if (ParseArg(argv[i], L"terminate_after_timed"))      { args->mTerminateAfterTimer      = true; continue; }
+        else if (ParseArg(argv[i], L"batch_jobs"))                 { if (ParseValue(argv, argc, &i, &args->mBatchJobs)) continue; }
 
         // Hidden options:
         #if PRESENTMON_ENABLE_DEBUG_TRACE
@@ -448,6 +458,25 @@ bool ParseCommandLine(int argc, wchar_t** argv)
         return false;
     }
 
+    // --etl_batch runs a separate --etl_file analysis for each ETL, writing
+    // a CSV named after the ETL, so it can't be combined with options that
+    // name a single input or output.
+    if (!args->mEtlBatch.empty()) {
+        if (args->mEtlFileName != nullptr || csvOutputStdout || csvOutputNone) {
+            PrintError(L"error: --etl_batch cannot be used with --etl_file, --output_stdout, or --no_csv.\n");
+            PrintUsage();
+            return false;
+        }
+        if (args->mOutputCsvFileName != nullptr) {
+            PrintWarning(L"warning: ignoring --output_file due to --etl_batch; use --batch_output_dir to choose where CSVs are written.\n");
+            args->mOutputCsvFileName = nullptr;
+        }
+    } else if (args->mBatchOutputDir != nullptr || args->mBatchJobs != 0) {
+        PrintWarning(L"warning: ignoring --batch_output_dir and --batch_jobs because --etl_batch was not used.\n");
+        args->mBatchOutputDir = nullptr;
+        args->mBatchJobs = 0;
+    }
+
     // Ensure only one of --output_file --output_stdout --no_csv.
     if (csvOutputNone + csvOutputStdout + (args->mOutputCsvFileName != nullptr) > 1) {
         PrintWarning(L"warning: only one of the following options may be used:");
@@ -249,56 +249,78 @@ static float CalculateFPSForPrintf(float duration)
     return duration == 0.f ? 0.f : ((1000.f / duration) + 0.05f);
 }
 
-void UpdateConsole(uint32_t processId, ProcessInfo const& processInfo)
+static void AppendPrint(std::wstring* s, wchar_t const* format, ...)
+{
+    wchar_t buffer[256];
+
+    va_list val;
+    va_start(val, format);
+    uint32_t numChars = VPrint(buffer, _countof(buffer), format, val);
+    va_end(val);
+
+    s->append(buffer, numChars);
+}
+
+static void FormatSwapChainRow(uint64_t address, SwapChainData const& chain, std::wstring* row)
 {
     auto const& args = GetCommandLineArgs();
 
+    row->clear();
+    AppendPrint(row, L"    %016llX", address);
+
+    if (chain.mPresentInfoValid) {
+        AppendPrint(row, L" (%hs): SyncInterval=%d Flags=%d CPU=%.3fms (%.1f fps)",
+            RuntimeToString(chain.mPresentRuntime),
+            chain.mPresentSyncInterval,
+            chain.mPresentFlags,
+            chain.mAvgCPUDuration,
+            CalculateFPSForPrintf(chain.mAvgCPUDuration));
+
+        if (args.mTrackDisplay) {
+            AppendPrint(row, L" Display=%.3fms (%.1f fps)",
+                chain.mAvgDisplayedTime,
+                CalculateFPSForPrintf(chain.mAvgDisplayedTime));
+        }
+
+        if (args.mTrackGPU) {
+            AppendPrint(row, L" GPU=%.3fms", chain.mAvgGPUDuration);
+        }
+
+        if (args.mTrackDisplay) {
+            AppendPrint(row, L" Latency=%.3fms %hs",
+                chain.mAvgDisplayLatency,
+                PresentModeToString(chain.mPresentMode));
+        }
+    }
+}
+
+void UpdateConsole(uint32_t processId, ProcessInfo* processInfo)
+{
     // Don't display non-target or empty processes
-    if (!processInfo.mIsTargetProcess ||
-        processInfo.mModuleName.empty() ||
-        processInfo.mSwapChain.empty()) {
+    if (!processInfo->mIsTargetProcess ||
+        processInfo->mModuleName.empty() ||
+        processInfo->mSwapChain.empty()) {
         return;
     }
 
     auto empty = true;
 
-    for (auto const& pair : processInfo.mSwapChain) {
-        auto address = pair.first;
-        auto const& chain = pair.second;
+    for (auto& pair : processInfo->mSwapChain) {
+        auto chain = &pair.second;
 
         if (empty) {
             empty = false;
-            ConsolePrintLn(L"%s[%d]:", processInfo.mModuleName.c_str(), processId);
+            ConsolePrintLn(L"%s[%d]:", processInfo->mModuleName.c_str(), processId);
         }
 
-        ConsolePrint(L"    %016llX", address);
-
-        if (chain.mPresentInfoValid) {
-            ConsolePrint(L" (%hs): SyncInterval=%d Flags=%d CPU=%.3fms (%.1f fps)",
-                RuntimeToString(chain.mPresentRuntime),
-                chain.mPresentSyncInterval,
-                chain.mPresentFlags,
-                chain.mAvgCPUDuration,
-                CalculateFPSForPrintf(chain.mAvgCPUDuration));
-
-            if (args.mTrackDisplay) {
-                ConsolePrint(L" Display=%.3fms (%.1f fps)",
-                    chain.mAvgDisplayedTime,
-                    CalculateFPSForPrintf(chain.mAvgDisplayedTime));
-            }
-
-            if (args.mTrackGPU) {
-                ConsolePrint(L" GPU=%.3fms", chain.mAvgGPUDuration);
-            }
-
-            if (args.mTrackDisplay) {
-                ConsolePrint(L" Latency=%.3fms %hs",
-                    chain.mAvgDisplayLatency,
-                    PresentModeToString(chain.mPresentMode));
-            }
+        // Only re-format the rows of chains that were updated since the last
+        // console update.
+        if (!chain->mConsoleRowValid) {
+            FormatSwapChainRow(pair.first, *chain, &chain->mConsoleRow);
+            chain->mConsoleRowValid = true;
         }
 
-        ConsolePrintLn(L"");
+        ConsolePrintLn(L"%s", chain->mConsoleRow.c_str());
     }
 
     if (!empty) {
@@ -368,3 +390,61 @@ int PrintError(wchar_t const* format, ...)
     va_end(val);
     return c;
 }
+
+void PrintConsumerStats(ConsumerStatsSnapshot const& stats)
+{
+    LARGE_INTEGER frequency = {};
+    QueryPerformanceFrequency(&frequency);
+    auto toUs = [&](uint64_t t) { return 1000000.0 * t / frequency.QuadPart; };
+
+    fwprintf(stderr, L"Events: %llu\n", stats.mTotalEventCount);
+    for (uint32_t p = 0; p < (uint32_t) ConsumerProvider::Count; ++p) {
+        uint64_t providerCount = 0;
+        for (auto count : stats.mEventCount[p]) {
+            providerCount += count;
+        }
+        if (providerCount == 0) {
+            continue;
+        }
+
+        fwprintf(stderr, L"    %-14hs %llu:", ConsumerProviderToString((ConsumerProvider) p), providerCount);
+        for (uint32_t id = 0; id <= ConsumerStatsSnapshot::kEventIdCount; ++id) {
+            if (stats.mEventCount[p][id] == 0) {
+                continue;
+            }
+            if (id == ConsumerStatsSnapshot::kEventIdCount) {
+                fwprintf(stderr, L" other=%llu", stats.mEventCount[p][id]);
+            } else {
+                fwprintf(stderr, L" %u=%llu", id, stats.mEventCount[p][id]);
+            }
+        }
+        fwprintf(stderr, L"\n");
+    }
+
+    if (stats.mSampledEventCount > 0) {
+        fwprintf(stderr, L"Handling time (%llu sampled events): %.2fus average, %.1f%% decoding\n",
+                 stats.mSampledEventCount,
+                 toUs(stats.mHandlerTime) / stats.mSampledEventCount,
+                 stats.mHandlerTime == 0 ? 0.0 : 100.0 * stats.mDecodeTime / stats.mHandlerTime);
+        for (uint32_t i = 0; i < ConsumerStatsSnapshot::kHistogramBucketCount; ++i) {
+            if (stats.mHandlerTimeHistogram[i] != 0) {
+                fwprintf(stderr, L"    >= %10.2fus: %llu\n", toUs(1ull << i), stats.mHandlerTimeHistogram[i]);
+            }
+        }
+    }
+
+    fwprintf(stderr, L"Tracked presents (current/peak):\n");
+    for (uint32_t i = 0; i < (uint32_t) TrackingCollection::Count; ++i) {
+        fwprintf(stderr, L"    %-38hs %llu/%llu\n", TrackingCollectionToString((TrackingCollection) i),
+                 stats.mTrackingSize[i], stats.mTrackingSizePeak[i]);
+    }
+
+    fwprintf(stderr, L"Lost presents:");
+    for (uint32_t i = 0; i < (uint32_t) LostPresentReason::Count; ++i) {
+        fwprintf(stderr, L" %hs=%llu", LostPresentReasonToString((LostPresentReason) i), stats.mLostPresentCount[i]);
+    }
+    fwprintf(stderr, L"\n");
+
+    fwprintf(stderr, L"Realtime losses: events=%llu buffers=%llu files=%llu\n",
+             stats.mRealtimeLostEvents, stats.mRealtimeLostBuffers, stats.mRealtimeLostFiles);
+}
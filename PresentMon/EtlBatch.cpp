@@ -0,0 +1,324 @@
+// Copyright (C) 2024 Intel Corporation
+// SPDX-License-Identifier: MIT
+
+#include "PresentMon.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <shlwapi.h>
+
+// --etl_batch analyzes many ETL files by running a separate PresentMon
+// process with --etl_file for each one.  This keeps each file's analysis
+// state (PMTraceConsumer, process tracking, CSV output) isolated, and allows
+// up to --batch_jobs files to be analyzed concurrently.
+//
+// Files are handled in sorted path order and each CSV is named after its ETL,
+// so the output doesn't depend on the order in which the jobs complete.
+
+namespace {
+
+struct BatchJob {
+    std::wstring mEtlPath;
+    std::wstring mCsvPath;
+    uint64_t mEtlBytes;
+    uint64_t mStartQpc;
+    double mSeconds;
+    DWORD mExitCode;
+};
+
+std::wstring GetDirectory(std::wstring const& path)
+{
+    auto i = path.find_last_of(L"/\\");
+    return i == std::wstring::npos ? std::wstring() : path.substr(0, i + 1);
+}
+
+bool HasWildcard(std::wstring const& path)
+{
+    return path.find_first_of(L"*?") != std::wstring::npos;
+}
+
+bool IsEtlPath(std::wstring const& path)
+{
+    return _wcsicmp(PathFindExtensionW(path.c_str()), L".etl") == 0;
+}
+
+void AddMatchingEtlFiles(std::wstring const& pattern, std::vector<std::wstring>* etlPaths)
+{
+    auto directory = GetDirectory(pattern);
+
+    WIN32_FIND_DATAW data = {};
+    auto h = FindFirstFileW(pattern.c_str(), &data);
+    if (h == INVALID_HANDLE_VALUE) {
+        PrintWarning(L"warning: no files match --etl_batch %s\n", pattern.c_str());
+        return;
+    }
+    do {
+        if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0) {
+            etlPaths->emplace_back(directory + data.cFileName);
+        }
+    } while (FindNextFileW(h, &data));
+    FindClose(h);
+}
+
+// A manifest lists one ETL path or wildcard pattern per line.  Relative paths
+// are relative to the manifest, and empty lines or lines starting with '#' are
+// ignored.
+bool AddManifestEtlFiles(std::wstring const& manifestPath, std::vector<std::wstring>* etlPaths)
+{
+    std::ifstream file(manifestPath.c_str());
+    if (!file) {
+        PrintError(L"error: failed to open --etl_batch manifest: %s\n", manifestPath.c_str());
+        return false;
+    }
+
+    auto directory = GetDirectory(manifestPath);
+    for (std::string line; std::getline(file, line); ) {
+        auto first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+        auto last = line.find_last_not_of(" \t\r");
+        line = line.substr(first, last - first + 1);
+
+        std::wstring path(MultiByteToWideChar(CP_UTF8, 0, line.c_str(), (int) line.size(), nullptr, 0), L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, line.c_str(), (int) line.size(), &path[0], (int) path.size());
+        if (PathIsRelativeW(path.c_str())) {
+            path = directory + path;
+        }
+
+        if (HasWildcard(path)) {
+            AddMatchingEtlFiles(path, etlPaths);
+        } else {
+            etlPaths->emplace_back(path);
+        }
+    }
+
+    return true;
+}
+
+// Whether arg is one of the batch options (which are not passed on to the
+// per-file processes), and if so whether it is followed by a value.
+bool IsBatchArg(wchar_t const* arg, bool* hasValue)
+{
+    switch (*arg) {
+    case L'/': arg += 1; break;
+    case L'-': arg += arg[1] == L'-' ? 2 : 1; break;
+    default: return false;
+    }
+
+    *hasValue = true;
+    if (_wcsicmp(arg, L"etl_batch")        == 0 ||
+        _wcsicmp(arg, L"batch_jobs")       == 0 ||
+        _wcsicmp(arg, L"batch_output_dir") == 0 ||
+        _wcsicmp(arg, L"output_file")      == 0) {
+        return true;
+    }
+
+    *hasValue = false;
+    return _wcsicmp(arg, L"no_console_stats") == 0 ||
+           _wcsicmp(arg, L"restart_as_admin") == 0;
+}
+
+void AppendArg(std::wstring* commandLine, std::wstring const& arg)
+{
+    auto addQuotes = arg.find_first_of(L" \t") != std::wstring::npos && arg[0] != L'\"';
+    *commandLine += L' ';
+    if (addQuotes) *commandLine += L'\"';
+    *commandLine += arg;
+    if (addQuotes) *commandLine += L'\"';
+}
+
+uint64_t GetFileBytes(std::wstring const& path)
+{
+    WIN32_FILE_ATTRIBUTE_DATA data = {};
+    if (!GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &data)) {
+        return 0;
+    }
+    return ((uint64_t) data.nFileSizeHigh << 32) | data.nFileSizeLow;
+}
+
+uint64_t GetQpc()
+{
+    LARGE_INTEGER qpc = {};
+    QueryPerformanceCounter(&qpc);
+    return qpc.QuadPart;
+}
+
+}
+
+int RunEtlBatch(int argc, wchar_t** argv)
+{
+    auto const& args = GetCommandLineArgs();
+
+    // Expand the --etl_batch arguments into a sorted list of unique ETL paths.
+    std::vector<std::wstring> etlPaths;
+    for (auto const& batchArg : args.mEtlBatch) {
+        if (HasWildcard(batchArg)) {
+            AddMatchingEtlFiles(batchArg, &etlPaths);
+        } else if (IsEtlPath(batchArg)) {
+            etlPaths.emplace_back(batchArg);
+        } else if (!AddManifestEtlFiles(batchArg, &etlPaths)) {
+            return 1;
+        }
+    }
+
+    std::sort(etlPaths.begin(), etlPaths.end(), [](std::wstring const& a, std::wstring const& b) {
+        return _wcsicmp(a.c_str(), b.c_str()) < 0;
+    });
+    etlPaths.erase(std::unique(etlPaths.begin(), etlPaths.end(), [](std::wstring const& a, std::wstring const& b) {
+        return _wcsicmp(a.c_str(), b.c_str()) == 0;
+    }), etlPaths.end());
+
+    if (etlPaths.empty()) {
+        PrintError(L"error: --etl_batch did not specify any ETL files.\n");
+        return 1;
+    }
+
+    // Name each CSV after its ETL, in --batch_output_dir if specified or next
+    // to the ETL otherwise.  ETLs with the same name from different
+    // directories get a "-<Index>" suffix, in path order.
+    std::wstring outputDir;
+    if (args.mBatchOutputDir != nullptr) {
+        outputDir = args.mBatchOutputDir;
+        if (outputDir.back() != L'\\' && outputDir.back() != L'/') {
+            outputDir += L'\\';
+        }
+        CreateDirectoryW(outputDir.c_str(), nullptr);
+    }
+
+    std::vector<BatchJob> jobs(etlPaths.size());
+    std::unordered_map<std::wstring, uint32_t> csvNameCounts;
+    for (size_t i = 0; i < etlPaths.size(); ++i) {
+        auto const& etlPath = etlPaths[i];
+
+        std::wstring name(PathFindFileNameW(etlPath.c_str()));
+        name.resize(name.size() - wcslen(PathFindExtensionW(name.c_str())));
+
+        std::wstring key(name);
+        std::transform(key.begin(), key.end(), key.begin(), [](wchar_t c) { return (wchar_t) ::towlower(c); });
+        auto count = ++csvNameCounts[key];
+        if (count > 1) {
+            name += L"-" + std::to_wstring(count);
+        }
+
+        auto job = &jobs[i];
+        job->mEtlPath  = etlPath;
+        job->mCsvPath  = (outputDir.empty() ? GetDirectory(etlPath) : outputDir) + name + L".csv";
+        job->mEtlBytes = GetFileBytes(etlPath);
+        job->mStartQpc = 0;
+        job->mSeconds  = 0.0;
+        job->mExitCode = (DWORD) -1;
+    }
+
+    // Arguments passed to every per-file process.
+    wchar_t exePath[MAX_PATH] = {};
+    GetModuleFileNameW(NULL, exePath, _countof(exePath));
+
+    std::wstring commonArgs;
+    AppendArg(&commonArgs, exePath);
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = false;
+        if (IsBatchArg(argv[i], &hasValue)) {
+            i += hasValue ? 1 : 0;
+            continue;
+        }
+        AppendArg(&commonArgs, argv[i]);
+    }
+    AppendArg(&commonArgs, L"--no_console_stats");
+
+    // Run the jobs, keeping up to --batch_jobs processes running at a time.
+    SYSTEM_INFO systemInfo = {};
+    GetSystemInfo(&systemInfo);
+    DWORD maxJobs = args.mBatchJobs != 0 ? args.mBatchJobs : systemInfo.dwNumberOfProcessors;
+    maxJobs = (std::max)(1ul, (std::min)(maxJobs, (DWORD) MAXIMUM_WAIT_OBJECTS));
+
+    LARGE_INTEGER qpcFrequency = {};
+    QueryPerformanceFrequency(&qpcFrequency);
+    auto batchStartQpc = GetQpc();
+
+    std::vector<HANDLE> runningProcesses;
+    std::vector<size_t> runningJobs;
+    size_t nextJob = 0;
+    while (nextJob < jobs.size() || !runningProcesses.empty()) {
+        while (nextJob < jobs.size() && runningProcesses.size() < maxJobs) {
+            auto job = &jobs[nextJob];
+
+            auto commandLine = commonArgs;
+            AppendArg(&commandLine, L"--etl_file");
+            AppendArg(&commandLine, job->mEtlPath);
+            AppendArg(&commandLine, L"--output_file");
+            AppendArg(&commandLine, job->mCsvPath);
+
+            STARTUPINFOW startupInfo = { sizeof(startupInfo) };
+            PROCESS_INFORMATION processInfo = {};
+            job->mStartQpc = GetQpc();
+            if (CreateProcessW(exePath, &commandLine[0], nullptr, nullptr, FALSE, 0, nullptr, nullptr,
+                               &startupInfo, &processInfo)) {
+                CloseHandle(processInfo.hThread);
+                runningProcesses.push_back(processInfo.hProcess);
+                runningJobs.push_back(nextJob);
+            } else {
+                PrintError(L"error: failed to start analysis of %s (error %lu).\n", job->mEtlPath.c_str(), GetLastError());
+            }
+            nextJob += 1;
+        }
+
+        if (runningProcesses.empty()) {
+            continue;
+        }
+
+        auto r = WaitForMultipleObjects((DWORD) runningProcesses.size(), runningProcesses.data(), FALSE, INFINITE);
+        if (r >= WAIT_OBJECT_0 + runningProcesses.size()) {
+            PrintError(L"error: failed to wait for --etl_batch jobs (error %lu).\n", GetLastError());
+            break;
+        }
+
+        auto index = r - WAIT_OBJECT_0;
+        auto job = &jobs[runningJobs[index]];
+        GetExitCodeProcess(runningProcesses[index], &job->mExitCode);
+        job->mSeconds = double(GetQpc() - job->mStartQpc) / qpcFrequency.QuadPart;
+        CloseHandle(runningProcesses[index]);
+
+        runningProcesses.erase(runningProcesses.begin() + index);
+        runningJobs.erase(runningJobs.begin() + index);
+    }
+
+    for (auto h : runningProcesses) {
+        CloseHandle(h);
+    }
+
+    auto batchSeconds = double(GetQpc() - batchStartQpc) / qpcFrequency.QuadPart;
+
+    // Write the throughput report, in the same order as the jobs.
+    uint64_t totalBytes = 0;
+    size_t failedCount = 0;
+    auto reportPath = outputDir + L"PresentMon-batch-report.csv";
+    FILE* fp = nullptr;
+    if (_wfopen_s(&fp, reportPath.c_str(), L"w,ccs=UTF-8") != 0) {
+        PrintError(L"error: failed to create batch report: %s\n", reportPath.c_str());
+        fp = nullptr;
+    }
+    if (fp != nullptr) {
+        fwprintf(fp, L"EtlFile,CsvFile,ExitCode,EtlBytes,Seconds,MBPerSecond\n");
+    }
+    for (auto const& job : jobs) {
+        totalBytes += job.mEtlBytes;
+        if (job.mExitCode != 0) {
+            failedCount += 1;
+        }
+        if (fp != nullptr) {
+            fwprintf(fp, L"\"%s\",\"%s\",%ld,%llu,%.3lf,%.3lf\n", job.mEtlPath.c_str(), job.mCsvPath.c_str(),
+                     (long) job.mExitCode, job.mEtlBytes, job.mSeconds,
+                     job.mSeconds > 0.0 ? job.mEtlBytes / (1024.0 * 1024.0) / job.mSeconds : 0.0);
+        }
+    }
+    if (fp != nullptr) {
+        fclose(fp);
+    }
+
+    wprintf(L"Analyzed %zu ETL files (%zu failed) using %lu jobs: %.1lf MB in %.2lf s (%.1lf MB/s)\n",
+                   jobs.size(), failedCount, maxJobs, totalBytes / (1024.0 * 1024.0), batchSeconds,
+                   batchSeconds > 0.0 ? totalBytes / (1024.0 * 1024.0) / batchSeconds : 0.0);
+
+    return failedCount == 0 ? 0 : 8;
+}
@@ -201,6 +201,13 @@ int wmain(int argc, wchar_t** argv)
         return 7;
     }
 
+    // --etl_batch analyzes each ETL in a separate PresentMon process.
+    if (!args.mEtlBatch.empty()) {
+        auto code = RunEtlBatch(argc, argv);
+        FinalizeConsole();
+        return code;
+    }
+
     // Attempt to elevate process privilege if necessary.
     //
     // If we are processing an ETL file we don't need elevated privilege, but
@@ -258,6 +265,11 @@ int wmain(int argc, wchar_t** argv)
     pmConsumer.mTrackGPU      = args.mTrackGPU;
     pmConsumer.mTrackGPUVideo = args.mTrackGPUVideo;
     pmConsumer.mTrackInput    = args.mTrackInput;
+    if (args.mLostPresentAgeMs != 0) {
+        for (auto& ageMs : pmConsumer.mLostPresentAgeMs) {
+            ageMs = args.mLostPresentAgeMs;
+        }
+    }
 
     if (args.mTargetPid != 0) {
         pmConsumer.mFilteredProcessIds = true;
@@ -375,6 +387,12 @@ int wmain(int argc, wchar_t** argv)
         PrintWarning(L"warning: %lu ETW events were lost.\n", pmSession.mNumEventsLost);
     }
 
+    if (args.mPrintConsumerStats) {
+        std::unique_ptr<ConsumerStatsSnapshot> stats(new ConsumerStatsSnapshot);
+        pmConsumer.GetStats(stats.get());
+        PrintConsumerStats(*stats);
+    }
+
     /* We cannot remove the Ctrl handler because it is in an infinite sleep so
      * this call will never return, either hanging the application or having
      * the threshold timer trigger and force terminate (depending on what Ctrl
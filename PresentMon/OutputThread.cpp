@@ -4,6 +4,8 @@
 #include "PresentMon.hpp"
 
 #include <algorithm>
+#include <map>
+#include <memory>
 #include <shlwapi.h>
 #include <thread>
 
@@ -73,64 +75,133 @@ static bool CopyRecordingToggleHistory(std::vector<uint64_t>* recordingToggleHis
 // get similar ProcessStart/ProcessStop events, but only if PresentMon is
 // running when the process started/stopped.  If we don't have elevated
 // privilege or we missed a process start/stop we update the active processes
-// whenever we notice an event with a new process id.  If it's a target
-// process, we obtain a handle to the process, and periodically check it to see
-// if it has exited.
+// whenever we notice an event with a new process id.  In this case, we look up
+// the process name and obtain a handle to the process asynchronously using
+// gProcessResolver, and are notified through the thread pool when the handle
+// is signaled to indicate the process exited.
 
 static std::unordered_map<uint32_t, ProcessInfo> gProcesses;
 static uint32_t gTargetProcessCount = 0;
 
-// Removes any directory and extension, and converts the remaining name to
-// lower case.
-void CanonicalizeProcessName(std::wstring* name)
-{
-    size_t i = name->find_last_of(L"./\\");
-    if (i != std::wstring::npos && (*name)[i] == L'.') {
-        name->resize(i);
-        i = name->find_last_of(L"/\\");
+// All SwapChainData are linked into a list ordered from least- to most-
+// recently updated, so that pruning old chains only has to look at the front
+// of the list instead of every chain of every process.  gPresentingProcesses
+// holds the processes that currently have any chains, which are the only ones
+// displayed by the console statistics.
+static SwapChainData* gOldestSwapChain = nullptr;
+static SwapChainData* gNewestSwapChain = nullptr;
+static std::map<uint32_t, ProcessInfo*> gPresentingProcesses;
+
+static std::unique_ptr<ProcessNameFilter> gProcessNameFilter;
+static std::unique_ptr<ProcessMetadataResolver> gProcessResolver; // Only used for realtime collection
+
+class Win32ProcessSource : public ProcessSource {
+    struct ExitWait {
+        HANDLE mWaitHandle;
+        uint32_t mProcessId;
+        ProcessMetadataResolver* mResolver;
+    };
+
+    static VOID CALLBACK OnProcessExit(PVOID context, BOOLEAN timedOut)
+    {
+        (void) timedOut;
+        auto exitWait = (ExitWait*) context;
+        exitWait->mResolver->NotifyExited(exitWait->mProcessId);
     }
 
-    *name = name->substr(i + 1);
-
-    std::transform(name->begin(), name->end(), name->begin(),
-                   [](wchar_t c) { return (wchar_t) ::towlower(c); });
-}
+public:
+    ProcessMetadata Open(uint32_t processId) override
+    {
+        wchar_t path[MAX_PATH];
+        wchar_t* processName = L"<unknown>";
 
-static bool IsTargetProcess(uint32_t processId, std::wstring const& processName)
-{
-    auto const& args = GetCommandLineArgs();
+        ProcessMetadata metadata;
+        auto handle = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION | SYNCHRONIZE, FALSE, processId);
+        if (handle != NULL) {
+            DWORD numChars = _countof(path);
+            if (QueryFullProcessImageNameW(handle, 0, path, &numChars)) {
+                for (;; --numChars) {
+                    if (numChars == 0 || path[numChars - 1] == L'\\' || path[numChars - 1] == L'/') {
+                        processName = &path[numChars];
+                        break;
+                    }
+                }
+            }
+        }
 
-    std::wstring compareName;
-    if (args.mExcludeProcessNames.size() + args.mTargetProcessNames.size() > 0) {
-        compareName = processName;
-        CanonicalizeProcessName(&compareName);
+        metadata.mModuleName = processName;
+        metadata.mHandle     = handle;
+        return metadata;
     }
 
-    // --exclude
-    for (auto excludeProcessName : args.mExcludeProcessNames) {
-        if (excludeProcessName == compareName) {
-            return false;
+    void* WatchExit(ProcessMetadata const& metadata, uint32_t processId, ProcessMetadataResolver* resolver) override
+    {
+        auto exitWait = new ExitWait{ NULL, processId, resolver };
+        if (!RegisterWaitForSingleObject(&exitWait->mWaitHandle, (HANDLE) metadata.mHandle, OnProcessExit, exitWait,
+                                         INFINITE, WT_EXECUTEONLYONCE)) {
+            delete exitWait;
+            return nullptr;
         }
+        return exitWait;
     }
 
-    // --capture_all
-    if (args.mTargetPid == 0 && args.mTargetProcessNames.empty()) {
-        return true;
+    void Close(ProcessMetadata* metadata) override
+    {
+        if (metadata->mExitWait != nullptr) {
+            // Wait for any in-progress callback to finish before freeing its context.
+            auto exitWait = (ExitWait*) metadata->mExitWait;
+            UnregisterWaitEx(exitWait->mWaitHandle, INVALID_HANDLE_VALUE);
+            delete exitWait;
+            metadata->mExitWait = nullptr;
+        }
+        if (metadata->mHandle != nullptr) {
+            CloseHandle((HANDLE) metadata->mHandle);
+            metadata->mHandle = nullptr;
+        }
     }
+};
 
-    // --process_id
-    if (args.mTargetPid != 0 && args.mTargetPid == processId) {
-        return true;
-    }
+static Win32ProcessSource gProcessSource;
 
-    // --process_name
-    for (auto targetProcessName : args.mTargetProcessNames) {
-        if (targetProcessName == compareName) {
-            return true;
-        }
+static void CloseProcessHandle(ProcessInfo* processInfo)
+{
+    ProcessMetadata metadata;
+    metadata.mHandle   = processInfo->mHandle;
+    metadata.mExitWait = processInfo->mExitWait;
+    gProcessSource.Close(&metadata);
+
+    processInfo->mHandle   = NULL;
+    processInfo->mExitWait = nullptr;
+}
+
+static void UnlinkSwapChain(SwapChainData* chain)
+{
+    (chain->mAgePrev == nullptr ? gOldestSwapChain : chain->mAgePrev->mAgeNext) = chain->mAgeNext;
+    (chain->mAgeNext == nullptr ? gNewestSwapChain : chain->mAgeNext->mAgePrev) = chain->mAgePrev;
+    chain->mAgePrev = nullptr;
+    chain->mAgeNext = nullptr;
+}
+
+static void LinkNewestSwapChain(SwapChainData* chain)
+{
+    chain->mAgePrev = gNewestSwapChain;
+    chain->mAgeNext = nullptr;
+    (gNewestSwapChain == nullptr ? gOldestSwapChain : gNewestSwapChain->mAgeNext) = chain;
+    gNewestSwapChain = chain;
+}
+
+static void EraseSwapChains(uint32_t processId, ProcessInfo* processInfo)
+{
+    for (auto& pair : processInfo->mSwapChain) {
+        UnlinkSwapChain(&pair.second);
     }
+    processInfo->mSwapChain.clear();
+    gPresentingProcesses.erase(processId);
+}
 
-    return false;
+static bool IsTargetProcess(uint32_t processId, std::wstring const& processName)
+{
+    return gProcessNameFilter->IsTargetProcess(processId, processName);
 }
 
 static void HandleTerminatedProcess(
@@ -159,9 +230,16 @@ static void ProcessProcessEvent(
 
         if (!pr.second) {
             HandleTerminatedProcess(info);
+            CloseProcessHandle(info);
+        }
+
+        // We don't need to look this process up anymore.
+        if (gProcessResolver != nullptr) {
+            gProcessResolver->Discard(processEvent.ProcessId);
         }
 
         info->mHandle          = NULL;
+        info->mExitWait        = nullptr;
         info->mModuleName      = processEvent.ImageFileName;
         info->mOutputCsv       = nullptr;
         info->mIsTargetProcess = IsTargetProcess(processEvent.ProcessId, processEvent.ImageFileName);
@@ -173,6 +251,8 @@ static void ProcessProcessEvent(
         auto ii = gProcesses.find(processEvent.ProcessId);
         if (ii != gProcesses.end()) {
             HandleTerminatedProcess(&ii->second);
+            CloseProcessHandle(&ii->second);
+            EraseSwapChains(ii->first, &ii->second);
             gProcesses.erase(std::move(ii));
         }
     }
@@ -182,40 +262,72 @@ static void UpdateProcessEvents(
     PMTraceConsumer* pmConsumer,
     std::vector<ProcessEvent>* processEvents)
 {
+    // The pending processEvents, the newly-dequeued events, and the realtime
+    // terminations below are each already in QpcTime order, so they are
+    // merged rather than re-sorting all pending events.
     std::vector<ProcessEvent> newProcessEvents;
     pmConsumer->DequeueProcessEvents(newProcessEvents);
 
-    if (!newProcessEvents.empty()) {
-        processEvents->insert(processEvents->end(), newProcessEvents.begin(), newProcessEvents.end());
-        newProcessEvents.clear();
-        newProcessEvents.shrink_to_fit();
-
-        std::sort(processEvents->begin(), processEvents->end(), [](ProcessEvent const& a, ProcessEvent const& b) { return a.QpcTime < b.QpcTime; });
-    }
-
-    // Check if any realtime processes terminated and create process events for them.
+    // Create process events for any realtime processes that were reported as terminated.
     //
     // We assume that the process terminated now, which is wrong but conservative and functionally
     // ok because no other process should start with the same PID as long as we're still holding a
     // handle to it.
-    for (auto& pair : gProcesses) {
-        auto processId = pair.first;
-        auto processInfo = &pair.second;
-
-        DWORD exitCode = 0;
-        if (processInfo->mHandle != NULL && GetExitCodeProcess(processInfo->mHandle, &exitCode) && exitCode != STILL_ACTIVE) {
+    std::vector<ProcessEvent> terminatedProcessEvents;
+    if (gProcessResolver != nullptr) {
+        std::vector<uint32_t> exitedProcessIds;
+        gProcessResolver->DequeueExitedProcesses(&exitedProcessIds);
+        if (!exitedProcessIds.empty()) {
             uint64_t qpc = 0;
             QueryPerformanceCounter((LARGE_INTEGER*) &qpc);
 
-            ProcessEvent e;
-            e.ImageFileName = processInfo->mModuleName;
-            e.QpcTime       = qpc;
-            e.ProcessId     = processId;
-            e.IsStartEvent  = false;
-            processEvents->push_back(e);
+            for (auto processId : exitedProcessIds) {
+                auto ii = gProcesses.find(processId);
+                if (ii == gProcesses.end() || ii->second.mHandle == NULL) {
+                    continue;
+                }
+
+                auto processInfo = &ii->second;
+
+                ProcessEvent e;
+                e.ImageFileName = processInfo->mModuleName;
+                e.QpcTime       = qpc;
+                e.ProcessId     = processId;
+                e.IsStartEvent  = false;
+                terminatedProcessEvents.push_back(e);
+
+                CloseProcessHandle(processInfo);
+            }
+        }
+    }
+
+    MergeProcessEvents(processEvents, { &newProcessEvents, &terminatedProcessEvents });
+}
+
+// Start looking up any processes that we don't know about yet and that won't
+// be identified by a pending ProcessStart event.
+static void RequestUnknownProcesses(
+    std::vector<std::shared_ptr<PresentEvent>> const& presentEvents,
+    std::vector<ProcessEvent> const& processEvents)
+{
+    std::unordered_set<uint32_t> startingProcessIds;
+    for (auto const& e : processEvents) {
+        if (e.IsStartEvent) {
+            startingProcessIds.insert(e.ProcessId);
+        }
+    }
+
+    uint32_t lastProcessId = 0;
+    for (auto const& presentEvent : presentEvents) {
+        auto processId = presentEvent->ProcessId;
+        if (processId == lastProcessId) {
+            continue;
+        }
+        lastProcessId = processId;
 
-            CloseHandle(processInfo->mHandle);
-            processInfo->mHandle = NULL;
+        if (gProcesses.find(processId) == gProcesses.end() &&
+            startingProcessIds.find(processId) == startingProcessIds.end()) {
+            gProcessResolver->Request(processId);
         }
     }
 }
@@ -243,6 +355,12 @@ static void UpdateChain(
     chain->mPresentSyncInterval = p.SyncInterval;
     chain->mPresentFlags        = p.PresentFlags;
     chain->mPresentInfoValid    = true;
+    chain->mConsoleRowValid     = false;
+
+    if (chain != gNewestSwapChain) {
+        UnlinkSwapChain(chain);
+        LinkNewestSwapChain(chain);
+    }
 
     // v1
     chain->mLastPresentStartTime = p.PresentStartTime;
@@ -352,44 +470,36 @@ static void PruneOldSwapChainData(
 {
     auto minTimestamp = latestTimestamp - pmSession.MilliSecondsDeltaToTimestamp(4000.0);
 
-    for (auto& pair : gProcesses) {
-        auto processInfo = &pair.second;
-        for (auto ii = processInfo->mSwapChain.begin(), ie = processInfo->mSwapChain.end(); ii != ie; ) {
-            auto chain = &ii->second;
-            if (chain->mNextFrameCPUStart < minTimestamp) {
-                ii = processInfo->mSwapChain.erase(ii);
-            } else {
-                ++ii;
-            }
+    // Presents don't complete in exactly PresentStartTime order, so the list
+    // is only approximately ordered by mNextFrameCPUStart.  Stopping at the
+    // first recent chain may delay pruning an older one behind it until a
+    // later pass, but never prunes a chain early.
+    while (gOldestSwapChain != nullptr && gOldestSwapChain->mNextFrameCPUStart < minTimestamp) {
+        auto chain = gOldestSwapChain;
+        UnlinkSwapChain(chain);
+
+        auto ii = gProcesses.find(chain->mProcessId);
+        auto processInfo = &ii->second;
+        processInfo->mSwapChain.erase(chain->mAddress);
+        if (processInfo->mSwapChain.empty()) {
+            gPresentingProcesses.erase(ii->first);
         }
     }
 }
 
 static void QueryProcessName(uint32_t processId, ProcessInfo* info)
 {
-    auto const& args = GetCommandLineArgs();
-
-    wchar_t path[MAX_PATH];
-    wchar_t* processName = L"<unknown>";
-    HANDLE handle = NULL;
-
-    if (args.mEtlFileName == nullptr) {
-        handle = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processId);
-        if (handle != NULL) {
-            DWORD numChars = _countof(path);
-            if (QueryFullProcessImageNameW(handle, 0, path, &numChars)) {
-                for (;; --numChars) {
-                    if (numChars == 0 || path[numChars - 1] == L'\\' || path[numChars - 1] == L'/') {
-                        processName = &path[numChars];
-                        break;
-                    }
-                }
-            }
-        }
+    if (gProcessResolver == nullptr) {
+        info->mModuleName = L"<unknown>";
+        info->mHandle     = NULL;
+        info->mExitWait   = nullptr;
+        return;
     }
 
-    info->mModuleName = processName;
-    info->mHandle     = handle;
+    auto metadata = gProcessResolver->Get(processId);
+    info->mModuleName = std::move(metadata.mModuleName);
+    info->mHandle     = (HANDLE) metadata.mHandle;
+    info->mExitWait   = metadata.mExitWait;
 }
 
 static bool GetPresentProcessInfo(
@@ -426,7 +536,15 @@ static bool GetPresentProcessInfo(
         return true;
     }
 
-    auto chain = &processInfo->mSwapChain[presentEvent.SwapChainAddress];
+    auto pr = processInfo->mSwapChain.emplace(presentEvent.SwapChainAddress, SwapChainData{});
+    auto chain = &pr.first->second;
+    if (pr.second) {
+        chain->mProcessId = presentEvent.ProcessId;
+        chain->mAddress   = presentEvent.SwapChainAddress;
+        LinkNewestSwapChain(chain);
+        gPresentingProcesses.emplace(presentEvent.ProcessId, processInfo);
+    }
+
     if (!chain->mPresentInfoValid) {
         UpdateChain(chain, presentEvent);
         return true;
@@ -577,6 +695,11 @@ void Output(PMTraceSession const* pmSession)
     processEvents.reserve(128);
     presentEvents.reserve(4096);
 
+    gProcessNameFilter.reset(new ProcessNameFilter(args.mTargetProcessNames, args.mExcludeProcessNames, args.mTargetPid));
+    if (args.mEtlFileName == nullptr) {
+        gProcessResolver.reset(new ProcessMetadataResolver(&gProcessSource, 4));
+    }
+
     for (;;) {
         // Read gQuit here, but then check it after processing queued events.
         // This ensures that we call Dequeue*() at least once after
@@ -589,6 +712,9 @@ void Output(PMTraceSession const* pmSession)
         // Copy process events, present events, and lost present events from ConsumerThread.
         UpdateProcessEvents(pmSession->mPMConsumer, &processEvents);
         pmSession->mPMConsumer->DequeuePresentEvents(presentEvents);
+        if (gProcessResolver != nullptr) {
+            RequestUnknownProcesses(presentEvents, processEvents);
+        }
         {
             std::vector<std::shared_ptr<PresentEvent>> lostPresentEvents;
             pmSession->mPMConsumer->DequeueLostPresentEvents(lostPresentEvents);
@@ -617,7 +743,7 @@ void Output(PMTraceSession const* pmSession)
         #endif
         case ConsoleOutput::Statistics:
             if (BeginConsoleUpdate()) {
-                for (auto const& pair : gProcesses) {
+                for (auto const& pair : gPresentingProcesses) {
                     UpdateConsole(pair.first, pair.second);
                 }
 
@@ -643,14 +769,17 @@ void Output(PMTraceSession const* pmSession)
     // Close all CSV and process handles
     for (auto& pair : gProcesses) {
         auto processInfo = &pair.second;
-        if (processInfo->mHandle != NULL) {
-            CloseHandle(processInfo->mHandle);
-        }
+        CloseProcessHandle(processInfo);
         CloseMultiCsv(processInfo);
     }
     CloseGlobalCsv();
 
     gProcesses.clear();
+    gPresentingProcesses.clear();
+    gOldestSwapChain = nullptr;
+    gNewestSwapChain = nullptr;
+    gProcessResolver.reset();
+    gProcessNameFilter.reset();
 
     gRecordingToggleHistory.clear();
     gRecordingToggleHistory.shrink_to_fit();
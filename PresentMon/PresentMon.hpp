@@ -28,6 +28,7 @@ which is controlled from MainThread based on user input or timer.
 
 #include "../PresentData/PresentMonTraceConsumer.hpp"
 #include "../PresentData/PresentMonTraceSession.hpp"
+#include "ProcessMetadata.hpp"
 
 #include <unordered_map>
 
@@ -56,10 +57,14 @@ enum class CSVOutput {
 struct CommandLineArgs {
     std::vector<std::wstring> mTargetProcessNames;
     std::vector<std::wstring> mExcludeProcessNames;
+    std::vector<std::wstring> mEtlBatch;
     const wchar_t *mOutputCsvFileName;
     const wchar_t *mEtlFileName;
     const wchar_t *mSessionName;
+    const wchar_t *mBatchOutputDir;
     UINT mTargetPid;
+    UINT mBatchJobs;
+    UINT mLostPresentAgeMs;
     UINT mDelay;
     UINT mTimer;
     UINT mHotkeyModifiers;
@@ -82,6 +87,7 @@ struct CommandLineArgs {
     bool mMultiCsv;
     bool mUseV1Metrics;
     bool mStopExistingSession;
+    bool mPrintConsumerStats;
 };
 
 // Metrics computed per-frame.  Duration and Latency metrics are in milliseconds.
@@ -115,6 +121,9 @@ struct FrameMetrics1 {
 //   presents,
 // - pending presents whose metrics cannot be computed until future presents are received,
 // - exponential averages of key metrics displayed in console output.
+//
+// Every SwapChainData is also linked into an age-ordered list (see OutputThread.cpp), so it must
+// not be copied or moved once it is added to ProcessInfo::mSwapChain.
 struct SwapChainData {
     // Pending presents waiting for the next displayed present.
     std::vector<std::shared_ptr<PresentEvent>> mPendingPresents;
@@ -134,12 +143,23 @@ struct SwapChainData {
     float mAvgGPUDuration = 0.f;
     float mAvgDisplayLatency = 0.f;
     float mAvgDisplayedTime = 0.f;
+
+    // Age-ordered list links, and the keys needed to erase this chain when it is pruned
+    SwapChainData* mAgePrev = nullptr;
+    SwapChainData* mAgeNext = nullptr;
+    uint32_t mProcessId = 0;
+    uint64_t mAddress = 0;
+
+    // Console statistics row, re-formatted only after the chain is updated
+    std::wstring mConsoleRow;
+    bool mConsoleRowValid = false;
 };
 
 struct ProcessInfo {
     std::wstring mModuleName;
     std::unordered_map<uint64_t, SwapChainData> mSwapChain;
     HANDLE mHandle;
+    void* mExitWait;
     FILE* mOutputCsv;
     bool mIsTargetProcess;
 };
@@ -157,9 +177,10 @@ bool BeginConsoleUpdate();
 void EndConsoleUpdate();
 void ConsolePrint(wchar_t const* format, ...);
 void ConsolePrintLn(wchar_t const* format, ...);
-void UpdateConsole(uint32_t processId, ProcessInfo const& processInfo);
+void UpdateConsole(uint32_t processId, ProcessInfo* processInfo);
 int PrintWarning(wchar_t const* format, ...);
 int PrintError(wchar_t const* format, ...);
+void PrintConsumerStats(ConsumerStatsSnapshot const& stats);
 
 // ConsumerThread.cpp:
 void StartConsumerThread(TRACEHANDLE traceHandle);
@@ -174,6 +195,9 @@ const char* RuntimeToString(Runtime rt);
 void UpdateCsv(PMTraceSession const& pmSession, ProcessInfo* processInfo, PresentEvent const& p, FrameMetrics const& metrics);
 void UpdateCsv(PMTraceSession const& pmSession, ProcessInfo* processInfo, PresentEvent const& p, FrameMetrics1 const& metrics);
 
+// EtlBatch.cpp:
+int RunEtlBatch(int argc, wchar_t** argv);
+
 // MainThread.cpp:
 void ExitMainThread();
 
@@ -181,7 +205,6 @@ void ExitMainThread();
 void StartOutputThread(PMTraceSession const& pmSession);
 void StopOutputThread();
 void SetOutputRecordingState(bool record);
-void CanonicalizeProcessName(std::wstring* path);
 
 // Privilege.cpp:
 bool InPerfLogUsersGroup();
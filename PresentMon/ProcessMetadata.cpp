@@ -0,0 +1,197 @@
+// Copyright (C) 2024 Intel Corporation
+// SPDX-License-Identifier: MIT
+
+#include "ProcessMetadata.hpp"
+
+#include <algorithm>
+#include <cwctype>
+
+void CanonicalizeProcessName(std::wstring* name)
+{
+    size_t i = name->find_last_of(L"./\\");
+    if (i != std::wstring::npos && (*name)[i] == L'.') {
+        name->resize(i);
+        i = name->find_last_of(L"/\\");
+    }
+
+    *name = name->substr(i + 1);
+
+    std::transform(name->begin(), name->end(), name->begin(),
+                   [](wchar_t c) { return (wchar_t) std::towlower(c); });
+}
+
+ProcessNameFilter::ProcessNameFilter(
+    std::vector<std::wstring> const& targetProcessNames,
+    std::vector<std::wstring> const& excludeProcessNames,
+    uint32_t targetProcessId)
+    : mTargetProcessNames(targetProcessNames.begin(), targetProcessNames.end())
+    , mExcludeProcessNames(excludeProcessNames.begin(), excludeProcessNames.end())
+    , mTargetProcessId(targetProcessId)
+{
+}
+
+bool ProcessNameFilter::IsTargetProcess(uint32_t processId, std::wstring const& processName) const
+{
+    std::wstring compareName;
+    if (!mExcludeProcessNames.empty() || !mTargetProcessNames.empty()) {
+        compareName = processName;
+        CanonicalizeProcessName(&compareName);
+    }
+
+    // --exclude
+    if (mExcludeProcessNames.find(compareName) != mExcludeProcessNames.end()) {
+        return false;
+    }
+
+    // --capture_all
+    if (mTargetProcessId == 0 && mTargetProcessNames.empty()) {
+        return true;
+    }
+
+    // --process_id
+    if (mTargetProcessId != 0 && mTargetProcessId == processId) {
+        return true;
+    }
+
+    // --process_name
+    return mTargetProcessNames.find(compareName) != mTargetProcessNames.end();
+}
+
+ProcessMetadataResolver::ProcessMetadataResolver(ProcessSource* source, uint32_t threadCount)
+    : mSource(source)
+{
+    threadCount = (std::max)(threadCount, 1u);
+    mThreads.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; ++i) {
+        mThreads.emplace_back(&ProcessMetadataResolver::Resolve, this);
+    }
+}
+
+ProcessMetadataResolver::~ProcessMetadataResolver()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mQuit = true;
+    }
+    mRequestCV.notify_all();
+
+    for (auto& thread : mThreads) {
+        thread.join();
+    }
+
+    // Release any lookups that were never retrieved.
+    for (auto& pair : mEntries) {
+        if (pair.second.mResolved) {
+            mSource->Close(&pair.second.mMetadata);
+        }
+    }
+    mEntries.clear();
+}
+
+void ProcessMetadataResolver::Request(uint32_t processId)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto pr = mEntries.emplace(processId, Entry{});
+        if (!pr.second) {
+            pr.first->second.mDiscarded = false;
+            return;
+        }
+        mRequests.push_back(processId);
+    }
+    mRequestCV.notify_one();
+}
+
+ProcessMetadata ProcessMetadataResolver::Get(uint32_t processId)
+{
+    Request(processId);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    auto ii = mEntries.find(processId);
+    mResolvedCV.wait(lock, [&]() { return ii->second.mResolved; });
+
+    auto metadata = std::move(ii->second.mMetadata);
+    if (ii->second.mExited) {
+        mExitedProcessIds.push_back(processId);
+    }
+    mEntries.erase(ii);
+    return metadata;
+}
+
+void ProcessMetadataResolver::Discard(uint32_t processId)
+{
+    ProcessMetadata metadata;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto ii = mEntries.find(processId);
+        if (ii == mEntries.end()) {
+            return;
+        }
+
+        // If the lookup is still running, the worker releases it when done.
+        if (!ii->second.mResolved) {
+            ii->second.mDiscarded = true;
+            return;
+        }
+
+        metadata = std::move(ii->second.mMetadata);
+        mEntries.erase(ii);
+    }
+
+    mSource->Close(&metadata);
+}
+
+void ProcessMetadataResolver::NotifyExited(uint32_t processId)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    // If the metadata hasn't been retrieved yet, defer the notification until
+    // it is so that the caller knows about the process first.
+    auto ii = mEntries.find(processId);
+    if (ii != mEntries.end()) {
+        ii->second.mExited = true;
+    } else {
+        mExitedProcessIds.push_back(processId);
+    }
+}
+
+void ProcessMetadataResolver::DequeueExitedProcesses(std::vector<uint32_t>* processIds)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    processIds->insert(processIds->end(), mExitedProcessIds.begin(), mExitedProcessIds.end());
+    mExitedProcessIds.clear();
+}
+
+void ProcessMetadataResolver::Resolve()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    for (;;) {
+        mRequestCV.wait(lock, [this]() { return mQuit || !mRequests.empty(); });
+        if (mQuit) {
+            break;
+        }
+
+        auto processId = mRequests.front();
+        mRequests.pop_front();
+
+        lock.unlock();
+        auto metadata = mSource->Open(processId);
+        if (metadata.mHandle != nullptr) {
+            metadata.mExitWait = mSource->WatchExit(metadata, processId, this);
+        }
+        lock.lock();
+
+        auto ii = mEntries.find(processId);
+        if (ii->second.mDiscarded) {
+            mEntries.erase(ii);
+            lock.unlock();
+            mSource->Close(&metadata);
+            lock.lock();
+            continue;
+        }
+
+        ii->second.mMetadata = std::move(metadata);
+        ii->second.mResolved = true;
+        mResolvedCV.notify_all();
+    }
+}
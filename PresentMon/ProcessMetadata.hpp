@@ -0,0 +1,122 @@
+// Copyright (C) 2024 Intel Corporation
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+/*
+Process name filtering and process metadata lookup used by the OutputThread.
+
+This code does not depend on the OS; the OS-specific queries are provided by a
+ProcessSource implementation (see OutputThread.cpp), so it can also be run
+against a fake ProcessSource.
+
+ProcessMetadataResolver looks up process metadata on a small pool of worker
+threads.  The OutputThread requests every unknown process id as soon as it
+dequeues the presents that reference them, so the lookups run concurrently
+instead of one at a time as each process' first present is handled.  Process
+exit is also reported asynchronously by the ProcessSource, rather than by
+polling every process handle each update.
+*/
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Removes any directory and extension, and converts the remaining name to
+// lower case.
+void CanonicalizeProcessName(std::wstring* name);
+
+// ProcessNameFilter decides which processes are targeted based on the
+// --process_name, --exclude, and --process_id arguments (or all processes if
+// neither --process_name or --process_id are used).  Names are compared
+// canonicalized, using hash lookups.
+class ProcessNameFilter {
+public:
+    ProcessNameFilter(std::vector<std::wstring> const& targetProcessNames,
+                      std::vector<std::wstring> const& excludeProcessNames,
+                      uint32_t targetProcessId);
+
+    bool IsTargetProcess(uint32_t processId, std::wstring const& processName) const;
+
+private:
+    std::unordered_set<std::wstring> mTargetProcessNames;
+    std::unordered_set<std::wstring> mExcludeProcessNames;
+    uint32_t mTargetProcessId;
+};
+
+struct ProcessMetadata {
+    std::wstring mModuleName;
+    void* mHandle = nullptr;    // Process handle used to detect exit, or nullptr if it couldn't be opened
+    void* mExitWait = nullptr;  // Exit watch returned by ProcessSource::WatchExit()
+};
+
+class ProcessMetadataResolver;
+
+class ProcessSource {
+public:
+    virtual ~ProcessSource() = default;
+
+    // Query the process' module name and open a handle that can be used to
+    // detect the process' exit.  This is called from the resolver's worker
+    // threads.
+    virtual ProcessMetadata Open(uint32_t processId) = 0;
+
+    // Start watching metadata.mHandle, calling resolver->NotifyExited() from
+    // any thread once the process exits.
+    virtual void* WatchExit(ProcessMetadata const& metadata, uint32_t processId, ProcessMetadataResolver* resolver) = 0;
+
+    // Stop watching for exit and release the handle.  No NotifyExited() call
+    // will be made for this process once this returns.
+    virtual void Close(ProcessMetadata* metadata) = 0;
+};
+
+class ProcessMetadataResolver {
+public:
+    ProcessMetadataResolver(ProcessSource* source, uint32_t threadCount);
+    ~ProcessMetadataResolver();
+
+    // Start looking up processId, if it isn't already being looked up.
+    void Request(uint32_t processId);
+
+    // Wait for processId's lookup to complete (requesting it if needed) and
+    // return the result.  The caller takes ownership of the result and must
+    // release it with ProcessSource::Close().
+    ProcessMetadata Get(uint32_t processId);
+
+    // Release a requested lookup that is no longer needed (e.g., because the
+    // process was identified from a ProcessStart event instead).
+    void Discard(uint32_t processId);
+
+    // Called by the ProcessSource when a watched process exits.
+    void NotifyExited(uint32_t processId);
+
+    // Move the ids of processes whose metadata has been returned by Get() and
+    // have since exited into processIds.
+    void DequeueExitedProcesses(std::vector<uint32_t>* processIds);
+
+private:
+    struct Entry {
+        ProcessMetadata mMetadata;
+        bool mResolved = false;
+        bool mExited = false;
+        bool mDiscarded = false;
+    };
+
+    void Resolve();
+
+    ProcessSource* mSource;
+    std::mutex mMutex;
+    std::condition_variable mRequestCV;
+    std::condition_variable mResolvedCV;
+    std::deque<uint32_t> mRequests;
+    std::unordered_map<uint32_t, Entry> mEntries;   // ProcessId -> Entry, until returned by Get()
+    std::vector<uint32_t> mExitedProcessIds;
+    std::vector<std::thread> mThreads;
+    bool mQuit = false;
+};
@@ -0,0 +1,110 @@
+// Copyright (C) 2024 Intel Corporation
+// SPDX-License-Identifier: MIT
+
+#include "PresentMonTests.h"
+#include "../PresentData/PresentMonTraceConsumer.hpp"
+
+namespace {
+
+using ProcessEvents = std::vector<ProcessEvent>;
+
+// ProcessId identifies each event, so tests can check both the order and
+// that every event was carried over exactly once.
+ProcessEvent MakeEvent(uint64_t qpcTime, uint32_t processId)
+{
+    ProcessEvent e;
+    e.ImageFileName = L"process" + std::to_wstring(processId) + L".exe";
+    e.QpcTime = qpcTime;
+    e.ProcessId = processId;
+    e.IsStartEvent = true;
+    return e;
+}
+
+std::vector<uint32_t> ProcessIds(ProcessEvents const& events)
+{
+    std::vector<uint32_t> ids;
+    for (auto const& e : events) {
+        ids.push_back(e.ProcessId);
+    }
+    return ids;
+}
+
+}
+
+TEST(MergeProcessEventsTests, InterleavedSources)
+{
+    ProcessEvents events     { MakeEvent(10, 1), MakeEvent(40, 4), MakeEvent(70, 7) };
+    ProcessEvents newEvents  { MakeEvent(20, 2), MakeEvent(50, 5), MakeEvent(80, 8), MakeEvent(90, 9) };
+    ProcessEvents termEvents { MakeEvent( 5, 0), MakeEvent(30, 3), MakeEvent(60, 6) };
+
+    MergeProcessEvents(&events, { &newEvents, &termEvents });
+
+    EXPECT_EQ(ProcessIds(events), (std::vector<uint32_t>{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+    for (auto const& e : events) {
+        EXPECT_EQ(e.ImageFileName, L"process" + std::to_wstring(e.ProcessId) + L".exe");
+    }
+    EXPECT_TRUE(newEvents.empty());
+    EXPECT_TRUE(termEvents.empty());
+}
+
+TEST(MergeProcessEventsTests, TiesKeepSourceOrder)
+{
+    // Events with the same QpcTime come out with existing events first, then
+    // each source in the order given, and in their original order within a
+    // sequence.
+    ProcessEvents events     { MakeEvent(10, 1), MakeEvent(20, 4), MakeEvent(20, 5) };
+    ProcessEvents newEvents  { MakeEvent(10, 2), MakeEvent(20, 6), MakeEvent(30, 9) };
+    ProcessEvents termEvents { MakeEvent(10, 3), MakeEvent(20, 7), MakeEvent(20, 8) };
+
+    MergeProcessEvents(&events, { &newEvents, &termEvents });
+
+    EXPECT_EQ(ProcessIds(events), (std::vector<uint32_t>{ 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+}
+
+TEST(MergeProcessEventsTests, AllEmpty)
+{
+    ProcessEvents events;
+    ProcessEvents newEvents;
+    ProcessEvents termEvents;
+
+    MergeProcessEvents(&events, { &newEvents, &termEvents });
+
+    EXPECT_TRUE(events.empty());
+    EXPECT_TRUE(newEvents.empty());
+    EXPECT_TRUE(termEvents.empty());
+}
+
+TEST(MergeProcessEventsTests, EmptySources)
+{
+    ProcessEvents events { MakeEvent(10, 1), MakeEvent(20, 2) };
+    ProcessEvents newEvents;
+    ProcessEvents termEvents;
+
+    MergeProcessEvents(&events, { &newEvents, &termEvents });
+
+    EXPECT_EQ(ProcessIds(events), (std::vector<uint32_t>{ 1, 2 }));
+}
+
+TEST(MergeProcessEventsTests, OnlyOneSourceHasEvents)
+{
+    ProcessEvents events;
+    ProcessEvents newEvents;
+    ProcessEvents termEvents { MakeEvent(10, 1), MakeEvent(20, 2) };
+
+    MergeProcessEvents(&events, { &newEvents, &termEvents });
+
+    EXPECT_EQ(ProcessIds(events), (std::vector<uint32_t>{ 1, 2 }));
+    EXPECT_TRUE(termEvents.empty());
+}
+
+TEST(MergeProcessEventsTests, OneEmptySourceAmongSeveral)
+{
+    ProcessEvents events     { MakeEvent(15, 2) };
+    ProcessEvents newEvents;
+    ProcessEvents termEvents { MakeEvent(10, 1), MakeEvent(20, 3) };
+
+    MergeProcessEvents(&events, { &newEvents, &termEvents });
+
+    EXPECT_EQ(ProcessIds(events), (std::vector<uint32_t>{ 1, 2, 3 }));
+    EXPECT_TRUE(termEvents.empty());
+}
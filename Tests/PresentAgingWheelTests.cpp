@@ -0,0 +1,193 @@
+// Copyright (C) 2024 Intel Corporation
+// SPDX-License-Identifier: MIT
+
+#include "PresentMonTests.h"
+#include "../PresentData/PresentMonTraceConsumer.hpp"
+
+namespace {
+
+using PresentList = std::vector<std::shared_ptr<PresentEvent>>;
+
+// Use a one-QPC tick so that deadlines are expressed directly in ticks.
+constexpr uint64_t kLevel1Span  = 1ull << (PresentAgingWheel::kSlotBits * 1);
+constexpr uint64_t kLevel2Span  = 1ull << (PresentAgingWheel::kSlotBits * 2);
+constexpr uint64_t kLevel3Span  = 1ull << (PresentAgingWheel::kSlotBits * 3);
+constexpr uint64_t kHorizonTick = (uint64_t) PresentAgingWheel::kSlotCount << (PresentAgingWheel::kSlotBits * 3);
+
+std::shared_ptr<PresentEvent> InsertPresent(PresentAgingWheel* wheel, uint64_t deadline)
+{
+    auto p = std::make_shared<PresentEvent>();
+    wheel->Insert(p, deadline);
+    return p;
+}
+
+// Advance to each deadline in turn, checking that the present expires
+// exactly at its deadline and not one tick earlier.
+void ExpectExpiresAt(PresentAgingWheel* wheel, std::shared_ptr<PresentEvent> const& p, uint64_t deadline)
+{
+    PresentList expired;
+    wheel->Advance(deadline - 1, &expired);
+    EXPECT_TRUE(expired.empty()) << "present expired before deadline " << deadline;
+
+    wheel->Advance(deadline, &expired);
+    ASSERT_EQ(expired.size(), 1u) << "present did not expire at deadline " << deadline;
+    EXPECT_EQ(expired[0], p);
+    EXPECT_EQ(p->AgingWheelIndex, PresentAgingWheel::kInvalidIndex);
+}
+
+}
+
+TEST(PresentAgingWheelTests, ExpiresAtDeadline)
+{
+    PresentAgingWheel wheel;
+    wheel.Start(1, 0);
+
+    auto p = InsertPresent(&wheel, 5);
+    EXPECT_EQ(wheel.Size(), 1u);
+    EXPECT_NE(p->AgingWheelIndex, PresentAgingWheel::kInvalidIndex);
+
+    ExpectExpiresAt(&wheel, p, 5);
+    EXPECT_EQ(wheel.Size(), 0u);
+}
+
+TEST(PresentAgingWheelTests, DeadlineRoundsUpToTick)
+{
+    PresentAgingWheel wheel;
+    wheel.Start(10, 0);
+
+    // Deadline 15 falls inside tick 1, so it must not expire until tick 2
+    // starts at QPC 20.
+    auto p = InsertPresent(&wheel, 15);
+
+    PresentList expired;
+    wheel.Advance(19, &expired);
+    EXPECT_TRUE(expired.empty());
+    wheel.Advance(20, &expired);
+    ASSERT_EQ(expired.size(), 1u);
+    EXPECT_EQ(expired[0], p);
+}
+
+TEST(PresentAgingWheelTests, PastDeadlineExpiresOnNextTick)
+{
+    PresentAgingWheel wheel;
+    wheel.Start(1, 100);
+
+    auto p = InsertPresent(&wheel, 50);
+    ExpectExpiresAt(&wheel, p, 101);
+}
+
+TEST(PresentAgingWheelTests, CascadesFromEachLevel)
+{
+    PresentAgingWheel wheel;
+    wheel.Start(1, 0);
+
+    // One deadline stored in each level, none on a slot boundary so that the
+    // present has to cascade all the way down to level 0 before expiring.
+    uint64_t deadlines[] = {
+        37,
+        kLevel1Span * 3 + 5,
+        kLevel2Span * 2 + kLevel1Span + 7,
+        kLevel3Span * 5 + kLevel2Span * 3 + kLevel1Span * 2 + 9,
+    };
+
+    std::shared_ptr<PresentEvent> presents[_countof(deadlines)];
+    for (size_t i = 0; i < _countof(deadlines); ++i) {
+        presents[i] = InsertPresent(&wheel, deadlines[i]);
+    }
+    EXPECT_EQ(wheel.Size(), _countof(deadlines));
+
+    for (size_t i = 0; i < _countof(deadlines); ++i) {
+        ExpectExpiresAt(&wheel, presents[i], deadlines[i]);
+        EXPECT_EQ(wheel.Size(), _countof(deadlines) - i - 1);
+    }
+}
+
+TEST(PresentAgingWheelTests, CascadesWhenAdvancingInOneStep)
+{
+    PresentAgingWheel wheel;
+    wheel.Start(1, 0);
+
+    auto a = InsertPresent(&wheel, kLevel2Span + 3);
+    auto b = InsertPresent(&wheel, kLevel3Span * 2 + 11);
+
+    // A single large advance must expire everything up to now, and leave
+    // later presents in the wheel.
+    PresentList expired;
+    wheel.Advance(kLevel3Span, &expired);
+    ASSERT_EQ(expired.size(), 1u);
+    EXPECT_EQ(expired[0], a);
+    EXPECT_EQ(wheel.Size(), 1u);
+
+    ExpectExpiresAt(&wheel, b, kLevel3Span * 2 + 11);
+}
+
+TEST(PresentAgingWheelTests, ClampsDeadlineToHorizon)
+{
+    PresentAgingWheel wheel;
+    wheel.Start(1, 0);
+
+    // A deadline past the highest level is clamped, so the present expires
+    // early at the horizon.  Re-inserting it, as the consumer does, then
+    // expires it at the real deadline.
+    auto deadline = kHorizonTick + kLevel2Span + 17;
+    auto p = InsertPresent(&wheel, deadline);
+
+    ExpectExpiresAt(&wheel, p, kHorizonTick);
+
+    wheel.Insert(p, deadline);
+    ExpectExpiresAt(&wheel, p, deadline);
+}
+
+TEST(PresentAgingWheelTests, RemoveFixesUpMovedEntry)
+{
+    PresentAgingWheel wheel;
+    wheel.Start(1, 0);
+
+    // Three presents in the same slot; removing the first moves the last
+    // into its position, which must then still be removable.
+    auto a = InsertPresent(&wheel, 9);
+    auto b = InsertPresent(&wheel, 9);
+    auto c = InsertPresent(&wheel, 9);
+    EXPECT_EQ(wheel.Size(), 3u);
+
+    wheel.Remove(a.get());
+    EXPECT_EQ(a->AgingWheelIndex, PresentAgingWheel::kInvalidIndex);
+    EXPECT_EQ(wheel.Size(), 2u);
+
+    wheel.Remove(c.get());
+    EXPECT_EQ(c->AgingWheelIndex, PresentAgingWheel::kInvalidIndex);
+    EXPECT_EQ(wheel.Size(), 1u);
+
+    // Removing a present that is not in the wheel is a no-op.
+    wheel.Remove(a.get());
+    EXPECT_EQ(wheel.Size(), 1u);
+
+    ExpectExpiresAt(&wheel, b, 9);
+}
+
+TEST(PresentAgingWheelTests, RemoveFromHigherLevels)
+{
+    PresentAgingWheel wheel;
+    wheel.Start(1, 0);
+
+    auto a = InsertPresent(&wheel, kLevel1Span * 2 + 1);
+    auto b = InsertPresent(&wheel, kLevel2Span * 2 + 1);
+    auto c = InsertPresent(&wheel, kLevel3Span * 2 + 1);
+    auto d = InsertPresent(&wheel, kLevel3Span * 2 + 1);
+
+    wheel.Remove(a.get());
+    wheel.Remove(c.get());
+    EXPECT_EQ(wheel.Size(), 2u);
+
+    // Remove an entry after it has cascaded down a level.
+    PresentList expired;
+    wheel.Advance(kLevel2Span * 2, &expired);
+    EXPECT_TRUE(expired.empty());
+    wheel.Remove(b.get());
+    EXPECT_EQ(wheel.Size(), 1u);
+
+    wheel.Advance(kLevel3Span * 2 + 1, &expired);
+    ASSERT_EQ(expired.size(), 1u);
+    EXPECT_EQ(expired[0], d);
+    EXPECT_EQ(wheel.Size(), 0u);
+}
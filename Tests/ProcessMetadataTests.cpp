@@ -0,0 +1,363 @@
+// Copyright (C) 2024 Intel Corporation
+// SPDX-License-Identifier: MIT
+
+#include "PresentMonTests.h"
+#include "../PresentMon/ProcessMetadata.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <random>
+
+namespace {
+
+// FakeProcessSource hands out fake handles and tracks their lifetime so the
+// tests can check that every handle opened by the resolver is closed exactly
+// once.  Open() can be held at a gate to control when lookups complete, and
+// Exit() simulates a process exit by notifying each resolver watching it.
+class FakeProcessSource : public ProcessSource {
+public:
+    ProcessMetadata Open(uint32_t processId) override
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mOpenCount += 1;
+        mInFlight += 1;
+        mCV.notify_all();
+        mCV.wait(lock, [this]() { return mGateOpen; });
+        mInFlight -= 1;
+
+        ProcessMetadata metadata;
+        metadata.mModuleName = L"process" + std::to_wstring(processId) + L".exe";
+        metadata.mHandle = reinterpret_cast<void*>(++mNextHandle);
+        mHandles.emplace(metadata.mHandle, Handle{ processId, nullptr });
+        return metadata;
+    }
+
+    void* WatchExit(ProcessMetadata const& metadata, uint32_t processId, ProcessMetadataResolver* resolver) override
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        auto ii = mHandles.find(metadata.mHandle);
+        EXPECT_TRUE(ii != mHandles.end());
+        EXPECT_EQ(ii->second.mProcessId, processId);
+        ii->second.mResolver = resolver;
+        mWatchCount += 1;
+        mCV.notify_all();
+
+        // The process may have exited while it was being opened.
+        if (mExitOnWatch.count(processId) != 0) {
+            resolver->NotifyExited(processId);
+        }
+        return metadata.mHandle;
+    }
+
+    void Close(ProcessMetadata* metadata) override
+    {
+        if (metadata->mHandle == nullptr) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        EXPECT_EQ(metadata->mExitWait, metadata->mHandle);
+        EXPECT_EQ(mHandles.erase(metadata->mHandle), 1u) << "handle closed twice";
+        metadata->mHandle = nullptr;
+        metadata->mExitWait = nullptr;
+        mCloseCount += 1;
+        mCV.notify_all();
+    }
+
+    void Exit(uint32_t processId)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (auto const& pair : mHandles) {
+            if (pair.second.mProcessId == processId && pair.second.mResolver != nullptr) {
+                pair.second.mResolver->NotifyExited(processId);
+            }
+        }
+    }
+
+    void ExitOnWatch(uint32_t processId)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mExitOnWatch.insert(processId);
+    }
+
+    void SetGate(bool open)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mGateOpen = open;
+        }
+        mCV.notify_all();
+    }
+
+    // Wait until condition() is true, or fail after a timeout.
+    template<typename Condition>
+    void WaitFor(Condition condition)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        EXPECT_TRUE(mCV.wait_for(lock, std::chrono::seconds(10), [&]() { return condition(*this); }));
+    }
+
+    uint32_t OpenCount()  { std::lock_guard<std::mutex> lock(mMutex); return mOpenCount; }
+    uint32_t CloseCount() { std::lock_guard<std::mutex> lock(mMutex); return mCloseCount; }
+    size_t OpenHandles()  { std::lock_guard<std::mutex> lock(mMutex); return mHandles.size(); }
+
+    // Only read from within WaitFor()
+    uint32_t mOpenCount = 0;
+    uint32_t mCloseCount = 0;
+    uint32_t mWatchCount = 0;
+    uint32_t mInFlight = 0;
+
+private:
+    struct Handle {
+        uint32_t mProcessId;
+        ProcessMetadataResolver* mResolver;
+    };
+
+    std::mutex mMutex;
+    std::condition_variable mCV;
+    std::unordered_map<void*, Handle> mHandles;
+    std::unordered_set<uint32_t> mExitOnWatch;
+    uintptr_t mNextHandle = 0;
+    bool mGateOpen = true;
+};
+
+std::vector<uint32_t> DequeueExited(ProcessMetadataResolver* resolver)
+{
+    std::vector<uint32_t> processIds;
+    resolver->DequeueExitedProcesses(&processIds);
+    return processIds;
+}
+
+}
+
+TEST(ProcessMetadataTests, CanonicalizeProcessName)
+{
+    std::wstring name(L"C:\\Program Files\\Game\\Game.Win64.EXE");
+    CanonicalizeProcessName(&name);
+    EXPECT_EQ(name, L"game.win64");
+
+    name = L"dir.with.dots/app";
+    CanonicalizeProcessName(&name);
+    EXPECT_EQ(name, L"app");
+}
+
+TEST(ProcessMetadataTests, ProcessNameFilter)
+{
+    // The command line canonicalizes the argument names.
+    ProcessNameFilter all({}, { L"dwm" }, 0);
+    EXPECT_TRUE(all.IsTargetProcess(1, L"C:\\game.exe"));
+    EXPECT_FALSE(all.IsTargetProcess(2, L"C:\\Windows\\DWM.exe"));
+
+    ProcessNameFilter byName({ L"game" }, {}, 0);
+    EXPECT_TRUE(byName.IsTargetProcess(1, L"D:\\Game.exe"));
+    EXPECT_FALSE(byName.IsTargetProcess(2, L"other.exe"));
+
+    ProcessNameFilter byId({}, {}, 42);
+    EXPECT_TRUE(byId.IsTargetProcess(42, L"anything.exe"));
+    EXPECT_FALSE(byId.IsTargetProcess(43, L"anything.exe"));
+}
+
+TEST(ProcessMetadataTests, GetReturnsMetadata)
+{
+    FakeProcessSource source;
+    {
+        ProcessMetadataResolver resolver(&source, 2);
+
+        auto metadata = resolver.Get(7);
+        EXPECT_EQ(metadata.mModuleName, L"process7.exe");
+        EXPECT_NE(metadata.mHandle, nullptr);
+        EXPECT_EQ(metadata.mExitWait, metadata.mHandle);
+        source.Close(&metadata);
+    }
+    EXPECT_EQ(source.OpenCount(), 1u);
+    EXPECT_EQ(source.OpenHandles(), 0u);
+}
+
+TEST(ProcessMetadataTests, RequestsResolveConcurrently)
+{
+    FakeProcessSource source;
+    source.SetGate(false);
+    {
+        ProcessMetadataResolver resolver(&source, 4);
+        for (uint32_t processId = 1; processId <= 4; ++processId) {
+            resolver.Request(processId);
+        }
+
+        // Requesting an id that is already pending doesn't start another
+        // lookup.
+        resolver.Request(1);
+
+        source.WaitFor([](FakeProcessSource const& s) { return s.mInFlight == 4; });
+        source.SetGate(true);
+
+        for (uint32_t processId = 1; processId <= 4; ++processId) {
+            auto metadata = resolver.Get(processId);
+            EXPECT_EQ(metadata.mModuleName, L"process" + std::to_wstring(processId) + L".exe");
+            source.Close(&metadata);
+        }
+    }
+    EXPECT_EQ(source.OpenCount(), 4u);
+    EXPECT_EQ(source.OpenHandles(), 0u);
+}
+
+TEST(ProcessMetadataTests, DiscardWhileResolving)
+{
+    FakeProcessSource source;
+    source.SetGate(false);
+    {
+        ProcessMetadataResolver resolver(&source, 1);
+        resolver.Request(3);
+        source.WaitFor([](FakeProcessSource const& s) { return s.mInFlight == 1; });
+
+        // The worker releases the lookup itself once it completes.
+        resolver.Discard(3);
+        source.SetGate(true);
+        source.WaitFor([](FakeProcessSource const& s) { return s.mCloseCount == 1; });
+        EXPECT_EQ(source.OpenHandles(), 0u);
+    }
+    EXPECT_EQ(source.OpenCount(), 1u);
+}
+
+TEST(ProcessMetadataTests, DiscardAfterResolved)
+{
+    FakeProcessSource source;
+    {
+        ProcessMetadataResolver resolver(&source, 1);
+        resolver.Request(3);
+        source.WaitFor([](FakeProcessSource const& s) { return s.mWatchCount == 1; });
+
+        // Whether or not the worker has published the result yet, the
+        // handle is closed exactly once.
+        resolver.Discard(3);
+        source.WaitFor([](FakeProcessSource const& s) { return s.mCloseCount == 1; });
+
+        // Discarding an unknown id is a no-op.
+        resolver.Discard(3);
+    }
+    EXPECT_EQ(source.OpenCount(), 1u);
+    EXPECT_EQ(source.CloseCount(), 1u);
+}
+
+TEST(ProcessMetadataTests, RequestAfterDiscardKeepsLookup)
+{
+    FakeProcessSource source;
+    source.SetGate(false);
+    {
+        ProcessMetadataResolver resolver(&source, 1);
+        resolver.Request(9);
+        source.WaitFor([](FakeProcessSource const& s) { return s.mInFlight == 1; });
+
+        // Re-requesting a discarded lookup that is still running reuses it
+        // rather than closing it.
+        resolver.Discard(9);
+        resolver.Request(9);
+        source.SetGate(true);
+
+        auto metadata = resolver.Get(9);
+        EXPECT_NE(metadata.mHandle, nullptr);
+        EXPECT_EQ(source.CloseCount(), 0u);
+        source.Close(&metadata);
+    }
+    EXPECT_EQ(source.OpenCount(), 1u);
+    EXPECT_EQ(source.OpenHandles(), 0u);
+}
+
+TEST(ProcessMetadataTests, ExitBeforeGetIsDeferred)
+{
+    FakeProcessSource source;
+    source.ExitOnWatch(5);
+    {
+        ProcessMetadataResolver resolver(&source, 1);
+        resolver.Request(5);
+        source.WaitFor([](FakeProcessSource const& s) { return s.mWatchCount == 1; });
+
+        // The exit isn't reported until the caller has received the metadata.
+        EXPECT_TRUE(DequeueExited(&resolver).empty());
+
+        auto metadata = resolver.Get(5);
+        EXPECT_EQ(DequeueExited(&resolver), std::vector<uint32_t>{ 5 });
+        EXPECT_TRUE(DequeueExited(&resolver).empty());
+        source.Close(&metadata);
+    }
+    EXPECT_EQ(source.OpenHandles(), 0u);
+}
+
+TEST(ProcessMetadataTests, ExitAfterGet)
+{
+    FakeProcessSource source;
+    {
+        ProcessMetadataResolver resolver(&source, 1);
+
+        auto metadata = resolver.Get(11);
+        EXPECT_TRUE(DequeueExited(&resolver).empty());
+
+        source.Exit(11);
+        EXPECT_EQ(DequeueExited(&resolver), std::vector<uint32_t>{ 11 });
+
+        // No exit is reported once the handle is closed.
+        source.Close(&metadata);
+        source.Exit(11);
+        EXPECT_TRUE(DequeueExited(&resolver).empty());
+    }
+    EXPECT_EQ(source.OpenHandles(), 0u);
+}
+
+TEST(ProcessMetadataTests, DestructorReleasesUnretrievedLookups)
+{
+    FakeProcessSource source;
+    {
+        ProcessMetadataResolver resolver(&source, 2);
+        for (uint32_t processId = 1; processId <= 8; ++processId) {
+            resolver.Request(processId);
+        }
+        source.WaitFor([](FakeProcessSource const& s) { return s.mWatchCount == 8; });
+    }
+    EXPECT_EQ(source.OpenCount(), 8u);
+    EXPECT_EQ(source.OpenHandles(), 0u);
+}
+
+TEST(ProcessMetadataTests, ConcurrentRequestDiscardGetExit)
+{
+    // Callers race Request/Discard/Get against exits reported from other
+    // threads.  Every handle the resolver opens must end up closed exactly
+    // once, and no exit may be reported for an id that was never requested.
+    constexpr uint32_t kProcessCount = 64;
+    constexpr uint32_t kIterations = 2000;
+
+    FakeProcessSource source;
+    {
+        ProcessMetadataResolver resolver(&source, 4);
+
+        std::atomic<bool> done = false;
+        std::thread exiter([&]() {
+            std::mt19937 rng(1);
+            while (!done) {
+                source.Exit(rng() % kProcessCount);
+            }
+        });
+
+        std::mt19937 rng(2);
+        for (uint32_t i = 0; i < kIterations; ++i) {
+            auto processId = (uint32_t) (rng() % kProcessCount);
+            switch (rng() % 3) {
+            case 0: resolver.Request(processId); break;
+            case 1: resolver.Discard(processId); break;
+            case 2: {
+                auto metadata = resolver.Get(processId);
+                EXPECT_EQ(metadata.mModuleName, L"process" + std::to_wstring(processId) + L".exe");
+                source.Close(&metadata);
+                break;
+            }
+            }
+        }
+
+        done = true;
+        exiter.join();
+
+        for (auto processId : DequeueExited(&resolver)) {
+            EXPECT_LT(processId, kProcessCount);
+        }
+    }
+    EXPECT_EQ(source.OpenHandles(), 0u);
+    EXPECT_EQ(source.OpenCount(), source.CloseCount());
+}